@@ -0,0 +1,246 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ *
+ *  Where the time goes: the oracle or the ellipsoid.
+ *
+ *  Solves each of the bundled problems `repeats` times with a `SolverStats`
+ *  observer and writes, as JSON on stdout, for each problem: the iterations
+ *  of a solve, the time of a solve in `assess_*` and in `update_*`, the cuts
+ *  per second, and the peak RSS of the process so far.
+ *
+ *      BM_breakdown [repeats [problem]]
+ *
+ *  The peak RSS only grows, so that a problem of its own, e.g.
+ *  `BM_breakdown 100 lmi`, gives the peak RSS of that problem alone.
+ */
+#include <cmath>                               // for exp
+#include <cstdio>                              // for printf
+#include <cstdlib>                             // for atoi
+#include <cstring>                             // for strcmp
+#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim, cutting_plane_optim_q
+#include <ellalgo/cutting_plane_observer.hpp>  // for SolverStats
+#include <ellalgo/ell.hpp>                     // for Ell
+#include <ellalgo/ell_config.hpp>              // for Options
+#include <ellalgo/ell_matrix.hpp>              // for Matrix
+#include <ellalgo/oracles/lmi_oracle.hpp>      // for LmiOracle
+#include <ellalgo/oracles/lowpass_oracle.hpp>  // for create_lowpass_case
+#include <ellalgo/oracles/profit_oracle.hpp>   // for ProfitOracle, ProfitOracleRb, ProfitOracleQ
+#include <tuple>                               // for tuple, get
+#include <utility>                             // for pair
+#include <valarray>                            // for valarray
+#include <vector>                              // for vector
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <sys/resource.h>  // for getrusage
+#endif
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief The problem of test_lmi.cpp
+ */
+class MyLMIOracle {
+    using Cut = std::pair<Vec, double>;
+
+    LmiOracle<Vec, Matrix> lmi1;
+    LmiOracle<Vec, Matrix> lmi2;
+    const Vec c;
+
+  public:
+    MyLMIOracle(size_t m1, const std::vector<Matrix> &F1, const Matrix &B1, size_t m2,
+                const std::vector<Matrix> &F2, const Matrix &B2, Vec c)
+        : lmi1{m1, F1, B1}, lmi2{m2, F2, B2}, c{std::move(c)} {}
+
+    auto assess_optim(const Vec &x, double &gamma) -> std::tuple<Cut, bool> {
+        if (const auto cut1 = this->lmi1(x)) {
+            return {*cut1, false};
+        }
+        if (const auto cut2 = this->lmi2(x)) {
+            return {*cut2, false};
+        }
+        const auto f0 = (this->c * x).sum();
+        const auto f1 = f0 - gamma;
+        if (f1 > 0.0) {
+            return {{this->c, f1}, false};
+        }
+        gamma = f0;
+        return {{this->c, 0.0}, true};
+    }
+};
+
+/**
+ * @brief The problem of test_quasicvx.cpp
+ */
+struct MyQuasicCvxOracle {
+    using Cut = std::pair<Vec, double>;
+
+    int idx = -1;  // for round robin
+
+    auto assess_optim(const Vec &xc, double &gamma) -> std::tuple<Cut, bool> {
+        const auto sqrtx = xc[0];
+        const auto logy = xc[1];
+        const auto y = std::exp(logy);
+        for (int i = 0; i != 2; i++) {
+            this->idx = this->idx == 1 ? 0 : this->idx + 1;
+            double fj;
+            if (this->idx == 0 && (fj = sqrtx * sqrtx - logy) > 0.0) {  // exp(x) <= y
+                return {{Vec{2 * sqrtx, -1.0}, fj}, false};
+            }
+            const auto tmp3 = gamma * y;
+            if (this->idx == 1 && (fj = -sqrtx + tmp3) > 0.0) {
+                return {{Vec{-1.0, tmp3}, fj}, false};
+            }
+        }
+        gamma = sqrtx / y;
+        return {{Vec{-1.0, sqrtx}, 0}, true};
+    }
+};
+
+static auto lmi_matrices() -> std::pair<std::vector<Matrix>, std::vector<Matrix>> {
+    auto m0F1 = Matrix(2);
+    m0F1.row(0) = Vec{-7.0, -11.0};
+    m0F1.row(1) = Vec{-11.0, 3.0};
+    auto m1F1 = Matrix(2);
+    m1F1.row(0) = Vec{7.0, -18.0};
+    m1F1.row(1) = Vec{-18.0, 8.0};
+    auto m2F1 = Matrix(2);
+    m2F1.row(0) = Vec{-2.0, -8.0};
+    m2F1.row(1) = Vec{-8.0, 1.0};
+    auto B1 = Matrix(2);
+    B1.row(0) = Vec{33.0, -9.0};
+    B1.row(1) = Vec{-9.0, 26.0};
+
+    auto m0F2 = Matrix(3);
+    m0F2.row(0) = Vec{-21.0, -11.0, 0.0};
+    m0F2.row(1) = Vec{-11.0, 10.0, 8.0};
+    m0F2.row(2) = Vec{0.0, 8.0, 5.0};
+    auto m1F2 = Matrix(3);
+    m1F2.row(0) = Vec{0.0, 10.0, 16.0};
+    m1F2.row(1) = Vec{10.0, -10.0, -10.0};
+    m1F2.row(2) = Vec{16.0, -10.0, 3.0};
+    auto m2F2 = Matrix(3);
+    m2F2.row(0) = Vec{-5.0, 2.0, -17.0};
+    m2F2.row(1) = Vec{2.0, -6.0, 8.0};
+    m2F2.row(2) = Vec{-17.0, 8.0, 6.0};
+    auto B2 = Matrix(3);
+    B2.row(0) = Vec{14.0, 9.0, 40.0};
+    B2.row(1) = Vec{9.0, 91.0, 10.0};
+    B2.row(2) = Vec{40.0, 10.0, 15.0};
+
+    return {{m0F1, m1F1, m2F1, B1}, {m0F2, m1F2, m2F2, B2}};  // B last
+}
+
+/**
+ * @brief Peak resident set size of the process, in KiB (0 if unknown)
+ */
+static auto peak_rss_kib() -> long {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage {};
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+#    ifdef __APPLE__
+        return usage.ru_maxrss / 1024;  // in bytes
+#    else
+        return usage.ru_maxrss;
+#    endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief Run `solve(stats)` repeats times and write the record of the problem
+ *
+ * @param[in] solve returns the number of iterations
+ */
+template <typename Solve>
+static auto report(const char *name, int repeats, bool &first, Solve &&solve) -> void {
+    auto stats = SolverStats();
+    size_t num_iters = 0U;
+    for (auto k = 0; k != repeats; ++k) {
+        num_iters = solve(stats);
+    }
+    const auto oracle_s = stats.oracle_seconds() / repeats;
+    const auto update_s = stats.update_seconds() / repeats;
+    const auto num_cuts = double(stats.num_updates()) / repeats;
+    std::printf("%s\n    {\"name\": \"%s\", \"iterations\": %zu, \"oracle_seconds\": %.9g, "
+                "\"update_seconds\": %.9g, \"cuts_per_second\": %.9g, \"peak_rss_kib\": %ld}",
+                first ? "" : ",", name, num_iters, oracle_s, update_s,
+                num_cuts / (oracle_s + update_s), peak_rss_kib());
+    first = false;
+}
+
+auto main(int argc, char *argv[]) -> int {
+    const auto repeats = argc > 1 ? std::atoi(argv[1]) : 100;
+    const auto *only = argc > 2 ? argv[2] : nullptr;
+    if (repeats <= 0) {
+        std::fprintf(stderr, "usage: %s [repeats [problem]]\n", argv[0]);
+        return 1;
+    }
+    auto wanted = [only](const char *name) { return only == nullptr || !std::strcmp(only, name); };
+
+    const auto unit_price = 20.0;
+    const auto A = 40.0;
+    const auto limit = 30.5;
+    const auto a = Vec{0.1, 0.4};
+    const auto v = Vec{10.0, 35.0};
+
+    auto first = true;
+    std::printf("{\"repeats\": %d, \"problems\": [", repeats);
+    if (wanted("lowpass")) {
+        const auto lowpass = create_lowpass_case(32);
+        report("lowpass", repeats, first, [&lowpass](SolverStats &stats) {
+            auto omega = lowpass.first;
+            auto gamma = lowpass.second;
+            auto ellip = Ell<Vec>(40.0, Vec(0.0, 32));
+            const auto options = Options(50000, 1e-20);
+            return std::get<1>(cutting_plane_optim(omega, ellip, gamma, options, stats));
+        });
+    }
+    if (wanted("lmi")) {
+        const auto mats = lmi_matrices();
+        const auto F1 = std::vector<Matrix>(mats.first.begin(), mats.first.end() - 1);
+        const auto F2 = std::vector<Matrix>(mats.second.begin(), mats.second.end() - 1);
+        report("lmi", repeats, first, [&](SolverStats &stats) {
+            MyLMIOracle omega{2, F1, mats.first.back(), 3, F2, mats.second.back(),
+                              Vec{1.0, -1.0, 1.0}};
+            auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+            auto gamma = 1e100;
+            return std::get<1>(cutting_plane_optim(omega, ellip, gamma, Options(), stats));
+        });
+    }
+    if (wanted("profit")) {
+        report("profit", repeats, first, [&](SolverStats &stats) {
+            ProfitOracle omega{unit_price, A, limit, a, v};
+            auto ellip = Ell<Vec>(Vec{100.0, 100.0}, Vec{0.0, 0.0});
+            auto gamma = 0.0;
+            return std::get<1>(cutting_plane_optim(omega, ellip, gamma, Options(), stats));
+        });
+    }
+    if (wanted("profit_rb")) {
+        report("profit_rb", repeats, first, [&](SolverStats &stats) {
+            ProfitOracleRb omega{unit_price, A, limit, a, v, Vec{0.003, 0.007}, 1.0};
+            auto ellip = Ell<Vec>(100.0, Vec{0.0, 0.0});
+            auto gamma = 0.0;
+            return std::get<1>(cutting_plane_optim(omega, ellip, gamma, Options(), stats));
+        });
+    }
+    if (wanted("profit_q")) {
+        report("profit_q", repeats, first, [&](SolverStats &stats) {
+            ProfitOracleQ omega{unit_price, A, limit, a, v};
+            auto ellip = Ell<Vec>(100.0, Vec{0.0, 0.0});
+            auto gamma = 0.0;
+            return std::get<1>(cutting_plane_optim_q(omega, ellip, gamma, Options(), stats));
+        });
+    }
+    if (wanted("quasicvx")) {
+        report("quasicvx", repeats, first, [](SolverStats &stats) {
+            auto omega = MyQuasicCvxOracle{};
+            auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0});
+            auto gamma = 0.0;
+            const auto options = Options(2000, 1e-8);
+            return std::get<1>(cutting_plane_optim(omega, ellip, gamma, options, stats));
+        });
+    }
+    std::printf("\n]}\n");
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <ellalgo/ell_calc.hpp>    // for EllCalc, CutBatch
+#include <ellalgo/ell_config.hpp>  // for CutStatus
+#include <random>                  // for mt19937, uniform_real_distribution
+#include <tuple>                   // for tuple
+#include <vector>                  // for vector
+
+#include "benchmark/benchmark.h"  // for BENCHMARK, State, BENCHMARK_...
+
+/**
+ * @brief The parallel cuts of K = state.range(0) lanes, of every kind
+ *
+ * beta0 in [0, 0.8] and beta1 above it, against tsq in [0.5, 1.5], so that the lanes take
+ * all the paths of `EllCalc::calc_parallel_bias_cut`.
+ */
+struct CalcLanes {
+    std::vector<double> beta0;
+    std::vector<double> beta1;
+    std::vector<double> tsq;
+    std::vector<CutStatus> status;
+    std::vector<double> rho;
+    std::vector<double> sigma;
+    std::vector<double> delta;
+
+    explicit CalcLanes(size_t num)
+        : beta0(num), beta1(num), tsq(num), status(num), rho(num), sigma(num), delta(num) {
+        auto gen = std::mt19937{7U};
+        auto dist = std::uniform_real_distribution<double>{-1.0, 1.0};
+        for (auto k = 0U; k != num; ++k) {
+            this->tsq[k] = 0.5 + 0.5 * (dist(gen) + 1.0);
+            this->beta0[k] = 0.4 * (dist(gen) + 1.0);
+            this->beta1[k] = this->beta0[k] + 0.6 * (dist(gen) + 1.0);
+        }
+    }
+
+    auto out() -> CutBatch {
+        return {this->status.data(), this->rho.data(), this->sigma.data(), this->delta.data()};
+    }
+};
+
+/**
+ * @brief One `calc_parallel_bias_cut` per lane
+ *
+ * @param[in,out] state
+ */
+template <bool adaptive> static void CALC_parallel_bias_cut(benchmark::State &state) {
+    const auto num = static_cast<size_t>(state.range(0));
+    auto lanes = CalcLanes(num);
+    auto calc = EllCalc(16U);
+    calc.adaptive_parallel_cut = adaptive;
+    for (auto _ : state) {
+        for (auto k = 0U; k != num; ++k) {
+            const auto result = calc.calc_parallel_bias_cut(lanes.beta0[k], lanes.beta1[k],
+                                                            lanes.tsq[k]);
+            lanes.status[k] = std::get<0>(result);
+            std::tie(lanes.rho[k], lanes.sigma[k], lanes.delta[k]) = std::get<1>(result);
+        }
+        benchmark::DoNotOptimize(lanes.rho.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+/**
+ * @brief `calc_parallel_bias_cut_batch` on all the lanes
+ *
+ * @param[in,out] state
+ */
+template <bool adaptive> static void CALC_parallel_bias_cut_batch(benchmark::State &state) {
+    const auto num = static_cast<size_t>(state.range(0));
+    auto lanes = CalcLanes(num);
+    auto calc = EllCalc(16U);
+    calc.adaptive_parallel_cut = adaptive;
+    for (auto _ : state) {
+        calc.calc_parallel_bias_cut_batch(lanes.beta0.data(), lanes.beta1.data(),
+                                          lanes.tsq.data(), num, lanes.out());
+        benchmark::DoNotOptimize(lanes.rho.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_TEMPLATE(CALC_parallel_bias_cut, false)->Arg(4096);
+BENCHMARK_TEMPLATE(CALC_parallel_bias_cut_batch, false)->Arg(4096);
+BENCHMARK_TEMPLATE(CALC_parallel_bias_cut, true)->Arg(4096);
+BENCHMARK_TEMPLATE(CALC_parallel_bias_cut_batch, true)->Arg(4096);
+
+BENCHMARK_MAIN();
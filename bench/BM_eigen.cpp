@@ -0,0 +1,132 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <cmath>                               // for sqrt, sin, abs
+#include <ellalgo/cg_engine.hpp>               // for SymCsrMatrix
+#include <ellalgo/eigen_solver.hpp>            // for PowerIteration, Lanczos
+#include <ellalgo/ell_span.hpp>                // for make_span
+#include <ellalgo/oracles/structured_sym.hpp>  // for SparseSym
+#include <vector>                              // for vector
+
+#include "benchmark/benchmark.h"  // for BENCHMARK, State, BENCHMARK_...
+
+/**
+ * The spectrum spread over about [1, 2], of a small gap at the top
+ */
+static auto make_matrix(size_t n) -> SymCsrMatrix {
+    auto mat = SparseSym(n);
+    for (auto i = 0U; i != n; ++i) {
+        mat.add(i, i, 1.0 + double(i) / double(n));
+        if (i != 0U) {
+            mat.add(i, i - 1, -0.1);
+        }
+    }
+    return SymCsrMatrix(mat);
+}
+
+static auto make_start(size_t n) -> std::vector<double> {
+    auto x = std::vector<double>(n);
+    for (auto i = 0U; i != n; ++i) {
+        x[i] = std::sin(1.0 + 1.7 * double(i));
+    }
+    return x;
+}
+
+/**
+ * power_iteration2 of experiment/power_iteration.cpp, as it is: a new vector per operation
+ */
+static auto prototype_power_iteration2(const SymCsrMatrix &A, std::vector<double> &x,
+                                       size_t max_iters, double tol) -> double {
+    const auto n = x.size();
+    const auto dot = [n](const std::vector<double> &a, const std::vector<double> &b) {
+        auto sum = 0.0;
+        for (auto i = 0U; i != n; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    };
+    const auto times = [&A, n](const std::vector<double> &v) {
+        auto res = std::vector<double>(n);
+        A.apply(v.data(), res.data());
+        return res;
+    };
+    const auto normalized = [&dot](std::vector<double> v) {
+        const auto nrm = std::sqrt(dot(v, v));
+        for (auto &e : v) {
+            e /= nrm;
+        }
+        return v;
+    };
+    x = normalized(x);
+    auto new_x = times(x);
+    auto ld = dot(x, new_x);
+    for (auto niter = 0U; niter != max_iters; ++niter) {
+        const auto ld1 = ld;
+        x = normalized(new_x);
+        new_x = times(x);
+        ld = dot(x, new_x);
+        if (std::abs(ld1 - ld) <= tol) {
+            break;
+        }
+    }
+    return ld;
+}
+
+static void EIG_prototype(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto A = make_matrix(n);
+    const auto x0 = make_start(n);
+    while (state.KeepRunning()) {
+        auto x = x0;
+        benchmark::DoNotOptimize(prototype_power_iteration2(A, x, 2000U, 1e-9));
+    }
+}
+BENCHMARK(EIG_prototype)->Arg(200)->Arg(10000);
+
+static void EIG_power(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto A = make_matrix(n);
+    const auto x0 = make_start(n);
+    auto power = PowerIteration(n);
+    auto x = x0;
+    while (state.KeepRunning()) {
+        x = x0;
+        benchmark::DoNotOptimize(power.solve(A, make_span(x)));
+    }
+}
+BENCHMARK(EIG_power)->Arg(200)->Arg(10000);
+
+static void EIG_lanczos(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto A = make_matrix(n);
+    const auto x0 = make_start(n);
+    auto lanczos = Lanczos(n, 100);
+    auto x = x0;
+    while (state.KeepRunning()) {
+        x = x0;
+        benchmark::DoNotOptimize(lanczos.solve(A, make_span(x)));
+    }
+}
+BENCHMARK(EIG_lanczos)->Arg(200)->Arg(10000);
+
+/**
+ * The top 4 eigenvalues, 4 vectors applied at once
+ */
+static void EIG_block_power(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto k = 4U;
+    const auto A = make_matrix(n);
+    auto X0 = std::vector<double>(n * k);
+    for (auto i = 0U; i != n * k; ++i) {
+        X0[i] = std::sin(0.3 + 1.7 * double(i));
+    }
+    auto block = BlockPowerIteration(n, k);
+    auto X = X0;
+    while (state.KeepRunning()) {
+        X = X0;
+        benchmark::DoNotOptimize(block.solve(A, make_span(X)));
+    }
+}
+BENCHMARK(EIG_block_power)->Arg(200)->Arg(2000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,68 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <cmath>                    // for sin
+#include <ellalgo/ell1d.hpp>        // for ell1d
+#include <ellalgo/ell1d_batch.hpp>  // for Ell1dBatch
+#include <utility>                  // for pair
+#include <valarray>                 // for valarray
+#include <vector>                   // for vector
+
+#include "benchmark/benchmark.h"  // for BENCHMARK, State, BENCHMARK_...
+
+using Vec = std::valarray<double>;
+
+static const auto num_cuts = 40U;
+
+static auto cut_of(size_t it, size_t k) -> std::pair<double, double> {
+    return {std::sin(1.0 + 0.7 * it + 0.1 * k), 0.01 * std::sin(0.3 * it + 1.1 * k)};
+}
+
+/**
+ * K separate ell1d instances, each updated by the same deep cuts as below
+ */
+static void ELL1D_separate(benchmark::State &state) {
+    const auto num = static_cast<size_t>(state.range(0));
+    auto cuts = std::vector<std::pair<double, double>>{};
+    for (auto it = 0U; it != num_cuts; ++it) {
+        for (auto k = 0U; k != num; ++k) {
+            cuts.push_back(cut_of(it, k));
+        }
+    }
+    while (state.KeepRunning()) {
+        auto ells = std::vector<ell1d>(num, ell1d(-10.0, 10.0));
+        for (auto it = 0U; it != num_cuts; ++it) {
+            for (auto k = 0U; k != num; ++k) {
+                benchmark::DoNotOptimize(ells[k].update_bias_cut(cuts[it * num + k]));
+            }
+        }
+    }
+}
+BENCHMARK(ELL1D_separate)->Arg(1024)->Arg(1 << 14)->Arg(1 << 20);
+
+/**
+ * The same K instances in one Ell1dBatch
+ */
+static void ELL1D_batch(benchmark::State &state) {
+    const auto num = static_cast<size_t>(state.range(0));
+    const auto S = Ell1dBatch(-10.0, 10.0, num).stride();
+    auto grads = std::vector<Vec>(num_cuts, Vec(0.0, S));
+    auto betas = std::vector<Vec>(num_cuts, Vec(0.0, S));
+    for (auto it = 0U; it != num_cuts; ++it) {
+        for (auto k = 0U; k != num; ++k) {
+            const auto cut = cut_of(it, k);
+            grads[it][k] = cut.first;
+            betas[it][k] = cut.second;
+        }
+    }
+    while (state.KeepRunning()) {
+        auto batch = Ell1dBatch(-10.0, 10.0, num);
+        for (auto it = 0U; it != num_cuts; ++it) {
+            batch.update_bias_cut(grads[it], betas[it]);
+        }
+        benchmark::DoNotOptimize(batch.xc());
+    }
+}
+BENCHMARK(ELL1D_batch)->Arg(1024)->Arg(1 << 14)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,126 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <cmath>                              // for sin
+#include <ellalgo/cutting_plane.hpp>          // for cutting_plane_optim
+#include <ellalgo/ell.hpp>                    // for Ell
+#include <ellalgo/ell_batch.hpp>              // for EllBatch, cutting_plane_optim_batch
+#include <ellalgo/oracles/profit_oracle.hpp>  // for ProfitOracle, ProfitOracleBatch
+#include <utility>                            // for pair
+#include <valarray>                           // for valarray
+#include <vector>                             // for vector
+
+#include "benchmark/benchmark.h"  // for BENCHMARK, State, BENCHMARK_...
+
+using Vec = std::valarray<double>;
+
+static const auto ndim = 10U;
+static const auto num_cuts = 20U;
+
+static auto grad_of(size_t it, size_t k) -> Vec {
+    auto g = Vec(ndim);
+    for (auto i = 0U; i != ndim; ++i) {
+        g[i] = std::sin(1.0 + 0.7 * it + 1.3 * i + 0.1 * k);
+    }
+    return g;
+}
+
+/**
+ * K separate Ell instances, each updated by the same central cuts as below
+ */
+static void ELL_separate(benchmark::State &state) {
+    const auto num = static_cast<size_t>(state.range(0));
+    auto cuts = std::vector<std::pair<Vec, double>>{};
+    for (auto it = 0U; it != num_cuts; ++it) {
+        for (auto k = 0U; k != num; ++k) {
+            cuts.emplace_back(grad_of(it, k), 0.0);
+        }
+    }
+    while (state.KeepRunning()) {
+        auto ells = std::vector<Ell<Vec>>{};
+        for (auto k = 0U; k != num; ++k) {
+            ells.emplace_back(10.0, Vec(0.0, ndim));
+        }
+        for (auto it = 0U; it != num_cuts; ++it) {
+            for (auto k = 0U; k != num; ++k) {
+                benchmark::DoNotOptimize(ells[k].update_central_cut(cuts[it * num + k]));
+            }
+        }
+    }
+}
+BENCHMARK(ELL_separate)->Arg(8)->Arg(64)->Arg(512);
+
+/**
+ * The same K instances in one EllBatch
+ */
+static void ELL_batch(benchmark::State &state) {
+    const auto num = static_cast<size_t>(state.range(0));
+    auto probe = EllBatch(10.0, Vec(0.0, ndim), num);
+    const auto S = probe.stride();
+    auto grads = std::vector<Vec>{};
+    for (auto it = 0U; it != num_cuts; ++it) {
+        auto grad = Vec(0.0, ndim * S);
+        for (auto k = 0U; k != num; ++k) {
+            const auto g = grad_of(it, k);
+            for (auto i = 0U; i != ndim; ++i) {
+                grad[i * S + k] = g[i];
+            }
+        }
+        grads.push_back(std::move(grad));
+    }
+    const auto beta = Vec(0.0, S);
+    while (state.KeepRunning()) {
+        auto batch = EllBatch(10.0, Vec(0.0, ndim), num);
+        for (auto it = 0U; it != num_cuts; ++it) {
+            batch.update_central_cut(grads[it], beta);
+        }
+        benchmark::DoNotOptimize(batch.tsq());
+    }
+}
+BENCHMARK(ELL_batch)->Arg(8)->Arg(64)->Arg(512);
+
+/**
+ * The limit k of the profit scenario k
+ */
+static auto limit_of(size_t k) -> double { return 20.0 + 10.0 * std::sin(0.1 * k); }
+
+/**
+ * K profit scenarios, solved one after another
+ */
+static void PROFIT_separate(benchmark::State &state) {
+    const auto num = static_cast<size_t>(state.range(0));
+    while (state.KeepRunning()) {
+        for (auto k = 0U; k != num; ++k) {
+            auto ellip = Ell<Vec>(Vec{100.0, 100.0}, Vec{0.0, 0.0});
+            ProfitOracle omega{20.0, 40.0, limit_of(k), Vec{0.1, 0.4}, Vec{10.0, 35.0}};
+            auto gamma = 0.0;
+            benchmark::DoNotOptimize(cutting_plane_optim(omega, ellip, gamma));
+        }
+    }
+}
+BENCHMARK(PROFIT_separate)->Arg(8)->Arg(64)->Arg(512);
+
+/**
+ * The same K scenarios in lockstep, by ProfitOracleBatch
+ */
+static void PROFIT_batch(benchmark::State &state) {
+    const auto num = static_cast<size_t>(state.range(0));
+    auto limits = Vec(num);
+    for (auto k = 0U; k != num; ++k) {
+        limits[k] = limit_of(k);
+    }
+    auto a = Vec(0.1, 2 * num);
+    a[std::slice(num, num, 1)] = 0.4;
+    auto v = Vec(10.0, 2 * num);
+    v[std::slice(num, num, 1)] = 35.0;
+    while (state.KeepRunning()) {
+        auto space = EllBatch(Vec{100.0, 100.0}, Vec{0.0, 0.0}, num);
+        auto omega
+            = ProfitOracleBatch(Vec(20.0, num), Vec(40.0, num), limits, a, v, space.stride());
+        auto gamma = Vec(0.0, space.stride());
+        benchmark::DoNotOptimize(cutting_plane_optim_batch(omega, space, gamma));
+    }
+}
+BENCHMARK(PROFIT_batch)->Arg(8)->Arg(64)->Arg(512);
+
+BENCHMARK_MAIN();
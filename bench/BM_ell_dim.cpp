@@ -0,0 +1,143 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <cmath>                   // for sqrt
+#include <cstdint>                 // for int64_t
+#include <ellalgo/ell.hpp>         // for Ell
+#include <ellalgo/ell_config.hpp>  // for CutStatus
+#include <ellalgo/ell_stable.hpp>  // for EllStable
+#include <random>                  // for mt19937, normal_distribution
+#include <utility>                 // for pair
+#include <valarray>                // for valarray
+#include <vector>                  // for vector
+
+#include "benchmark/benchmark.h"  // for BENCHMARK, State, BENCHMARK_...
+
+using Vec = std::valarray<double>;
+
+/**
+ * The ellipsoid starts as the unit ball and is restored after every
+ * `num_cuts` cuts, so that tau stays around 1 and the cuts below all succeed
+ * at every dimension.
+ */
+static const auto num_cuts = 16U;
+static const auto seed = 20240U;
+
+/**
+ * @brief Random cuts with unit gradients, the same ones for every run
+ */
+template <typename T> static auto random_cuts(size_t ndim, const T &beta)
+    -> std::vector<std::pair<Vec, T>> {
+    auto gen = std::mt19937{seed};
+    auto dist = std::normal_distribution<double>{};
+    auto cuts = std::vector<std::pair<Vec, T>>{};
+    for (auto k = 0U; k != num_cuts; ++k) {
+        auto g = Vec(ndim);
+        for (auto &gi : g) {
+            gi = dist(gen);
+        }
+        g /= std::sqrt((g * g).sum());
+        cuts.emplace_back(std::move(g), beta);
+    }
+    return cuts;
+}
+
+struct BiasCut {
+    static auto beta() -> double { return 0.01; }
+    template <typename Space, typename Cut> static auto update(Space &space, const Cut &cut)
+        -> CutStatus {
+        return space.update_bias_cut(cut);
+    }
+};
+
+struct CentralCut {
+    static auto beta() -> double { return 0.0; }
+    template <typename Space, typename Cut> static auto update(Space &space, const Cut &cut)
+        -> CutStatus {
+        return space.update_central_cut(cut);
+    }
+};
+
+struct QCut {
+    static auto beta() -> double { return 0.01; }
+    template <typename Space, typename Cut> static auto update(Space &space, const Cut &cut)
+        -> CutStatus {
+        return space.update_q(cut);
+    }
+};
+
+struct ParallelCut {
+    static auto beta() -> Vec { return Vec{0.01, 0.5}; }
+    template <typename Space, typename Cut> static auto update(Space &space, const Cut &cut)
+        -> CutStatus {
+        return space.update_bias_cut(cut);
+    }
+};
+
+/**
+ * @brief Memory traffic and flops of one cut, as modelled by the kernels
+ *
+ * Ell streams the packed lower triangle of mq once per cut (matvec fused
+ * with the deferred rank-one update), reading and writing it, with about
+ * 2 n^2 flops for the matvec and n^2 for the rank-one update. EllStable
+ * reads L twice for the two triangular solves and then reads and writes it
+ * for the rank-one update of the factors.
+ */
+template <typename Space> struct CutCost;
+
+template <> struct CutCost<Ell<Vec>> {
+    static auto bytes(double n) -> double { return 2.0 * sizeof(double) * n * (n + 1) / 2; }
+    static auto flops(double n) -> double { return 3.0 * n * n; }
+};
+
+template <> struct CutCost<EllStable<Vec>> {
+    static auto bytes(double n) -> double { return 4.0 * sizeof(double) * n * (n + 1) / 2; }
+    static auto flops(double n) -> double { return 5.0 * n * n; }
+};
+
+/**
+ * One cut per iteration, on an ellipsoid of dimension state.range(0)
+ */
+template <typename Space, typename Kind> static void BM_cut(benchmark::State &state) {
+    const auto ndim = static_cast<size_t>(state.range(0));
+    const auto cuts = random_cuts(ndim, Kind::beta());
+    auto space = Space(1.0, Vec(0.0, ndim));
+    const auto start = space.snapshot();
+    auto idx = 0U;
+    auto num_failed = 0U;
+    for (auto _ : state) {
+        if (idx == num_cuts) {
+            state.PauseTiming();
+            space.restore(start);
+            idx = 0U;
+            state.ResumeTiming();
+        }
+        const auto status = Kind::update(space, cuts[idx++]);
+        num_failed += status != CutStatus::Success ? 1U : 0U;
+        benchmark::DoNotOptimize(status);
+    }
+    const auto nd = static_cast<double>(ndim);
+    const auto iters = static_cast<double>(state.iterations());
+    state.SetComplexityN(state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(iters * CutCost<Space>::bytes(nd)));
+    state.counters["bytes/cut"] = CutCost<Space>::bytes(nd);
+    state.counters["flops/cut"] = CutCost<Space>::flops(nd);
+    state.counters["FLOPS"] = benchmark::Counter(CutCost<Space>::flops(nd) * iters,
+                                                 benchmark::Counter::kIsRate);
+    state.counters["failed"] = static_cast<double>(num_failed) / iters;  // should be 0
+}
+
+#define ELL_DIM_BENCH(Space, Kind)                                                          \
+    BENCHMARK_TEMPLATE2(BM_cut, Space, Kind)->RangeMultiplier(2)->Range(2, 1024)->Complexity( \
+        benchmark::oNSquared)
+
+ELL_DIM_BENCH(Ell<Vec>, BiasCut);
+ELL_DIM_BENCH(Ell<Vec>, CentralCut);
+ELL_DIM_BENCH(Ell<Vec>, QCut);
+ELL_DIM_BENCH(Ell<Vec>, ParallelCut);
+ELL_DIM_BENCH(EllStable<Vec>, BiasCut);
+ELL_DIM_BENCH(EllStable<Vec>, CentralCut);
+ELL_DIM_BENCH(EllStable<Vec>, QCut);
+ELL_DIM_BENCH(EllStable<Vec>, ParallelCut);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,68 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <array>                      // for array
+#include <ellalgo/cutting_plane.hpp>  // for cutting_plane_optim
+#include <ellalgo/ell.hpp>            // for Ell
+#include <ellalgo/ell_config.hpp>     // for Options
+#include <ellalgo/ell_fixed.hpp>      // for EllFixed
+#include <tuple>                      // for tuple
+#include <utility>                    // for pair
+#include <valarray>                   // for valarray
+
+#include "benchmark/benchmark.h"  // for BENCHMARK, State, BENCHMARK_...
+
+using Vec = std::valarray<double>;
+using Arr = std::array<double, 2>;
+
+/**
+ * @brief The oracle of test_example1.cpp, for either array type
+ */
+template <typename T> struct MyOracle {
+    using Cut = std::pair<T, double>;
+
+    int idx = -1;  // for round robin
+
+    auto assess_optim(const T &xc, double &gamma) -> std::tuple<Cut, bool> {
+        const auto f0 = xc[0] + xc[1];
+        for (int i = 0; i != 3; i++) {
+            this->idx = this->idx == 2 ? 0 : this->idx + 1;
+            double fj;
+            if (this->idx == 0 && f0 > 3.0) {
+                return {{T{1.0, 1.0}, f0 - 3.0}, false};
+            }
+            if (this->idx == 1 && (fj = -xc[0] + xc[1] + 1.0) > 0.0) {
+                return {{T{-1.0, 1.0}, fj}, false};
+            }
+            if (this->idx == 2 && (fj = gamma - f0) > 0.0) {
+                return {{T{-1.0, -1.0}, fj}, false};
+            }
+        }
+        gamma = f0;
+        return {{T{-1.0, -1.0}, 0.0}, true};
+    }
+};
+
+static void ELL_valarray(benchmark::State &state) {
+    while (state.KeepRunning()) {
+        auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+        auto oracle = MyOracle<Vec>{};
+        auto gamma = -1.0e100;
+        auto result = cutting_plane_optim(oracle, ell, gamma, Options{2000, 1e-10});
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(ELL_valarray);
+
+static void ELL_fixed(benchmark::State &state) {
+    while (state.KeepRunning()) {
+        auto ell = EllFixed<2>(Arr{10.0, 10.0}, Arr{0.0, 0.0});
+        auto oracle = MyOracle<Arr>{};
+        auto gamma = -1.0e100;
+        auto result = cutting_plane_optim(oracle, ell, gamma, Options{2000, 1e-10});
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(ELL_fixed);
+
+BENCHMARK_MAIN();
@@ -1,11 +1,13 @@
-#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim
-#include <ellalgo/ell.hpp>                     // for Ell
-#include <ellalgo/ell_matrix.hpp>              // for Matrix
-#include <ellalgo/oracles/lmi_old_oracle.hpp>  // for LmiOldOracle
-#include <ellalgo/oracles/lmi_oracle.hpp>      // for LmiOracle
-#include <tuple>                               // for tuple
-#include <type_traits>                         // for move
-#include <vector>                              // for vector
+#include <ellalgo/cutting_plane.hpp>            // for cutting_plane_optim
+#include <ellalgo/ell.hpp>                      // for Ell
+#include <ellalgo/ell_matrix.hpp>               // for Matrix
+#include <ellalgo/oracles/lmi_incr_oracle.hpp>  // for LmiIncrOracle
+#include <ellalgo/oracles/lmi_old_oracle.hpp>   // for LmiOldOracle
+#include <ellalgo/oracles/lmi_oracle.hpp>       // for LmiOracle
+#include <random>                               // for mt19937, normal_distribution
+#include <tuple>                                // for tuple
+#include <type_traits>                          // for move
+#include <vector>                               // for vector
 
 #include "benchmark/benchmark.h"  // for BENCHMARK, State, BENCHMARK_...
 
@@ -134,6 +136,69 @@ static void LMI_Lazy(benchmark::State &state) {
 // Register the function as a benchmark
 BENCHMARK(LMI_Lazy);
 
+/**
+ * @brief
+ *
+ * @param[in,out] state
+ */
+static void LMI_Incr(benchmark::State &state) {
+    using Vec = std::valarray<double>;
+    using M_t = std::vector<Matrix>;
+
+    auto c = Vec{1.0, -1.0, 1.0};
+
+    auto m0F1 = Matrix(2);
+    m0F1.row(0) = Vec{-7.0, -11.0};
+    m0F1.row(1) = Vec{-11.0, 3.0};
+
+    auto m1F1 = Matrix(2);
+    m1F1.row(0) = Vec{7.0, -18.0};
+    m1F1.row(1) = Vec{-18.0, 8.0};
+
+    auto m2F1 = Matrix(2);
+    m2F1.row(0) = Vec{-2.0, -8.0};
+    m2F1.row(1) = Vec{-8.0, 1.0};
+
+    auto F1 = M_t{m0F1, m1F1, m2F1};
+
+    auto B1 = Matrix(2);
+    B1.row(0) = Vec{33.0, -9.0};
+    B1.row(1) = Vec{-9.0, 26.0};
+
+    auto m0F2 = Matrix(3);
+    m0F2.row(0) = Vec{-21.0, -11.0, 0.0};
+    m0F2.row(1) = Vec{-11.0, 10.0, 8.0};
+    m0F2.row(2) = Vec{0.0, 8.0, 5.0};
+
+    auto m1F2 = Matrix(3);
+    m1F2.row(0) = Vec{0.0, 10.0, 16.0};
+    m1F2.row(1) = Vec{10.0, -10.0, -10.0};
+    m1F2.row(2) = Vec{16.0, -10.0, 3.0};
+
+    auto m2F2 = Matrix(3);
+    m2F2.row(0) = Vec{-5.0, 2.0, -17.0};
+    m2F2.row(1) = Vec{2.0, -6.0, 8.0};
+    m2F2.row(2) = Vec{-17.0, 8.0, 6.0};
+
+    auto F2 = M_t{m0F2, m1F2, m2F2};
+
+    auto B2 = Matrix(3);
+    B2.row(0) = Vec{14.0, 9.0, 40.0};
+    B2.row(1) = Vec{9.0, 91.0, 10.0};
+    B2.row(2) = Vec{40.0, 10.0, 15.0};
+
+    while (state.KeepRunning()) {
+        auto omega
+            = MyOracle<LmiIncrOracle<Vec, Matrix>>(2, F1, B1, 3, F2, B2, Vec{1.0, -1.0, 1.0});
+        auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+        auto gamma = 1e100;  // std::numeric_limits<double>::max()
+        auto result = cutting_plane_optim(omega, ellip, gamma);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+BENCHMARK(LMI_Incr);
+
 //~~~~~~~~~~~~~~~~
 
 /**
@@ -197,6 +262,55 @@ static void LMI_old(benchmark::State &state) {
 }
 BENCHMARK(LMI_old);
 
+//~~~~~~~~~~~~~~~~
+
+/**
+ * @brief One oracle call per iteration, for m = n = state.range(0)
+ *
+ * The matrices are random, and x follows a random walk of small dense steps,
+ * like the centres of the ellipsoids; B is large enough for x to be
+ * feasible, so that every call factorizes the whole matrix.
+ *
+ * @tparam Oracle
+ * @param[in,out] state
+ */
+template <typename Oracle> static void LMI_dim(benchmark::State &state) {
+    using Vec = std::valarray<double>;
+    const auto ndim = static_cast<size_t>(state.range(0));
+    auto gen = std::mt19937{5U};
+    auto dist = std::normal_distribution<double>{};
+    auto F = std::vector<Matrix>{};
+    for (auto k = 0U; k != ndim; ++k) {
+        auto Fk = Matrix(ndim);
+        for (auto i = 0U; i != ndim; ++i) {
+            for (auto j = 0U; j <= i; ++j) {
+                Fk(i, j) = Fk(j, i) = dist(gen);
+            }
+        }
+        F.push_back(std::move(Fk));
+    }
+    auto B = Matrix(ndim);
+    for (auto i = 0U; i != ndim; ++i) {
+        B(i, i) = 1000.0;
+    }
+    auto xs = std::vector<Vec>{};
+    auto x = Vec(0.0, ndim);
+    for (auto t = 0U; t != 256U; ++t) {
+        for (auto &xk : x) {
+            xk += 0.01 * dist(gen);
+        }
+        xs.push_back(x);
+    }
+    auto omega = Oracle(ndim, F, B);
+    auto t = 0U;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(omega(xs[t]));
+        t = (t + 1U) % 256U;
+    }
+}
+BENCHMARK_TEMPLATE(LMI_dim, LmiOracle<std::valarray<double>, Matrix>)->Arg(10)->Arg(50);
+BENCHMARK_TEMPLATE(LMI_dim, LmiIncrOracle<std::valarray<double>, Matrix>)->Arg(10)->Arg(50);
+
 BENCHMARK_MAIN();
 
 /*
@@ -0,0 +1,312 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <atomic>                              // for atomic
+#include <cmath>                               // for sqrt
+#include <cstdlib>                             // for malloc, free
+#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim
+#include <ellalgo/ell.hpp>                     // for Ell
+#include <ellalgo/ell_config.hpp>              // for Options
+#include <ellalgo/ell_matrix.hpp>              // for Matrix
+#include <ellalgo/ell_span.hpp>                // for make_span
+#include <ellalgo/ell_stable.hpp>              // for EllStable
+#include <ellalgo/oracles/lmi0_oracle.hpp>     // for Lmi0Oracle
+#include <ellalgo/oracles/lmi_old_oracle.hpp>  // for LmiOldOracle
+#include <ellalgo/oracles/lmi_oracle.hpp>      // for LmiOracle
+#include <ellalgo/oracles/lowpass_oracle.hpp>  // for create_lowpass_case
+#include <new>                                 // for bad_alloc
+#include <random>                              // for mt19937, normal_distribution
+#include <tuple>                               // for tuple, get
+#include <utility>                             // for pair, move
+#include <valarray>                            // for valarray
+#include <vector>                              // for vector
+
+#include "benchmark/benchmark.h"  // for BENCHMARK, State, BENCHMARK_...
+
+/*
+ * Whole solves at the sizes of production, rather than the toy cases of
+ * BM_lowpass.cpp and BM_lmi.cpp. Every benchmark reports, per solve:
+ *
+ * - "iters": the iterations of the cutting-plane method,
+ * - "allocs/iter": the heap allocations of the solve per iteration,
+ * - "time/iter": the time per iteration,
+ *
+ * and, of what was solved,
+ *
+ * - "solved": 1 if a solution was found, for the lowpass filters,
+ * - "gamma": the best c' x after the 200 iterations, for the LMIs, whose
+ *   solves stop before they converge.
+ *
+ * The counters but the time do not depend on the machine. The
+ * stored baselines in bench/baselines/ and bench/perf_gate.py compare a run
+ * with them (see the `perf_gate` test in bench/CMakeLists.txt).
+ */
+
+#if defined(__GNUC__) && !defined(__clang__)
+// the replaced operator delete below pairs with the replaced operator new
+#    pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Counts every heap allocation of this benchmark program
+static std::atomic<size_t> num_allocs{0U};
+
+void *operator new(std::size_t size) {
+    num_allocs.fetch_add(1U, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size != 0U ? size : 1U)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief Run `solve` once per benchmark iteration and report the counters
+ *
+ * @tparam Solve returns the tuple of the solution and the iterations
+ * @param[in,out] state
+ * @param[in] solve
+ * @return the fraction of the solves that found a solution
+ */
+template <typename Solve> static auto run_solves(benchmark::State &state, Solve &&solve)
+    -> double {
+    auto num_iters = size_t{0};
+    auto num_solved = size_t{0};
+    auto allocs = size_t{0};
+    for (auto _ : state) {
+        const auto before = num_allocs.load();
+        const auto result = solve();
+        allocs += num_allocs.load() - before;
+        num_iters += std::get<1>(result);
+        num_solved += std::get<0>(result).size() != 0U ? 1U : 0U;
+        benchmark::DoNotOptimize(result);
+    }
+    const auto solves = static_cast<double>(state.iterations());
+    const auto iters = static_cast<double>(num_iters);
+    state.counters["iters"] = iters / solves;
+    state.counters["allocs/iter"] = static_cast<double>(allocs) / iters;
+    state.counters["time/iter"]
+        = benchmark::Counter(iters, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    return static_cast<double>(num_solved) / solves;
+}
+
+// ********************************************************************
+// lowpass
+// ********************************************************************
+
+/**
+ * @brief The lowpass filter of `create_lowpass_case(N)`, for N = state.range(0)
+ *
+ * @tparam Space `Ell` or `EllStable`
+ * @tparam parallel whether to use the parallel cuts
+ * @param[in,out] state
+ */
+template <typename Space, bool parallel> static void LOWPASS(benchmark::State &state) {
+    const auto N = static_cast<size_t>(state.range(0));
+    auto options = Options();
+    options.max_iters = 20000;
+    state.counters["solved"] = run_solves(state, [&]() {
+        auto ellip = Space(40.0, Vec(0.0, N));
+        ellip.set_use_parallel_cut(parallel);
+        auto result = create_lowpass_case(N);
+        auto omega = std::move(result.first);
+        auto gamma = result.second;
+        return cutting_plane_optim(omega, ellip, gamma, options);
+    });
+}
+
+BENCHMARK_TEMPLATE(LOWPASS, Ell<Vec>, true)
+    ->Arg(64)
+    ->Arg(128)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(LOWPASS, Ell<Vec>, false)
+    ->Arg(64)
+    ->Arg(128)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(LOWPASS, EllStable<Vec>, true)
+    ->Arg(64)
+    ->Arg(128)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(LOWPASS, EllStable<Vec>, false)
+    ->Arg(64)
+    ->Arg(128)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
+
+// ********************************************************************
+// random LMI
+// ********************************************************************
+
+/**
+ * @brief minimize c' x  s.t.  B - F * x >= 0, for random F and c
+ *
+ * The F[k] are dense, with standard normal entries, and B = sqrt(m) I, so
+ * that x = 0 is feasible and the feasible set is bounded.
+ */
+struct LmiCase {
+    size_t m;
+    std::vector<Matrix> F;
+    Matrix B;
+    Vec c;
+    std::vector<Matrix> F0;  //!< {B, -F[0], ..., -F[n - 1]}, for `Lmi0Oracle`
+
+    LmiCase(size_t m, size_t n) : m{m}, B(m), c(n) {
+        auto gen = std::mt19937{5U};
+        auto dist = std::normal_distribution<double>{};
+        for (auto k = 0U; k != n; ++k) {
+            auto Fk = Matrix(m);
+            for (auto i = 0U; i != m; ++i) {
+                for (auto j = 0U; j <= i; ++j) {
+                    Fk(i, j) = Fk(j, i) = dist(gen);
+                }
+            }
+            this->F.push_back(std::move(Fk));
+        }
+        for (auto i = 0U; i != m; ++i) {
+            this->B(i, i) = std::sqrt(static_cast<double>(m));
+        }
+        for (auto &ck : this->c) {
+            ck = dist(gen);
+        }
+        this->F0.push_back(this->B);
+        for (const auto &Fk : this->F) {
+            auto negFk = Matrix(m);
+            for (auto i = 0U; i != m; ++i) {
+                for (auto j = 0U; j != m; ++j) {
+                    negFk(i, j) = -Fk(i, j);
+                }
+            }
+            this->F0.push_back(std::move(negFk));
+        }
+    }
+};
+
+/**
+ * @brief B - F * x >= 0 by `Lmi0Oracle`, on (1, x) and {B, -F}
+ *
+ * The cuts are the ones of `LmiOracle`, less the gradient for the constant.
+ */
+class HomogeneousLmi {
+    using Cut = std::pair<Vec, double>;
+
+    Lmi0Oracle<Vec, Matrix> _lmi0;
+    Vec _y;  //!< (1, x)
+    Vec _g;  //!< gradient for (1, x)
+    Cut _cut;
+
+  public:
+    HomogeneousLmi(size_t m, const std::vector<Matrix> &F0)
+        : _lmi0{m, F0}, _y(1.0, F0.size()), _g(F0.size()), _cut{Vec(F0.size() - 1U), 0.0} {}
+
+    auto operator()(const Vec &x) -> Cut * {
+        for (auto k = 0U; k != x.size(); ++k) {
+            this->_y[k + 1U] = x[k];
+        }
+        if (!this->_lmi0.assess_feas(this->_y, make_span(this->_g), this->_cut.second)) {
+            return nullptr;
+        }
+        for (auto k = 0U; k != x.size(); ++k) {
+            this->_cut.first[k] = this->_g[k + 1U];
+        }
+        return &this->_cut;
+    }
+};
+
+template <typename Oracle> struct LmiMaker {
+    static auto make(const LmiCase &lmi) -> Oracle {
+        return Oracle(lmi.m, lmi.F, lmi.B);
+    }
+};
+
+template <> struct LmiMaker<HomogeneousLmi> {
+    static auto make(const LmiCase &lmi) -> HomogeneousLmi {
+        return HomogeneousLmi(lmi.m, lmi.F0);
+    }
+};
+
+/**
+ * @brief The objective and the LMI of a `LmiCase`
+ *
+ * @tparam Oracle
+ */
+template <typename Oracle> class LmiOptim {
+    using Cut = std::pair<Vec, double>;
+
+    Oracle _lmi;
+    const Vec &_c;
+
+  public:
+    explicit LmiOptim(const LmiCase &lmi) : _lmi{LmiMaker<Oracle>::make(lmi)}, _c{lmi.c} {}
+
+    /**
+     * @brief
+     *
+     * @param[in] x
+     * @param[in,out] gamma
+     * @return std::tuple<Cut, bool>
+     */
+    auto assess_optim(const Vec &x, double &gamma) -> std::tuple<Cut, bool> {
+        const auto f0 = (this->_c * x).sum();
+        const auto f1 = f0 - gamma;
+        if (f1 > 0.0) {
+            return {{this->_c, f1}, false};
+        }
+        if (const auto cut = this->_lmi(x)) {
+            return {*cut, false};
+        }
+        gamma = f0;
+        return {{this->_c, 0.0}, true};
+    }
+};
+
+/**
+ * @brief A random LMI of m = state.range(0) and n = state.range(1)
+ *
+ * A solve takes O(n^2) iterations of O(m^3 + n m^2) each, hours at the
+ * largest sizes, so every solve stops after 200 iterations: the time per
+ * iteration is what is measured. Since x = 0 is feasible, every solve
+ * finds a solution; how far it got is the best c' x, "gamma".
+ *
+ * @tparam Space `Ell` or `EllStable`
+ * @tparam Oracle `LmiOracle`, `LmiOldOracle` or `HomogeneousLmi`
+ * @param[in,out] state
+ */
+template <typename Space, typename Oracle> static void LMI(benchmark::State &state) {
+    const auto m = static_cast<size_t>(state.range(0));
+    const auto n = static_cast<size_t>(state.range(1));
+    const auto lmi = LmiCase(m, n);
+    auto options = Options();
+    options.max_iters = 200;
+    auto best = 0.0;
+    run_solves(state, [&]() {
+        auto omega = LmiOptim<Oracle>(lmi);
+        auto ellip = Space(10.0, Vec(0.0, n));
+        auto gamma = 1e100;
+        auto result = cutting_plane_optim(omega, ellip, gamma, options);
+        best = gamma;
+        return result;
+    });
+    state.counters["gamma"] = best;
+}
+
+// m up to 500 and n up to 200; F of m = 500 and n = 200 would take 400 MB
+static auto lmi_sizes(benchmark::internal::Benchmark *bench) -> void {
+    bench->Args({100, 20})->Args({200, 50})->Args({200, 200})->Args({500, 20});
+    bench->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_TEMPLATE(LMI, Ell<Vec>, LmiOracle<Vec, Matrix>)->Apply(lmi_sizes);
+BENCHMARK_TEMPLATE(LMI, Ell<Vec>, LmiOldOracle<Vec, Matrix>)->Apply(lmi_sizes);
+BENCHMARK_TEMPLATE(LMI, Ell<Vec>, HomogeneousLmi)->Apply(lmi_sizes);
+BENCHMARK_TEMPLATE(LMI, EllStable<Vec>, LmiOracle<Vec, Matrix>)->Apply(lmi_sizes);
+BENCHMARK_TEMPLATE(LMI, EllStable<Vec>, LmiOldOracle<Vec, Matrix>)->Apply(lmi_sizes);
+BENCHMARK_TEMPLATE(LMI, EllStable<Vec>, HomogeneousLmi)->Apply(lmi_sizes);
+
+BENCHMARK_MAIN();
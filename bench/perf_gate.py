@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Compare a run of BM_production with its stored baseline.
+
+The run is the JSON output of Google Benchmark:
+
+    BM_production --benchmark_out=run.json --benchmark_out_format=json
+    python3 perf_gate.py run.json baselines/BM_production.json
+
+A benchmark fails the gate when
+
+* its number of iterations ("iters") differs from the baseline by more
+  than --iters-tolerance,
+* it allocates more per iteration ("allocs/iter"),
+* it no longer finds a solution ("solved", of the lowpass filters), or
+* it ends at a worse objective ("gamma", of the LMIs, which stop after a
+  fixed number of iterations) by more than --gamma-tolerance of it.
+
+These do not depend on the machine, and are all the stored baseline holds.
+The iterations may still move a little with the rounding of the compiler
+and the instruction set, hence the tolerance.
+
+The times do depend on the machine, so they are only compared against a
+baseline of the same machine, given by --time-baseline: a benchmark then
+also fails when its CPU time exceeds that baseline by more than
+--time-tolerance. Of repeated runs (--benchmark_repetitions), the fastest
+one is taken.
+
+`--update` rewrites the baseline from the run, or only the time baseline
+if one is given.
+"""
+
+import argparse
+import json
+import sys
+
+COUNTERS = ("iters", "allocs/iter", "solved", "gamma")
+
+
+def load_run(path):
+    """Return {name: {<the COUNTERS it reports>, "cpu_time_ns"}} of a run."""
+    with open(path) as f:
+        data = json.load(f)
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    results = {}
+    for bench in data["benchmarks"]:
+        if bench.get("run_type", "iteration") != "iteration":
+            continue  # mean, median, stddev of repetitions
+        name = bench.get("run_name", bench["name"])
+        cpu_time = bench["cpu_time"] * scale[bench.get("time_unit", "ns")]
+        entry = {key: bench[key] for key in COUNTERS if key in bench}
+        entry["cpu_time_ns"] = round(cpu_time)
+        if name in results and results[name]["cpu_time_ns"] <= cpu_time:
+            continue
+        results[name] = entry
+    return results
+
+
+def compare(run, baseline, iters_tolerance, gamma_tolerance):
+    """Return the list of failures of the counters of `run` against `baseline`."""
+    failures = []
+    for name, base in sorted(baseline.items()):
+        if name not in run:
+            failures.append(f"{name}: missing from the run")
+            continue
+        cur = run[name]
+        missing = [key for key in base if key not in cur]
+        if missing:
+            failures.append(f"{name}: {', '.join(missing)} missing from the run")
+            continue
+        if abs(cur["iters"] - base["iters"]) > iters_tolerance * base["iters"] + 1e-9:
+            failures.append(f"{name}: iters {base['iters']:g} -> {cur['iters']:g}")
+        if "solved" in base and cur["solved"] < base["solved"]:
+            failures.append(f"{name}: solved {base['solved']:g} -> {cur['solved']:g}")
+        if cur["allocs/iter"] > base["allocs/iter"] + 1e-6:
+            failures.append(
+                f"{name}: allocs/iter {base['allocs/iter']:g} -> {cur['allocs/iter']:g}"
+            )
+        if "gamma" in base and cur["gamma"] > base["gamma"] + gamma_tolerance * abs(base["gamma"]):
+            failures.append(f"{name}: gamma {base['gamma']:.6g} -> {cur['gamma']:.6g}")
+        print(f"{name:64} iters {cur['iters']:g}  allocs/iter {cur['allocs/iter']:g}")
+    for name in sorted(set(run) - set(baseline)):
+        print(f"{name:64} (not in the baseline)")
+    return failures
+
+
+def compare_times(run, time_baseline, time_tolerance):
+    """Return the list of failures of the times of `run` against `time_baseline`."""
+    failures = []
+    for name, base in sorted(time_baseline.items()):
+        if name not in run:
+            continue  # reported by compare()
+        ratio = run[name]["cpu_time_ns"] / base["cpu_time_ns"]
+        if ratio > 1.0 + time_tolerance:
+            failures.append(f"{name}: cpu time x{ratio:.2f} of the time baseline")
+        print(f"{name:64} cpu time x{ratio:5.2f}")
+    return failures
+
+
+def write_json(path, data):
+    with open(path, "w") as f:
+        json.dump(data, f, indent=2, sort_keys=True)
+        f.write("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("run", help="JSON output of the benchmark")
+    parser.add_argument("baseline", help="stored baseline of the counters")
+    parser.add_argument(
+        "--iters-tolerance",
+        type=float,
+        default=0.02,
+        help="allowed relative change of the iterations (default: 0.02)",
+    )
+    parser.add_argument(
+        "--gamma-tolerance",
+        type=float,
+        default=1e-3,
+        help="allowed relative rise of the final objective of the LMIs (default: 0.001)",
+    )
+    parser.add_argument(
+        "--time-baseline",
+        help="baseline of the times, from the same machine (default: do not compare the times)",
+    )
+    parser.add_argument(
+        "--time-tolerance",
+        type=float,
+        default=0.25,
+        help="allowed relative slowdown against --time-baseline (default: 0.25)",
+    )
+    parser.add_argument("--update", action="store_true", help="rewrite the (time) baseline from the run")
+    args = parser.parse_args()
+
+    run = load_run(args.run)
+    if args.update:
+        if args.time_baseline:
+            path = args.time_baseline
+            data = {name: {"cpu_time_ns": entry["cpu_time_ns"]} for name, entry in run.items()}
+        else:
+            path = args.baseline
+            data = {
+                name: {key: entry[key] for key in COUNTERS if key in entry}
+                for name, entry in run.items()
+            }
+        write_json(path, data)
+        print(f"{path}: {len(run)} benchmarks")
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    failures = compare(run, baseline, args.iters_tolerance, args.gamma_tolerance)
+    if args.time_baseline:
+        with open(args.time_baseline) as f:
+            time_baseline = json.load(f)
+        failures += compare_times(run, time_baseline, args.time_tolerance)
+    for failure in failures:
+        print(f"FAILED {failure}")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,63 @@
+# this file contains the whole-program optimizations of the builds that measure (see bench/). They
+# are enabled during configuration by passing an additional argument to CMake:
+#
+# * `-DELLALGO_ENABLE_LTO=ON` links with link-time optimization, so that the oracles, the updates of
+#   the ellipsoids and the solvers in source/*.cpp can be inlined into each other and into the
+#   benchmarks, as if the library were header-only.
+# * `-DELLALGO_PGO=GENERATE` instruments the build; running the `pgo_train` target then writes the
+#   profiles into `ELLALGO_PGO_DIR`. A second build with `-DELLALGO_PGO=USE` optimizes with them.
+#
+# Include this file before the library is added, so that its targets take the options too.
+
+include_guard(GLOBAL)
+
+option(ELLALGO_ENABLE_LTO "Enable link-time optimization" OFF)
+set(ELLALGO_PGO
+    "OFF"
+    CACHE STRING "Profile-guided optimization: OFF, GENERATE or USE"
+)
+set_property(CACHE ELLALGO_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(ELLALGO_PGO_DIR
+    "${CMAKE_BINARY_DIR}/pgo"
+    CACHE PATH "Directory of the profiles of profile-guided optimization"
+)
+
+if(ELLALGO_ENABLE_LTO)
+  include(CheckIPOSupported)
+  check_ipo_supported(RESULT ELLALGO_IPO_SUPPORTED OUTPUT ELLALGO_IPO_OUTPUT LANGUAGES CXX)
+  if(NOT ELLALGO_IPO_SUPPORTED)
+    message(FATAL_ERROR "Link-time optimization is not supported: ${ELLALGO_IPO_OUTPUT}")
+  endif()
+  set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+endif()
+
+if(ELLALGO_PGO STREQUAL "OFF")
+  return()
+endif()
+
+if(NOT (CMAKE_CXX_COMPILER_ID MATCHES "Clang" OR CMAKE_CXX_COMPILER_ID MATCHES "GNU"))
+  message(FATAL_ERROR "Profile-guided optimization is only set up for GCC and Clang")
+endif()
+
+if(ELLALGO_PGO STREQUAL "GENERATE")
+  file(MAKE_DIRECTORY ${ELLALGO_PGO_DIR})
+  add_compile_options(-fprofile-generate=${ELLALGO_PGO_DIR})
+  add_link_options(-fprofile-generate=${ELLALGO_PGO_DIR})
+  if(CMAKE_CXX_COMPILER_ID MATCHES "GNU")
+    # the solvers of parallel_driver.hpp update the counters from several threads
+    add_compile_options(-fprofile-update=atomic)
+  endif()
+elseif(ELLALGO_PGO STREQUAL "USE")
+  if(CMAKE_CXX_COMPILER_ID MATCHES "GNU")
+    # the code not reached by the training keeps its usual optimization
+    add_compile_options(-fprofile-use=${ELLALGO_PGO_DIR} -fprofile-partial-training
+                        -Wno-missing-profile
+    )
+    add_link_options(-fprofile-use=${ELLALGO_PGO_DIR})
+  else()
+    add_compile_options(-fprofile-use=${ELLALGO_PGO_DIR}/default.profdata)
+    add_link_options(-fprofile-use=${ELLALGO_PGO_DIR}/default.profdata)
+  endif()
+else()
+  message(FATAL_ERROR "ELLALGO_PGO must be OFF, GENERATE or USE, not ${ELLALGO_PGO}")
+endif()
@@ -0,0 +1,553 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <cmath>        // for sqrt
+#include <cstddef>      // for size_t
+#include <type_traits>  // for is_same, enable_if
+#include <utility>      // for move, declval
+#include <vector>
+
+#include "ell_span.hpp"
+
+class SparseSym;
+
+/**
+ * @brief In-place kernels of the conjugate gradient method, on contiguous vectors
+ *
+ * One pass over the vectors each, without temporaries.
+ */
+namespace cg_kernel {
+
+    /**
+     * @brief x' * y
+     */
+    extern auto dot(const double *x, const double *y, size_t n) -> double;
+
+    /**
+     * @brief y += alpha * x
+     */
+    extern auto axpy(double alpha, const double *x, double *y, size_t n) -> void;
+
+    /**
+     * @brief p = z + beta * p
+     */
+    extern auto xpby(const double *z, double beta, double *p, size_t n) -> void;
+
+    /**
+     * @brief x += alpha * p and r -= alpha * ap, returning r' * r, in one pass
+     */
+    extern auto update_x_r(double alpha, const double *p, const double *ap, double *x, double *r,
+                           size_t n) -> double;
+
+    /**
+     * @name Blocks of k vectors of size n, element i of vector j at i * k + j
+     *
+     * The same operations as above, vector by vector, in the same order.
+     */
+    ///@{
+    /**
+     * @brief res(j) = x(:, j)' * y(:, j)
+     */
+    extern auto dot_block(const double *x, const double *y, size_t n, size_t k, double *res)
+        -> void;
+
+    /**
+     * @brief p(:, j) = z(:, j) + beta(j) * p(:, j)
+     */
+    extern auto xpby_block(const double *z, const double *beta, double *p, size_t n, size_t k)
+        -> void;
+
+    /**
+     * @brief x(:, j) += alpha(j) * p(:, j) and r(:, j) -= alpha(j) * ap(:, j), rr(j) = r(:, j)' *
+     * r(:, j)
+     */
+    extern auto update_x_r_block(const double *alpha, const double *p, const double *ap, double *x,
+                                 double *r, size_t n, size_t k, double *rr) -> void;
+    ///@}
+
+}  // namespace cg_kernel
+
+/**
+ * @brief Symmetric sparse matrix in compressed sparse row (CSR) form
+ *
+ * Both triangles are stored, row by row in increasing column order, in
+ * three contiguous arrays, so that `apply` streams them once.
+ */
+class SymCsrMatrix {
+    size_t _n;
+    std::vector<size_t> _row_start;  //!< of size n + 1
+    std::vector<size_t> _col;
+    std::vector<double> _val;
+
+  public:
+    /**
+     * @brief Assemble the matrix from the elements of its lower triangle
+     *
+     * The elements given more than once are added up.
+     *
+     * @param[in] mat
+     */
+    explicit SymCsrMatrix(const SparseSym &mat);
+
+    auto size() const -> size_t { return this->_n; }
+
+    auto num_nonzeros() const -> size_t { return this->_val.size(); }
+
+    /**
+     * @brief y = A * x
+     *
+     * @param[in] x of size n
+     * @param[out] y of size n
+     */
+    auto apply(const double *x, double *y) const -> void;
+
+    /**
+     * @brief Y = A * X, for k vectors at once, element i of vector j at i * k + j
+     *
+     * Every element of A is read once for the k vectors.
+     *
+     * @param[in] X of size n * k
+     * @param[out] Y of size n * k
+     * @param[in] k
+     */
+    auto apply_block(const double *X, double *Y, size_t k) const -> void;
+
+    /**
+     * @brief The diagonal, zero where it is not stored
+     *
+     * @return std::vector<double>
+     */
+    auto diagonal() const -> std::vector<double>;
+
+    auto row_start() const -> const std::vector<size_t> & { return this->_row_start; }
+    auto col() const -> const std::vector<size_t> & { return this->_col; }
+    auto val() const -> const std::vector<double> & { return this->_val; }
+};
+
+/**
+ * @brief A symmetric operator given by a function, for `ConjugateGradient`
+ *
+ * fn(x, y) computes y = A * x, for operators that are never formed, e.g.
+ * implicit or assembled on the fly.
+ *
+ * @tparam Fn
+ */
+template <typename Fn> class FunctionOperator {
+    size_t _n;
+    Fn _fn;
+
+  public:
+    FunctionOperator(size_t n, Fn fn) : _n{n}, _fn{std::move(fn)} {}
+
+    auto size() const -> size_t { return this->_n; }
+
+    auto apply(const double *x, double *y) const -> void { this->_fn(x, y); }
+};
+
+template <typename Fn> inline auto make_operator(size_t n, Fn fn) -> FunctionOperator<Fn> {
+    return FunctionOperator<Fn>(n, std::move(fn));
+}
+
+/**
+ * @brief No preconditioning: z = r
+ */
+struct IdentityPreconditioner {
+    auto apply(const double *r, double *z, size_t n) const -> void {
+        for (auto i = 0U; i != n; ++i) {
+            z[i] = r[i];
+        }
+    }
+
+    auto apply_block(const double *R, double *Z, size_t n, size_t k) const -> void {
+        this->apply(R, Z, n * k);
+    }
+};
+
+/**
+ * @brief Jacobi preconditioning: z = inv(diag(A)) * r
+ */
+class JacobiPreconditioner {
+    std::vector<double> _inv_diag;
+
+  public:
+    /**
+     * @brief From the diagonal of A, e.g. of a `FunctionOperator`
+     *
+     * @param[in] diag
+     * @throws std::runtime_error if an element is not positive
+     */
+    explicit JacobiPreconditioner(const std::vector<double> &diag);
+
+    explicit JacobiPreconditioner(const SymCsrMatrix &mat)
+        : JacobiPreconditioner{mat.diagonal()} {}
+
+    auto apply(const double *r, double *z, size_t n) const -> void {
+        for (auto i = 0U; i != n; ++i) {
+            z[i] = this->_inv_diag[i] * r[i];
+        }
+    }
+
+    auto apply_block(const double *R, double *Z, size_t n, size_t k) const -> void {
+        for (auto i = 0U; i != n; ++i) {
+            for (auto j = 0U; j != k; ++j) {
+                Z[i * k + j] = this->_inv_diag[i] * R[i * k + j];
+            }
+        }
+    }
+};
+
+/**
+ * @brief Incomplete Cholesky preconditioning without fill-in, IC(0)
+ *
+ * L L' ~ A, with L on the pattern of the lower triangle of A, and z is
+ * the solution of L L' z = r. It often takes the number of iterations of
+ * the discretized elliptic problems down by a factor of two to four.
+ */
+class Ic0Preconditioner {
+    std::vector<size_t> _row_start;
+    std::vector<size_t> _col;  //!< the diagonal last in every row
+    std::vector<double> _val;
+
+  public:
+    /**
+     * @brief Factorize A
+     *
+     * @param[in] mat
+     * @throws std::runtime_error if a pivot is not positive
+     */
+    explicit Ic0Preconditioner(const SymCsrMatrix &mat);
+
+    auto apply(const double *r, double *z, size_t n) const -> void;
+
+    auto apply_block(const double *R, double *Z, size_t n, size_t k) const -> void;
+};
+
+/**
+ * @brief How a solve by `ConjugateGradient` ended
+ */
+struct CgInfo {
+    bool converged;
+    size_t num_iters;
+    double residual_norm;  //!< ||b - A x|| as updated by the iterations
+};
+
+/**
+ * @brief Conjugate gradient method for a symmetric positive definite A x = b
+ *
+ * The operator provides `size()` and `apply(x, y)`, y = A * x on contiguous
+ * vectors (e.g. `SymCsrMatrix`, `FunctionOperator`), and the
+ * preconditioner `apply(r, z, n)`, z = inv(M) * r for some symmetric
+ * positive definite M ~ A (e.g. `JacobiPreconditioner`).
+ *
+ * The work vectors are allocated once, by the constructor, in one block:
+ * an iteration is one product by A, one by inv(M), and three fused passes
+ * over the vectors, without any allocation.
+ *
+ * Example:
+ *
+ *     auto solver = ConjugateGradient(A.size());
+ *     const auto info = solver.solve(A, make_span(b), make_span(x), Ic0Preconditioner(A));
+ */
+class ConjugateGradient {
+    size_t _n;
+    std::vector<double> _work;  //!< r, z, p and A * p
+
+  public:
+    double tolerance = 1e-5;  //!< on ||b - A x||, as `conjugate_gradient`
+    size_t max_iters = 1000U;
+
+    explicit ConjugateGradient(size_t n) : _n{n}, _work(4 * n) {}
+
+    /**
+     * @brief Solve A x = b, starting from x
+     *
+     * Stops when ||r|| < tolerance, after max_iters iterations, or if
+     * p' A p <= 0, i.e. A is not positive definite.
+     *
+     * @param[in] A
+     * @param[in] b of size n
+     * @param[in,out] x of size n: the initial guess, then the solution
+     * @param[in] M
+     * @return CgInfo
+     */
+    template <typename Operator, typename Preconditioner = IdentityPreconditioner>
+    auto solve(const Operator &A, Span<const double> b, Span<double> x,
+               const Preconditioner &M = Preconditioner()) -> CgInfo {
+        // z is r itself without a preconditioner
+        constexpr auto plain = std::is_same<Preconditioner, IdentityPreconditioner>::value;
+        const auto n = this->_n;
+        auto *r = &this->_work[0];
+        auto *z = plain ? r : r + n;
+        auto *p = r + 2 * n;
+        auto *ap = r + 3 * n;
+
+        A.apply(x.data(), ap);
+        for (auto i = 0U; i != n; ++i) {
+            r[i] = b[i] - ap[i];
+        }
+        auto rr = cg_kernel::dot(r, r, n);
+        if (std::sqrt(rr) < this->tolerance) {
+            return {true, 0U, std::sqrt(rr)};
+        }
+        if (!plain) {
+            M.apply(r, z, n);
+        }
+        auto rz = plain ? rr : cg_kernel::dot(r, z, n);
+        for (auto i = 0U; i != n; ++i) {
+            p[i] = z[i];
+        }
+
+        for (auto niter = 1U; niter <= this->max_iters; ++niter) {
+            A.apply(p, ap);
+            const auto pap = cg_kernel::dot(p, ap, n);
+            if (!(pap > 0.0)) {
+                return {false, niter - 1, std::sqrt(rr)};
+            }
+            const auto alpha = rz / pap;
+            rr = cg_kernel::update_x_r(alpha, p, ap, x.data(), r, n);
+            if (std::sqrt(rr) < this->tolerance) {
+                return {true, niter, std::sqrt(rr)};
+            }
+            if (!plain) {
+                M.apply(r, z, n);
+            }
+            const auto rz_new = plain ? rr : cg_kernel::dot(r, z, n);
+            cg_kernel::xpby(z, rz_new / rz, p, n);
+            rz = rz_new;
+        }
+        return {false, this->max_iters, std::sqrt(rr)};
+    }
+};
+
+namespace cg_detail {
+    template <typename... Ts> struct voider {
+        using type = void;
+    };
+
+    /**
+     * @brief Whether the operator provides `apply_block(X, Y, k)`, as `SymCsrMatrix` does
+     */
+    template <typename Operator, typename = void> struct has_apply_block : std::false_type {};
+
+    template <typename Operator> struct has_apply_block<
+        Operator, typename voider<decltype(std::declval<const Operator &>().apply_block(
+                      std::declval<const double *>(), std::declval<double *>(), size_t{}))>::type>
+        : std::true_type {};
+
+    /**
+     * @brief Whether the preconditioner provides `apply_block(R, Z, n, k)`
+     */
+    template <typename Preconditioner, typename = void> struct has_apply_block_n
+        : std::false_type {};
+
+    template <typename Preconditioner> struct has_apply_block_n<
+        Preconditioner,
+        typename voider<decltype(std::declval<const Preconditioner &>().apply_block(
+            std::declval<const double *>(), std::declval<double *>(), size_t{}, size_t{}))>::type>
+        : std::true_type {};
+
+    /**
+     * @brief Apply fn(x, y) to the k vectors of X one by one, through x and y, of size n
+     */
+    template <typename Fn> auto by_vectors(Fn &&fn, const double *X, double *Y, size_t n, size_t k,
+                                           double *x, double *y) -> void {
+        for (auto j = 0U; j != k; ++j) {
+            for (auto i = 0U; i != n; ++i) {
+                x[i] = X[i * k + j];
+            }
+            fn(x, y);
+            for (auto i = 0U; i != n; ++i) {
+                Y[i * k + j] = y[i];
+            }
+        }
+    }
+
+    template <typename Operator>
+    inline auto apply_block(const Operator &A, const double *X, double *Y, size_t /* n */,
+                            size_t k, double * /* x */, double * /* y */) ->
+        typename std::enable_if<has_apply_block<Operator>::value>::type {
+        A.apply_block(X, Y, k);
+    }
+
+    template <typename Operator>
+    inline auto apply_block(const Operator &A, const double *X, double *Y, size_t n, size_t k,
+                            double *x, double *y) ->
+        typename std::enable_if<!has_apply_block<Operator>::value>::type {
+        by_vectors([&A](const double *x1, double *y1) { A.apply(x1, y1); }, X, Y, n, k, x, y);
+    }
+
+    template <typename Preconditioner>
+    inline auto precondition_block(const Preconditioner &M, const double *R, double *Z, size_t n,
+                                   size_t k, double * /* x */, double * /* y */) ->
+        typename std::enable_if<has_apply_block_n<Preconditioner>::value>::type {
+        M.apply_block(R, Z, n, k);
+    }
+
+    template <typename Preconditioner>
+    inline auto precondition_block(const Preconditioner &M, const double *R, double *Z, size_t n,
+                                   size_t k, double *x, double *y) ->
+        typename std::enable_if<!has_apply_block_n<Preconditioner>::value>::type {
+        by_vectors([&M, n](const double *r1, double *z1) { M.apply(r1, z1, n); }, R, Z, n, k, x,
+                   y);
+    }
+}  // namespace cg_detail
+
+/**
+ * @brief Conjugate gradient method for A X = B, with k right-hand sides at once
+ *
+ * The k solves run side by side, each with its own step sizes, and share
+ * the products: A and inv(M) are applied to the k vectors in one go,
+ * through `apply_block` where the operator or the preconditioner provides
+ * it (a product by a block, as `SymCsrMatrix` and the preconditioners of
+ * this file do), or vector by vector otherwise. A solve that has converged
+ * is left as it is while the others go on.
+ *
+ * The blocks are stored as n by k arrays row by row, element i of the
+ * right-hand side j at i * k + j. X is the initial guess, e.g. the
+ * solutions for the previous right-hand sides, and the solutions. Each
+ * solve reports how it ended in a `CgInfo`, and with keep_history the
+ * norms of its residuals, the initial one first.
+ *
+ * The work space is allocated by the constructor; a solve does not allocate
+ * unless keep_history is set.
+ */
+class BlockConjugateGradient {
+    size_t _n;
+    size_t _k;
+    std::vector<double> _work;   //!< R, Z, P and A * P, then x and y for `by_vectors`
+    std::vector<double> _coeff;  //!< rr, rz, pap, alpha and beta, of size k each
+    std::vector<CgInfo> _info;
+    std::vector<char> _active;  //!< whether the solve j goes on
+    std::vector<std::vector<double>> _history;
+
+  public:
+    double tolerance = 1e-5;  //!< on ||b - A x||, for each right-hand side
+    size_t max_iters = 1000U;
+    bool keep_history = false;
+
+    BlockConjugateGradient(size_t n, size_t k)
+        : _n{n}, _k{k}, _work(4 * n * k + 2 * n), _coeff(5 * k), _info(k), _active(k),
+          _history(k) {}
+
+    auto num_rhs() const -> size_t { return this->_k; }
+
+    /**
+     * @brief Solve A X = B, starting from X
+     *
+     * @param[in] A
+     * @param[in] B of size n * k
+     * @param[in,out] X of size n * k: the initial guess, then the solutions
+     * @param[in] M
+     * @return const std::vector<CgInfo>& one for each right-hand side
+     */
+    template <typename Operator, typename Preconditioner = IdentityPreconditioner>
+    auto solve(const Operator &A, Span<const double> B, Span<double> X,
+               const Preconditioner &M = Preconditioner()) -> const std::vector<CgInfo> & {
+        constexpr auto plain = std::is_same<Preconditioner, IdentityPreconditioner>::value;
+        const auto n = this->_n;
+        const auto k = this->_k;
+        const auto nk = n * k;
+        auto *R = &this->_work[0];
+        auto *Z = plain ? R : R + nk;
+        auto *P = R + 2 * nk;
+        auto *AP = R + 3 * nk;
+        auto *x = R + 4 * nk;
+        auto *y = x + n;
+        auto *rr = &this->_coeff[0];
+        auto *rz = rr + k;
+        auto *pap = rr + 2 * k;
+        auto *alpha = rr + 3 * k;
+        auto *beta = rr + 4 * k;
+
+        cg_detail::apply_block(A, X.data(), AP, n, k, x, y);
+        for (auto i = 0U; i != nk; ++i) {
+            R[i] = B[i] - AP[i];
+        }
+        cg_kernel::dot_block(R, R, n, k, rr);
+        auto num_active = 0U;
+        for (auto j = 0U; j != k; ++j) {
+            const auto converged = std::sqrt(rr[j]) < this->tolerance;
+            this->_info[j] = CgInfo{converged, 0U, std::sqrt(rr[j])};
+            this->_active[j] = converged ? 0 : 1;
+            num_active += converged ? 0U : 1U;
+            this->_history[j].clear();
+            if (this->keep_history) {
+                this->_history[j].push_back(std::sqrt(rr[j]));
+            }
+        }
+        if (num_active == 0U) {
+            return this->_info;
+        }
+        if (!plain) {
+            cg_detail::precondition_block(M, R, Z, n, k, x, y);
+            cg_kernel::dot_block(R, Z, n, k, rz);
+        } else {
+            for (auto j = 0U; j != k; ++j) {
+                rz[j] = rr[j];
+            }
+        }
+        for (auto i = 0U; i != nk; ++i) {
+            P[i] = Z[i];
+        }
+
+        for (auto niter = 1U; niter <= this->max_iters; ++niter) {
+            cg_detail::apply_block(A, P, AP, n, k, x, y);
+            cg_kernel::dot_block(P, AP, n, k, pap);
+            for (auto j = 0U; j != k; ++j) {
+                if (this->_active[j] != 0 && !(pap[j] > 0.0)) {  // not positive definite
+                    this->_active[j] = 0;
+                    --num_active;
+                }
+                // the stopped solves stay as they are
+                alpha[j] = this->_active[j] != 0 ? rz[j] / pap[j] : 0.0;
+            }
+            cg_kernel::update_x_r_block(alpha, P, AP, X.data(), R, n, k, rr);
+            for (auto j = 0U; j != k; ++j) {
+                if (this->_active[j] == 0) {
+                    continue;
+                }
+                auto &info = this->_info[j];
+                info.num_iters = niter;
+                info.residual_norm = std::sqrt(rr[j]);
+                if (this->keep_history) {
+                    this->_history[j].push_back(info.residual_norm);
+                }
+                if (info.residual_norm < this->tolerance) {
+                    info.converged = true;
+                    this->_active[j] = 0;
+                    --num_active;
+                }
+            }
+            if (num_active == 0U) {
+                break;
+            }
+            if (!plain) {
+                cg_detail::precondition_block(M, R, Z, n, k, x, y);
+                cg_kernel::dot_block(R, Z, n, k, beta);  // the new rz
+            } else {
+                for (auto j = 0U; j != k; ++j) {
+                    beta[j] = rr[j];
+                }
+            }
+            for (auto j = 0U; j != k; ++j) {
+                const auto rz_new = beta[j];
+                beta[j] = this->_active[j] != 0 ? rz_new / rz[j] : 0.0;
+                rz[j] = rz_new;
+            }
+            cg_kernel::xpby_block(Z, beta, P, n, k);
+        }
+        return this->_info;
+    }
+
+    /**
+     * @brief The norms of the residuals of the last solve of the right-hand side j
+     *
+     * Empty unless keep_history was set.
+     *
+     * @param[in] j
+     * @return const std::vector<double>&
+     */
+    auto residual_history(size_t j) const -> const std::vector<double> & {
+        return this->_history[j];
+    }
+};
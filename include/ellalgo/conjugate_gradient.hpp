@@ -83,6 +83,8 @@ class Matrix0 {
 /**
  * Solves the linear system Ax = b using the conjugate gradient method.
  *
+ * For large sparse or matrix-free systems, see `ConjugateGradient` in cg_engine.hpp.
+ *
  * @tparam Matrix0 The matrix type, which must support matrix-vector multiplication.
  * @tparam Vector0 The vector type, which must support vector operations.
  * @param A The matrix A in the linear system Ax = b.
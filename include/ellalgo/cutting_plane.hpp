@@ -4,8 +4,12 @@
 #include <cmath>
 #include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "cutting_plane_observer.hpp"
 #include "ell_config.hpp"
+#include "ell_span.hpp"
 #include "half_nonnegative.hpp"
 
 template <typename SearchSpace> using CuttingPlaneArrayType =
@@ -21,6 +25,382 @@ template <typename T> inline auto invalid_value() ->
     return T{};
 }
 
+namespace detail {
+    template <typename...> struct voider {
+        using type = void;
+    };
+
+    /**
+     * @brief Whether the oracle can write its cut into `space.grad_buffer()`, i.e.
+     *        provides `assess_feas(x, Span<double> grad, double &beta) -> bool`
+     */
+    template <typename Oracle, typename Space, typename = void> struct has_span_feas
+        : std::false_type {};
+
+    template <typename Oracle, typename Space> struct has_span_feas<
+        Oracle, Space,
+        typename voider<decltype(std::declval<Oracle &>().assess_feas(
+            std::declval<Space &>().xc(), std::declval<Space &>().grad_buffer(),
+            std::declval<double &>()))>::type> : std::true_type {};
+
+    /**
+     * @brief Whether the oracle provides
+     *        `assess_optim(x, gamma, Span<double> grad, double &beta) -> bool`
+     */
+    template <typename Oracle, typename Space, typename Num, typename = void>
+    struct has_span_optim : std::false_type {};
+
+    template <typename Oracle, typename Space, typename Num> struct has_span_optim<
+        Oracle, Space, Num,
+        typename voider<decltype(std::declval<Oracle &>().assess_optim(
+            std::declval<Space &>().xc(), std::declval<Num &>(),
+            std::declval<Space &>().grad_buffer(), std::declval<double &>()))>::type>
+        : std::true_type {};
+
+    /**
+     * @brief Whether the oracle provides `assess_optim_q(x, gamma, retry, Span<double> grad,
+     *        double &beta, bool &more_alt)`, returning a pointer to the discrete point if
+     *        gamma was shrunk
+     */
+    template <typename Oracle, typename Space, typename Num, typename = void>
+    struct has_span_optim_q : std::false_type {};
+
+    template <typename Oracle, typename Space, typename Num> struct has_span_optim_q<
+        Oracle, Space, Num,
+        typename voider<decltype(std::declval<Oracle &>().assess_optim_q(
+            std::declval<Space &>().xc(), std::declval<Num &>(), false,
+            std::declval<Space &>().grad_buffer(), std::declval<double &>(),
+            std::declval<bool &>()))>::type> : std::true_type {};
+
+    /**
+     * @brief Whether the oracle reports all the cuts it finds, i.e. provides
+     *        `assess_feas_all(x, std::vector<Cut> &cuts)`, leaving cuts empty
+     *        if x is feasible
+     */
+    template <typename Oracle, typename Space, typename = void> struct has_multi_feas
+        : std::false_type {};
+
+    template <typename Oracle, typename Space> struct has_multi_feas<
+        Oracle, Space,
+        typename voider<decltype(std::declval<Oracle &>().assess_feas_all(
+            std::declval<Space &>().xc(),
+            std::declval<std::vector<typename Oracle::Cut> &>()))>::type> : std::true_type {};
+
+    /**
+     * @brief Whether the oracle provides
+     *        `assess_optim_all(x, gamma, std::vector<Cut> &cuts) -> bool`, see
+     *        `optim_step`
+     */
+    template <typename Oracle, typename Space, typename Num, typename = void>
+    struct has_multi_optim : std::false_type {};
+
+    template <typename Oracle, typename Space, typename Num> struct has_multi_optim<
+        Oracle, Space, Num,
+        typename voider<decltype(std::declval<Oracle &>().assess_optim_all(
+            std::declval<Space &>().xc(), std::declval<Num &>(),
+            std::declval<std::vector<typename Oracle::Cut> &>()))>::type> : std::true_type {};
+
+    struct multi_cut {};  //!< the tag of the oracles of several cuts per call
+
+    struct no_cuts {};  //!< the cut buffer of the other oracles
+
+    /**
+     * @brief The tag of the step for an oracle: multi_cut, or whether it is span-based
+     */
+    template <bool Multi, typename SpanBased> using step_tag =
+        typename std::conditional<Multi, multi_cut, SpanBased>::type;
+
+    template <typename Oracle, typename Tag> struct cut_buffer {
+        using type = no_cuts;
+    };
+
+    template <typename Oracle> struct cut_buffer<Oracle, multi_cut> {
+        using type = std::vector<typename Oracle::Cut>;  // reused by every iteration
+    };
+
+    /**
+     * @brief Whether the observer may stop the method, i.e. provides
+     *        `stop_now(double gamma) -> bool`, see `StoppingRule`
+     */
+    template <typename Observer, typename = void> struct has_stop_now : std::false_type {};
+
+    template <typename Observer> struct has_stop_now<
+        Observer, typename voider<decltype(std::declval<Observer &>().stop_now(0.0))>::type>
+        : std::true_type {};
+
+    /**
+     * @brief Ask the observer whether to stop, after the update of an iteration
+     *
+     * @param[in] gamma the best-so-far value, NaN for a feasibility problem
+     */
+    template <typename Observer, typename Num>
+    inline auto stop_now(Observer &observer, const Num &gamma) ->
+        typename std::enable_if<has_stop_now<Observer>::value, bool>::type {
+        return observer.stop_now(static_cast<double>(gamma));
+    }
+
+    template <typename Observer, typename Num>
+    inline auto stop_now(Observer & /* observer */, const Num & /* gamma */) ->
+        typename std::enable_if<!has_stop_now<Observer>::value, bool>::type {
+        return false;
+    }
+
+    /**
+     * @brief Whether the space provides `log_volume() -> double`, as `Ell` does
+     */
+    template <typename Space, typename = void> struct has_log_volume : std::false_type {};
+
+    template <typename Space> struct has_log_volume<
+        Space, typename voider<decltype(std::declval<const Space &>().log_volume())>::type>
+        : std::true_type {};
+
+    /**
+     * @brief The log of the volume of the space, for the records of the observer
+     *
+     * @return double - NaN if the space does not track it
+     */
+    template <typename Space> inline auto log_volume(const Space &space) ->
+        typename std::enable_if<has_log_volume<Space>::value, double>::type {
+        return space.log_volume();
+    }
+
+    template <typename Space> inline auto log_volume(const Space & /* space */) ->
+        typename std::enable_if<!has_log_volume<Space>::value, double>::type {
+        return std::nan("");
+    }
+
+    /**
+     * @brief The kind of a cut by its beta, see `CutKind`
+     */
+    inline auto cut_kind(const double & /* beta */, bool central) -> CutKind {
+        return central ? CutKind::Central : CutKind::Bias;
+    }
+
+    template <typename Arr> inline auto cut_kind(const Arr &beta, bool central) -> CutKind {
+        if (beta.size() < 2U) {
+            return central ? CutKind::Central : CutKind::Bias;
+        }
+        return central ? CutKind::ParallelCentral : CutKind::Parallel;
+    }
+
+    /**
+     * @brief Assess xc and, unless it is feasible, update the space by the cut
+     *
+     * @return false if xc is feasible
+     */
+    template <typename OracleFeas, typename SearchSpace, typename Observer>
+    inline auto feas_step(OracleFeas &omega, SearchSpace &space, CutStatus &status,
+                          Observer &observer, size_t niter, no_cuts & /* cuts */,
+                          std::false_type /* pair-based */) -> bool {
+        observer.oracle_begin();
+        const auto cut = omega.assess_feas(space.xc());
+        observer.oracle_end();
+        if (!cut) {
+            return false;
+        }
+        status = space.update_bias_cut(*cut);
+        observer.update_end({niter, cut_kind(cut->second, false), status, space.tsq(),
+                             log_volume(space)});
+        return true;
+    }
+
+    template <typename OracleFeas, typename SearchSpace, typename Observer>
+    inline auto feas_step(OracleFeas &omega, SearchSpace &space, CutStatus &status,
+                          Observer &observer, size_t niter, no_cuts & /* cuts */,
+                          std::true_type /* span-based */) -> bool {
+        const auto grad = space.grad_buffer();  // written in place by the oracle
+        auto beta = 0.0;
+        observer.oracle_begin();
+        const auto infeasible = omega.assess_feas(space.xc(), grad, beta);
+        observer.oracle_end();
+        if (!infeasible) {
+            return false;
+        }
+        status = space.update_bias_cut(Span<const double>(grad), beta);
+        observer.update_end({niter, CutKind::Bias, status, space.tsq(), log_volume(space)});
+        return true;
+    }
+
+    template <typename OracleFeas, typename SearchSpace, typename Observer, typename Cuts>
+    inline auto feas_step(OracleFeas &omega, SearchSpace &space, CutStatus &status,
+                          Observer &observer, size_t niter, Cuts &cuts, multi_cut /* all cuts */)
+        -> bool {
+        cuts.clear();
+        observer.oracle_begin();
+        omega.assess_feas_all(space.xc(), cuts);
+        observer.oracle_end();
+        if (cuts.empty()) {
+            return false;
+        }
+        const auto result = space.update_deepest_cut(cuts);
+        status = result.first;
+        observer.update_end(
+            {niter, cut_kind(cuts[result.second].second, false), status, space.tsq(),
+             log_volume(space)});
+        return true;
+    }
+
+    /**
+     * @brief Assess xc, then update the space by the cut
+     *
+     * xc is stored in x_best if gamma was shrunk (best-so-far sol'n).
+     *
+     * @return CutStatus
+     */
+    template <typename OracleOptim, typename SearchSpace, typename Num, typename Observer>
+    inline auto optim_step(OracleOptim &omega, SearchSpace &space, Num &gamma,
+                           CuttingPlaneArrayType<SearchSpace> &x_best, Observer &observer,
+                           size_t niter, no_cuts & /* cuts */, std::false_type /* pair-based */)
+        -> CutStatus {
+        observer.oracle_begin();
+        const auto __result1 = omega.assess_optim(space.xc(), gamma);
+        observer.oracle_end();
+        const auto &cut = std::get<0>(__result1);
+        const auto &shrunk = std::get<1>(__result1);
+        auto status = CutStatus::Success;
+        if (shrunk) {  // best gamma obtained
+            x_best = space.xc();
+            status = space.update_central_cut(cut);  // should update_central_cut
+        } else {
+            status = space.update_bias_cut(cut);
+        }
+        observer.update_end({niter, cut_kind(cut.second, shrunk), status, space.tsq(),
+                             log_volume(space), shrunk});
+        return status;
+    }
+
+    template <typename OracleOptim, typename SearchSpace, typename Num, typename Observer>
+    inline auto optim_step(OracleOptim &omega, SearchSpace &space, Num &gamma,
+                           CuttingPlaneArrayType<SearchSpace> &x_best, Observer &observer,
+                           size_t niter, no_cuts & /* cuts */, std::true_type /* span-based */)
+        -> CutStatus {
+        const auto grad = space.grad_buffer();  // written in place by the oracle
+        auto beta = 0.0;
+        observer.oracle_begin();
+        const auto shrunk = omega.assess_optim(space.xc(), gamma, grad, beta);
+        observer.oracle_end();
+        auto status = CutStatus::Success;
+        if (shrunk) {  // best gamma obtained
+            x_best = space.xc();
+            status = space.update_central_cut(Span<const double>(grad), beta);
+        } else {
+            status = space.update_bias_cut(Span<const double>(grad), beta);
+        }
+        observer.update_end({niter, cut_kind(beta, shrunk), status, space.tsq(),
+                             log_volume(space), shrunk});
+        return status;
+    }
+
+    /**
+     * With an oracle of several cuts: if gamma was shrunk, cuts holds the cut
+     * of the objective alone, which is applied as a central cut; otherwise
+     * the space is updated by the deepest of the cuts found.
+     */
+    template <typename OracleOptim, typename SearchSpace, typename Num, typename Observer,
+              typename Cuts>
+    inline auto optim_step(OracleOptim &omega, SearchSpace &space, Num &gamma,
+                           CuttingPlaneArrayType<SearchSpace> &x_best, Observer &observer,
+                           size_t niter, Cuts &cuts, multi_cut /* all cuts */) -> CutStatus {
+        cuts.clear();
+        observer.oracle_begin();
+        const auto shrunk = omega.assess_optim_all(space.xc(), gamma, cuts);
+        observer.oracle_end();
+        assert(!cuts.empty());
+        auto index = size_t(0U);
+        auto status = CutStatus::Success;
+        if (shrunk) {  // best gamma obtained
+            x_best = space.xc();
+            status = space.update_central_cut(cuts.front());
+        } else {
+            std::tie(status, index) = space.update_deepest_cut(cuts);
+        }
+        observer.update_end({niter, cut_kind(cuts[index].second, shrunk), status, space.tsq(),
+                             log_volume(space), shrunk});
+        return status;
+    }
+
+    /**
+     * @brief What `cutting_plane_optim_q` does after an iteration
+     */
+    enum class QStep { Continue, Stop, NoAlternative };
+
+    /**
+     * @brief What follows the update of `cutting_plane_optim_q` by a cut of the given status
+     */
+    inline auto q_step_after(CutStatus status, bool more_alt, bool &retry) -> QStep {
+        if (status == CutStatus::Success) {
+            retry = false;
+        } else if (status == CutStatus::NoSoln) {
+            return QStep::Stop;
+        } else if (status == CutStatus::NoEffect) {
+            if (!more_alt) {  // more alt?
+                return QStep::NoAlternative;
+            }
+            retry = true;
+        }
+        return QStep::Continue;
+    }
+
+    template <typename OracleOptimQ, typename SearchSpaceQ, typename Num, typename Observer>
+    inline auto optim_q_step(OracleOptimQ &omega, SearchSpaceQ &space_q, Num &gamma,
+                             CuttingPlaneArrayType<SearchSpaceQ> &x_best, bool &retry,
+                             Observer &observer, size_t niter, std::false_type /* span-based */)
+        -> QStep {
+        observer.oracle_begin();
+        const auto result1 = omega.assess_optim_q(space_q.xc(), gamma, retry);
+        observer.oracle_end();
+        const auto &cut = std::get<0>(result1);
+        const auto &shrunk = std::get<1>(result1);
+        if (shrunk) {  // best gamma obtained
+            auto x_q = std::get<2>(result1);
+            x_best = std::move(x_q);
+            retry = false;
+        }
+        auto status = space_q.update_q(cut);
+        observer.update_end({niter, cut_kind(cut.second, false), status, space_q.tsq(),
+                             log_volume(space_q)});
+        return q_step_after(status, std::get<3>(result1), retry);
+    }
+
+    template <typename OracleOptimQ, typename SearchSpaceQ, typename Num, typename Observer>
+    inline auto optim_q_step(OracleOptimQ &omega, SearchSpaceQ &space_q, Num &gamma,
+                             CuttingPlaneArrayType<SearchSpaceQ> &x_best, bool &retry,
+                             Observer &observer, size_t niter, std::true_type /* span-based */)
+        -> QStep {
+        const auto grad = space_q.grad_buffer();  // written in place by the oracle
+        auto beta = 0.0;
+        auto more_alt = false;
+        observer.oracle_begin();
+        const auto *x_q = omega.assess_optim_q(space_q.xc(), gamma, retry, grad, beta, more_alt);
+        observer.oracle_end();
+        if (x_q != nullptr) {  // best gamma obtained
+            x_best = *x_q;
+            retry = false;
+        }
+        auto status = space_q.update_q(Span<const double>(grad), beta);
+        observer.update_end({niter, cut_kind(beta, false), status, space_q.tsq(),
+                             log_volume(space_q)});
+        return q_step_after(status, more_alt, retry);
+    }
+
+    /**
+     * @brief Assess xc over the discrete set, then update the space by the cut
+     *
+     * retry is true if the oracle is to give an alternative cut, the last
+     * one having had no effect. The cut is written into `space_q.grad_buffer()`
+     * if the oracle can, see `has_span_optim_q`.
+     *
+     * @return QStep
+     */
+    template <typename OracleOptimQ, typename SearchSpaceQ, typename Num, typename Observer>
+    inline auto optim_q_step(OracleOptimQ &omega, SearchSpaceQ &space_q, Num &gamma,
+                             CuttingPlaneArrayType<SearchSpaceQ> &x_best, bool &retry,
+                             Observer &observer, size_t niter) -> QStep {
+        return optim_q_step(omega, space_q, gamma, x_best, retry, observer, niter,
+                            has_span_optim_q<OracleOptimQ, SearchSpaceQ, Num>{});
+    }
+}  // namespace detail
+
 /**
  * @brief Find a point in a convex set (defined through a cutting-plane oracle).
  *
@@ -40,24 +420,33 @@ template <typename T> inline auto invalid_value() ->
  * A *separation oracle* asserts that an evalution point xc is feasible,
  * or provide a cut that separates the feasible region and xc.
  *
+ * An oracle that provides `assess_feas_all` reports all the cuts it finds
+ * at xc, and the space is updated by the deepest of them (see
+ * `Ell::update_deepest_cut`).
+ *
  * @tparam OracleFeas
  * @tparam SearchSpace
- * @param[in,out] omega   perform assessment on x0
- * @param[in,out] space   search Space containing x*
- * @param[in]     options maximum iteration and error tolerance etc.
+ * @tparam Observer e.g. `SolverStats`, see `NullObserver`
+ * @param[in,out] omega    perform assessment on x0
+ * @param[in,out] space    search Space containing x*
+ * @param[in]     options  maximum iteration and error tolerance etc.
+ * @param[in,out] observer notified of every iteration
  * @return Information of Cutting-plane method
  */
-template <typename OracleFeas, typename SearchSpace>
-inline auto cutting_plane_feas(OracleFeas &omega, SearchSpace &space,
-                               const Options &options = Options())
+template <typename OracleFeas, typename SearchSpace, typename Observer>
+inline auto cutting_plane_feas(OracleFeas &omega, SearchSpace &space, const Options &options,
+                               Observer &observer)
     -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    using Tag = detail::step_tag<detail::has_multi_feas<OracleFeas, SearchSpace>::value,
+                                 detail::has_span_feas<OracleFeas, SearchSpace>>;
+    auto cuts = typename detail::cut_buffer<OracleFeas, Tag>::type{};
     for (auto niter = 0U; niter != options.max_iters; ++niter) {
-        const auto cut = omega.assess_feas(space.xc());
-        if (!cut) {  // feasible sol'n obtained
-            return {space.xc(), niter};
+        auto status = CutStatus::Success;
+        if (!detail::feas_step(omega, space, status, observer, niter, cuts, Tag{})) {
+            return {space.xc(), niter};  // feasible sol'n obtained
         }
-        const auto status = space.update_bias_cut(*cut);  // update space
-        if (status != CutStatus::Success || space.tsq() < options.tolerance) {
+        if (status != CutStatus::Success || space.tsq() < options.tolerance
+            || detail::stop_now(observer, std::nan(""))) {
             auto res = invalid_value<CuttingPlaneArrayType<SearchSpace>>();
             return {std::move(res), niter};
         }
@@ -66,6 +455,19 @@ inline auto cutting_plane_feas(OracleFeas &omega, SearchSpace &space,
     return {std::move(res), options.max_iters};
 }
 
+/**
+ * @brief Find a point in a convex set, without an observer
+ *
+ * @see cutting_plane_feas
+ */
+template <typename OracleFeas, typename SearchSpace>
+inline auto cutting_plane_feas(OracleFeas &omega, SearchSpace &space,
+                               const Options &options = Options())
+    -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    auto observer = NullObserver{};
+    return cutting_plane_feas(omega, space, options, observer);
+}
+
 /**
  * @brief Cutting-plane method for solving convex problem
  *
@@ -82,39 +484,99 @@ inline auto cutting_plane_feas(OracleFeas &omega, SearchSpace &space,
  * function g' (x - xc) + beta is called a cutting-plane, or a ``cut'' for
  * short.
  *
+ * An oracle that provides `assess_optim_all` reports all the cuts it finds
+ * at xc, and the space is updated by the deepest of them (see
+ * `Ell::update_deepest_cut`).
+ *
  * @tparam OracleOptim
  * @tparam SearchSpace
  * @tparam Num
- * @param[in,out] omega   perform assessment on x0
- * @param[in,out] space   search Space containing x*
- * @param[in,out] gamma   best-so-far optimal sol'n
- * @param[in]     options maximum iteration and error tolerance etc.
+ * @tparam Observer e.g. `SolverStats`, see `NullObserver`
+ * @param[in,out] omega    perform assessment on x0
+ * @param[in,out] space    search Space containing x*
+ * @param[in,out] gamma    best-so-far optimal sol'n
+ * @param[in]     options  maximum iteration and error tolerance etc.
+ * @param[in,out] observer notified of every iteration
  * @return Information of Cutting-plane method
  */
-template <typename OracleOptim, typename SearchSpace, typename Num>
+template <typename OracleOptim, typename SearchSpace, typename Num, typename Observer>
 inline auto cutting_plane_optim(OracleOptim &omega, SearchSpace &space, Num &gamma,
-                                const Options &options = Options())
+                                const Options &options, Observer &observer)
     -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    using Tag = detail::step_tag<detail::has_multi_optim<OracleOptim, SearchSpace, Num>::value,
+                                 detail::has_span_optim<OracleOptim, SearchSpace, Num>>;
+    auto cuts = typename detail::cut_buffer<OracleOptim, Tag>::type{};
     auto x_best = invalid_value<CuttingPlaneArrayType<SearchSpace>>();
     for (auto niter = 0U; niter < options.max_iters; ++niter) {
-        const auto __result1 = omega.assess_optim(space.xc(), gamma);
-        const auto &cut = std::get<0>(__result1);
-        const auto &shrunk = std::get<1>(__result1);
-        const auto status = [&]() {
-            if (shrunk) {  // best gamma obtained
-                x_best = space.xc();
-                return space.update_central_cut(cut);  // should update_central_cut
-            } else {
-                return space.update_bias_cut(cut);
-            }
-        }();
-        if (status != CutStatus::Success || space.tsq() < options.tolerance) {  // no more
+        const auto status
+            = detail::optim_step(omega, space, gamma, x_best, observer, niter, cuts, Tag{});
+        if (status != CutStatus::Success || space.tsq() < options.tolerance
+            || detail::stop_now(observer, gamma)) {  // no more
             return {std::move(x_best), niter};
         }
     }
     return {std::move(x_best), options.max_iters};
 }  // END
 
+/**
+ * @brief Cutting-plane method for solving convex problem, without an observer
+ *
+ * @see cutting_plane_optim
+ */
+template <typename OracleOptim, typename SearchSpace, typename Num>
+inline auto cutting_plane_optim(OracleOptim &omega, SearchSpace &space, Num &gamma,
+                                const Options &options = Options())
+    -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    auto observer = NullObserver{};
+    return cutting_plane_optim(omega, space, gamma, options, observer);
+}
+
+/**
+ * @brief `cutting_plane_optim`, restarting the space every so many iterations
+ *
+ * After every `restart.interval` iterations, the space starts again from a
+ * diagonal ellipsoid about its centre (see `Ell::recondition`), for at most
+ * `restart.max_restarts` times. The cuts so far have shrunk and rotated the
+ * ellipsoid; the restart keeps the scale along each axis and drops the rest,
+ * which lets a too small or badly scaled initial ellipsoid grow again
+ * (inflate > 1) towards a solution outside of it. For a well-posed problem,
+ * it costs iterations instead.
+ *
+ * @tparam OracleOptim
+ * @tparam SearchSpace e.g. `Ell`
+ * @tparam Num
+ * @param[in,out] omega    perform assessment on x0
+ * @param[in,out] space    search Space containing x*
+ * @param[in,out] gamma    best-so-far optimal sol'n
+ * @param[in]     options  maximum iteration (of all rounds) and error tolerance etc.
+ * @param[in]     restart  interval, inflate and maximum number of restarts
+ * @return Information of Cutting-plane method
+ */
+template <typename OracleOptim, typename SearchSpace, typename Num>
+inline auto cutting_plane_optim_restart(OracleOptim &omega, SearchSpace &space, Num &gamma,
+                                        const Options &options, const RestartOptions &restart)
+    -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    auto x_best = invalid_value<CuttingPlaneArrayType<SearchSpace>>();
+    auto total = size_t(0U);
+    for (auto round = size_t(0U); total < options.max_iters; ++round) {
+        const auto remaining = options.max_iters - total;
+        const auto last = round == restart.max_restarts || restart.interval >= remaining;
+        const auto round_options = Options(last ? remaining : restart.interval, options.tolerance);
+        auto result = cutting_plane_optim(omega, space, gamma, round_options);
+        auto &x = std::get<0>(result);
+        const auto num_iters = std::get<1>(result);
+        total += num_iters;
+        if (x.size() != 0U) {
+            x_best = std::move(x);
+        }
+        if (last || num_iters < round_options.max_iters) {
+            break;  // stopped early, or the last round
+        }
+        space.recondition(restart.inflate);
+    }
+    return {std::move(x_best), total};
+}
+
 /**
  * @brief Cutting-plane method for solving convex discrete optimization problem
  *
@@ -133,47 +595,49 @@ inline auto cutting_plane_optim(OracleOptim &omega, SearchSpace &space, Num &gam
  *
  * @tparam OracleOptimQ
  * @tparam Space
- * @param[in,out] omega   perform assessment on x0
- * @param[in,out] space   search Space containing x*
- * @param[in,out] gamma   best-so-far optimal sol'n
- * @param[in]     options maximum iteration and error tolerance etc.
+ * @tparam Observer e.g. `SolverStats`, see `NullObserver`
+ * @param[in,out] omega    perform assessment on x0
+ * @param[in,out] space    search Space containing x*
+ * @param[in,out] gamma    best-so-far optimal sol'n
+ * @param[in]     options  maximum iteration and error tolerance etc.
+ * @param[in,out] observer notified of every iteration
  * @return Information of Cutting-plane method
  */
-template <typename OracleOptimQ, typename SearchSpaceQ, typename Num>
+template <typename OracleOptimQ, typename SearchSpaceQ, typename Num, typename Observer>
 inline auto cutting_plane_optim_q(OracleOptimQ &omega, SearchSpaceQ &space_q, Num &gamma,
-                                  const Options &options = Options())
+                                  const Options &options, Observer &observer)
     -> std::tuple<CuttingPlaneArrayType<SearchSpaceQ>, size_t> {
     auto x_best = invalid_value<CuttingPlaneArrayType<SearchSpaceQ>>();
     auto retry = false;
 
     for (auto niter = 0U; niter < options.max_iters; ++niter) {
-        const auto result1 = omega.assess_optim_q(space_q.xc(), gamma, retry);
-        const auto &cut = std::get<0>(result1);
-        const auto &shrunk = std::get<1>(result1);
-        if (shrunk) {  // best gamma obtained
-            auto x_q = std::get<2>(result1);
-            x_best = std::move(x_q);
-            retry = false;
-        }
-        auto status = space_q.update_q(cut);
-        if (status == CutStatus::Success) {
-            retry = false;
-        } else if (status == CutStatus::NoSoln) {
-            return {std::move(x_best), niter};
-        } else if (status == CutStatus::NoEffect) {
-            const auto &more_alt = std::get<3>(result1);
-            if (!more_alt) {  // more alt?
-                break;        // no more alternative cut
-            }
-            retry = true;
+        const auto step
+            = detail::optim_q_step(omega, space_q, gamma, x_best, retry, observer, niter);
+        if (step == detail::QStep::NoAlternative) {
+            break;  // no more alternative cut
         }
-        if (space_q.tsq() < options.tolerance) {  // no more
+        if (step == detail::QStep::Stop || space_q.tsq() < options.tolerance
+            || detail::stop_now(observer, gamma)) {  // no more
             return {std::move(x_best), niter};
         }
     }
     return {std::move(x_best), options.max_iters};
 }  // END
 
+/**
+ * @brief Cutting-plane method for solving convex discrete optimization problem, without an
+ *        observer
+ *
+ * @see cutting_plane_optim_q
+ */
+template <typename OracleOptimQ, typename SearchSpaceQ, typename Num>
+inline auto cutting_plane_optim_q(OracleOptimQ &omega, SearchSpaceQ &space_q, Num &gamma,
+                                  const Options &options = Options())
+    -> std::tuple<CuttingPlaneArrayType<SearchSpaceQ>, size_t> {
+    auto observer = NullObserver{};
+    return cutting_plane_optim_q(omega, space_q, gamma, options, observer);
+}
+
 /**
  * @brief
  *
@@ -187,8 +651,20 @@ class BSearchAdaptor {
     Oracle &_omega;
     Space &_space;
     const Options _options;
+    Space _work;                      //!< the space of the probes, reused
+    typename Space::Snapshot _start;  //!< where the probes start from
 
   public:
+    /**
+     * @brief Start a probe from the ellipsoid of the last feasible probe
+     *
+     * The final ellipsoid of a feasible probe still contains the feasible
+     * set of every smaller gamma (assuming monotone), so that the next probe
+     * may continue from it instead of the original space, which usually
+     * takes fewer iterations.
+     */
+    bool warm_start = false;
+
     /**
      * @brief Construct a new bsearch adaptor object
      *
@@ -205,14 +681,20 @@ class BSearchAdaptor {
      * @param[in]     options maximum iteration and error tolerance etc.
      */
     BSearchAdaptor(Oracle &omega, Space &space, const Options &options)
-        : _omega{omega}, _space{space}, _options{options} {}
+        : _omega{omega},
+          _space{space},
+          _options{options},
+          _work{space.copy()},
+          _start{space.snapshot()} {}
 
     /**
-     * @brief get best x
+     * @brief get best x, as the space gives its centre (e.g. without a copy)
      *
      * @return auto
      */
-    auto x_best() const -> ArrayType { return this->_space.xc(); }
+    auto x_best() const -> decltype(std::declval<const Space &>().xc()) {
+        return this->_space.xc();
+    }
 
     /**
      * @brief
@@ -222,12 +704,17 @@ class BSearchAdaptor {
      * @return bool
      */
     template <typename Num> auto assess_bs(Num &gamma) -> bool {
-        Space space = this->_space.copy();  // copy
+        this->_work.restore(this->_start);  // no allocation
         this->_omega.update(gamma);
-        const auto result = cutting_plane_feas(this->_omega, space, this->_options);
+        const auto result = cutting_plane_feas(this->_omega, this->_work, this->_options);
         auto x_feas = std::get<0>(result);
         if (x_feas.size() != 0U) {
             this->_space.set_xc(x_feas);
+            if (this->warm_start) {
+                this->_work.checkpoint(this->_start);
+            } else {
+                this->_space.checkpoint(this->_start);  // the original space, at x_feas
+            }
             return true;
         }
         return false;
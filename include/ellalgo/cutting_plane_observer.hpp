@@ -0,0 +1,344 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "ell_config.hpp"
+
+/**
+ * @brief The kind of the cut of an iteration
+ */
+enum class CutKind : unsigned char { Central, Bias, ParallelCentral, Parallel };
+
+/**
+ * @brief What an iteration of the cutting-plane method did
+ */
+struct CutRecord {
+    size_t niter;
+    CutKind kind;
+    CutStatus status;
+    double tsq;         //!< tsq of the space after the update
+    double log_volume;  //!< of the space after the update, NaN if it does not track it
+    /**
+     * The cut is that of the objective at xc, gamma having just improved:
+     * set by `cutting_plane_optim` only, not for the feasibility cuts, nor
+     * for the cuts of `cutting_plane_optim_q`, which are not subgradients
+     * of the objective.
+     */
+    bool objective = false;
+};
+
+/**
+ * @brief The observer of the cutting-plane methods that does nothing
+ *
+ * The default observer. An observer provides the three hooks below, which
+ * the methods call in this order on every iteration:
+ *
+ *        oracle_begin()               before the oracle is called
+ *        oracle_end()                 once it has returned
+ *        update_end(const CutRecord&) once the space is updated by the cut
+ *
+ * `update_end` is not called when the oracle finds xc feasible. The hooks
+ * here are empty and inline, so that the methods compile to the same code
+ * as without an observer.
+ *
+ * An observer may also provide `stop_now(double gamma) -> bool`, called
+ * after `update_end`, to stop the method early (see `StoppingRule`); gamma
+ * is the best-so-far value (NaN for `cutting_plane_feas`).
+ */
+struct NullObserver {
+    void oracle_begin() {}
+    void oracle_end() {}
+    void update_end(const CutRecord & /* record */) {}
+};
+
+/**
+ * @brief An observer that counts, times and traces the iterations
+ *
+ * It counts the cuts by kind and by status, and sums the time spent in the
+ * oracle and in the update of the space (steady_clock, three readings per
+ * iteration). If a trace capacity is given, the records of the last
+ * `capacity` iterations are kept in a ring buffer, allocated once.
+ *
+ * Example:
+ *
+ *     auto stats = SolverStats(64);
+ *     cutting_plane_optim(omega, ellip, gamma, Options(), stats);
+ *     stats.oracle_seconds(); stats.trace();
+ */
+class SolverStats {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point _start{};
+    Clock::time_point _oracle_done{};
+    Clock::duration _oracle_time{};
+    Clock::duration _update_time{};
+    size_t _num_oracle_calls = 0U;
+    size_t _num_updates = 0U;
+    size_t _kind_count[4] = {};
+    size_t _status_count[4] = {};
+    size_t _capacity;
+    std::vector<CutRecord> _ring;
+    size_t _next = 0U;  //!< where the next record goes in `_ring`
+
+  public:
+    /**
+     * @brief Construct a new solver stats object
+     *
+     * @param[in] capacity number of records to trace, none by default
+     */
+    explicit SolverStats(size_t capacity = 0U) : _capacity{capacity} {
+        this->_ring.reserve(capacity);
+    }
+
+    void oracle_begin() {
+        ++this->_num_oracle_calls;
+        this->_start = Clock::now();
+    }
+
+    void oracle_end() {
+        this->_oracle_done = Clock::now();
+        this->_oracle_time += this->_oracle_done - this->_start;
+    }
+
+    void update_end(const CutRecord &record) {
+        this->_update_time += Clock::now() - this->_oracle_done;
+        ++this->_num_updates;
+        ++this->_kind_count[static_cast<size_t>(record.kind)];
+        ++this->_status_count[static_cast<size_t>(record.status)];
+        if (this->_capacity == 0U) {
+            return;
+        }
+        if (this->_ring.size() != this->_capacity) {
+            this->_ring.push_back(record);
+        } else {
+            this->_ring[this->_next] = record;
+        }
+        this->_next = this->_next + 1U == this->_capacity ? 0U : this->_next + 1U;
+    }
+
+    /**
+     * @brief Forget everything recorded, but keep the trace capacity
+     */
+    void reset() {
+        const auto capacity = this->_capacity;
+        auto ring = std::move(this->_ring);  // keeps its storage
+        ring.clear();
+        *this = SolverStats{};
+        this->_capacity = capacity;
+        this->_ring = std::move(ring);
+    }
+
+    auto num_oracle_calls() const -> size_t { return this->_num_oracle_calls; }
+
+    auto num_updates() const -> size_t { return this->_num_updates; }
+
+    auto count(CutKind kind) const -> size_t {
+        return this->_kind_count[static_cast<size_t>(kind)];
+    }
+
+    auto count(CutStatus status) const -> size_t {
+        return this->_status_count[static_cast<size_t>(status)];
+    }
+
+    /**
+     * @brief Total time in the oracle, in seconds
+     *
+     * @return double
+     */
+    auto oracle_seconds() const -> double {
+        return std::chrono::duration<double>(this->_oracle_time).count();
+    }
+
+    /**
+     * @brief Total time in the update of the space, in seconds
+     *
+     * @return double
+     */
+    auto update_seconds() const -> double {
+        return std::chrono::duration<double>(this->_update_time).count();
+    }
+
+    /**
+     * @brief The traced records, oldest first
+     *
+     * @return std::vector<CutRecord>
+     */
+    auto trace() const -> std::vector<CutRecord> {
+        auto records = std::vector<CutRecord>{};
+        records.reserve(this->_ring.size());
+        const auto wrapped = this->_ring.size() == this->_capacity;
+        for (auto k = wrapped ? this->_next : 0U; k != this->_ring.size(); ++k) {
+            records.push_back(this->_ring[k]);
+        }
+        for (auto k = 0U; wrapped && k != this->_next; ++k) {
+            records.push_back(this->_ring[k]);
+        }
+        return records;
+    }
+};
+
+/**
+ * @brief An observer that stops the method as soon as the solution is good enough
+ *
+ * Besides `Options::max_iters` and `Options::tolerance`, the method stops
+ * at the first of the criteria set here that is met, each being off by
+ * default:
+ *
+ *   - stalled: gamma improved by no more than `rel_improvement * |gamma|`
+ *     over the last `window` iterations, counted from the first change of
+ *     gamma from its initial value (never for `cutting_plane_feas`);
+ *   - out of time: `max_seconds` have passed since the first iteration;
+ *   - gap: the gap estimate is at most `rel_gap * |gamma|`. The estimate
+ *     is sqrt(tsq) of the last cut of the objective (`CutRecord::objective`):
+ *     as the ellipsoid contains x*, f(x*) >= f(xc) + g' (x* - xc) >=
+ *     f(xc) - sqrt(tsq);
+ *   - volume: the log of the volume of the space is below
+ *     `min_log_volume`, for the spaces that track it (`CutRecord`).
+ *
+ * The gap estimate is a bound only if the objective is convex and its
+ * cuts from the oracle are subgradient cuts, f(x) >= f(xc) + g' (x - xc)
+ * for all x; `rel_gap` must stay 0 otherwise, e.g. for a quasi-convex
+ * objective given to `cutting_plane_optim`. The feasibility cuts bound
+ * nothing about f, and never set the estimate, nor do the cuts of
+ * `cutting_plane_optim_q`: it stays infinite there.
+ *
+ * The hooks are forwarded to the observer given, e.g. `SolverStats`. A
+ * rule keeps the state of its solve (the clock, the window, the gap
+ * estimate); `reset` clears it for the next solve.
+ *
+ * Example:
+ *
+ *     auto rule = StoppingRule<>();
+ *     rule.rel_gap = 1e-6;
+ *     cutting_plane_optim(omega, ellip, gamma, Options(), rule);
+ *     rule.reason();
+ *
+ * @tparam Observer
+ */
+template <typename Observer = NullObserver> class StoppingRule {
+    using Clock = std::chrono::steady_clock;
+
+    Observer _observer;
+    Clock::time_point _start{};
+    bool _started = false;
+    double _gap = std::numeric_limits<double>::infinity();
+    double _log_volume = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> _gammas;  //!< ring of the last `window` values of gamma
+    size_t _next = 0U;
+    double _first_gamma = std::numeric_limits<double>::quiet_NaN();  //!< of the first check
+    bool _gamma_changed = false;  //!< from _first_gamma, which starts the window
+
+  public:
+    enum class Reason : unsigned char { None, Stalled, OutOfTime, Gap, Volume };
+
+  private:
+    Reason _reason = Reason::None;
+
+  public:
+
+    size_t window = 0U;            //!< 0 for no stall criterion
+    double rel_improvement = 0.0;  //!< see `window`
+    double max_seconds = 0.0;      //!< 0 for no time budget
+    double rel_gap = 0.0;          //!< 0 for no gap criterion
+    double min_log_volume = -std::numeric_limits<double>::infinity();  //!< see `Ell::log_volume`
+
+    explicit StoppingRule(Observer observer = Observer()) : _observer{std::move(observer)} {}
+
+    void oracle_begin() {
+        if (!this->_started) {
+            this->_started = true;
+            this->_start = Clock::now();
+        }
+        this->_observer.oracle_begin();
+    }
+
+    void oracle_end() { this->_observer.oracle_end(); }
+
+    void update_end(const CutRecord &record) {
+        if (record.objective) {
+            this->_gap = std::sqrt(record.tsq);
+        }
+        this->_log_volume = record.log_volume;
+        this->_observer.update_end(record);
+    }
+
+    /**
+     * @brief Forget the state of the last solve, but keep the criteria and the storage
+     *
+     * The observer given is left as it is.
+     */
+    void reset() {
+        this->_started = false;
+        this->_start = Clock::time_point{};
+        this->_gap = std::numeric_limits<double>::infinity();
+        this->_log_volume = std::numeric_limits<double>::quiet_NaN();
+        this->_gammas.clear();  // keeps its storage
+        this->_next = 0U;
+        this->_first_gamma = std::numeric_limits<double>::quiet_NaN();
+        this->_gamma_changed = false;
+        this->_reason = Reason::None;
+    }
+
+    auto stop_now(double gamma) -> bool {
+        this->_reason = this->_check(gamma);
+        return this->_reason != Reason::None;
+    }
+
+    /**
+     * @brief Why the method was stopped, `None` if not by this rule
+     *
+     * @return Reason
+     */
+    auto reason() const -> Reason { return this->_reason; }
+
+    /**
+     * @brief The gap estimate of the last objective cut, infinity if none yet
+     *
+     * @return double
+     */
+    auto gap() const -> double { return this->_gap; }
+
+    auto observer() -> Observer & { return this->_observer; }
+
+  private:
+    auto _check(double gamma) -> Reason {
+        const auto scale = std::abs(gamma);
+        if (this->rel_gap > 0.0 && this->_gap <= this->rel_gap * scale) {
+            return Reason::Gap;
+        }
+        if (!this->_gamma_changed && !std::isnan(gamma)) {
+            if (std::isnan(this->_first_gamma)) {
+                this->_first_gamma = gamma;
+            }
+            this->_gamma_changed = gamma != this->_first_gamma;
+        }
+        if (this->window != 0U && this->_gamma_changed) {
+            // from the first improvement of gamma on
+            if (this->_gammas.size() != this->window) {
+                this->_gammas.push_back(gamma);  // allocated once
+            } else {
+                const auto oldest = this->_gammas[this->_next];
+                this->_gammas[this->_next] = gamma;
+                this->_next = this->_next + 1U == this->window ? 0U : this->_next + 1U;
+                if (std::abs(gamma - oldest) <= this->rel_improvement * scale) {
+                    return Reason::Stalled;
+                }
+            }
+        }
+        if (this->_log_volume < this->min_log_volume) {  // false for NaN
+            return Reason::Volume;
+        }
+        if (this->max_seconds > 0.0
+            && std::chrono::duration<double>(Clock::now() - this->_start).count()
+                   >= this->max_seconds) {
+            return Reason::OutOfTime;
+        }
+        return Reason::None;
+    }
+};
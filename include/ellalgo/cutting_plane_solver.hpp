@@ -0,0 +1,353 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint64_t
+#include <tuple>    // for tuple
+#include <utility>  // for move
+
+#include "cutting_plane.hpp"
+#include "cutting_plane_observer.hpp"
+#include "ell_checkpoint.hpp"
+#include "ell_config.hpp"
+
+namespace detail {
+    /**
+     * @brief Append the loop state of a solver, then its space, to a checkpoint
+     */
+    template <typename Arr, typename Num, typename Space>
+    inline auto save_solver(CheckpointWriter &out, std::uint64_t kind, size_t niter, bool done,
+                            bool retry, const Num &gamma, const Arr &x_best, const Space &space)
+        -> void {
+        out.write_value(checkpoint_tag::solver);
+        out.write_value(kind);
+        out.write_value(std::uint64_t(niter));
+        out.write_value(std::uint64_t(done) | std::uint64_t(retry) << 1U);
+        out.write_value(gamma);
+        out.write_value(std::uint64_t(x_best.size()));
+        if (x_best.size() != 0U) {
+            out.write(&x_best[0], x_best.size() * sizeof(double));
+        }
+        space.save(out);
+    }
+
+    /**
+     * @brief Go back to the state saved by `save_solver`
+     */
+    template <typename Arr, typename Num, typename Space>
+    inline auto load_solver(CheckpointFile &in, std::uint64_t kind, size_t &niter, bool &done,
+                            bool &retry, Num &gamma, Arr &x_best, Space &space) -> void {
+        in.expect(checkpoint_tag::solver, "record");
+        in.expect(kind, "solver kind");
+        niter = static_cast<size_t>(in.read_value<std::uint64_t>());
+        const auto flags = in.read_value<std::uint64_t>();
+        done = (flags & 1U) != 0U;
+        retry = (flags & 2U) != 0U;
+        gamma = in.read_value<Num>();
+        const auto size = static_cast<size_t>(in.read_value<std::uint64_t>());
+        x_best = size == 0U ? invalid_value<Arr>() : Arr(size);
+        if (size != 0U) {
+            in.read(&x_best[0], size * sizeof(double));
+        }
+        space.load(in);
+    }
+}  // namespace detail
+
+/**
+ * @brief `cutting_plane_optim` as a resumable solve
+ *
+ * The solve runs by slices of iterations: `resume(k)` runs up to k more
+ * iterations and returns, so that a scheduler can interleave many solves
+ * on a few threads, and stop or preempt any of them between two slices.
+ * Between the slices, `x_best()`, `gamma()` and `tsq()` give the progress
+ * so far. Run to the end, the iterates and the result are exactly those of
+ * `cutting_plane_optim` with the same arguments, however it is sliced.
+ *
+ * The oracle and the space are referenced, and must only be used by this
+ * solve; gamma and the observer are kept by the solver.
+ *
+ * `save` writes the loop state and the space to a checkpoint file, from
+ * which `load` resumes the solve, e.g. on another node, bit for bit. The
+ * oracle and the observer are not saved: an oracle with a state of its
+ * own (e.g. a round robin) has to be saved alongside.
+ *
+ * Example:
+ *
+ *     auto solver = make_cutting_plane_solver(omega, ellip, gamma);
+ *     while (!solver.resume(10)) {
+ *         // e.g. resume other solves
+ *     }
+ *     const auto x = solver.x_best();
+ *
+ * @tparam OracleOptim
+ * @tparam SearchSpace
+ * @tparam Num
+ * @tparam Observer e.g. `SolverStats`, see `NullObserver`
+ */
+template <typename OracleOptim, typename SearchSpace, typename Num,
+          typename Observer = NullObserver>
+class CuttingPlaneSolver {
+    using ArrayType = CuttingPlaneArrayType<SearchSpace>;
+    using Tag = detail::step_tag<detail::has_multi_optim<OracleOptim, SearchSpace, Num>::value,
+                                 detail::has_span_optim<OracleOptim, SearchSpace, Num>>;
+
+    OracleOptim &_omega;
+    SearchSpace &_space;
+    Num _gamma;
+    Options _options;
+    Observer _observer;
+    typename detail::cut_buffer<OracleOptim, Tag>::type _cuts{};
+    ArrayType _x_best = invalid_value<ArrayType>();
+    size_t _niter = 0U;
+    bool _done = false;
+
+  public:
+    /**
+     * @brief Construct a new cutting plane solver object
+     *
+     * @param[in,out] omega    perform assessment on x0
+     * @param[in,out] space    search Space containing x*
+     * @param[in]     gamma    best-so-far optimal sol'n
+     * @param[in]     options  maximum iteration and error tolerance etc.
+     * @param[in]     observer notified of every iteration
+     */
+    CuttingPlaneSolver(OracleOptim &omega, SearchSpace &space, Num gamma,
+                       const Options &options = Options(), Observer observer = Observer())
+        : _omega{omega},
+          _space{space},
+          _gamma{std::move(gamma)},
+          _options{options},
+          _observer{std::move(observer)},
+          _done{options.max_iters == 0U} {}
+
+    /**
+     * @brief Run up to num_iters more iterations
+     *
+     * @param[in] num_iters
+     * @return whether the solve is done
+     */
+    auto resume(size_t num_iters) -> bool {
+        for (auto k = 0U; k != num_iters && !this->_done; ++k) {
+            const auto status
+                = detail::optim_step(this->_omega, this->_space, this->_gamma, this->_x_best,
+                                     this->_observer, this->_niter, this->_cuts, Tag{});
+            if (status != CutStatus::Success || this->_space.tsq() < this->_options.tolerance
+                || detail::stop_now(this->_observer, this->_gamma)) {
+                this->_done = true;  // no more
+            } else if (++this->_niter == this->_options.max_iters) {
+                this->_done = true;
+            }
+        }
+        return this->_done;
+    }
+
+    /**
+     * @brief Run the solve to the end
+     *
+     * @return the result of `cutting_plane_optim`
+     */
+    auto run() -> std::tuple<ArrayType, size_t> {
+        this->resume(this->_options.max_iters);  // at most that many are left
+        return this->result();
+    }
+
+    auto done() const -> bool { return this->_done; }
+
+    /**
+     * @brief Number of iterations so far, as counted by `cutting_plane_optim`
+     *
+     * @return size_t
+     */
+    auto num_iters() const -> size_t { return this->_niter; }
+
+    /**
+     * @brief Best-so-far sol'n, empty (or invalid) if none yet
+     *
+     * @return const ArrayType&
+     */
+    auto x_best() const -> const ArrayType & { return this->_x_best; }
+
+    auto gamma() const -> const Num & { return this->_gamma; }
+
+    auto tsq() const -> double { return this->_space.tsq(); }
+
+    auto observer() -> Observer & { return this->_observer; }
+
+    /**
+     * @brief The result so far, in the form of `cutting_plane_optim`
+     *
+     * @return std::tuple<ArrayType, size_t>
+     */
+    auto result() const -> std::tuple<ArrayType, size_t> {
+        return {this->_x_best, this->_niter};
+    }
+
+    /**
+     * @brief Append the state of the solve, including the space, to a checkpoint
+     *
+     * @param[in,out] out
+     */
+    void save(CheckpointWriter &out) const {
+        detail::save_solver(out, 0U, this->_niter, this->_done, false, this->_gamma,
+                            this->_x_best, this->_space);
+    }
+
+    /**
+     * @brief Go back to the state saved by `save`, with a space of the same dimension
+     *
+     * @param[in,out] in
+     * @throws std::runtime_error if the record is not that of such a solve
+     */
+    void load(CheckpointFile &in) {
+        auto retry = false;
+        detail::load_solver(in, 0U, this->_niter, this->_done, retry, this->_gamma,
+                            this->_x_best, this->_space);
+    }
+};
+
+/**
+ * @brief Make a `CuttingPlaneSolver` without an observer
+ */
+template <typename OracleOptim, typename SearchSpace, typename Num>
+inline auto make_cutting_plane_solver(OracleOptim &omega, SearchSpace &space, Num gamma,
+                                      const Options &options = Options())
+    -> CuttingPlaneSolver<OracleOptim, SearchSpace, Num> {
+    return CuttingPlaneSolver<OracleOptim, SearchSpace, Num>(omega, space, std::move(gamma),
+                                                             options);
+}
+
+/**
+ * @brief `cutting_plane_optim_q` as a resumable solve
+ *
+ * As `CuttingPlaneSolver`, with the `retry` flag of the loop, which tells
+ * the oracle to give an alternative cut, part of the state.
+ *
+ * @tparam OracleOptimQ
+ * @tparam SearchSpaceQ
+ * @tparam Num
+ * @tparam Observer e.g. `SolverStats`, see `NullObserver`
+ */
+template <typename OracleOptimQ, typename SearchSpaceQ, typename Num,
+          typename Observer = NullObserver>
+class CuttingPlaneSolverQ {
+    using ArrayType = CuttingPlaneArrayType<SearchSpaceQ>;
+
+    OracleOptimQ &_omega;
+    SearchSpaceQ &_space_q;
+    Num _gamma;
+    Options _options;
+    Observer _observer;
+    ArrayType _x_best = invalid_value<ArrayType>();
+    size_t _niter = 0U;
+    bool _retry = false;
+    bool _done;
+
+  public:
+    /**
+     * @brief Construct a new cutting plane solver object
+     *
+     * @param[in,out] omega    perform assessment on x0
+     * @param[in,out] space_q  search Space containing x*
+     * @param[in]     gamma    best-so-far optimal sol'n
+     * @param[in]     options  maximum iteration and error tolerance etc.
+     * @param[in]     observer notified of every iteration
+     */
+    CuttingPlaneSolverQ(OracleOptimQ &omega, SearchSpaceQ &space_q, Num gamma,
+                        const Options &options = Options(), Observer observer = Observer())
+        : _omega{omega},
+          _space_q{space_q},
+          _gamma{std::move(gamma)},
+          _options{options},
+          _observer{std::move(observer)},
+          _done{options.max_iters == 0U} {}
+
+    /**
+     * @brief Run up to num_iters more iterations
+     *
+     * @param[in] num_iters
+     * @return whether the solve is done
+     */
+    auto resume(size_t num_iters) -> bool {
+        for (auto k = 0U; k != num_iters && !this->_done; ++k) {
+            const auto step = detail::optim_q_step(this->_omega, this->_space_q, this->_gamma,
+                                                   this->_x_best, this->_retry, this->_observer,
+                                                   this->_niter);
+            if (step == detail::QStep::NoAlternative) {
+                this->_niter = this->_options.max_iters;  // as counted by cutting_plane_optim_q
+                this->_done = true;
+            } else if (step == detail::QStep::Stop
+                       || this->_space_q.tsq() < this->_options.tolerance
+                       || detail::stop_now(this->_observer, this->_gamma)) {
+                this->_done = true;  // no more
+            } else if (++this->_niter == this->_options.max_iters) {
+                this->_done = true;
+            }
+        }
+        return this->_done;
+    }
+
+    /**
+     * @brief Run the solve to the end
+     *
+     * @return the result of `cutting_plane_optim_q`
+     */
+    auto run() -> std::tuple<ArrayType, size_t> {
+        this->resume(this->_options.max_iters);  // at most that many are left
+        return this->result();
+    }
+
+    auto done() const -> bool { return this->_done; }
+
+    auto num_iters() const -> size_t { return this->_niter; }
+
+    /**
+     * @brief Whether the oracle is to give an alternative cut next
+     *
+     * @return bool
+     */
+    auto retry() const -> bool { return this->_retry; }
+
+    auto x_best() const -> const ArrayType & { return this->_x_best; }
+
+    auto gamma() const -> const Num & { return this->_gamma; }
+
+    auto tsq() const -> double { return this->_space_q.tsq(); }
+
+    auto observer() -> Observer & { return this->_observer; }
+
+    auto result() const -> std::tuple<ArrayType, size_t> {
+        return {this->_x_best, this->_niter};
+    }
+
+    /**
+     * @brief Append the state of the solve, including the space, to a checkpoint
+     *
+     * @param[in,out] out
+     */
+    void save(CheckpointWriter &out) const {
+        detail::save_solver(out, 1U, this->_niter, this->_done, this->_retry, this->_gamma,
+                            this->_x_best, this->_space_q);
+    }
+
+    /**
+     * @brief Go back to the state saved by `save`, with a space of the same dimension
+     *
+     * @param[in,out] in
+     * @throws std::runtime_error if the record is not that of such a solve
+     */
+    void load(CheckpointFile &in) {
+        detail::load_solver(in, 1U, this->_niter, this->_done, this->_retry, this->_gamma,
+                            this->_x_best, this->_space_q);
+    }
+};
+
+/**
+ * @brief Make a `CuttingPlaneSolverQ` without an observer
+ */
+template <typename OracleOptimQ, typename SearchSpaceQ, typename Num>
+inline auto make_cutting_plane_solver_q(OracleOptimQ &omega, SearchSpaceQ &space_q, Num gamma,
+                                        const Options &options = Options())
+    -> CuttingPlaneSolverQ<OracleOptimQ, SearchSpaceQ, Num> {
+    return CuttingPlaneSolverQ<OracleOptimQ, SearchSpaceQ, Num>(omega, space_q,
+                                                                std::move(gamma), options);
+}
@@ -0,0 +1,347 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <cmath>    // for sqrt, abs
+#include <cstddef>  // for size_t
+#include <vector>
+
+#include "cg_engine.hpp"  // for cg_kernel, cg_detail::apply_block
+#include "ell_span.hpp"
+
+/**
+ * @brief Kernels of the eigen-solvers below
+ */
+namespace eigen_kernel {
+
+    /**
+     * @brief Eigen-decomposition of a small dense symmetric matrix, by cyclic Jacobi rotations
+     *
+     * @param[in,out] a the m by m matrix, row by row, destroyed
+     * @param[in] m
+     * @param[out] vecs the eigenvectors, as the columns of an m by m matrix, row by row
+     * @param[out] vals the eigenvalues, in decreasing order
+     */
+    extern auto sym_eigen(double *a, size_t m, double *vecs, double *vals) -> void;
+
+    /**
+     * @brief The eigenvalue j of a symmetric tridiagonal matrix, in decreasing order, by bisection
+     *
+     * @param[in] diag of size m
+     * @param[in] offdiag of size m - 1
+     * @param[in] m
+     * @param[in] j 0 for the largest
+     * @return double
+     */
+    extern auto tridiag_eigenvalue(const double *diag, const double *offdiag, size_t m, size_t j)
+        -> double;
+
+    /**
+     * @brief The unit eigenvector of a symmetric tridiagonal matrix for its eigenvalue theta
+     *
+     * By two steps of inverse iteration, with the LU factors of T - theta I
+     * with partial pivoting.
+     *
+     * @param[in] diag of size m
+     * @param[in] offdiag of size m - 1
+     * @param[in] m
+     * @param[in] theta
+     * @param[out] s of size m
+     * @param[out] work of size 5 m
+     */
+    extern auto tridiag_eigenvector(const double *diag, const double *offdiag, size_t m,
+                                    double theta, double *s, double *work) -> void;
+
+    /**
+     * @brief Make the k vectors of X orthonormal, by modified Gram-Schmidt (twice)
+     *
+     * A vector that vanishes is replaced by a fixed one, so that X keeps k columns.
+     *
+     * @param[in,out] X of size n * k, element i of vector j at i * k + j
+     * @param[in] n
+     * @param[in] k
+     */
+    extern auto orthonormalize(double *X, size_t n, size_t k) -> void;
+
+    /**
+     * @brief proj = X' * Y, symmetrized, k by k row by row
+     */
+    extern auto project(const double *X, const double *Y, size_t n, size_t k, double *proj)
+        -> void;
+
+    /**
+     * @brief X <- X * S, for S k by k row by row, with row of size k as work space
+     */
+    extern auto rotate(double *X, size_t n, size_t k, const double *S, double *row) -> void;
+
+}  // namespace eigen_kernel
+
+/**
+ * @brief How an eigen-solve ended
+ */
+struct EigenInfo {
+    bool converged;
+    size_t num_iters;  //!< the number of products by A, less one
+    double eigenvalue;
+};
+
+/**
+ * @brief Power iteration for the dominant eigenpair of a symmetric A
+ *
+ * The operator is as for `ConjugateGradient`: `size()` and `apply(x, y)`.
+ * That is `power_iteration2` of experiment/power_iteration.cpp on
+ * contiguous storage: the Rayleigh quotient stops when it changes by at
+ * most tolerance times itself, and an iteration is one product by A and
+ * two passes over the vectors, without any allocation.
+ *
+ * It takes about log(tolerance) / log(|lambda_2 / lambda_1|^2)
+ * iterations; `Lanczos` takes far fewer products on a small gap.
+ */
+class PowerIteration {
+    size_t _n;
+    std::vector<double> _y;  //!< A * x
+
+  public:
+    double tolerance = 1e-9;
+    size_t max_iters = 2000U;
+
+    explicit PowerIteration(size_t n) : _n{n}, _y(n) {}
+
+    /**
+     * @brief Find the eigenvalue of largest magnitude
+     *
+     * @param[in] A
+     * @param[in,out] x of size n: the initial guess, nonzero, then the unit eigenvector
+     * @return EigenInfo
+     */
+    template <typename Operator> auto solve(const Operator &A, Span<double> x) -> EigenInfo {
+        const auto n = this->_n;
+        auto *y = &this->_y[0];
+        auto *xp = x.data();
+        const auto nrm = std::sqrt(cg_kernel::dot(xp, xp, n));
+        for (auto i = 0U; i != n; ++i) {
+            xp[i] /= nrm;
+        }
+        A.apply(xp, y);
+        auto ld = cg_kernel::dot(xp, y, n);
+        for (auto niter = 1U; niter <= this->max_iters; ++niter) {
+            const auto ld1 = ld;
+            const auto ny = std::sqrt(cg_kernel::dot(y, y, n));
+            if (ny == 0.0) {  // A x = 0
+                return {true, niter - 1, 0.0};
+            }
+            for (auto i = 0U; i != n; ++i) {
+                xp[i] = y[i] / ny;
+            }
+            A.apply(xp, y);
+            ld = cg_kernel::dot(xp, y, n);
+            if (std::abs(ld1 - ld) <= this->tolerance * std::abs(ld)) {
+                return {true, niter, ld};
+            }
+        }
+        return {false, this->max_iters, ld};
+    }
+};
+
+/**
+ * @brief Lanczos method for the largest eigenpair of a symmetric A
+ *
+ * Builds a basis of the Krylov space of x by the three-term recurrence,
+ * one product by A and three passes over the vectors per step, and stops
+ * when the largest eigenvalue of the tridiagonal projection T of A changes
+ * by at most tolerance times itself. It takes tens of products where power
+ * iteration takes hundreds or thousands.
+ *
+ * The basis loses its orthogonality as the Ritz values converge, which
+ * leaves the largest as it is but may repeat some of the others in
+ * `ritz_values`; reorthogonalize keeps the basis orthonormal, for O(n m)
+ * more work at step m.
+ *
+ * The basis is kept, n * (max_steps + 1) doubles allocated by the
+ * constructor; a solve does not allocate.
+ */
+class Lanczos {
+    size_t _n;
+    size_t _max_steps;
+    std::vector<double> _basis;  //!< the columns v_0, ..., then w
+    std::vector<double> _alpha;  //!< the diagonal of the tridiagonal T
+    std::vector<double> _beta;   //!< its off-diagonal
+    std::vector<double> _svec;   //!< the eigenvector of T, then work space
+    std::vector<double> _ritz;   //!< the eigenvalues of T
+    size_t _num_steps = 0U;
+
+  public:
+    double tolerance = 1e-9;
+    bool reorthogonalize = false;
+
+    /**
+     * @param[in] n
+     * @param[in] max_steps the largest dimension of the Krylov space
+     */
+    Lanczos(size_t n, size_t max_steps)
+        : _n{n},
+          _max_steps{max_steps},
+          _basis((max_steps + 1) * n),
+          _alpha(max_steps),
+          _beta(max_steps),
+          _svec(6 * max_steps),
+          _ritz(max_steps) {}
+
+    /**
+     * @brief Find the largest eigenvalue
+     *
+     * @param[in] A
+     * @param[in,out] x of size n: the initial vector, nonzero, then the unit Ritz vector
+     * @return EigenInfo with num_iters the dimension of the Krylov space less one
+     */
+    template <typename Operator> auto solve(const Operator &A, Span<double> x) -> EigenInfo {
+        const auto n = this->_n;
+        auto *alpha = &this->_alpha[0];
+        auto *beta = &this->_beta[0];
+        auto *v = &this->_basis[0];
+        const auto nrm = std::sqrt(cg_kernel::dot(x.data(), x.data(), n));
+        for (auto i = 0U; i != n; ++i) {
+            v[i] = x[i] / nrm;
+        }
+        auto theta = 0.0;
+        auto converged = false;
+        auto m = 0U;
+        while (m != this->_max_steps && !converged) {
+            const auto *vj = v + m * n;
+            auto *w = v + (m + 1) * n;
+            A.apply(vj, w);
+            alpha[m] = cg_kernel::dot(vj, w, n);
+            if (this->reorthogonalize) {  // twice, in place of the three-term recurrence
+                for (auto pass = 0; pass != 2; ++pass) {
+                    for (auto i = 0U; i <= m; ++i) {
+                        const auto *vi = v + i * n;
+                        cg_kernel::axpy(-cg_kernel::dot(vi, w, n), vi, w, n);
+                    }
+                }
+            } else {
+                cg_kernel::axpy(-alpha[m], vj, w, n);
+                if (m != 0U) {
+                    cg_kernel::axpy(-beta[m - 1], vj - n, w, n);
+                }
+            }
+            beta[m] = std::sqrt(cg_kernel::dot(w, w, n));
+            ++m;
+            const auto theta1 = theta;
+            theta = eigen_kernel::tridiag_eigenvalue(alpha, beta, m, 0U);
+            converged = (m > 1 && std::abs(theta - theta1) <= this->tolerance * std::abs(theta))
+                        || beta[m - 1] <= 1e-14 * std::abs(theta);  // an invariant space
+            if (!converged && m != this->_max_steps) {
+                for (auto i = 0U; i != n; ++i) {
+                    w[i] /= beta[m - 1];
+                }
+            }
+        }
+        this->_num_steps = m;
+
+        // the Ritz values, and the Ritz vector of the largest
+        for (auto j = 0U; j != m; ++j) {
+            this->_ritz[j] = j == 0U ? theta : eigen_kernel::tridiag_eigenvalue(alpha, beta, m, j);
+        }
+        auto *svec = &this->_svec[0];
+        eigen_kernel::tridiag_eigenvector(alpha, beta, m, theta, svec, svec + m);
+        for (auto i = 0U; i != n; ++i) {
+            x[i] = 0.0;
+        }
+        for (auto j = 0U; j != m; ++j) {
+            cg_kernel::axpy(svec[j], v + j * n, x.data(), n);
+        }
+        const auto nx = std::sqrt(cg_kernel::dot(x.data(), x.data(), n));
+        for (auto i = 0U; i != n; ++i) {
+            x[i] /= nx;
+        }
+        return {converged, m - 1, theta};
+    }
+
+    /**
+     * @brief The eigenvalues of the projection of A of the last solve, in decreasing order
+     *
+     * The first ones approximate the largest eigenvalues of A, the last ones its smallest.
+     *
+     * @return Span<const double>
+     */
+    auto ritz_values() const -> Span<const double> {
+        return Span<const double>(this->_ritz.data(), this->_num_steps);
+    }
+};
+
+/**
+ * @brief Block power (subspace) iteration for the k largest eigenpairs of a symmetric A
+ *
+ * Applies A to k orthonormal vectors at once, through `apply_block` where
+ * the operator provides it (see `BlockConjugateGradient`), and rotates them
+ * by the eigenvectors of their projection of A (Rayleigh-Ritz), until each
+ * of the k Ritz values changes by at most tolerance times itself. For a
+ * positive semidefinite A, e.g. a `Q` of an ellipsoid.
+ *
+ * The blocks are stored as n by k arrays row by row, element i of vector j
+ * at i * k + j. The work space is allocated by the constructor; a solve
+ * does not allocate.
+ */
+class BlockPowerIteration {
+    size_t _n;
+    size_t _k;
+    std::vector<double> _work;  //!< A * X, then x and y for `by_vectors`
+    std::vector<double> _proj;  //!< the projection of A, then its eigenvectors
+    std::vector<double> _vals;  //!< the Ritz values, then the previous ones, then a row
+    std::vector<EigenInfo> _info;
+
+  public:
+    double tolerance = 1e-9;
+    size_t max_iters = 2000U;
+
+    BlockPowerIteration(size_t n, size_t k)
+        : _n{n}, _k{k}, _work(n * k + 2 * n), _proj(2 * k * k), _vals(3 * k), _info(k) {}
+
+    /**
+     * @brief Find the k largest eigenvalues
+     *
+     * @param[in] A
+     * @param[in,out] X of size n * k: the initial vectors, independent, then the eigenvectors
+     * @return const std::vector<EigenInfo>& in decreasing order of the eigenvalues
+     */
+    template <typename Operator>
+    auto solve(const Operator &A, Span<double> X) -> const std::vector<EigenInfo> & {
+        const auto n = this->_n;
+        const auto k = this->_k;
+        auto *xp = X.data();
+        auto *Y = &this->_work[0];
+        auto *x = Y + n * k;
+        auto *y = x + n;
+        auto *proj = &this->_proj[0];
+        auto *vecs = proj + k * k;
+        auto *theta = &this->_vals[0];
+        auto *theta1 = theta + k;
+        auto *row = theta + 2 * k;
+
+        eigen_kernel::orthonormalize(xp, n, k);
+        for (auto niter = 1U; niter <= this->max_iters + 1; ++niter) {
+            cg_detail::apply_block(A, xp, Y, n, k, x, y);
+            eigen_kernel::project(xp, Y, n, k, proj);
+            eigen_kernel::sym_eigen(proj, k, vecs, theta);
+            auto converged = niter != 1U;
+            for (auto j = 0U; j != k; ++j) {
+                const auto ok = niter != 1U
+                                && std::abs(theta[j] - theta1[j])
+                                       <= this->tolerance * std::abs(theta[j]);
+                this->_info[j] = EigenInfo{ok, niter - 1, theta[j]};
+                converged = converged && ok;
+                theta1[j] = theta[j];
+            }
+            // the Ritz vectors, and A times them
+            eigen_kernel::rotate(xp, n, k, vecs, row);
+            eigen_kernel::rotate(Y, n, k, vecs, row);
+            if (converged || niter == this->max_iters + 1) {
+                break;
+            }
+            for (auto i = 0U; i != n * k; ++i) {
+                xp[i] = Y[i];
+            }
+            eigen_kernel::orthonormalize(xp, n, k);
+        }
+        return this->_info;
+    }
+};
@@ -1,12 +1,18 @@
 // -*- coding: utf-8 -*-
 #pragma once
 
+#include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <tuple>
+#include <utility>
 #include <valarray>
+#include <vector>
 
+#include "ell_checkpoint.hpp"
 #include "ell_config.hpp"
 #include "ell_core.hpp"
+#include "ell_span.hpp"
 #include "ell_matrix.hpp"
 
 // forward declaration
@@ -27,16 +33,36 @@ enum class CutStatus;
  * ellipsoid, such as the center point and the squared radius.
  *
  * This version keeps $Q$ symmetric but no promise of positive definite
+ *
+ * With `Scalar` = float, $Q$ is kept in single precision (see
+ * `BasicEllCore`); `Ell<Arr>(E)` then continues in double from where `E`
+ * got to.
+ *
+ * @tparam Arr
+ * @tparam Scalar the type of the elements of $Q$, double or float
  */
-template <typename Arr> class Ell {
+template <typename Arr, typename Scalar = double> class Ell {
+    template <typename, typename> friend class Ell;
+
   public:
     using Vec = std::valarray<double>;
     using ArrayType = Arr;
 
+    /**
+     * @brief The centre and the core of an Ell object
+     */
+    struct Snapshot {
+        Arr xc;
+        typename BasicEllCore<Scalar>::Snapshot core;
+    };
+
   private:
     const size_t _n;
     Arr _xc;
-    EllCore _mgr;
+    BasicEllCore<Scalar> _mgr;
+    Vec _g;  //!< workspace for the gradient
+    std::vector<const double *> _grads;  //!< workspace of `update_deepest_cut`
+    std::vector<double> _tsqs;
 
     /**
      * @brief Construct a new Ell object
@@ -49,6 +75,15 @@ template <typename Arr> class Ell {
      */
     auto operator=(const Ell &E) -> Ell & = delete;
 
+    /**
+     * @brief Construct a new Ell object from a centre and a core, see `copy`
+     *
+     * @param[in] x
+     * @param[in] mgr
+     */
+    Ell(Arr x, BasicEllCore<Scalar> &&mgr)
+        : _n{x.size()}, _xc{std::move(x)}, _mgr{std::move(mgr)}, _g(_n) {}
+
   public:
     /**
      * @brief Construct a new Ell object
@@ -60,7 +95,8 @@ template <typename Arr> class Ell {
      * @param[in] x x is an object of type Arr, which is likely an array or vector. It is being
      * passed by value to the constructor of the Ell class.
      */
-    Ell(const Vec &val, Arr x) : _n{x.size()}, _xc{std::move(x)}, _mgr(val, _n) {}
+    Ell(const Vec &val, Arr x)
+        : _n{x.size()}, _xc{std::move(x)}, _mgr(val, _n), _g(_n) {}
 
     /**
      * @brief Construct a new Ell object
@@ -73,7 +109,8 @@ template <typename Arr> class Ell {
      * kind. It is being passed by value, meaning a copy of the `x` object will be made and stored
      * in the `_xc` member variable of the `Ell` object being constructed.
      */
-    Ell(const double &alpha, Arr x) : _n{x.size()}, _xc{std::move(x)}, _mgr(alpha, _n) {}
+    Ell(const double &alpha, Arr x)
+        : _n{x.size()}, _xc{std::move(x)}, _mgr(alpha, _n), _g(_n) {}
 
     /**
      * @brief Construct a new Ell object
@@ -100,6 +137,15 @@ template <typename Arr> class Ell {
      */
     explicit Ell(const Ell &E) = default;
 
+    /**
+     * @brief Construct a new Ell object from one of another precision
+     *
+     * @tparam S2
+     * @param[in] E
+     */
+    template <typename S2>
+    explicit Ell(const Ell<Arr, S2> &E) : _n{E._n}, _xc{E._xc}, _mgr(E._mgr), _g(_n) {}
+
     /**
      * @brief explicitly copy
      *
@@ -108,11 +154,88 @@ template <typename Arr> class Ell {
     auto copy() const -> Ell { return Ell(*this); }
 
     /**
-     * @brief copy the whole array anyway
+     * @brief explicitly copy, with the matrix from the given resource (e.g. a `PoolResource`)
+     *
+     * @param[in] res
+     * @return Ell
+     */
+    auto copy(MemoryResource &res) const -> Ell { return Ell(this->_xc, this->_mgr.copy(res)); }
+
+    /**
+     * @brief Copy into an object of the same dimension, without allocation
+     *
+     * E.g. to start the searches of a fan-out from the same space again and
+     * again, into the same few objects.
+     *
+     * @param[out] dst
+     */
+    void copy_into(Ell &dst) const {
+        dst._xc = this->_xc;
+        this->_mgr.copy_into(dst._mgr);
+    }
+
+    /**
+     * @brief Allocate a snapshot of the current state
+     *
+     * @return Snapshot
+     */
+    auto snapshot() const -> Snapshot { return Snapshot{this->_xc, this->_mgr.snapshot()}; }
+
+    /**
+     * @brief Save the current state into a snapshot, without allocation
+     *
+     * @param[out] snap - obtained from `snapshot` of an object of the same dimension
+     */
+    void checkpoint(Snapshot &snap) const {
+        snap.xc = this->_xc;
+        this->_mgr.checkpoint(snap.core);
+    }
+
+    /**
+     * @brief Go back to the state saved in a snapshot, without allocation
+     *
+     * @param[in] snap - obtained from `snapshot` of an object of the same dimension
+     */
+    void restore(const Snapshot &snap) {
+        this->_xc = snap.xc;
+        this->_mgr.restore(snap.core);
+    }
+
+    /**
+     * @brief Append the state to a checkpoint file, see `CheckpointWriter`
      *
-     * @return Arr
+     * @param[in,out] out
      */
-    auto xc() const -> Arr { return this->_xc; }
+    void save(CheckpointWriter &out) const {
+        out.write_value(checkpoint_tag::ell);
+        out.write_value(std::uint64_t(this->_n));
+        out.write(&this->_xc[0], this->_n * sizeof(double));
+        this->_mgr.save(out);
+    }
+
+    /**
+     * @brief Go back to the state saved by `save`, in an object of the same dimension
+     *
+     * Continues bit for bit as the object that was saved.
+     *
+     * @param[in,out] in
+     * @throws std::runtime_error if the record is not that of such an Ell
+     */
+    void load(CheckpointFile &in) {
+        in.expect(checkpoint_tag::ell, "record");
+        in.expect(this->_n, "dimension");
+        in.read(&this->_xc[0], this->_n * sizeof(double));
+        this->_mgr.load(in);
+    }
+
+    /**
+     * @brief The centre, without a copy
+     *
+     * Valid until the next update; copy it to keep it.
+     *
+     * @return const Arr&
+     */
+    auto xc() const -> const Arr & { return this->_xc; }
 
     /**
      * @brief Set the xc object
@@ -128,6 +251,47 @@ template <typename Arr> class Ell {
      */
     auto tsq() const -> double { return this->_mgr.tsq(); }
 
+    /**
+     * @brief The log of the volume of the ellipsoid, see `EllCore::log_volume`
+     *
+     * @return double
+     */
+    auto log_volume() const -> double { return this->_mgr.log_volume(); }
+
+    /**
+     * @brief The squared width kappa * g' * mq * g of the ellipsoid along g
+     *
+     * E.g. for the normalized depth beta / sqrt(g' * mq * g) of a cut.
+     *
+     * @param[in] g of size n
+     * @return double
+     */
+    auto quad(Span<const double> g) -> double { return this->_mgr.quad(g.data()); }
+
+    /**
+     * @brief Restart from a diagonal ellipsoid about the same centre
+     *
+     * The half-width along axis i becomes inflate * sqrt(kappa * mq(i, i)),
+     * forgetting the orientation that the cuts built up but not their scale.
+     * Since |x_i - xc_i| <= sqrt(kappa * mq(i, i)) in the ellipsoid, inflate
+     * = sqrt(n) keeps all of it; a smaller one trades that for volume.
+     * Not for the stable updates, see `EllCore::axis_widths_sq`.
+     *
+     * @param[in] inflate
+     */
+    void recondition(double inflate) {
+        this->_mgr.axis_widths_sq(&this->_g[0]);
+        this->_g *= inflate * inflate;
+        this->_mgr.reset_diagonal(this->_g);
+    }
+
+    /**
+     * @brief Apply the pending update of the ellipsoid now, see `EllCore::flush`
+     *
+     * Only touches the core, so that it may run while an oracle reads `xc()`.
+     */
+    void flush() { this->_mgr.flush(); }
+
     /**
      * The function sets the value of the use_parallel_cut property in the _mgr object.
      *
@@ -136,6 +300,20 @@ template <typename Arr> class Ell {
      */
     void set_use_parallel_cut(bool value) { this->_mgr.set_use_parallel_cut(value); }
 
+    /**
+     * @brief Choose between a parallel cut and a single one, see `EllCalc::adaptive_parallel_cut`
+     *
+     * @param[in] value
+     */
+    void set_adaptive_parallel_cut(bool value) { this->_mgr.set_adaptive_parallel_cut(value); }
+
+    /**
+     * @brief The calculator of the cuts, e.g. for its counters
+     *
+     * @return const EllCalc&
+     */
+    auto calc() const -> const EllCalc & { return this->_mgr.calc(); }
+
     /**
      * @brief Update ellipsoid core function using the deep cut(s)
      *
@@ -147,9 +325,7 @@ template <typename Arr> class Ell {
      * @return std::tuple<int, double>
      */
     template <typename T> auto update_bias_cut(const std::pair<Arr, T> &cut) -> CutStatus {
-        return this->_update_core(cut, [this](Vec &grad, const T &beta) {
-            return this->_mgr.update_bias_cut(grad, beta);
-        });
+        return this->update_bias_cut(make_span(cut.first), cut.second);
     }
 
     /**
@@ -163,9 +339,7 @@ template <typename Arr> class Ell {
      * @return std::tuple<int, double>
      */
     template <typename T> auto update_central_cut(const std::pair<Arr, T> &cut) -> CutStatus {
-        return this->_update_core(cut, [this](Vec &grad, const T &beta) {
-            return this->_mgr.update_central_cut(grad, beta);
-        });
+        return this->update_central_cut(make_span(cut.first), cut.second);
     }
 
     /**
@@ -179,11 +353,107 @@ template <typename Arr> class Ell {
      * @return std::tuple<int, double>
      */
     template <typename T> auto update_q(const std::pair<Arr, T> &cut) -> CutStatus {
-        return this->_update_core(
-            cut, [this](Vec &grad, const T &beta) { return this->_mgr.update_q(grad, beta); });
+        return this->update_q(make_span(cut.first), cut.second);
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the deepest of several cuts
+     *
+     * The depth of a cut (g, beta) is beta / sqrt(kappa * g' * mq * g), with
+     * the first beta of a parallel cut: the deepest cut removes the largest
+     * part of the ellipsoid. The g' * mq * g of all the cuts are formed in
+     * one pass over mq, so that a block of cuts costs about two passes
+     * instead of one per cut.
+     *
+     * @tparam T
+     * @param[in] cuts cutting-planes, at least one
+     * @return the status of the update, and the index of the cut that was applied
+     */
+    template <typename T> auto update_deepest_cut(const std::vector<std::pair<Arr, T>> &cuts)
+        -> std::pair<CutStatus, size_t> {
+        assert(!cuts.empty());
+        const auto num = cuts.size();
+        auto best = size_t(0U);
+        if (num > 1U) {
+            this->_grads.resize(num);  // allocates only for a larger block
+            this->_tsqs.resize(num);
+            for (auto k = 0U; k != num; ++k) {
+                this->_grads[k] = make_span(cuts[k].first).data();
+            }
+            this->_mgr.quad_multi(this->_grads.data(), this->_tsqs.data(), num);
+            auto depth = _first(cuts[0].second) / std::sqrt(this->_tsqs[0]);
+            for (auto k = 1U; k != num; ++k) {
+                const auto depth_k = _first(cuts[k].second) / std::sqrt(this->_tsqs[k]);
+                if (depth_k > depth) {
+                    best = k;
+                    depth = depth_k;
+                }
+            }
+        }
+        return {this->update_bias_cut(cuts[best]), best};
+    }
+
+    /**
+     * @brief Buffer for the gradient of the next cut
+     *
+     * An oracle may write the gradient directly into this buffer and pass it
+     * to the `Span` overloads of the update functions, which then copy
+     * nothing. The buffer is overwritten by every update.
+     *
+     * @return Span<double> of size n
+     */
+    auto grad_buffer() -> Span<double> { return make_span(this->_g); }
+
+    /**
+     * @brief Update ellipsoid core function using the deep cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_bias_cut(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](Vec &g, const T &beta_l) {
+            return this->_mgr.update_bias_cut(g, beta_l);
+        });
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the central cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_central_cut(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](Vec &g, const T &beta_l) {
+            return this->_mgr.update_central_cut(g, beta_l);
+        });
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_q(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](Vec &g, const T &beta_l) {
+            return this->_mgr.update_q(g, beta_l);
+        });
     }
 
   private:
+    static auto _first(const double &beta) -> double { return beta; }
+
+    template <typename T> static auto _first(const T &beta) -> double { return beta[0]; }
+
     /**
      * @brief Update ellipsoid core function using the cut(s)
      *
@@ -191,16 +461,17 @@ template <typename Arr> class Ell {
      * update the ellipsoid core function using a cutting plane.
      *
      * @tparam T
-     * @param[in] cut cutting-plane
-     * @return std::tuple<int, double>
+     * @param[in] grad gradient
+     * @param[in] beta
+     * @return CutStatus
      */
     template <typename T, typename Fn>
-    auto _update_core(const std::pair<Arr, T> &cut, Fn &&cut_strategy) -> CutStatus {
-        const auto &grad = cut.first;
-        const auto &beta = cut.second;
-        std::valarray<double> g(this->_n);
-        for (auto i = 0U; i != this->_n; ++i) {
-            g[i] = grad[i];
+    auto _update_core(Span<const double> grad, const T &beta, Fn &&cut_strategy) -> CutStatus {
+        auto &g = this->_g;  // no allocation
+        if (grad.data() != &g[0]) {  // not written in place
+            for (auto i = 0U; i != this->_n; ++i) {
+                g[i] = grad[i];
+            }
         }
 
         auto result = cut_strategy(g, beta);
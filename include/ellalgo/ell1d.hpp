@@ -65,6 +65,16 @@ class ell1d {
      */
     auto update(const std::pair<double, double> &cut) noexcept -> CutStatus;
 
+    /**
+     * @brief The same as `update`, by the name that the cutting-plane drivers use
+     *
+     * @param[in] cut
+     * @return CutStatus
+     */
+    auto update_bias_cut(const std::pair<double, double> &cut) noexcept -> CutStatus {
+        return this->update(cut);
+    }
+
     /**
      * @brief
      *
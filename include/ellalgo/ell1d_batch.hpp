@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <valarray>  // for valarray
+#include <vector>    // for vector
+
+#include "ell_config.hpp"
+#include "ell_kernel.hpp"
+
+/**
+ * @brief Many independent `ell1d` intervals, updated in lockstep
+ *
+ * `Ell1dBatch` holds K instances of `ell1d` as arrays of their centers and
+ * half-widths, the instance k at `[k]`, i.e. in the layout of `EllBatch`
+ * with n = 1. An update runs over all instances at once without branches
+ * (see `ell_kernel::batch_interval_cut`): every lane computes the new
+ * interval and its status, and keeps the old one unless the cut succeeded.
+ * The number of lanes is rounded up to a multiple of `lane_block`; the
+ * padding lanes are never active.
+ *
+ * An instance can be masked off (see `deactivate`), e.g. when it has
+ * converged. The cut of a masked-off instance is ignored, and its interval
+ * stays as it is.
+ *
+ * Every instance goes through exactly the same floating point operations as
+ * the corresponding `ell1d`, so the results agree bit for bit. It may be
+ * driven by `cutting_plane_optim_batch` (see ell_batch.hpp).
+ */
+class Ell1dBatch {
+  public:
+    using Vec = std::valarray<double>;
+    using Mask = std::valarray<bool>;
+
+    static constexpr size_t lane_block = ell_kernel::batch_block;  //!< lanes handled together
+
+  private:
+    const size_t _num;
+    const size_t _stride;
+    Vec _xc;
+    Vec _r;
+    Vec _tsq;
+    Mask _active;
+    std::vector<CutStatus> _status;
+    Vec _g;      //!< gradients of the next cuts, see `grad_buffer`
+    Mask _none;  //!< no central cuts, see `ell_kernel::batch_interval_cut`
+    Vec _code;   //!< the statuses as numbers
+
+  public:
+    /**
+     * @brief Construct the K instances ell1d(l[k], u[k])
+     *
+     * @param[in] l - lower bounds, of size K
+     * @param[in] u - upper bounds, of size K
+     */
+    Ell1dBatch(const Vec &l, const Vec &u);
+
+    /**
+     * @brief Construct K instances of ell1d(l, u)
+     *
+     * @param[in] l
+     * @param[in] u
+     * @param[in] num - number of instances K
+     */
+    Ell1dBatch(double l, double u, size_t num);
+
+    /**
+     * @brief Dimension of every instance, 1
+     *
+     * @return size_t
+     */
+    auto ndim() const -> size_t { return 1U; }
+
+    /**
+     * @brief Number of instances K
+     *
+     * @return size_t
+     */
+    auto size() const -> size_t { return this->_num; }
+
+    /**
+     * @brief Number of lanes (K rounded up)
+     *
+     * @return size_t
+     */
+    auto stride() const -> size_t { return this->_stride; }
+
+    /**
+     * @brief Centers of all instances
+     *
+     * @return const Vec&
+     */
+    auto xc() const -> const Vec & { return this->_xc; }
+
+    /**
+     * @brief Set the center of the instance k
+     *
+     * @param[in] k
+     * @param[in] xc
+     */
+    auto set_xc(size_t k, double xc) -> void { this->_xc[k] = xc; }
+
+    /**
+     * @brief Half-widths of the intervals
+     *
+     * @return const Vec&
+     */
+    auto radius() const -> const Vec & { return this->_r; }
+
+    /**
+     * @brief Squared radii of the last cuts, one per lane
+     *
+     * @return const Vec&
+     */
+    auto tsq() const -> const Vec & { return this->_tsq; }
+
+    /**
+     * @brief Status of the last update, one per lane
+     *
+     * @return const std::vector<CutStatus>&
+     */
+    auto status() const -> const std::vector<CutStatus> & { return this->_status; }
+
+    /**
+     * @brief Which lanes take part in the updates
+     *
+     * @return const Mask&
+     */
+    auto active() const -> const Mask & { return this->_active; }
+
+    /**
+     * @brief Mask off the instance k
+     *
+     * @param[in] k
+     */
+    auto deactivate(size_t k) -> void { this->_active[k] = false; }
+
+    /**
+     * @brief Number of instances that are not masked off
+     *
+     * @return size_t
+     */
+    auto num_active() const -> size_t;
+
+    /**
+     * @brief Buffer for the gradients of the next cuts, one per lane
+     *
+     * @return Vec&
+     */
+    auto grad_buffer() -> Vec & { return this->_g; }
+
+    /**
+     * @brief Update every active instance by its deep cut (see `ell1d::update`)
+     *
+     * @param[in] grad - one per lane
+     * @param[in] beta - one per lane
+     */
+    auto update_bias_cut(const Vec &grad, const Vec &beta) -> void;
+
+    /**
+     * @brief Update every active instance by its central cut, i.e. bisect it
+     *
+     * @param[in] grad - one per lane
+     * @param[in] beta - one per lane (not used)
+     */
+    auto update_central_cut(const Vec &grad, const Vec &beta) -> void;
+
+    /**
+     * @brief Central cuts for the lanes in `central`, deep cuts for the others
+     *
+     * @param[in] grad - one per lane
+     * @param[in] beta - one per lane
+     * @param[in] central - one per lane
+     */
+    auto update_optim_cut(const Vec &grad, const Vec &beta, const Mask &central) -> void;
+
+  private:
+    /**
+     * @brief Update the active lanes by `ell_kernel::batch_interval_cut`
+     */
+    auto _update(const Vec &grad, const Vec &beta, const Mask &central) -> void;
+};
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <cmath>    // for nan
+#include <tuple>    // for tuple
+#include <valarray>
+#include <vector>
+
+#include "ell_calc.hpp"
+#include "ell_config.hpp"
+#include "ell_kernel.hpp"
+
+/**
+ * @brief Many independent ellipsoids of the same dimension, updated in lockstep
+ *
+ * `EllBatch` holds K instances of `Ell<Vec>` in structure-of-arrays form:
+ * the element i of instance k is stored at `[i * stride() + k]`, for the
+ * centers, the gradients, and each element of the packed lower triangles of
+ * the matrices Q. An update then runs the O(n^2) loops over all instances at
+ * once, with consecutive instances in consecutive SIMD lanes. The number of
+ * lanes is rounded up to a multiple of `lane_block`; the padding lanes are
+ * never active.
+ *
+ * An instance can be masked off (see `deactivate`), e.g. when it has
+ * converged. The cut of a masked-off instance is ignored, and its ellipsoid
+ * stays as it is.
+ *
+ * Every instance goes through exactly the same floating point operations as
+ * the corresponding `Ell<Vec>`, so the results agree bit for bit.
+ */
+class EllBatch {
+  public:
+    using Vec = std::valarray<double>;
+    using Mask = std::valarray<bool>;
+
+    static constexpr size_t lane_block = ell_kernel::batch_block;  //!< lanes handled together
+
+  private:
+    const size_t _n;
+    const size_t _num;
+    const size_t _stride;
+    Vec _xc;
+    Vec _mq;  //!< packed lower triangles, column by column
+    Vec _kappa;
+    Vec _tsq;
+    Mask _active;
+    std::vector<CutStatus> _status;
+    EllCalc _helper;
+
+    // Workspace, so that an update does not allocate
+    Vec _g;
+    Vec _qg;
+    Vec _omega;
+    Vec _r;
+    Vec _s;
+    Vec _rho;    //!< rho, sigma and delta of the lanes (and, from stride(), of their central cuts)
+    Vec _sigma;
+    Vec _delta;
+    std::vector<CutStatus> _cut_status;
+
+  public:
+    /**
+     * @brief Construct K instances of ell = {x | (x - x0)' Q^-1 (x - x0) <= 1}, Q = diag(val)
+     *
+     * @param[in] val - diagonal of Q, of size n
+     * @param[in] x0 - initial center of every instance, of size n
+     * @param[in] num - number of instances K
+     */
+    EllBatch(const Vec &val, const Vec &x0, size_t num);
+
+    /**
+     * @brief Construct K instances of ell = {x | (x - x0)' (x - x0) <= alpha}
+     *
+     * @param[in] alpha
+     * @param[in] x0 - initial center of every instance, of size n
+     * @param[in] num - number of instances K
+     */
+    EllBatch(double alpha, const Vec &x0, size_t num);
+
+    /**
+     * @brief Dimension n of every instance
+     *
+     * @return size_t
+     */
+    auto ndim() const -> size_t { return this->_n; }
+
+    /**
+     * @brief Number of instances K
+     *
+     * @return size_t
+     */
+    auto size() const -> size_t { return this->_num; }
+
+    /**
+     * @brief Distance between the same element of two rows (K rounded up)
+     *
+     * @return size_t
+     */
+    auto stride() const -> size_t { return this->_stride; }
+
+    /**
+     * @brief Centers of all instances, element i of instance k at `[i * stride() + k]`
+     *
+     * @return const Vec&
+     */
+    auto xc() const -> const Vec & { return this->_xc; }
+
+    /**
+     * @brief Center of the instance k
+     *
+     * @param[in] k
+     * @return Vec
+     */
+    auto xc(size_t k) const -> Vec;
+
+    /**
+     * @brief Set the center of the instance k
+     *
+     * @param[in] k
+     * @param[in] x of size n
+     */
+    auto set_xc(size_t k, const Vec &x) -> void;
+
+    /**
+     * @brief Squared radii of the last cuts, one per lane
+     *
+     * @return const Vec&
+     */
+    auto tsq() const -> const Vec & { return this->_tsq; }
+
+    /**
+     * @brief Status of the last update, one per lane
+     *
+     * @return const std::vector<CutStatus>&
+     */
+    auto status() const -> const std::vector<CutStatus> & { return this->_status; }
+
+    /**
+     * @brief Which lanes take part in the updates
+     *
+     * @return const Mask&
+     */
+    auto active() const -> const Mask & { return this->_active; }
+
+    /**
+     * @brief Mask off the instance k
+     *
+     * @param[in] k
+     */
+    auto deactivate(size_t k) -> void { this->_active[k] = false; }
+
+    /**
+     * @brief Number of instances that are not masked off
+     *
+     * @return size_t
+     */
+    auto num_active() const -> size_t;
+
+    void set_use_parallel_cut(bool value) { this->_helper.use_parallel_cut = value; }
+
+    /**
+     * @brief Buffer for the gradients of the next cuts (n * stride())
+     *
+     * An oracle may write the gradients directly into this buffer, which is
+     * overwritten by every update.
+     *
+     * @return Vec&
+     */
+    auto grad_buffer() -> Vec & { return this->_g; }
+
+    /**
+     * @brief Update every active instance by its deep cut
+     *
+     * @param[in] grad - gradients, element i of instance k at `[i * stride() + k]`
+     * @param[in] beta - one per lane
+     */
+    auto update_bias_cut(const Vec &grad, const Vec &beta) -> void;
+
+    /**
+     * @brief Update every active instance by its central cut
+     *
+     * @param[in] grad - gradients, element i of instance k at `[i * stride() + k]`
+     * @param[in] beta - one per lane (not used)
+     */
+    auto update_central_cut(const Vec &grad, const Vec &beta) -> void;
+
+    /**
+     * @brief Update every active instance by its non-central cut (see `Ell::update_q`)
+     *
+     * @param[in] grad - gradients, element i of instance k at `[i * stride() + k]`
+     * @param[in] beta - one per lane
+     */
+    auto update_q(const Vec &grad, const Vec &beta) -> void;
+
+    /**
+     * @brief Central cuts for the lanes in `central`, deep cuts for the others
+     *
+     * This is the update of the cutting-plane method for optimization, where
+     * a central cut is made whenever the best-so-far value has been shrunk.
+     *
+     * @param[in] grad - gradients, element i of instance k at `[i * stride() + k]`
+     * @param[in] beta - one per lane
+     * @param[in] central - one per lane
+     */
+    auto update_optim_cut(const Vec &grad, const Vec &beta, const Mask &central) -> void;
+
+  private:
+    /**
+     * @brief Offset of the element (i, j), i >= j, in the packed lower triangle
+     */
+    auto _pos(size_t i, size_t j) const -> size_t {
+        return j * (2 * this->_n + 1 - j) / 2 + (i - j);
+    }
+
+    /**
+     * @brief Copy the gradients, with zeros in the lanes that are masked off
+     */
+    auto _load(const Vec &grad) -> void;
+
+    /**
+     * @brief qg = Q * g and omega = g' * Q * g, for all lanes (see `ell_kernel::batch_matvec`)
+     */
+    auto _matvec() -> void;
+
+    /**
+     * @brief Q -= r * qg * qg' and xc -= s * qg, for all lanes
+     *
+     * The lanes with r = s = 0 (masked off, or unsuccessful) are unchanged.
+     */
+    auto _rank_one() -> void;
+
+    /**
+     * @brief Where the cuts at `offset` (0, or stride() for a second set) are stored
+     */
+    auto _cuts(size_t offset) -> CutBatch {
+        return {&this->_cut_status[offset], &this->_rho[offset], &this->_sigma[offset],
+                &this->_delta[offset]};
+    }
+
+    /**
+     * @brief Update the active lanes by the cuts computed by cut_batch (see `EllCalc`)
+     *
+     * cut_batch(tsq) fills `_cuts(0)` for all the lanes at once; those that
+     * are masked off are ignored.
+     */
+    template <typename Fn> auto _update_core(const Vec &grad, Fn &&cut_batch) -> void {
+        this->_load(grad);
+        this->_matvec();
+        for (auto k = 0U; k != this->_num; ++k) {
+            if (this->_active[k]) {
+                this->_tsq[k] = this->_kappa[k] * this->_omega[k];
+            }
+        }
+        cut_batch(&this->_tsq[0]);
+        for (auto k = 0U; k != this->_num; ++k) {
+            this->_r[k] = 0.0;  // no update unless successful
+            this->_s[k] = 0.0;
+            if (!this->_active[k]) {
+                continue;
+            }
+            this->_status[k] = this->_cut_status[k];
+            if (this->_status[k] != CutStatus::Success) {
+                continue;
+            }
+            const auto omega = this->_omega[k];
+            this->_r[k] = this->_sigma[k] / omega;
+            this->_s[k] = this->_rho[k] / omega;
+            this->_kappa[k] *= this->_delta[k];
+        }
+        this->_rank_one();
+    }
+};
+
+/**
+ * @brief Cutting-plane method for K independent convex problems, in lockstep
+ *
+ * The batched version of `cutting_plane_optim`. The oracle provides
+ *
+ *     void assess_optim_batch(const Vec &xc, Vec &gamma, const Mask &active,
+ *                             Vec &grad, Vec &beta, Mask &shrunk);
+ *
+ * which assesses the centers `xc` of all active lanes (in the layout of
+ * `EllBatch`), and writes their cuts into `grad` and `beta`, and into
+ * `shrunk` whether the best-so-far value `gamma` of the lane was shrunk. An
+ * instance is masked off as soon as it has converged, or the update failed.
+ *
+ * @tparam OracleBatch
+ * @tparam SpaceBatch `EllBatch`, or `Ell1dBatch` (with n = 1)
+ * @param[in,out] omega   perform assessment on the centers
+ * @param[in,out] space   search spaces
+ * @param[in,out] gamma   best-so-far optimal values, one per lane
+ * @param[in]     options maximum iteration and error tolerance etc.
+ * @return best-so-far sol'ns (NaN if none), in the layout of `EllBatch`, and
+ *         the number of iterations of each instance
+ */
+template <typename OracleBatch, typename SpaceBatch>
+inline auto cutting_plane_optim_batch(OracleBatch &omega, SpaceBatch &space,
+                                      std::valarray<double> &gamma,
+                                      const Options &options = Options())
+    -> std::tuple<std::valarray<double>, std::vector<size_t>> {
+    const auto ndim = space.ndim();
+    const auto stride = space.stride();
+    auto x_best = std::valarray<double>(std::nan("1"), ndim * stride);
+    auto num_iters = std::vector<size_t>(space.size(), options.max_iters);
+    auto &grad = space.grad_buffer();
+    auto beta = std::valarray<double>(0.0, stride);
+    auto shrunk = typename SpaceBatch::Mask(false, stride);
+    for (auto niter = 0U; niter < options.max_iters && space.num_active() != 0U; ++niter) {
+        omega.assess_optim_batch(space.xc(), gamma, space.active(), grad, beta, shrunk);
+        for (auto k = 0U; k != space.size(); ++k) {
+            if (space.active()[k] && shrunk[k]) {  // best gamma obtained
+                for (auto i = 0U; i != ndim; ++i) {
+                    x_best[i * stride + k] = space.xc()[i * stride + k];
+                }
+            }
+        }
+        space.update_optim_cut(grad, beta, shrunk);
+        for (auto k = 0U; k != space.size(); ++k) {
+            if (space.active()[k]
+                && (space.status()[k] != CutStatus::Success
+                    || space.tsq()[k] < options.tolerance)) {  // no more
+                space.deactivate(k);
+                num_iters[k] = niter;
+            }
+        }
+    }
+    return {std::move(x_best), std::move(num_iters)};
+}
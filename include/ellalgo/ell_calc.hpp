@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <tuple>
 
 #include "ell_calc_core.hpp"
@@ -8,6 +9,19 @@
 // Forward declaration
 enum class CutStatus;
 
+/**
+ * @brief The results of a batch of cuts, in structure-of-arrays form
+ *
+ * Lane k of the `_batch` methods of `EllCalc` gets in `status[k]`, `rho[k]`,
+ * `sigma[k]` and `delta[k]` exactly what the method for one cut returns.
+ */
+struct CutBatch {
+    CutStatus *status;
+    double *rho;
+    double *sigma;
+    double *delta;
+};
+
 /**
  * @brief Ellipsoid Search Space
  *
@@ -19,9 +33,22 @@ class EllCalc {
   public:
     bool use_parallel_cut = true;
 
+    /**
+     * @brief Take a parallel cut only if it shrinks the volume at least as much
+     *
+     * The volume is multiplied by sqrt(delta^n * (1 - sigma)) by a cut, so
+     * the parallel cut is compared with the single deep cut of its first
+     * constraint from the sigma and delta of both, at the cost of two logs.
+     * In exact arithmetic the parallel cut never loses; the counters show
+     * how often it is chosen, and the comparison guards against rounding
+     * where its second constraint is nearly inactive.
+     */
+    bool adaptive_parallel_cut = false;
+
   protected:
-    const double _n_f;
     const EllCalcCore _helper;
+    mutable size_t _num_parallel{};  //!< chosen by `adaptive_parallel_cut`
+    mutable size_t _num_single{};
 
   public:
     /**
@@ -33,7 +60,7 @@ class EllCalc {
      * @param[in] mq
      * @param[in] x
      */
-    explicit EllCalc(size_t ndim) : _n_f{double(ndim)}, _helper{ndim} {
+    explicit EllCalc(size_t ndim) : _helper{ndim} {
         assert(ndim >= 2U);  // do not accept one-dimensional
     }
 
@@ -59,6 +86,25 @@ class EllCalc {
      */
     EllCalc(const EllCalc &E) = default;
 
+    /**
+     * @brief How many times `adaptive_parallel_cut` chose the parallel cut
+     *
+     * @return size_t
+     */
+    auto num_parallel_chosen() const -> size_t { return this->_num_parallel; }
+
+    /**
+     * @brief How many times `adaptive_parallel_cut` chose the single cut instead
+     *
+     * @return size_t
+     */
+    auto num_single_chosen() const -> size_t { return this->_num_single; }
+
+    void reset_counts() {
+        this->_num_parallel = 0U;
+        this->_num_single = 0U;
+    }
+
     /**
      * @brief Calculate a new ellipsoid under a parallel cut
      *
@@ -135,4 +181,42 @@ class EllCalc {
      */
     auto calc_bias_cut_q(const double &beta, const double &tsq) const
         -> std::tuple<CutStatus, std::tuple<double, double, double>>;
+
+    /*
+     * The same for num cuts at a time, lane k taking beta[k] (beta0[k] and
+     * beta1[k]) and tsq[k]. Each lane is computed once, both sides of every
+     * test, into blocks of structure-of-arrays temporaries, with AVX2 when
+     * `ell_kernel::active_isa()` has it (the compiler does not vectorize the
+     * tests of the loops by itself). Every lane gets the same result as the
+     * method for one cut, bit for bit, the adaptive choice and its counters
+     * included.
+     */
+
+    auto calc_parallel_bias_cut_batch(const double *beta0, const double *beta1, const double *tsq,
+                                      size_t num, CutBatch out) const -> void;
+
+    auto calc_parallel_central_cut_batch(const double *beta1, const double *tsq, size_t num,
+                                         CutBatch out) const -> void;
+
+    auto calc_bias_cut_batch(const double *beta, const double *tsq, size_t num,
+                             CutBatch out) const -> void;
+
+    auto calc_central_cut_batch(const double *tsq, size_t num, CutBatch out) const -> void;
+
+    auto calc_parallel_bias_cut_q_batch(const double *beta0, const double *beta1,
+                                        const double *tsq, size_t num, CutBatch out) const
+        -> void;
+
+    auto calc_bias_cut_q_batch(const double *beta, const double *tsq, size_t num,
+                               CutBatch out) const -> void;
+
+  private:
+    /**
+     * @brief Whether the parallel cut shrinks the volume at least as much, and count the choice
+     *
+     * @param[in] parallel rho, sigma and delta of the parallel cut
+     * @param[in] single those of the single cut
+     */
+    auto _prefer_parallel(const std::tuple<double, double, double> &parallel,
+                          const std::tuple<double, double, double> &single) const -> bool;
 };  // } EllCalc
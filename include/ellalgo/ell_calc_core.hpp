@@ -1,8 +1,59 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 #include <tuple>
 
+/**
+ * @brief The constants of `EllCalcCore` for a dimension
+ *
+ * They depend on the dimension only, so that a single, immutable table per
+ * dimension is shared by all the `EllCalcCore` objects, instead of a copy
+ * in each of them. The table is constexpr when the dimension is known at
+ * compile time, e.g.
+ *
+ *     static constexpr auto consts = EllCalcConsts(4);
+ *     auto E = EllCalcCore(consts);
+ *
+ * and is interned by `intern` otherwise.
+ */
+struct EllCalcConsts {
+    double n_f;
+    double n_plus_1;
+    double half_n;
+    double inv_n;
+    double n_sq;
+    double cst1;
+    double cst2;
+
+    /**
+     * @brief Computes the constants of the dimension ndim
+     *
+     * @param[in] ndim
+     */
+    constexpr explicit EllCalcConsts(size_t ndim)
+        : n_f{double(ndim)},
+          n_plus_1{n_f + 1.0},
+          half_n{n_f / 2.0},
+          inv_n{1.0 / n_f},
+          n_sq{n_f * n_f},
+          cst1{n_sq / (n_sq - 1.0)},
+          cst2{2.0 / n_plus_1} {}
+
+    /**
+     * @brief The shared table of the dimension ndim
+     *
+     * The tables of the small dimensions are computed once; the others are
+     * computed on first use and kept for the lifetime of the program. The
+     * same dimension always gives the same address. Thread-safe: a lock is
+     * only taken to insert a dimension, not to look it up again.
+     *
+     * @param[in] ndim
+     * @return const EllCalcConsts&
+     */
+    static auto intern(size_t ndim) -> const EllCalcConsts &;
+};
+
 /**
  * @brief Ellipsoid Search Space
  *
@@ -13,34 +64,29 @@
 class EllCalcCore {
   private:
     /**
-     * Member variables for EllCalcCore class.
+     * The shared constants of the dimension, see `EllCalcConsts`.
      */
-    const double _n_f;
-    const double _n_plus_1;
-    const double _half_n;
-    const double _inv_n;
-    const double _n_sq;
-    const double _cst1;
-    const double _cst2;
+    const EllCalcConsts *_c;
 
   public:
     /**
      * Constructor for EllCalcCore class.
-     * Initializes member variables based on input ndim.
+     * Refers to the interned constants of the dimension ndim.
      *
      * Example:
      * EllCalcCore E(2);
      *
      * @param[in] ndim Number of dimensions for EllCalcCore object.
      */
-    explicit EllCalcCore(size_t ndim)
-        : _n_f{double(ndim)},
-          _n_plus_1{_n_f + 1.0},
-          _half_n{_n_f / 2.0},
-          _inv_n{1.0 / _n_f},
-          _n_sq{_n_f * _n_f},
-          _cst1{_n_sq / (_n_sq - 1.0)},
-          _cst2{2.0 / _n_plus_1} {}
+    explicit EllCalcCore(size_t ndim) : _c{&EllCalcConsts::intern(ndim)} {}
+
+    /**
+     * Constructor for EllCalcCore class.
+     * Refers to the given constants, which must outlive the object.
+     *
+     * @param[in] consts The constants of the dimension, e.g. constexpr.
+     */
+    constexpr explicit EllCalcCore(const EllCalcConsts &consts) : _c{&consts} {}
 
     /**
      * Move constructor for EllCalcCore.
@@ -62,6 +108,13 @@ class EllCalcCore {
      */
     EllCalcCore(const EllCalcCore &E) = default;
 
+    /**
+     * The constants of the dimension.
+     *
+     * @return const EllCalcConsts&
+     */
+    auto consts() const -> const EllCalcConsts & { return *this->_c; }
+
     /**
      * Calculates the new ellipsoid parameters rho, sigma, and delta after
      * applying parallel cuts defined by beta0 and beta1.
@@ -91,7 +144,7 @@ class EllCalcCore {
     auto calc_parallel_cut(const double &beta0, const double &beta1, const double &tsq) const
         -> std::tuple<double, double, double> {
         auto b0b1 = beta0 * beta1;
-        auto eta = tsq + this->_n_f * b0b1;
+        auto eta = tsq + this->_c->n_f * b0b1;
         return this->calc_parallel_cut_fast(beta0, beta1, tsq, b0b1, eta);
     }
 
@@ -155,7 +208,7 @@ class EllCalcCore {
      */
     auto calc_bias_cut(const double &beta, const double &tau) const
         -> std::tuple<double, double, double> {
-        return this->calc_bias_cut_fast(beta, tau, tau + this->_n_f * beta);
+        return this->calc_bias_cut_fast(beta, tau, tau + this->_c->n_f * beta);
     }
 
     /**
@@ -0,0 +1,130 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint64_t
+#include <cstdio>       // for FILE
+#include <string>
+#include <type_traits>  // for is_trivially_copyable
+#include <vector>
+
+/**
+ * @brief Writes a checkpoint file, field by field
+ *
+ * The file is the magic "ELLCKP\0\1" followed by the records of the saved
+ * objects (see e.g. `Ell::save`), each field in the byte order of the
+ * machine. The arrays are written from where they are, without a copy.
+ *
+ * The file is written under `path` + ".tmp" and renamed to `path` by
+ * `close`, so that a process killed while it writes leaves the previous
+ * checkpoint as it was. A writer destroyed without `close`, e.g. by an
+ * exception from `write`, deletes the ".tmp" file and keeps the previous
+ * checkpoint too.
+ */
+class CheckpointWriter {
+    std::FILE *_file;
+    std::string _path;
+
+  public:
+    /**
+     * @brief Create the file
+     *
+     * @param[in] path
+     * @throws std::runtime_error if the file cannot be created
+     */
+    explicit CheckpointWriter(const std::string &path);
+
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+    /**
+     * @brief Append size bytes
+     *
+     * @param[in] data
+     * @param[in] size
+     * @throws std::runtime_error on a write error
+     */
+    auto write(const void *data, size_t size) -> void;
+
+    template <typename T> auto write_value(const T &value) -> void {
+        static_assert(std::is_trivially_copyable<T>::value, "written as it is in memory");
+        this->write(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Close the file, and move it over the previous checkpoint
+     *
+     * @throws std::runtime_error on a write error
+     */
+    auto close() -> void;
+};
+
+/**
+ * @brief Reads a checkpoint file, mapped into memory, field by field
+ *
+ * The arrays are copied straight from the mapped pages into the objects
+ * they are restored into (see e.g. `Ell::load`).
+ */
+class CheckpointFile {
+    const char *_base = nullptr;
+    size_t _size = 0U;
+    size_t _pos = 0U;
+    std::vector<char> _buffer;  //!< the contents, where the file cannot be mapped
+
+  public:
+    /**
+     * @brief Map a file into memory
+     *
+     * @param[in] path
+     * @throws std::runtime_error if the file cannot be read, or is not a checkpoint
+     */
+    explicit CheckpointFile(const std::string &path);
+
+    ~CheckpointFile();
+    CheckpointFile(const CheckpointFile &) = delete;
+    CheckpointFile &operator=(const CheckpointFile &) = delete;
+
+    /**
+     * @brief Read the next size bytes
+     *
+     * @param[out] data
+     * @param[in] size
+     * @throws std::runtime_error if the file is shorter
+     */
+    auto read(void *data, size_t size) -> void;
+
+    template <typename T> auto read_value() -> T {
+        static_assert(std::is_trivially_copyable<T>::value, "read as it is in memory");
+        T value;
+        this->read(&value, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Read a field, which must be equal to value
+     *
+     * @param[in] value
+     * @param[in] what the field, for the message
+     * @throws std::runtime_error otherwise
+     */
+    auto expect(std::uint64_t value, const char *what) -> void;
+
+    /**
+     * @brief Number of bytes not read yet
+     *
+     * @return size_t
+     */
+    auto remaining() const -> size_t { return this->_size - this->_pos; }
+
+  private:
+    auto _unmap() -> void;
+};
+
+namespace checkpoint_tag {
+    // The first field of each record
+    static const std::uint64_t core = 0x45524f434c4c45ULL;        // "ELLCORE"
+    static const std::uint64_t ell = 0x4c4c45ULL;                 // "ELL"
+    static const std::uint64_t ell_stable = 0x424154534c4c45ULL;  // "ELLSTAB"
+    static const std::uint64_t solver = 0x564c4f534c4c45ULL;      // "ELLSOLV"
+}  // namespace checkpoint_tag
@@ -15,6 +15,20 @@ struct Options {
     Options(size_t max_iters, double tol) : max_iters{max_iters}, tolerance{tol} {}
 };
 
+/**
+ * @brief RestartOptions, see `cutting_plane_optim_restart`
+ *
+ */
+struct RestartOptions {
+    size_t interval;  //!< iterations between restarts
+    double inflate;   //!< see `Ell::recondition`
+    size_t max_restarts;
+
+    RestartOptions() : interval{500}, inflate{1.0}, max_restarts{100} {}
+    RestartOptions(size_t interval, double inflate)
+        : interval{interval}, inflate{inflate}, max_restarts{100} {}
+};
+
 /**
  * @brief Cut Status
  *
@@ -1,12 +1,22 @@
 // -*- coding: utf-8 -*-
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <tuple>
+#include <type_traits>
 #include <valarray>
+#include <vector>
 
 #include "ell_calc.hpp"
+#include "ell_checkpoint.hpp"
 #include "ell_config.hpp"
-#include "ell_matrix.hpp"
+#include "ell_kernel.hpp"
+#include "ell_sym_matrix.hpp"
 
 /**
  * @brief Ellipsoid Search Space Core
@@ -14,19 +24,82 @@
  * Without the knowledge of the type of xc
  *
  *  \mathcal{E} {x | (x - xc)' mq^-1 (x - xc) \le \kappa}
+ *
+ * The shape matrix `mq` is symmetric, so only its lower triangle is kept (see
+ * `SymMatrix`). In the stable version, the strict lower triangle holds L and
+ * the diagonal holds inv(D) of the factorization mq = L D L'.
+ *
+ * The rank-one update of `mq` after a cut is not applied right away, but
+ * together with the matrix-vector product of the next cut, so that `mq` is
+ * streamed through the cache only once per iteration.
+ *
+ * `Scalar` is the type of the elements of `mq` only: with float, the matrix
+ * takes half the memory and half the bandwidth, while kappa, g' mq g and
+ * all the other quantities stay in double. A float matrix is rescaled by a
+ * power of two (into kappa) whenever its diagonal drifts out of
+ * [2^-32, 2^32], so that it never comes near the range of float. The
+ * stable updates need double. A float `BasicEllCore` may be converted into
+ * a double one, to refine its solution in double.
+ *
+ * @tparam Scalar double or float
  */
-class EllCore {
+template <typename Scalar> class BasicEllCore {
     using Vec = std::valarray<double>;
 
+    template <typename> friend class BasicEllCore;
+
     size_t _n;
     double _kappa;
-    Matrix _mq;
+    BasicSymMatrix<Scalar> _mq;
     EllCalc _helper;
     double _tsq{};
+    Vec _qg;      //!< mq * g of the last cut, for the pending rank-one update
+    double _r{};  //!< mq -= _r * _qg * _qg' is pending
+    bool _pending{};
+    bool _pending_ldl{};  //!< stable: ldl_rank_one with v = _qg (the last g), oldt = _r
+    double _log_volume{};  //!< 0.5 * log(det(kappa * mq)), see `log_volume`
+
+    // Workspace, so that an update does not allocate
+    Vec _grad_t;
+    Vec _inv_lg;
+    Vec _inv_d_inv_lg;
+    Vec _v;
+    Vec _multi;                     //!< the products of `quad_multi`, grown on demand
+    std::vector<double *> _multi_out;
 
   public:
     bool no_defer_trick = false;
 
+    /**
+     * @brief Fold kappa into mq only when it leaves [2^-64, 2^65)
+     *
+     * With the defer trick, kappa grows while mq shrinks as the ellipsoid
+     * shrinks, until mq underflows long before kappa * mq does. Instead of
+     * multiplying mq by kappa on every cut (`no_defer_trick`), the power of
+     * two of kappa is moved into mq when its exponent gets out of range,
+     * which is exact: the iterates are those of the defer trick, bit for
+     * bit, for as long as the defer trick does not underflow. A float `mq`
+     * is kept in range by its own rescaling instead.
+     */
+    bool lazy_rescale = false;
+
+    /**
+     * @brief The state of an EllCore object, see `checkpoint` and `restore`
+     *
+     * The pending rank-one update is saved as it is, so that a restored
+     * object continues bit for bit as the one that was saved.
+     */
+    struct Snapshot {
+        double kappa;
+        std::valarray<Scalar> mq;  //!< the storage of `mq`, including the padding
+        double tsq;
+        Vec qg;
+        double r;
+        bool pending;
+        bool pending_ldl;
+        double log_volume;
+    };
+
   private:
     /**
      * @brief Construct a new EllCore object
@@ -37,24 +110,31 @@ class EllCore {
      *
      * @param[in] E The parameter "E" is a reference to an object of type "EllCore".
      */
-    auto operator=(const EllCore &E) -> EllCore & = delete;
+    auto operator=(const BasicEllCore &E) -> BasicEllCore & = delete;
 
     /**
      * @brief Construct a new EllCore object
      *
-     * The function is a constructor for the EllCore class that takes in a kappa value, a Matrix
+     * The function is a constructor for the EllCore class that takes in a kappa value, a SymMatrix
      * object, and a size_t value as parameters.
      *
      * @param[in] kappa The kappa parameter is a constant value of type double. It is used in the
      * construction of the EllCore object.
-     * @param[in] mq The parameter `mq` is a matrix of type `Matrix` that is being moved into the
-     * `_mq` member variable of the `EllCore` object. The type `Matrix` is not specified in the code
-     * snippet, so it would need to be defined elsewhere in the code.
+     * @param[in] mq The parameter `mq` is a matrix of type `SymMatrix` that is being moved into
+     * the `_mq` member variable of the `EllCore` object.
      * @param[in] ndim The parameter `ndim` represents the number of dimensions for the EllCore
      * object.
      */
-    EllCore(const double &kappa, Matrix &&mq, size_t ndim)
-        : _n{ndim}, _kappa{kappa}, _mq{std::move(mq)}, _helper{_n} {}
+    BasicEllCore(const double &kappa, BasicSymMatrix<Scalar> &&mq, size_t ndim)
+        : _n{ndim},
+          _kappa{kappa},
+          _mq{std::move(mq)},
+          _helper{_n},
+          _qg(_n),
+          _grad_t(_n),
+          _inv_lg(_n),
+          _inv_d_inv_lg(_n),
+          _v(_n) {}
 
   public:
     /**
@@ -66,8 +146,12 @@ class EllCore {
      * @param[in] ndim The parameter `ndim` represents the number of dimensions for the `EllCore`
      * object.
      */
-    EllCore(const Vec &val, size_t ndim) : EllCore{1.0, Matrix(ndim), ndim} {
-        this->_mq.diagonal() = val;
+    BasicEllCore(const Vec &val, size_t ndim)
+        : BasicEllCore{1.0, BasicSymMatrix<Scalar>(ndim), ndim} {
+        this->_mq.set_diagonal(val);
+        for (auto i = 0U; i != ndim; ++i) {
+            this->_log_volume += 0.5 * std::log(val[i]);
+        }
     }
 
     /**
@@ -81,8 +165,10 @@ class EllCore {
      * @param[in] ndim The parameter `ndim` represents the number of dimensions for the EllCore
      * object. It specifies the size of the matrix used in the construction of the object.
      */
-    EllCore(double alpha, size_t ndim) : EllCore{alpha, Matrix(ndim), ndim} {
+    BasicEllCore(double alpha, size_t ndim)
+        : BasicEllCore{alpha, BasicSymMatrix<Scalar>(ndim), ndim} {
         this->_mq.identity();
+        this->_log_volume = 0.5 * double(ndim) * std::log(alpha);
     }
 
     /**
@@ -94,13 +180,13 @@ class EllCore {
      * @param[in] E The parameter "E" is an rvalue reference to an object of type "EllCore".
      *
      */
-    EllCore(EllCore &&E) = default;
+    BasicEllCore(BasicEllCore &&E) = default;
 
     /**
      * @brief Destroy the EllCore object
      *
      */
-    ~EllCore() = default;
+    ~BasicEllCore() = default;
 
     /**
      * @brief Construct a new EllCore object
@@ -109,14 +195,185 @@ class EllCore {
      *
      * @param[in] E The parameter "E" is a reference to an object of type "EllCore".
      */
-    explicit EllCore(const EllCore &E) = default;
+    explicit BasicEllCore(const BasicEllCore &E) = default;
+
+    /**
+     * @brief Construct a new EllCore object from one of another precision
+     *
+     * E.g. to refine in double the solution found with a float matrix. The
+     * pending rank-one update, kept in double, is carried over as it is.
+     *
+     * @tparam S2
+     * @param[in] E
+     */
+    template <typename S2>
+    explicit BasicEllCore(const BasicEllCore<S2> &E)
+        : BasicEllCore{E._kappa, BasicSymMatrix<Scalar>(E._n), E._n} {
+        for (auto j = 0U; j != this->_n; ++j) {
+            const auto *src = E._mq.column(j);
+            auto *dst = this->_mq.column(j);
+            for (auto k = 0U; k != this->_n - j; ++k) {
+                dst[k] = Scalar(src[k]);
+            }
+        }
+        this->_helper.use_parallel_cut = E._helper.use_parallel_cut;
+        this->_helper.adaptive_parallel_cut = E._helper.adaptive_parallel_cut;
+        this->_tsq = E._tsq;
+        this->_qg = E._qg;
+        this->_r = E._r;
+        this->_pending = E._pending;
+        this->_pending_ldl = E._pending_ldl;
+        this->_log_volume = E._log_volume;
+        this->no_defer_trick = E.no_defer_trick;
+        this->lazy_rescale = E.lazy_rescale;
+    }
 
     /**
      * @brief explicitly copy
      *
-     * @return EllCore
+     * @return BasicEllCore
+     */
+    auto copy() const -> BasicEllCore { return BasicEllCore(*this); }
+
+    /**
+     * @brief explicitly copy, with mq from the given resource (e.g. a `PoolResource`)
+     *
+     * @param[in] res
+     * @return BasicEllCore
+     */
+    auto copy(MemoryResource &res) const -> BasicEllCore {
+        auto E = BasicEllCore{this->_kappa, BasicSymMatrix<Scalar>(this->_n, 0.0, &res), this->_n};
+        this->copy_into(E);
+        return E;
+    }
+
+    /**
+     * @brief Copy into an object of the same dimension, without allocation
+     *
+     * As `copy`, options included, but the buffers of `dst` are reused. The
+     * counts of `EllCalc` (see `EllCalc::num_parallel_chosen`) are not copied.
+     *
+     * @param[out] dst
+     */
+    void copy_into(BasicEllCore &dst) const {
+        assert(dst._n == this->_n);
+        dst._mq = this->_mq;  // the same size, no allocation
+        dst._helper.use_parallel_cut = this->_helper.use_parallel_cut;
+        dst._helper.adaptive_parallel_cut = this->_helper.adaptive_parallel_cut;
+        dst._kappa = this->_kappa;
+        dst._tsq = this->_tsq;
+        std::copy(std::begin(this->_qg), std::end(this->_qg), std::begin(dst._qg));
+        dst._r = this->_r;
+        dst._pending = this->_pending;
+        dst._pending_ldl = this->_pending_ldl;
+        dst._log_volume = this->_log_volume;
+        dst.no_defer_trick = this->no_defer_trick;
+        dst.lazy_rescale = this->lazy_rescale;
+    }
+
+    /**
+     * @brief Allocate a snapshot of the current state
+     *
+     * The result is the buffer for the later calls of `checkpoint`.
+     *
+     * @return Snapshot
+     */
+    auto snapshot() const -> Snapshot {
+        auto snap = Snapshot{0.0, std::valarray<Scalar>(this->_mq.storage_size()), 0.0,
+                             Vec(this->_n), 0.0, false, false, 0.0};
+        this->checkpoint(snap);
+        return snap;
+    }
+
+    /**
+     * @brief Save the current state into a snapshot of the same dimension
+     *
+     * Unlike `copy`, nothing is allocated.
+     *
+     * @param[out] snap
      */
-    auto copy() const -> EllCore { return EllCore(*this); }
+    void checkpoint(Snapshot &snap) const {
+        assert(snap.mq.size() == this->_mq.storage_size());
+        const auto *mq = this->_mq.data();
+        std::copy(mq, mq + this->_mq.storage_size(), &snap.mq[0]);
+        snap.kappa = this->_kappa;
+        snap.tsq = this->_tsq;
+        std::copy(std::begin(this->_qg), std::end(this->_qg), std::begin(snap.qg));
+        snap.r = this->_r;
+        snap.pending = this->_pending;
+        snap.pending_ldl = this->_pending_ldl;
+        snap.log_volume = this->_log_volume;
+    }
+
+    /**
+     * @brief Go back to the state saved in a snapshot of the same dimension
+     *
+     * @param[in] snap
+     */
+    void restore(const Snapshot &snap) {
+        assert(snap.mq.size() == this->_mq.storage_size());
+        std::copy(&snap.mq[0], &snap.mq[0] + snap.mq.size(), this->_mq.data());
+        this->_kappa = snap.kappa;
+        this->_tsq = snap.tsq;
+        std::copy(std::begin(snap.qg), std::end(snap.qg), std::begin(this->_qg));
+        this->_r = snap.r;
+        this->_pending = snap.pending;
+        this->_pending_ldl = snap.pending_ldl;
+        this->_log_volume = snap.log_volume;
+    }
+
+    /**
+     * @brief Append the state to a checkpoint file
+     *
+     * The same state as `checkpoint`, plus the options, with mq written
+     * from its own storage.
+     *
+     * @param[in,out] out
+     */
+    void save(CheckpointWriter &out) const {
+        const auto flags = std::uint64_t(this->_pending) | std::uint64_t(this->_pending_ldl) << 1U
+                           | std::uint64_t(this->no_defer_trick) << 2U
+                           | std::uint64_t(this->lazy_rescale) << 3U
+                           | std::uint64_t(this->_helper.use_parallel_cut) << 4U
+                           | std::uint64_t(this->_helper.adaptive_parallel_cut) << 5U;
+        out.write_value(checkpoint_tag::core);
+        out.write_value(std::uint64_t(this->_n));
+        out.write_value(std::uint64_t(sizeof(Scalar)));
+        out.write_value(std::uint64_t(this->_mq.storage_size()));
+        out.write_value(flags);
+        out.write_value(this->_kappa);
+        out.write_value(this->_tsq);
+        out.write_value(this->_r);
+        out.write_value(this->_log_volume);
+        out.write(&this->_qg[0], this->_n * sizeof(double));
+        out.write(this->_mq.data(), this->_mq.storage_size() * sizeof(Scalar));
+    }
+
+    /**
+     * @brief Go back to the state saved by `save`, in an object of the same dimension
+     *
+     * @param[in,out] in
+     * @throws std::runtime_error if the record is not that of such an object
+     */
+    void load(CheckpointFile &in) {
+        in.expect(checkpoint_tag::core, "record");
+        in.expect(this->_n, "dimension");
+        in.expect(sizeof(Scalar), "element size");
+        in.expect(this->_mq.storage_size(), "storage size");
+        const auto flags = in.read_value<std::uint64_t>();
+        this->_kappa = in.read_value<double>();
+        this->_tsq = in.read_value<double>();
+        this->_r = in.read_value<double>();
+        this->_log_volume = in.read_value<double>();
+        in.read(&this->_qg[0], this->_n * sizeof(double));
+        in.read(this->_mq.data(), this->_mq.storage_size() * sizeof(Scalar));
+        this->_pending = (flags & 1U) != 0U;
+        this->_pending_ldl = (flags & 2U) != 0U;
+        this->no_defer_trick = (flags & 4U) != 0U;
+        this->lazy_rescale = (flags & 8U) != 0U;
+        this->_helper.use_parallel_cut = (flags & 16U) != 0U;
+        this->_helper.adaptive_parallel_cut = (flags & 32U) != 0U;
+    }
 
     /**
      * @brief
@@ -125,6 +382,116 @@ class EllCore {
      */
     auto tsq() const -> double { return this->_tsq; }
 
+    /**
+     * @brief The logarithm of the volume of the ellipsoid, less that of the unit ball
+     *
+     * That is, 0.5 * log(det(kappa * mq)), kept up to date at O(1) per cut:
+     * a cut multiplies det(kappa * mq) by delta^n * (1 - sigma). Unlike the
+     * determinant itself, it does not underflow as the ellipsoid shrinks.
+     *
+     * @return double
+     */
+    auto log_volume() const -> double { return this->_log_volume; }
+
+    /**
+     * @brief kappa * g' * mq * g, the squared width of the ellipsoid along g
+     *
+     * Taking the pending rank-one update into account, without applying it.
+     * Valid for the updates other than the stable ones, whose `mq` holds a
+     * factorization.
+     *
+     * @param[in] g vector of size n
+     * @return double
+     */
+    auto quad(const double *g) -> double {
+        auto omega = ell_kernel::sym_matvec(this->_mq, g, &this->_v[0]);
+        if (this->_pending) {
+            auto qg_g = 0.0;
+            for (auto i = 0U; i != this->_n; ++i) {
+                qg_g += this->_qg[i] * g[i];
+            }
+            omega -= this->_r * qg_g * qg_g;
+        }
+        return this->_kappa * omega;
+    }
+
+    /**
+     * @brief `quad` of num gradients at once, in a single pass over mq
+     *
+     * @param[in] g num vectors of size n
+     * @param[out] tsq of size num
+     * @param[in] num
+     */
+    void quad_multi(const double *const *g, double *tsq, size_t num) {
+        if (this->_multi_out.size() < num) {
+            this->_multi.resize(num * this->_n);
+            this->_multi_out.resize(num);
+        }
+        for (auto k = 0U; k != num; ++k) {
+            this->_multi_out[k] = &this->_multi[k * this->_n];
+        }
+        _matvec_multi(this->_mq, g, this->_multi_out.data(), tsq, num);
+        for (auto k = 0U; k != num; ++k) {
+            if (this->_pending) {
+                auto qg_g = 0.0;
+                for (auto i = 0U; i != this->_n; ++i) {
+                    qg_g += this->_qg[i] * g[k][i];
+                }
+                tsq[k] -= this->_r * qg_g * qg_g;
+            }
+            tsq[k] *= this->_kappa;
+        }
+    }
+
+    /**
+     * @brief kappa * mq(i, i), the squared half-widths of the ellipsoid along the axes
+     *
+     * As `quad` of the unit vectors, with the pending update, and valid for
+     * the same updates.
+     *
+     * @param[out] out of size n
+     */
+    void axis_widths_sq(double *out) const {
+        for (auto i = 0U; i != this->_n; ++i) {
+            auto qii = double(this->_mq.column(i)[0]);
+            if (this->_pending) {
+                qii -= this->_r * this->_qg[i] * this->_qg[i];
+            }
+            out[i] = this->_kappa * qii;
+        }
+    }
+
+    /**
+     * @brief Start again from the diagonal mq = diag(val), in place
+     *
+     * As the constructor from val, without allocating, and keeping the
+     * settings of the cuts.
+     *
+     * @param[in] val of size n
+     */
+    void reset_diagonal(const Vec &val) {
+        this->_mq.clear();
+        this->_mq.set_diagonal(val);
+        this->_kappa = 1.0;
+        this->_tsq = 0.0;
+        this->_r = 0.0;
+        this->_pending = false;
+        this->_pending_ldl = false;
+        this->_log_volume = 0.0;
+        for (auto i = 0U; i != this->_n; ++i) {
+            this->_log_volume += 0.5 * std::log(val[i]);
+        }
+    }
+
+    /**
+     * @brief Apply the pending update of mq now, if any
+     *
+     * The next update does the same work otherwise, fused with its product
+     * by mq, and both give the same iterates bit for bit. Done ahead, e.g.
+     * while the oracle runs, it shortens the next update.
+     */
+    void flush() { this->_flush(); }
+
     /**
      * The function sets the value of the use_parallel_cut property in the _mgr object.
      *
@@ -133,6 +500,20 @@ class EllCore {
      */
     void set_use_parallel_cut(bool value) { this->_helper.use_parallel_cut = value; }
 
+    /**
+     * @brief Choose between a parallel cut and a single one, see `EllCalc::adaptive_parallel_cut`
+     *
+     * @param[in] value
+     */
+    void set_adaptive_parallel_cut(bool value) { this->_helper.adaptive_parallel_cut = value; }
+
+    /**
+     * @brief The calculator of the cuts, e.g. for its counters
+     *
+     * @return const EllCalc&
+     */
+    auto calc() const -> const EllCalc & { return this->_helper; }
+
     /**
      * @brief Update ellipsoid core function using the deep cut(s)
      *
@@ -236,6 +617,90 @@ class EllCore {
     }
 
   private:
+    /**
+     * @brief Apply the pending rank-one update to mq, if any
+     */
+    void _flush() {
+        if (this->_pending) {
+            ell_kernel::sym_rank_one(this->_mq, this->_r, &this->_qg[0]);
+            this->_pending = false;
+        }
+        this->_flush_ldl();
+    }
+
+    /**
+     * @brief Apply the pending update of the factorization, if any
+     */
+    void _flush_ldl() {
+        if (this->_pending_ldl) {
+            _ldl_update(this->_mq, &this->_qg[0], this->_r);
+            this->_pending_ldl = false;
+        }
+    }
+
+    static void _matvec_multi(const SymMatrix &mq, const double *const *g, double *const *out,
+                              double *omega, size_t num) {
+        ell_kernel::sym_matvec_multi(mq, g, out, omega, num);
+    }
+
+    static void _matvec_multi(const SymMatrixF &mq, const double *const *g, double *const *out,
+                              double *omega, size_t num) {
+        for (auto k = 0U; k != num; ++k) {
+            omega[k] = ell_kernel::sym_matvec(mq, g[k], out[k]);
+        }
+    }
+
+    static void _ldl_update(SymMatrix &mq, double *v, double oldt) {
+        ell_kernel::ldl_update_solve(mq, v, oldt, nullptr);
+    }
+
+    static void _ldl_update(SymMatrixF & /* mq */, double * /* v */, double /* oldt */) {
+        // never pending: the stable updates need double
+    }
+
+    /**
+     * @brief Move a power of two from mq into kappa, if the diagonal of mq is out of range
+     *
+     * The scaling is exact, and the pending update is scaled with mq by r.
+     */
+    void _renormalize() {
+        auto diag = 0.0;
+        for (auto i = 0U; i != this->_n; ++i) {
+            const auto qii = this->_mq.column(i)[0] - this->_r * this->_qg[i] * this->_qg[i];
+            diag = std::max(diag, qii);
+        }
+        if (diag == 0.0 || std::abs(std::ilogb(diag)) <= 32) {
+            return;
+        }
+        const auto c = std::ldexp(1.0, -std::ilogb(diag));
+        this->_mq *= c;
+        this->_r *= c;
+        this->_kappa /= c;
+    }
+
+    /**
+     * @brief det(kappa * mq) is multiplied by delta^n * (1 - sigma) by a cut
+     */
+    void _update_log_volume(double sigma, double delta) {
+        this->_log_volume += 0.5 * (double(this->_n) * std::log(delta) + std::log1p(-sigma));
+    }
+
+    /**
+     * @brief Move the power of two of kappa into mq, if kappa is out of range
+     *
+     * The scaling is exact, and the pending update is scaled with mq by r.
+     */
+    void _fold_kappa() {
+        const auto e = std::ilogb(this->_kappa);
+        if (std::abs(e) <= 64) {
+            return;
+        }
+        const auto c = std::ldexp(1.0, e);
+        this->_mq *= c;
+        this->_r *= c;
+        this->_kappa /= c;
+    }
+
     /**
      * @brief Update ellipsoid core function using the cut(s)
      *
@@ -251,14 +716,14 @@ class EllCore {
      */
     template <typename T, typename Fn>
     auto _update_core(Vec &grad, const T &beta, Fn &&cut_strategy) -> CutStatus {
-        std::valarray<double> grad_t(0.0, this->_n);
-        auto omega = 0.0;
-        for (auto i = 0U; i != this->_n; ++i) {
-            for (auto j = 0U; j != this->_n; ++j) {
-                grad_t[i] += this->_mq(i, j) * grad[j];
-            }
-            omega += grad_t[i] * grad[i];
-        }
+        // Q * g and g' * Q * g from the lower triangle only, applying the
+        // pending rank-one update in the same pass
+        auto &grad_t = this->_grad_t;
+        const auto omega = this->_pending ? ell_kernel::sym_update_matvec(this->_mq, this->_r,
+                                                                          &this->_qg[0], &grad[0],
+                                                                          &grad_t[0])
+                                          : ell_kernel::sym_matvec(this->_mq, &grad[0], &grad_t[0]);
+        this->_pending = false;
 
         this->_tsq = this->_kappa * omega;
 
@@ -273,25 +738,26 @@ class EllCore {
         double delta;
         std::tie(rho, sigma, delta) = std::get<1>(__result);
 
-        // n (n+1) / 2 + n
-        const auto r = sigma / omega;
-        for (auto i = 0U; i != this->_n; ++i) {
-            const auto rQg = r * grad_t[i];
-            for (auto j = 0U; j != i; ++j) {
-                this->_mq(i, j) -= rQg * grad_t[j];
-                this->_mq(j, i) = this->_mq(i, j);
-            }
-            this->_mq(i, i) -= rQg * grad_t[i];
-        }
+        // n (n+1) / 2 + n, lower triangle only, deferred to the next cut
+        this->_r = sigma / omega;
+        this->_qg.swap(grad_t);
+        this->_pending = true;
 
         this->_kappa *= delta;
+        this->_update_log_volume(sigma, delta);
 
         if (this->no_defer_trick) {
+            this->_flush();
             this->_mq *= this->_kappa;
             this->_kappa = 1.0;
+        } else if (!std::is_same<Scalar, double>::value) {
+            this->_renormalize();
+        } else if (this->lazy_rescale) {
+            this->_fold_kappa();
         }
 
-        grad = grad_t * (rho / omega);
+        grad = this->_qg;
+        grad *= rho / omega;
         return status;  // g++-7 is ok
     }
 
@@ -310,28 +776,26 @@ class EllCore {
      */
     template <typename T, typename Fn>
     auto _update_stable_core(Vec &g, const T &beta, Fn &&cut_strategy) -> CutStatus {
-        // Calculate L^-1 * grad: (n-1)*n/2 multiplications
-        auto invLg{g};  // initially
-        for (auto j = 0U; j != this->_n - 1; ++j) {
-            for (auto i = j + 1; i != this->_n; ++i) {
-                this->_mq(j, i) = this->_mq(i, j) * invLg[j];
-                // keep for rank-one update
-                invLg[i] -= this->_mq(j, i);
-            }
+        static_assert(std::is_same<Scalar, double>::value, "the stable updates need double");
+
+        // Calculate L^-1 * grad: (n-1)*n/2 multiplications, in the same pass
+        // as the pending update of the factorization
+        auto &invLg = this->_inv_lg;
+        invLg = g;  // initially
+        if (this->_pending_ldl) {
+            ell_kernel::ldl_update_solve(this->_mq, &this->_qg[0], this->_r, &invLg[0]);
+            this->_pending_ldl = false;
+        } else {
+            this->_flush();
+            ell_kernel::lower_solve(this->_mq, &invLg[0]);
         }
 
-        // calculate inv(D)*inv(L)*grad: n
-        auto invDinvLg{invLg};  // initially
+        // calculate inv(D)*inv(L)*grad and omega: 2n
+        auto &invDinvLg = this->_inv_d_inv_lg;
+        auto omega = 0.0;  // initially
         for (auto i = 0U; i != this->_n; ++i) {
-            invDinvLg[i] *= this->_mq(i, i);
-        }
-
-        // calculate omega: n
-        auto gg_t{invDinvLg};  // initially
-        auto omega = 0.0;      // initially
-        for (auto i = 0U; i != this->_n; ++i) {
-            gg_t[i] *= invLg[i];
-            omega += gg_t[i];
+            invDinvLg[i] = invLg[i] * this->_mq.column(i)[0];
+            omega += invDinvLg[i] * invLg[i];
         }
 
         this->_tsq = this->_kappa * omega;
@@ -348,36 +812,21 @@ class EllCore {
         std::tie(rho, sigma, delta) = std::get<1>(__result);
 
         // Calculate the (L')^-1 * D^-1 * L^-1 * grad : (n-1)n / 2
-        auto grad_t{invDinvLg};                     // initially
-        for (auto i = this->_n - 1; i != 0; --i) {  // backward subsituition
-            for (auto j = i; j != this->_n; ++j) {
-                grad_t[i - 1] -= this->_mq(j, i - 1) * grad_t[j];  // ???
-            }
-        }
+        auto &grad_t = this->_grad_t;
+        grad_t = invDinvLg;  // initially
+        ell_kernel::lower_transpose_solve(this->_mq, &grad_t[0]);
 
-        // rank-one update: 3*n + (n-1)*n/2
-        // const auto r = this->_sigma / omega;
+        // rank-one update: 3*n + (n-1)*n/2, deferred to the next cut, where
+        // it is done in the pass of L^-1 * grad
         const auto mu = sigma / (1.0 - sigma);
-        auto oldt = omega / mu;  // initially
-        // const auto m = this->_n - 1;
-        auto v{g};
-        for (auto j = 0U; j != this->_n; ++j) {
-            const auto p = v[j];
-            const auto temp = invDinvLg[j];
-            const auto newt = oldt + p * temp;
-            const auto beta2 = temp / newt;
-            this->_mq(j, j) *= oldt / newt;  // update invD
-            for (auto k = j + 1; k != this->_n; ++k) {
-                v[k] -= this->_mq(j, k);
-                this->_mq(k, j) += beta2 * v[k];
-            }
-            oldt = newt;
-        }
-        // const auto gamma = oldt + gg_t[m];
-        // this->_mq(m, m) *= oldt / gamma; // update invD
-        //
+        this->_r = omega / mu;
+        this->_qg.swap(g);
+        this->_pending_ldl = true;
+
         this->_kappa *= delta;
-        g = grad_t * (rho / omega);
+        this->_update_log_volume(sigma, delta);
+        g.swap(grad_t);
+        g *= rho / omega;
         return status;
     }
 
@@ -480,4 +929,6 @@ class EllCore {
         return this->_helper.calc_parallel_bias_cut_q(beta[0], beta[1], tsq);
     }
 
-};  // } EllCore
+};  // } BasicEllCore
+
+using EllCore = BasicEllCore<double>;
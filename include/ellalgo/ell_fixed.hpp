@@ -0,0 +1,436 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <tuple>
+#include <valarray>
+
+#include "ell_assert.hpp"
+#include "ell_config.hpp"
+#include "ell_span.hpp"
+
+/**
+ * @brief `EllCalc` for a dimension known at compile time
+ *
+ * The same formulas as `EllCalc` and `EllCalcCore`, inline, with their
+ * constants folded by the compiler. The results are the same, bit for bit.
+ *
+ * @tparam N dimension, at least 2
+ */
+template <size_t N> class EllCalcFixed {
+    static_assert(N >= 2U, "do not accept one-dimensional");
+
+    using Result = std::tuple<CutStatus, std::tuple<double, double, double>>;
+
+    static constexpr double _n_f = double(N);
+    static constexpr double _n_plus_1 = _n_f + 1.0;
+    static constexpr double _half_n = _n_f / 2.0;
+    static constexpr double _inv_n = 1.0 / _n_f;
+    static constexpr double _n_sq = _n_f * _n_f;
+    static constexpr double _cst1 = _n_sq / (_n_sq - 1.0);
+    static constexpr double _cst2 = 2.0 / _n_plus_1;
+
+  public:
+    bool use_parallel_cut = true;
+
+    /** @see EllCalc::calc_parallel_bias_cut */
+    auto calc_parallel_bias_cut(double beta0, double beta1, double tsq) const -> Result {
+        if (beta1 < beta0) {
+            return {CutStatus::NoSoln, {0.0, 0.0, 0.0}};  // no sol'n
+        }
+        if ((beta1 > 0 && tsq <= beta1 * beta1) || !this->use_parallel_cut) {
+            return this->calc_bias_cut(beta0, tsq);
+        }
+        const auto b0b1 = beta0 * beta1;
+        const auto eta = tsq + _n_f * b0b1;
+        return {CutStatus::Success, _parallel_cut(beta0, beta1, tsq, b0b1, eta)};
+    }
+
+    /** @see EllCalc::calc_parallel_central_cut */
+    auto calc_parallel_central_cut(double beta1, double tsq) const -> Result {
+        if (beta1 < 0.0) {
+            return {CutStatus::NoSoln, {0.0, 0.0, 0.0}};  // no sol'n
+        }
+        if (tsq < beta1 * beta1 || !this->use_parallel_cut) {
+            return this->calc_central_cut(tsq);
+        }
+        const auto b1sq = beta1 * beta1;
+        const auto a1sq = b1sq / tsq;
+        const auto k = _half_n * a1sq;
+        const auto r = k + std::sqrt(1.0 - a1sq + k * k);
+        const auto r_plus_1 = r + 1.0;
+        return {CutStatus::Success, {beta1 / r_plus_1, 2.0 / r_plus_1, r / (r - _inv_n)}};
+    }
+
+    /** @see EllCalc::calc_bias_cut */
+    auto calc_bias_cut(double beta, double tsq) const -> Result {
+        assert(beta >= 0.0);
+        if (tsq < beta * beta) {
+            return {CutStatus::NoSoln, {0.0, 0.0, 0.0}};  // no sol'n
+        }
+        const auto tau = std::sqrt(tsq);
+        return {CutStatus::Success, _bias_cut(beta, tau, tau + _n_f * beta)};
+    }
+
+    /** @see EllCalc::calc_central_cut */
+    auto calc_central_cut(double tsq) const -> Result {
+        return {CutStatus::Success, {std::sqrt(tsq) / _n_plus_1, _cst2, _cst1}};
+    }
+
+    /** @see EllCalc::calc_parallel_bias_cut_q */
+    auto calc_parallel_bias_cut_q(double beta0, double beta1, double tsq) const -> Result {
+        if (beta1 < beta0) {
+            return {CutStatus::NoSoln, {0.0, 0.0, 0.0}};  // no sol'n
+        }
+        if ((beta1 > 0.0 && tsq <= beta1 * beta1) || !this->use_parallel_cut) {
+            return this->calc_bias_cut_q(beta0, tsq);
+        }
+        const auto b0b1 = beta0 * beta1;
+        const auto eta = tsq + _n_f * b0b1;
+        if (ELL_UNLIKELY(eta <= 0.0)) {
+            return {CutStatus::NoEffect, {0.0, 0.0, 1.0}};  // no effect
+        }
+        return {CutStatus::Success, _parallel_cut(beta0, beta1, tsq, b0b1, eta)};
+    }
+
+    /** @see EllCalc::calc_bias_cut_q */
+    auto calc_bias_cut_q(double beta, double tsq) const -> Result {
+        const auto tau = std::sqrt(tsq);
+        if (tau < beta) {
+            return {CutStatus::NoSoln, {0.0, 0.0, 0.0}};  // no sol'n
+        }
+        const auto eta = tau + _n_f * beta;
+        if (ELL_UNLIKELY(eta <= 0.0)) {
+            return {CutStatus::NoEffect, {0.0, 0.0, 1.0}};  // no effect
+        }
+        return {CutStatus::Success, _bias_cut(beta, tau, eta)};
+    }
+
+  private:
+    static auto _parallel_cut(double beta0, double beta1, double tsq, double b0b1, double eta)
+        -> std::tuple<double, double, double> {
+        const auto bavg = 0.5 * (beta0 + beta1);
+        const auto bavgsq = bavg * bavg;
+        const auto h = 0.5 * (tsq + b0b1) + _n_f * bavgsq;
+        const auto k = h + std::sqrt(h * h - _n_plus_1 * eta * bavgsq);
+        const auto inv_mu_plus_1 = eta / k;
+        const auto inv_mu = eta / (k - eta);
+        return {bavg * inv_mu_plus_1, inv_mu_plus_1,
+                (tsq + inv_mu * (bavgsq * inv_mu_plus_1 - b0b1)) / tsq};
+    }
+
+    static auto _bias_cut(double beta, double tau, double eta)
+        -> std::tuple<double, double, double> {
+        const auto alpha = beta / tau;
+        return {eta / _n_plus_1, _cst2 * eta / (tau + beta), _cst1 * (1.0 - alpha * alpha)};
+    }
+};
+
+template <size_t N> constexpr double EllCalcFixed<N>::_n_f;
+template <size_t N> constexpr double EllCalcFixed<N>::_n_plus_1;
+template <size_t N> constexpr double EllCalcFixed<N>::_half_n;
+template <size_t N> constexpr double EllCalcFixed<N>::_inv_n;
+template <size_t N> constexpr double EllCalcFixed<N>::_n_sq;
+template <size_t N> constexpr double EllCalcFixed<N>::_cst1;
+template <size_t N> constexpr double EllCalcFixed<N>::_cst2;
+
+/**
+ * @brief Ellipsoid Search Space of a dimension known at compile time
+ *
+ *   ell = {x | (x - xc)' mq^-1 (x - xc) \le \kappa}
+ *
+ * `Ell<Arr>` for small problems of a fixed size, e.g. in 2 or 3
+ * dimensions: the centre is a `std::array`, the lower triangle of mq is
+ * kept in a `std::array` column by column, as in `SymMatrix` but without
+ * the padding, and all the loops have a constant trip count, so that the
+ * compiler unrolls them. Nothing is allocated, and an object can live on
+ * the stack or in registers. The rank-one update is applied right away.
+ *
+ * The arithmetic is that of `Ell<Arr>`, in the same order, so that both
+ * follow the same iterates, bit for bit.
+ *
+ * @tparam N dimension, at least 2
+ */
+template <size_t N> class EllFixed {
+  public:
+    using Vec = std::valarray<double>;
+    using ArrayType = std::array<double, N>;
+
+  private:
+    static constexpr size_t _size = N * (N + 1U) / 2U;
+
+    ArrayType _xc;
+    std::array<double, _size> _mq{};
+    double _kappa;
+    double _tsq{};
+    EllCalcFixed<N> _helper;
+    ArrayType _g{};  //!< workspace for the gradient
+
+    auto operator=(const EllFixed &E) -> EllFixed & = delete;
+
+  public:
+    /**
+     * @brief Construct a new EllFixed object
+     *
+     * @param[in] val the diagonal of mq
+     * @param[in] x the centre
+     */
+    EllFixed(const ArrayType &val, const ArrayType &x) : _xc(x), _kappa{1.0} {
+        for (size_t j = 0U, pos = 0U; j != N; pos += N - j, ++j) {
+            this->_mq[pos] = val[j];
+        }
+    }
+
+    /**
+     * @brief Construct a new EllFixed object
+     *
+     * @param[in] alpha kappa, with mq the identity
+     * @param[in] x the centre
+     */
+    EllFixed(double alpha, const ArrayType &x) : _xc(x), _kappa{alpha} {
+        for (size_t j = 0U, pos = 0U; j != N; pos += N - j, ++j) {
+            this->_mq[pos] = 1.0;
+        }
+    }
+
+    EllFixed(EllFixed &&E) noexcept = default;
+
+    ~EllFixed() = default;
+
+    /**
+     * @brief Construct a new EllFixed object
+     *
+     * To avoid accidentally copying, only explicit copy is allowed
+     *
+     * @param[in] E
+     */
+    explicit EllFixed(const EllFixed &E) = default;
+
+    /**
+     * @brief explicitly copy
+     *
+     * @return EllFixed
+     */
+    auto copy() const -> EllFixed { return EllFixed(*this); }
+
+    /**
+     * @brief the centre, without a copy
+     *
+     * @return const ArrayType&
+     */
+    auto xc() const -> const ArrayType & { return this->_xc; }
+
+    /**
+     * @brief Set the xc object
+     *
+     * @param[in] xc
+     */
+    void set_xc(const ArrayType &xc) { this->_xc = xc; }
+
+    /**
+     * @brief
+     *
+     * @return double
+     */
+    auto tsq() const -> double { return this->_tsq; }
+
+    /**
+     * @brief Whether the parallel cuts are used, as in `Ell`
+     *
+     * @param[in] value
+     */
+    void set_use_parallel_cut(bool value) { this->_helper.use_parallel_cut = value; }
+
+    /**
+     * @brief Update ellipsoid core function using the deep cut(s)
+     *
+     * @tparam T double, or `std::valarray<double>` for a parallel cut
+     * @param[in] cut cutting-plane
+     * @return CutStatus
+     */
+    template <typename T> auto update_bias_cut(const std::pair<ArrayType, T> &cut) -> CutStatus {
+        return this->update_bias_cut(make_span(cut.first), cut.second);
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the central cut(s)
+     *
+     * @tparam T double, or `std::valarray<double>` for a parallel cut
+     * @param[in] cut cutting-plane
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_central_cut(const std::pair<ArrayType, T> &cut) -> CutStatus {
+        return this->update_central_cut(make_span(cut.first), cut.second);
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the cut(s)
+     *
+     * @tparam T double, or `std::valarray<double>` for a parallel cut
+     * @param[in] cut cutting-plane
+     * @return CutStatus
+     */
+    template <typename T> auto update_q(const std::pair<ArrayType, T> &cut) -> CutStatus {
+        return this->update_q(make_span(cut.first), cut.second);
+    }
+
+    /**
+     * @brief Buffer for the gradient of the next cut, see `Ell::grad_buffer`
+     *
+     * @return Span<double> of size N
+     */
+    auto grad_buffer() -> Span<double> { return make_span(this->_g); }
+
+    /**
+     * @brief Update ellipsoid core function using the deep cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_bias_cut(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](const T &beta_l, double tsq) {
+            return this->_bias_cut(beta_l, tsq);
+        });
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the central cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_central_cut(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](const T &beta_l, double tsq) {
+            return this->_central_cut(beta_l, tsq);
+        });
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T> auto update_q(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](const T &beta_l, double tsq) {
+            return this->_q_cut(beta_l, tsq);
+        });
+    }
+
+  private:
+    /**
+     * @brief Update the ellipsoid by the cut(s)
+     *
+     * mq * g column by column as `ell_kernel::sym_matvec`, and the rank-one
+     * update as `ell_kernel::sym_rank_one`.
+     *
+     * @tparam T
+     * @tparam Fn
+     * @param[in] grad gradient
+     * @param[in] beta
+     * @param[in] cut_strategy
+     * @return CutStatus
+     */
+    template <typename T, typename Fn>
+    auto _update_core(Span<const double> grad, const T &beta, Fn &&cut_strategy) -> CutStatus {
+        auto &g = this->_g;
+        if (grad.data() != g.data()) {  // not written in place
+            for (size_t i = 0U; i != N; ++i) {
+                g[i] = grad[i];
+            }
+        }
+
+        auto qg = ArrayType{};
+        auto omega = 0.0;
+        for (size_t j = 0U, pos = 0U; j != N; pos += N - j, ++j) {
+            const auto *col = &this->_mq[pos];
+            const auto gj = g[j];
+            auto s = qg[j] + col[0] * gj;
+            for (size_t k = 1U; k != N - j; ++k) {
+                s += col[k] * g[j + k];
+                qg[j + k] += col[k] * gj;
+            }
+            qg[j] = s;
+            omega += s * gj;
+        }
+
+        this->_tsq = this->_kappa * omega;
+
+        auto __result = cut_strategy(beta, this->_tsq);
+        auto status = std::get<0>(__result);
+        if (status != CutStatus::Success) {
+            return status;
+        }
+
+        double rho;
+        double sigma;
+        double delta;
+        std::tie(rho, sigma, delta) = std::get<1>(__result);
+
+        const auto r = sigma / omega;
+        for (size_t j = 0U, pos = 0U; j != N; pos += N - j, ++j) {
+            auto *col = &this->_mq[pos];
+            for (size_t k = 0U; k != N - j; ++k) {
+                col[k] -= r * qg[j + k] * qg[j];
+            }
+        }
+        this->_kappa *= delta;
+
+        const auto c = rho / omega;
+        for (size_t i = 0U; i != N; ++i) {
+            g[i] = qg[i] * c;
+            this->_xc[i] -= g[i];
+        }
+        return status;
+    }
+
+    auto _bias_cut(double beta, double tsq) const
+        -> std::tuple<CutStatus, std::tuple<double, double, double>> {
+        return this->_helper.calc_bias_cut(beta, tsq);
+    }
+
+    auto _bias_cut(const Vec &beta, double tsq) const
+        -> std::tuple<CutStatus, std::tuple<double, double, double>> {  // parallel cut
+        if (beta.size() < 2) {
+            return this->_helper.calc_bias_cut(beta[0], tsq);
+        }
+        return this->_helper.calc_parallel_bias_cut(beta[0], beta[1], tsq);
+    }
+
+    auto _central_cut(double, double tsq) const
+        -> std::tuple<CutStatus, std::tuple<double, double, double>> {
+        return this->_helper.calc_central_cut(tsq);
+    }
+
+    auto _central_cut(const Vec &beta, double tsq) const
+        -> std::tuple<CutStatus, std::tuple<double, double, double>> {  // parallel cut
+        if (beta.size() < 2) {
+            return this->_helper.calc_central_cut(tsq);
+        }
+        return this->_helper.calc_parallel_central_cut(beta[1], tsq);
+    }
+
+    auto _q_cut(double beta, double tsq) const
+        -> std::tuple<CutStatus, std::tuple<double, double, double>> {
+        return this->_helper.calc_bias_cut_q(beta, tsq);
+    }
+
+    auto _q_cut(const Vec &beta, double tsq) const
+        -> std::tuple<CutStatus, std::tuple<double, double, double>> {  // parallel cut
+        if (beta.size() < 2) {
+            return this->_helper.calc_bias_cut_q(beta[0], tsq);
+        }
+        return this->_helper.calc_parallel_bias_cut_q(beta[0], beta[1], tsq);
+    }
+};  // } EllFixed
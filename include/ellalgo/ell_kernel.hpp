@@ -0,0 +1,306 @@
+#pragma once
+
+#include <cstddef>  // for size_t
+
+template <typename T> class BasicSymMatrix;
+using SymMatrix = BasicSymMatrix<double>;
+using SymMatrixF = BasicSymMatrix<float>;
+
+/**
+ * @brief Dense kernels of the ellipsoid update on a packed `SymMatrix`
+ *
+ * These are the O(n^2) loops of `EllCore`. Each of them walks the packed
+ * columns one by one, and the work on a column is done by a SIMD primitive
+ * that is picked at runtime from the instruction sets supported by the CPU
+ * (AVX-512, AVX2, NEON, or a portable scalar fallback).
+ *
+ * The result does not depend on the instruction set that was picked: none
+ * of the code paths uses fused multiply-add, `sym_matvec` adds up every
+ * element in the same order as the plain loop, and the inner products of
+ * `lower_transpose_solve` are always split over the same eight lanes.
+ * Define `ELL_KERNEL_NO_SIMD` to build the scalar code only.
+ */
+namespace ell_kernel {
+
+    enum class Isa { Scalar, Avx2, Avx512, Neon };
+
+    constexpr size_t batch_block = 8U;  //!< the batched kernels take lanes 8 at a time
+
+    /**
+     * @brief The best instruction set supported by this CPU (and this build)
+     *
+     * @return Isa
+     */
+    extern auto best_isa() -> Isa;
+
+    /**
+     * @brief The instruction set currently used by the kernels
+     *
+     * @return Isa
+     */
+    extern auto active_isa() -> Isa;
+
+    /**
+     * @brief Select the instruction set used by the kernels
+     *
+     * Mainly for testing and benchmarking.
+     *
+     * @param[in] isa
+     * @return true if `isa` is supported and now active, false otherwise
+     */
+    extern auto set_isa(Isa isa) -> bool;
+
+    /**
+     * @brief Name of the instruction set, e.g. "avx2"
+     *
+     * @param[in] isa
+     * @return const char*
+     */
+    extern auto isa_name(Isa isa) -> const char *;
+
+    /**
+     * @brief Run the kernels on a large `SymMatrix` on several threads
+     *
+     * `sym_matvec`, `sym_update_matvec` and `sym_rank_one` then split a
+     * matrix of size at least `min_dim` over `num_threads` threads (the
+     * calling one included), which are created here and kept for the calls
+     * to come; 1, the default, makes them serial again. The product is done
+     * by square tiles, in waves along the anti-diagonals of the tiles, so
+     * that every element is still added up in the serial order: the results
+     * are bitwise the same as serial.
+     *
+     * One call at a time is parallel: a kernel called while another one
+     * runs on the threads, e.g. from `parallel_run`, is done serially. The
+     * kernels on `SymMatrixF`, and the others, are always serial.
+     *
+     * @param[in] num_threads
+     * @param[in] min_dim - below which the threads cost more than they save
+     */
+    extern auto set_num_threads(size_t num_threads, size_t min_dim = 1024U) -> void;
+
+    /**
+     * @brief The number of threads of the kernels, see `set_num_threads`
+     *
+     * @return size_t
+     */
+    extern auto num_threads() -> size_t;
+
+    /**
+     * @brief Run task(arg, tid, num) for tid = 0, ..., num - 1 on the threads of `set_num_threads`
+     *
+     * num is at most max_threads and `num_threads()`, the calling thread
+     * taking tid 0; the calls must be independent of each other. As for the
+     * kernels, one call at a time runs on the threads: if they are busy,
+     * only task(arg, 0, 1) is run, on the calling thread.
+     *
+     * @param[in] task
+     * @param[in] arg
+     * @param[in] max_threads
+     */
+    extern auto run_on_threads(void (*task)(const void *arg, size_t tid, size_t num),
+                               const void *arg, size_t max_threads) -> void;
+
+    /**
+     * @brief out = Q * g, returning g' * Q * g
+     *
+     * @param[in] mq - symmetric matrix Q
+     * @param[in] g - input vector of size n
+     * @param[out] out - output vector of size n
+     * @return double
+     */
+    extern auto sym_matvec(const SymMatrix &mq, const double *g, double *out) -> double;
+
+    /**
+     * @brief Q -= r * u * u', then out = Q * g, returning g' * Q * g
+     *
+     * The result is exactly that of `sym_rank_one` followed by `sym_matvec`,
+     * but each tile of Q is read and written only once.
+     *
+     * @param[in,out] mq - symmetric matrix Q
+     * @param[in] r
+     * @param[in] u - vector of size n
+     * @param[in] g - input vector of size n
+     * @param[out] out - output vector of size n
+     * @return double
+     */
+    extern auto sym_update_matvec(SymMatrix &mq, double r, const double *u, const double *g,
+                                  double *out) -> double;
+
+    /**
+     * @brief Q -= r * v * v'
+     *
+     * @param[in,out] mq - symmetric matrix Q
+     * @param[in] r
+     * @param[in] v - vector of size n
+     */
+    extern auto sym_rank_one(SymMatrix &mq, double r, const double *v) -> void;
+
+    /**
+     * @brief out[k] = Q * g[k], returning each g[k]' * Q * g[k] in omega[k]
+     *
+     * For a few vectors at a time, by panels of columns, each panel being
+     * read once from memory for all of them. Every vector gets exactly the
+     * result of `sym_matvec`.
+     *
+     * @param[in] mq - symmetric matrix Q
+     * @param[in] g - num input vectors of size n
+     * @param[out] out - num output vectors of size n
+     * @param[out] omega - of size num
+     * @param[in] num
+     */
+    extern auto sym_matvec_multi(const SymMatrix &mq, const double *const *g, double *const *out,
+                                 double *omega, size_t num) -> void;
+
+    /*
+     * The same three on a `SymMatrixF`: the elements are stored in float,
+     * but all the arithmetic is in double, each updated element being
+     * rounded to float once. The inner products are split over eight lanes
+     * (row mod 8), so that the result does not depend on the instruction set.
+     */
+
+    extern auto sym_matvec(const SymMatrixF &mq, const double *g, double *out) -> double;
+
+    extern auto sym_update_matvec(SymMatrixF &mq, double r, const double *u, const double *g,
+                                  double *out) -> double;
+
+    extern auto sym_rank_one(SymMatrixF &mq, double r, const double *v) -> void;
+
+    /**
+     * @brief x = inv(L) * x
+     *
+     * L is the unit lower triangular matrix stored in the strict lower
+     * triangle of `mq` (the diagonal is not referenced).
+     *
+     * @param[in] mq
+     * @param[in,out] x - vector of size n
+     */
+    extern auto lower_solve(const SymMatrix &mq, double *x) -> void;
+
+    /**
+     * @brief x = inv(L') * x
+     *
+     * @param[in] mq - see `lower_solve`
+     * @param[in,out] x - vector of size n
+     */
+    extern auto lower_transpose_solve(const SymMatrix &mq, double *x) -> void;
+
+    /**
+     * @brief Rank-one update of the factorized form of Q
+     *
+     * `mq` holds L in its strict lower triangle and inv(D) on its diagonal
+     * (see `EllCore`).
+     *
+     * @param[in,out] mq
+     * @param[in,out] v - initially the gradient g; overwritten (size n)
+     * @param[in] inv_lg - inv(L) * g
+     * @param[in] inv_d_inv_lg - inv(D) * inv(L) * g
+     * @param[in] oldt - initially omega / mu
+     */
+    extern auto ldl_rank_one(SymMatrix &mq, double *v, const double *inv_lg,
+                             const double *inv_d_inv_lg, double oldt) -> void;
+
+    /**
+     * @brief `ldl_rank_one` with v = g, then x = inv(L) * x with the new L
+     *
+     * In a single pass over `mq`. inv(L) * g and inv(D) * inv(L) * g are
+     * not needed: they are formed along the way, bitwise as `lower_solve`
+     * forms them, so that the result is exactly that of
+     * `ldl_rank_one(mq, v, inv_lg, inv_d_inv_lg, oldt)` followed by
+     * `lower_solve(mq, x)`.
+     *
+     * @param[in,out] mq - see `ldl_rank_one`
+     * @param[in,out] v - initially the gradient g; overwritten (size n)
+     * @param[in] oldt - initially omega / mu
+     * @param[in,out] x - vector of size n, or nullptr for the update alone
+     */
+    extern auto ldl_update_solve(SymMatrix &mq, double *v, double oldt, double *x) -> void;
+
+    /**
+     * @brief qg = Q * g and omega = g' * Q * g, for a batch of K instances
+     *
+     * The batch is in structure-of-arrays form (see `EllBatch`): the element
+     * i of the lane k of a vector is at `[i * stride + k]`, and the element
+     * (i, j) of a packed lower triangle (without padding) at
+     * `[(j * (2 * ndim + 1 - j) / 2 + i - j) * stride + k]`. Every lane gets
+     * exactly the result of `sym_matvec`.
+     *
+     * @param[in] mq - symmetric matrices Q
+     * @param[in] g - input vectors
+     * @param[out] qg - output vectors
+     * @param[out] omega - one per lane
+     * @param[in] ndim
+     * @param[in] stride - a multiple of `batch_block`
+     */
+    extern auto batch_matvec(const double *mq, const double *g, double *qg, double *omega,
+                             size_t ndim, size_t stride) -> void;
+
+    /**
+     * @brief Q -= r * qg * qg' and xc -= s * qg, for a batch of K instances
+     *
+     * See `batch_matvec` for the layout. Every lane gets exactly the result
+     * of `sym_rank_one`.
+     *
+     * @param[in,out] mq - symmetric matrices Q
+     * @param[in] qg - vectors
+     * @param[in] r - one per lane
+     * @param[in] s - one per lane
+     * @param[in,out] xc - vectors
+     * @param[in] ndim
+     * @param[in] stride - a multiple of `batch_block`
+     */
+    extern auto batch_rank_one(double *mq, const double *qg, const double *r, const double *s,
+                               double *xc, size_t ndim, size_t stride) -> void;
+
+    /**
+     * @brief The cuts of a batch of `ell1d` intervals, one per lane
+     *
+     * The active lanes k are updated as by `ell1d::update_central_cut` if
+     * central[k], and by `ell1d::update` otherwise; the others are left as
+     * they are. code[k] gets the status of an update, 0 (success), 1 (no
+     * sol'n) or 2 (no effect), in the order of `CutStatus`. Every lane gets
+     * exactly the result of `ell1d`.
+     *
+     * @param[in] g - one per lane
+     * @param[in] beta - one per lane
+     * @param[in] active - one per lane
+     * @param[in] central - one per lane
+     * @param[in,out] xc - centers
+     * @param[in,out] r - half-widths
+     * @param[in,out] tsq - one per lane
+     * @param[in,out] code - one per lane
+     * @param[in] stride - a multiple of `batch_block`
+     */
+    extern auto batch_interval_cut(const double *g, const double *beta, const bool *active,
+                                   const bool *central, double *xc, double *r, double *tsq,
+                                   double *code, size_t stride) -> void;
+
+    /**
+     * @brief y -= a[0] * alpha[0] + a[1] * alpha[1] + ... + a[num - 1] * alpha[num - 1]
+     *
+     * The terms are subtracted one by one, in this order, from every element.
+     *
+     * @param[in,out] y - vector of size len
+     * @param[in] a - num vectors of size len
+     * @param[in] alpha - num coefficients
+     * @param[in] num
+     * @param[in] len
+     */
+    extern auto sub_combination(double *y, const double *const *a, const double *alpha, size_t num,
+                                size_t len) -> void;
+
+    /**
+     * @brief acc[l] -= panel[k * batch_block + l] * v[k] for k = first, ..., last - 1 in order
+     *
+     * The panel holds `batch_block` rows of a matrix, column by column, so
+     * that a column is updated in one SIMD operation (see `LDLTMgr`).
+     *
+     * @param[in] panel - columns of `batch_block` elements
+     * @param[in] v - vector of size last
+     * @param[in,out] acc - `batch_block` elements
+     * @param[in] first
+     * @param[in] last
+     */
+    extern auto sub_panel(const double *panel, const double *v, double *acc, size_t first,
+                          size_t last) -> void;
+
+}  // namespace ell_kernel
@@ -0,0 +1,79 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <mutex>    // for mutex
+#include <vector>   // for vector
+
+/**
+ * @brief Where the storage of the shape matrices comes from
+ *
+ * As `std::pmr::memory_resource` of C++17, reduced to what `BasicSymMatrix`
+ * needs: a block is given back with the size it was asked for. A matrix
+ * keeps the resource it was built with, and its copies take the same one
+ * (see `BasicSymMatrix`), so the resource must outlive all of them.
+ */
+class MemoryResource {
+  public:
+    virtual ~MemoryResource() = default;
+
+    /**
+     * @brief A block of at least `bytes` bytes, aligned as `operator new`
+     *
+     * @param[in] bytes
+     * @return void*
+     */
+    virtual auto allocate(size_t bytes) -> void * = 0;
+
+    /**
+     * @brief Give back a block from `allocate(bytes)`
+     *
+     * @param[in] ptr
+     * @param[in] bytes
+     */
+    virtual auto deallocate(void *ptr, size_t bytes) noexcept -> void = 0;
+};
+
+/**
+ * @brief `operator new` and `operator delete`, the resource by default
+ *
+ * @return MemoryResource*
+ */
+auto default_resource() noexcept -> MemoryResource *;
+
+/**
+ * @brief Keeps the blocks given back, for the next requests of the same size
+ *
+ * Made for fan-out searches, where the same few sizes of ellipsoids are
+ * copied and dropped over and over (e.g. branch-and-bound): after the first
+ * round, a copy takes a block from the pool instead of `operator new`. The
+ * blocks only go back to the system when the pool is destroyed. The pool
+ * may be shared by threads.
+ */
+class PoolResource : public MemoryResource {
+    struct Bucket {
+        size_t bytes;
+        size_t num;  //!< number of blocks of this size
+        std::vector<void *> free;
+    };
+
+    std::vector<Bucket> _buckets;  //!< one per size, a few at most
+    std::vector<void *> _blocks;   //!< all blocks, for the destructor
+    std::mutex _mutex;
+
+  public:
+    PoolResource() = default;
+    ~PoolResource() override;
+    PoolResource(const PoolResource &) = delete;
+    PoolResource &operator=(const PoolResource &) = delete;
+
+    auto allocate(size_t bytes) -> void * override;
+    auto deallocate(void *ptr, size_t bytes) noexcept -> void override;
+
+    /**
+     * @brief Number of blocks taken from `operator new` so far
+     *
+     * @return size_t
+     */
+    auto num_blocks() -> size_t;
+};
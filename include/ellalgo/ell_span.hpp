@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>      // for size_t
+#include <type_traits>  // for enable_if, is_convertible
+
+/**
+ * @brief Non-owning view of a contiguous array (a minimal `std::span`)
+ *
+ * Used by the zero-copy cut interface: an oracle writes the gradient of a
+ * cut directly into the buffer of the search space (see `Ell::grad_buffer`).
+ *
+ * @tparam T element type, possibly const
+ */
+template <typename T> class Span {
+    T *_data = nullptr;
+    size_t _size = 0U;
+
+  public:
+    constexpr Span() noexcept = default;
+
+    /**
+     * @brief Construct a new Span object
+     *
+     * @param[in] data - pointer to the first element
+     * @param[in] size - number of elements
+     */
+    constexpr Span(T *data, size_t size) noexcept : _data{data}, _size{size} {}
+
+    /**
+     * @brief Conversion from Span<U>, e.g. from Span<double> to Span<const double>
+     *
+     * @param[in] other
+     */
+    template <typename U, typename = typename std::enable_if<
+                              std::is_convertible<U (*)[], T (*)[]>::value>::type>
+    constexpr Span(const Span<U> &other) noexcept : _data{other.data()}, _size{other.size()} {}
+
+    constexpr auto data() const noexcept -> T * { return this->_data; }
+
+    constexpr auto size() const noexcept -> size_t { return this->_size; }
+
+    constexpr auto empty() const noexcept -> bool { return this->_size == 0U; }
+
+    constexpr auto operator[](size_t idx) const noexcept -> T & { return this->_data[idx]; }
+
+    constexpr auto begin() const noexcept -> T * { return this->_data; }
+
+    constexpr auto end() const noexcept -> T * { return this->_data + this->_size; }
+};
+
+/**
+ * @brief View of a contiguous container with `operator[]` and `size()`
+ *        (e.g. `std::valarray` or `std::vector`)
+ *
+ * @tparam Arr
+ * @param[in] arr
+ * @return Span
+ */
+template <typename Arr> inline auto make_span(Arr &arr)
+    -> Span<typename std::remove_reference<decltype(arr[0])>::type> {
+    return {arr.size() != 0U ? &arr[0] : nullptr, static_cast<size_t>(arr.size())};
+}
@@ -2,11 +2,15 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 #include <tuple>
+#include <utility>
 #include <valarray>
 
+#include "ell_checkpoint.hpp"
 #include "ell_config.hpp"
 #include "ell_core.hpp"
+#include "ell_span.hpp"
 #include "ell_matrix.hpp"
 
 // forward declaration
@@ -24,10 +28,19 @@ template <typename Arr> class EllStable {
     using Vec = std::valarray<double>;
     using ArrayType = Arr;
 
+    /**
+     * @brief The centre and the core of an EllStable object
+     */
+    struct Snapshot {
+        Arr xc;
+        EllCore::Snapshot core;
+    };
+
   private:
     const size_t _n;
     Arr _xc;
     EllCore _mgr;
+    Vec _g;  //!< workspace for the gradient
 
     /**
      * @brief Construct a new EllStable object
@@ -40,6 +53,15 @@ template <typename Arr> class EllStable {
      */
     auto operator=(const EllStable &E) -> EllStable & = delete;
 
+    /**
+     * @brief Construct a new EllStable object from a centre and a core, see `copy`
+     *
+     * @param[in] x
+     * @param[in] mgr
+     */
+    EllStable(Arr x, EllCore &&mgr)
+        : _n{x.size()}, _xc{std::move(x)}, _mgr{std::move(mgr)}, _g(_n) {}
+
   public:
     /**
      * @brief Construct a new EllStable object
@@ -52,7 +74,8 @@ template <typename Arr> class EllStable {
      * @param[in] x x is an object of type Arr, which is likely an array or vector. It is being
      * passed by value to the constructor of the EllStable class.
      */
-    EllStable(const Vec &val, Arr x) : _n{x.size()}, _xc{std::move(x)}, _mgr(val, _n) {}
+    EllStable(const Vec &val, Arr x)
+        : _n{x.size()}, _xc{std::move(x)}, _mgr(val, _n), _g(_n) {}
 
     /**
      * @brief Construct a new EllStable object
@@ -66,7 +89,8 @@ template <typename Arr> class EllStable {
      * kind. It is being passed by value, meaning a copy of the `x` object will be made and stored
      * in the `_xc` member variable of the `EllStable` object being constructed.
      */
-    EllStable(const double &alpha, Arr x) : _n{x.size()}, _xc{std::move(x)}, _mgr(alpha, _n) {}
+    EllStable(const double &alpha, Arr x)
+        : _n{x.size()}, _xc{std::move(x)}, _mgr(alpha, _n), _g(_n) {}
 
     /**
      * @brief Construct a new EllStable object
@@ -101,11 +125,90 @@ template <typename Arr> class EllStable {
     auto copy() const -> EllStable { return EllStable(*this); }
 
     /**
-     * @brief copy the whole array anyway
+     * @brief explicitly copy, with the matrix from the given resource (e.g. a `PoolResource`)
      *
-     * @return Arr
+     * @param[in] res
+     * @return EllStable
+     */
+    auto copy(MemoryResource &res) const -> EllStable {
+        return EllStable(this->_xc, this->_mgr.copy(res));
+    }
+
+    /**
+     * @brief Copy into an object of the same dimension, without allocation
+     *
+     * E.g. to start the searches of a fan-out from the same space again and
+     * again, into the same few objects.
+     *
+     * @param[out] dst
+     */
+    void copy_into(EllStable &dst) const {
+        dst._xc = this->_xc;
+        this->_mgr.copy_into(dst._mgr);
+    }
+
+    /**
+     * @brief Allocate a snapshot of the current state
+     *
+     * @return Snapshot
      */
-    auto xc() const -> Arr { return this->_xc; }
+    auto snapshot() const -> Snapshot { return Snapshot{this->_xc, this->_mgr.snapshot()}; }
+
+    /**
+     * @brief Save the current state into a snapshot, without allocation
+     *
+     * @param[out] snap - obtained from `snapshot` of an object of the same dimension
+     */
+    void checkpoint(Snapshot &snap) const {
+        snap.xc = this->_xc;
+        this->_mgr.checkpoint(snap.core);
+    }
+
+    /**
+     * @brief Go back to the state saved in a snapshot, without allocation
+     *
+     * @param[in] snap - obtained from `snapshot` of an object of the same dimension
+     */
+    void restore(const Snapshot &snap) {
+        this->_xc = snap.xc;
+        this->_mgr.restore(snap.core);
+    }
+
+    /**
+     * @brief Append the state to a checkpoint file, see `CheckpointWriter`
+     *
+     * @param[in,out] out
+     */
+    void save(CheckpointWriter &out) const {
+        out.write_value(checkpoint_tag::ell_stable);
+        out.write_value(std::uint64_t(this->_n));
+        out.write(&this->_xc[0], this->_n * sizeof(double));
+        this->_mgr.save(out);
+    }
+
+    /**
+     * @brief Go back to the state saved by `save`, in an object of the same dimension
+     *
+     * Continues bit for bit as the object that was saved.
+     *
+     * @param[in,out] in
+     * @throws std::runtime_error if the record is not that of such an EllStable
+     */
+    void load(CheckpointFile &in) {
+        in.expect(checkpoint_tag::ell_stable, "record");
+        in.expect(this->_n, "dimension");
+        in.read(&this->_xc[0], this->_n * sizeof(double));
+        this->_mgr.load(in);
+    }
+
+    /**
+     * @brief The centre, without a copy
+     *
+     * Valid until the next update; copy it to keep it.
+     *
+     * @return const Arr&
+     */
+    auto xc() const -> const Arr & { return this->_xc; }
 
     /**
      * @brief Set the xc object
@@ -121,6 +224,20 @@ template <typename Arr> class EllStable {
      */
     auto tsq() const -> double { return this->_mgr.tsq(); }
 
+    /**
+     * @brief The log of the volume of the ellipsoid, see `EllCore::log_volume`
+     *
+     * @return double
+     */
+    auto log_volume() const -> double { return this->_mgr.log_volume(); }
+
+    /**
+     * @brief Apply the pending update of the ellipsoid now, see `EllCore::flush`
+     *
+     * Only touches the core, so that it may run while an oracle reads `xc()`.
+     */
+    void flush() { this->_mgr.flush(); }
+
     /**
      * The function sets the value of the use_parallel_cut property in the _mgr object.
      *
@@ -129,6 +246,20 @@ template <typename Arr> class EllStable {
      */
     void set_use_parallel_cut(bool value) { this->_mgr.set_use_parallel_cut(value); }
 
+    /**
+     * @brief Choose between a parallel cut and a single one, see `EllCalc::adaptive_parallel_cut`
+     *
+     * @param[in] value
+     */
+    void set_adaptive_parallel_cut(bool value) { this->_mgr.set_adaptive_parallel_cut(value); }
+
+    /**
+     * @brief The calculator of the cuts, e.g. for its counters
+     *
+     * @return const EllCalc&
+     */
+    auto calc() const -> const EllCalc & { return this->_mgr.calc(); }
+
     /**
      * @brief Update ellipsoid core function using the deep cut(s)
      *
@@ -140,9 +271,7 @@ template <typename Arr> class EllStable {
      * @return std::tuple<int, double>
      */
     template <typename T> auto update_bias_cut(const std::pair<Arr, T> &cut) -> CutStatus {
-        return this->_update_core(cut, [this](Vec &grad, const T &beta) {
-            return this->_mgr.update_stable_bias_cut(grad, beta);
-        });
+        return this->update_bias_cut(make_span(cut.first), cut.second);
     }
 
     /**
@@ -156,9 +285,7 @@ template <typename Arr> class EllStable {
      * @return std::tuple<int, double>
      */
     template <typename T> auto update_central_cut(const std::pair<Arr, T> &cut) -> CutStatus {
-        return this->_update_core(cut, [this](Vec &grad, const T &beta) {
-            return this->_mgr.update_stable_central_cut(grad, beta);
-        });
+        return this->update_central_cut(make_span(cut.first), cut.second);
     }
 
     /**
@@ -172,8 +299,62 @@ template <typename Arr> class EllStable {
      * @return std::tuple<int, double>
      */
     template <typename T> auto update_q(const std::pair<Arr, T> &cut) -> CutStatus {
-        return this->_update_core(cut, [this](Vec &grad, const T &beta) {
-            return this->_mgr.update_stable_q(grad, beta);
+        return this->update_q(make_span(cut.first), cut.second);
+    }
+
+    /**
+     * @brief Buffer for the gradient of the next cut
+     *
+     * An oracle may write the gradient directly into this buffer and pass it
+     * to the `Span` overloads of the update functions, which then copy
+     * nothing. The buffer is overwritten by every update.
+     *
+     * @return Span<double> of size n
+     */
+    auto grad_buffer() -> Span<double> { return make_span(this->_g); }
+
+    /**
+     * @brief Update ellipsoid core function using the deep cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_bias_cut(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](Vec &g, const T &beta_l) {
+            return this->_mgr.update_stable_bias_cut(g, beta_l);
+        });
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the central cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_central_cut(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](Vec &g, const T &beta_l) {
+            return this->_mgr.update_stable_central_cut(g, beta_l);
+        });
+    }
+
+    /**
+     * @brief Update ellipsoid core function using the cut(s), given by a view
+     *
+     * @tparam T
+     * @param[in] grad gradient, possibly `grad_buffer()`
+     * @param[in] beta
+     * @return CutStatus
+     */
+    template <typename T>
+    auto update_q(Span<const double> grad, const T &beta) -> CutStatus {
+        return this->_update_core(grad, beta, [this](Vec &g, const T &beta_l) {
+            return this->_mgr.update_stable_q(g, beta_l);
         });
     }
 
@@ -185,16 +366,17 @@ template <typename Arr> class EllStable {
      * to update the ellipsoid core function using a cutting plane.
      *
      * @tparam T
-     * @param[in] cut cutting-plane
-     * @return std::tuple<int, double>
+     * @param[in] grad gradient
+     * @param[in] beta
+     * @return CutStatus
      */
     template <typename T, typename Fn>
-    auto _update_core(const std::pair<Arr, T> &cut, Fn &&cut_strategy) -> CutStatus {
-        const auto &grad = cut.first;
-        const auto &beta = cut.second;
-        std::valarray<double> g(this->_n);
-        for (auto i = 0U; i != this->_n; ++i) {
-            g[i] = grad[i];
+    auto _update_core(Span<const double> grad, const T &beta, Fn &&cut_strategy) -> CutStatus {
+        auto &g = this->_g;  // no allocation
+        if (grad.data() != &g[0]) {  // not written in place
+            for (auto i = 0U; i != this->_n; ++i) {
+                g[i] = grad[i];
+            }
         }
 
         auto result = cut_strategy(g, beta);
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uintptr_t
+#include <utility>  // for swap
+#include <valarray>
+
+#include "ell_memory.hpp"
+
+/**
+ * @brief Symmetric matrix in packed lower-triangular storage
+ *
+ * Only the lower triangle (including the diagonal) is stored, column by
+ * column, in the same order as the BLAS/LAPACK packed format with
+ * UPLO = 'L'. In addition, every column starts at a cache-line boundary, so
+ * that a column can be streamed by the SIMD kernels without a split load:
+ *
+ *     | q00                |      column 0: q00 q10 q20 q30 [pad]
+ *     | q10 q11            |      column 1: q11 q21 q31 [pad]
+ *     | q20 q21 q22        |      column 2: q22 q32 [pad]
+ *     | q30 q31 q32 q33    |      column 3: q33 [pad]
+ *
+ * The padding is up to `col_align` - 1 elements per column, about half a
+ * cache line on average, so that it only pays off for large matrices: the
+ * storage is about half of the full `Matrix` for n in the hundreds (5408
+ * doubles for n = 100, against 10000), the same at n = `col_align` (8 for
+ * double, 16 for float), and more below, with a whole cache line per
+ * column (16 doubles for n = 2, against 4).
+ *
+ * The elements are of type T, double (`SymMatrix`) or float (`SymMatrixF`);
+ * the scalars given to the member functions are double either way.
+ *
+ * The buffer comes from a `MemoryResource`, `operator new` by default, e.g.
+ * a `PoolResource` to copy the matrices of a fan-out search without going
+ * to malloc. A copy takes the resource of the original.
+ *
+ * @tparam T
+ */
+template <typename T> class BasicSymMatrix {
+  public:
+    static constexpr size_t cache_line = 64U;
+    static constexpr size_t col_align = cache_line / sizeof(T);  //!< elements per cache line
+
+  private:
+    size_t _ndim;
+    size_t _size;  //!< number of stored elements (including the padding)
+    MemoryResource *_res;
+    void *_raw = nullptr;
+    T *_data = nullptr;
+
+  public:
+    /**
+     * Constructor to create a new SymMatrix object.
+     *
+     * Example:
+     * @code{.cpp}
+     * SymMatrix A(3);
+     * @endcode
+     *
+     * @param[in] ndim - The dimension of the matrix (number of rows/columns)
+     * @param[in] init - Optional initial value for all elements. Default is 0.0.
+     * @param[in] res - Where the buffer comes from, see `MemoryResource`
+     */
+    explicit BasicSymMatrix(size_t ndim, double init = 0.0,
+                            MemoryResource *res = default_resource())
+        : _ndim{ndim}, _size{BasicSymMatrix::offset(ndim, ndim)}, _res{res} {
+        this->_allocate();
+        this->clear(init);
+    }
+
+    /**
+     * @brief Copy constructor
+     *
+     * @param[in] other
+     */
+    BasicSymMatrix(const BasicSymMatrix &other)
+        : _ndim{other._ndim}, _size{other._size}, _res{other._res} {
+        this->_allocate();
+        this->_copy_from(other);
+    }
+
+    /**
+     * @brief Move constructor
+     *
+     * @param[in] other
+     */
+    BasicSymMatrix(BasicSymMatrix &&other) noexcept
+        : _ndim{other._ndim},
+          _size{other._size},
+          _res{other._res},
+          _raw{other._raw},
+          _data{other._data} {
+        other._raw = nullptr;
+        other._data = nullptr;
+        other._size = 0U;
+        other._ndim = 0U;
+    }
+
+    /**
+     * @brief Copy assignment
+     *
+     * The existing buffer is reused if the dimensions agree, so that copying
+     * a matrix of the same size never allocates. The resource stays as it is.
+     *
+     * @param[in] other
+     * @return BasicSymMatrix&
+     */
+    BasicSymMatrix &operator=(const BasicSymMatrix &other) {
+        if (this != &other) {
+            if (this->_size != other._size) {
+                this->_release();
+                this->_size = other._size;
+                this->_allocate();
+            }
+            this->_ndim = other._ndim;
+            this->_copy_from(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Move assignment
+     *
+     * @param[in] other
+     * @return BasicSymMatrix&
+     */
+    BasicSymMatrix &operator=(BasicSymMatrix &&other) noexcept {
+        std::swap(this->_ndim, other._ndim);
+        std::swap(this->_size, other._size);
+        std::swap(this->_res, other._res);
+        std::swap(this->_raw, other._raw);
+        std::swap(this->_data, other._data);
+        return *this;
+    }
+
+    ~BasicSymMatrix() { this->_release(); }
+
+    /**
+     * @brief Offset of the column `col` in a packed matrix of dimension `ndim`
+     *
+     * Each column `k` occupies `ndim - k` elements rounded up to whole cache
+     * lines, so the offset has a closed form and needs no lookup table.
+     *
+     * @param[in] ndim - The dimension of the matrix
+     * @param[in] col - The column index (0 <= col <= ndim)
+     * @return size_t
+     */
+    static constexpr auto offset(size_t ndim, size_t col) -> size_t {
+        return BasicSymMatrix::_padded_sum(ndim) - BasicSymMatrix::_padded_sum(ndim - col);
+    }
+
+    /**
+     * @brief The dimension of the matrix
+     *
+     * @return size_t
+     */
+    auto size() const noexcept -> size_t { return this->_ndim; }
+
+    /**
+     * @brief Number of stored elements, including the padding
+     *
+     * @return size_t
+     */
+    auto storage_size() const noexcept -> size_t { return this->_size; }
+
+    /**
+     * @brief Where the buffer comes from
+     *
+     * @return MemoryResource*
+     */
+    auto resource() const noexcept -> MemoryResource * { return this->_res; }
+
+    /**
+     * @brief Raw access to the packed buffer
+     *
+     * @return T*
+     */
+    auto data() noexcept -> T * { return this->_data; }
+
+    /**
+     * @brief Raw access to the packed buffer (read-only)
+     *
+     * @return const T*
+     */
+    auto data() const noexcept -> const T * { return this->_data; }
+
+    /**
+     * Returns a pointer to the stored part of column `col`, i.e. the elements
+     * (col, col), (col + 1, col), ..., (ndim - 1, col), which are contiguous.
+     *
+     * @param[in] col - Column index
+     * @return T*
+     */
+    auto column(size_t col) noexcept -> T * {
+        return this->_data + BasicSymMatrix::offset(this->_ndim, col);
+    }
+
+    /**
+     * Returns a pointer to the stored part of column `col` (read-only).
+     *
+     * @param[in] col - Column index
+     * @return const T*
+     */
+    auto column(size_t col) const noexcept -> const T * {
+        return this->_data + BasicSymMatrix::offset(this->_ndim, col);
+    }
+
+    /**
+     * Operator overload to access elements using 2D array syntax. Since the
+     * matrix is symmetric, (row, col) and (col, row) refer to the same
+     * stored element.
+     *
+     * Example:
+     * @code{.cpp}
+     * SymMatrix A(2);
+     * A(1, 0) = 3.0;
+     * assert(A(0, 1) == 3.0);
+     * @endcode
+     *
+     * @param[in] row - Row index to access
+     * @param[in] col - Column index to access
+     * @return Reference to the element at the given row and column.
+     */
+    T &operator()(size_t row, size_t col) noexcept {
+        return row >= col ? this->column(col)[row - col] : this->column(row)[col - row];
+    }
+
+    /**
+     * Read-only accessor for matrix elements using 2D array syntax.
+     *
+     * @param[in] row - Row index
+     * @param[in] col - Column index
+     * @return Constant reference to element at (row, col)
+     */
+    const T &operator()(size_t row, size_t col) const noexcept {
+        return row >= col ? this->column(col)[row - col] : this->column(row)[col - row];
+    }
+
+    /**
+     * Sets all elements of the matrix to the given value.
+     *
+     * @param[in] value - The value to set all elements to. Defaults to 0.0.
+     */
+    void clear(double value = 0.0) {
+        for (auto j = 0U; j != this->_ndim; ++j) {
+            auto *col = this->column(j);
+            const auto len = BasicSymMatrix::_padded(this->_ndim - j);
+            for (auto k = 0U; k != len; ++k) {
+                col[k] = T(k < this->_ndim - j ? value : 0.0);  // keep the padding zero
+            }
+        }
+    }
+
+    /**
+     * Sets the matrix to be an identity matrix.
+     */
+    void identity() {
+        this->clear();
+        for (auto j = 0U; j != this->_ndim; ++j) {
+            this->column(j)[0] = T(1);
+        }
+    }
+
+    /**
+     * Sets the diagonal elements of the matrix.
+     *
+     * @param[in] val - The new diagonal elements
+     */
+    void set_diagonal(const std::valarray<double> &val) {
+        for (auto j = 0U; j != this->_ndim; ++j) {
+            this->column(j)[0] = T(val[j]);
+        }
+    }
+
+    /**
+     * Multiplies each element of the matrix by the given scalar value.
+     *
+     * @param[in] alpha - The scalar value to multiply each element by.
+     * @return Reference to this matrix after multiplication.
+     */
+    BasicSymMatrix &operator*=(double alpha) {
+        for (auto k = 0U; k != this->_size; ++k) {
+            this->_data[k] = T(this->_data[k] * alpha);
+        }
+        return *this;
+    }
+
+    /**
+     * Calculates the trace of the matrix, which is the sum of the diagonal elements.
+     *
+     * @return The trace of the matrix as a double.
+     */
+    double trace() const {
+        auto res = 0.0;
+        for (auto j = 0U; j != this->_ndim; ++j) {
+            res += this->column(j)[0];
+        }
+        return res;
+    }
+
+  private:
+    static constexpr auto _padded(size_t len) -> size_t {
+        return (len + col_align - 1U) / col_align * col_align;
+    }
+
+    /** Sum of _padded(m) for m = 1, ..., len */
+    static constexpr auto _padded_sum(size_t len) -> size_t {
+        return col_align * (col_align * (len / col_align) * (len / col_align + 1U) / 2U
+                            + (len % col_align) * (len / col_align + 1U));
+    }
+
+    void _allocate() {
+        if (this->_size == 0U) {
+            return;
+        }
+        this->_raw = this->_res->allocate(this->_size * sizeof(T) + cache_line);
+        const auto addr = reinterpret_cast<std::uintptr_t>(this->_raw);
+        const auto aligned = (addr + cache_line - 1U) / cache_line * cache_line;
+        this->_data = reinterpret_cast<T *>(aligned);
+    }
+
+    void _release() noexcept {
+        if (this->_raw != nullptr) {
+            this->_res->deallocate(this->_raw, this->_size * sizeof(T) + cache_line);
+        }
+        this->_raw = nullptr;
+        this->_data = nullptr;
+    }
+
+    void _copy_from(const BasicSymMatrix &other) {
+        for (auto k = 0U; k != this->_size; ++k) {
+            this->_data[k] = other._data[k];
+        }
+    }
+};
+
+template <typename T> constexpr size_t BasicSymMatrix<T>::cache_line;
+template <typename T> constexpr size_t BasicSymMatrix<T>::col_align;
+
+using SymMatrix = BasicSymMatrix<double>;
+using SymMatrixF = BasicSymMatrix<float>;  //!< for `Ell<Arr, float>`
@@ -0,0 +1,66 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <valarray>
+#include <vector>
+
+/**
+ * @brief The upper triangles of n symmetric matrices F[0], ..., F[n - 1], interleaved
+ *
+ * The elements F[0](i, j), ..., F[n - 1](i, j) are stored next to each
+ * other, and the (i, j) come row by row, so that a quadratic form can be
+ * evaluated for all the matrices at once, in a single pass over the data
+ * with unit stride (see `LDLTMgr::sym_quad_all`).
+ */
+class InterleavedMats {
+    using Vec = std::valarray<double>;
+
+    size_t _m;  //!< dimension of the matrices
+    size_t _n;  //!< number of matrices
+    Vec _data;
+
+  public:
+    /**
+     * @brief Construct a new interleaved mats object
+     *
+     * @tparam Mat
+     * @param[in] F
+     * @param[in] m dimension of the matrices
+     */
+    template <typename Mat>
+    InterleavedMats(const std::vector<Mat> &F, size_t m)
+        : _m{m}, _n{F.size()}, _data(m * (m + 1) / 2 * F.size()) {
+        for (auto i = 0U; i != m; ++i) {
+            for (auto j = i; j != m; ++j) {
+                auto *blk = &this->_data[this->_offset(i, j)];
+                for (auto k = 0U; k != this->_n; ++k) {
+                    blk[k] = F[k](i, j);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Number of matrices
+     *
+     * @return size_t
+     */
+    auto num_mats() const -> size_t { return this->_n; }
+
+    /**
+     * @brief F[0](i, j), ..., F[n - 1](i, j), for i <= j
+     *
+     * @param[in] i
+     * @param[in] j
+     * @return const double*
+     */
+    auto block(size_t i, size_t j) const -> const double * {
+        return &this->_data[this->_offset(i, j)];
+    }
+
+  private:
+    auto _offset(size_t i, size_t j) const -> size_t {
+        return (i * (2 * this->_m - i + 1) / 2 + j - i) * this->_n;
+    }
+};
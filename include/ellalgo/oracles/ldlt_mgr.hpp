@@ -1,13 +1,19 @@
 // -*- coding: utf-8 -*-
 #pragma once
 
-#include <cassert>  // for assert
-#include <cstddef>  // for size_t
+#include <algorithm>  // for min
+#include <cassert>    // for assert
+#include <cstddef>    // for size_t
 #include <functional>
 #include <utility>  // for pair
 #include <valarray>
+#include <vector>  // for vector
 
+#include "../ell_kernel.hpp"
 #include "../ell_matrix.hpp"
+#include "../ell_span.hpp"
+#include "interleaved_mats.hpp"
+#include "structured_sym.hpp"
 
 /**
  * @brief LDLT factorization
@@ -25,6 +31,19 @@
  *  - A matrix A in R^{m x m} is positive definite iff v' A v > 0
  *      for all v in R^n.
  *  - O(pos^2) per iteration, independent of N
+ *
+ * The factorization is left-looking, and takes the rows `batch_block` at a
+ * time: the part of a block left of the diagonal is computed column by
+ * column, each row of L D of the rows above being read once for the whole
+ * block, and the columns of the block updated by a SIMD kernel. Every
+ * element is still summed in the same order as in the row-by-row
+ * elimination, so that the result does not depend on the blocking. Only
+ * the elements of a block past the first non-positive pivot are
+ * evaluated in vain.
+ *
+ * The rows of the factors stay valid between the calls, so that a caller
+ * who knows that the leading rows of A have not changed may resume the
+ * factorization after them, see `factor(get_matrix_elem, num_same)`.
  */
 class LDLTMgr {
     using Vec = std::valarray<double>;
@@ -36,7 +55,12 @@ class LDLTMgr {
     const size_t _n;  //!< dimension
 
   private:
-    Matrix T;  //!< temporary storage
+    Matrix T;    //!< L in the strict lower triangle, D on the diagonal, L D above
+    Vec _panel;  //!< L of the current block of rows, column by column
+    size_t _num_valid = 0U;  //!< leading rows of T that are final, with pos.first = 0
+    // the rows and the weights of `sym_quad_all`, N per thread
+    mutable std::vector<const double *> _quad_rows;
+    mutable std::vector<double> _quad_alpha;
 
   public:
     /**
@@ -44,7 +68,13 @@ class LDLTMgr {
      *
      * @param[in] N dimension
      */
-    explicit LDLTMgr(size_t N) : witness_vec(0.0, N), _n{N}, T{N} {}
+    explicit LDLTMgr(size_t N)
+        : witness_vec(0.0, N),
+          _n{N},
+          T{N},
+          _panel(0.0, N * ell_kernel::batch_block),
+          _quad_rows(N),
+          _quad_alpha(N) {}
 
     LDLTMgr(const LDLTMgr &) = delete;
     LDLTMgr &operator=(const LDLTMgr &) = delete;
@@ -79,6 +109,40 @@ class LDLTMgr {
      */
     auto factor(const std::function<double(size_t, size_t)> &get_matrix_elem) -> bool;
 
+    /**
+     * @brief Perform LDLT Factorization (Lazy evaluation), inlining the element access
+     *
+     * The same as above, but `get_matrix_elem` may be any callable, and is
+     * called directly instead of through `std::function`.
+     *
+     * @tparam Fn callable as `double(size_t, size_t)`
+     * @param[in] get_matrix_elem function to access the elements of A
+     * @return true
+     * @return false
+     */
+    template <typename Fn> auto factor(Fn &&get_matrix_elem) -> bool {
+        return this->_factor<false>(get_matrix_elem, 0U);
+    }
+
+    /**
+     * @brief Perform LDLT Factorization (Lazy evaluation), reusing a leading block
+     *
+     * The caller asserts that the rows [0, num_same) of A are the same as in
+     * the previous call. The rows of the factors that that call has finished
+     * among them (those before its failing pivot, or all of them) are kept,
+     * and only the trailing rows are factored, with the same result as
+     * `factor(get_matrix_elem)`.
+     *
+     * @tparam Fn callable as `double(size_t, size_t)`
+     * @param[in] get_matrix_elem function to access the elements of A
+     * @param[in] num_same number of leading rows of A unchanged since the previous call
+     * @return true
+     * @return false
+     */
+    template <typename Fn> auto factor(Fn &&get_matrix_elem, size_t num_same) -> bool {
+        return this->_factor<false>(get_matrix_elem, num_same);
+    }
+
     /**
      * @brief Perform LDLT Factorization (Lazy evaluation)
      *
@@ -91,6 +155,34 @@ class LDLTMgr {
     auto factor_with_allow_semidefinite(
         const std::function<double(size_t, size_t)> &get_matrix_elem) -> bool;
 
+    /**
+     * @brief Perform LDLT Factorization (Lazy evaluation), inlining the element access
+     *
+     * @tparam Fn callable as `double(size_t, size_t)`
+     * @param[in] get_matrix_elem function to access the elements of A
+     * @return true
+     * @return false
+     */
+    template <typename Fn> auto factor_with_allow_semidefinite(Fn &&get_matrix_elem) -> bool {
+        return this->_factor<true>(get_matrix_elem, 0U);
+    }
+
+    /**
+     * @brief Perform LDLT Factorization (Lazy evaluation), reusing a leading block
+     *
+     * @tparam Fn callable as `double(size_t, size_t)`
+     * @param[in] get_matrix_elem function to access the elements of A
+     * @param[in] num_same number of leading rows of A unchanged since the previous call
+     * @return true
+     * @return false
+     *
+     * See also: factor(get_matrix_elem, num_same)
+     */
+    template <typename Fn>
+    auto factor_with_allow_semidefinite(Fn &&get_matrix_elem, size_t num_same) -> bool {
+        return this->_factor<true>(get_matrix_elem, num_same);
+    }
+
     /**
      * @brief Is $A$ symmetric positive definite (spd)
      *
@@ -146,6 +238,45 @@ class LDLTMgr {
         return res;
     }
 
+    /**
+     * @brief Calculate v'*{A}(pos,pos)*v, in O(nnz)
+     *
+     * @param[in] A
+     * @return double
+     */
+    auto sym_quad(const SparseSym &A) const -> double {
+        return A.quad(this->witness_vec, this->pos.first, this->pos.second);
+    }
+
+    /**
+     * @brief Calculate v'*{A}(pos,pos)*v, in O(rank * (stop - start))
+     *
+     * @param[in] A
+     * @return double
+     */
+    auto sym_quad(const LowRankSym &A) const -> double {
+        return A.quad(this->witness_vec, this->pos.first, this->pos.second);
+    }
+
+    /**
+     * @brief Calculate v'*{F[k]}(pos,pos)*v for all k at once
+     *
+     * The same as `grad[k] = sym_quad(F[k])` for every k, in one pass over
+     * the interleaved matrices: the products v[i] v[j] are applied to the n
+     * elements (i, j) together by a SIMD kernel. The sums are taken in a
+     * different order, so that the results may differ from `sym_quad` in
+     * the last bits. The range of k may be split over up to `num_threads`
+     * of the persistent threads of `ell_kernel::set_num_threads`, without
+     * changing the results. The workspace is kept between the calls, so
+     * that, once grown to the threads, a call does not allocate.
+     *
+     * @param[in] F
+     * @param[out] grad of size `F.num_mats()`
+     * @param[in] num_threads
+     */
+    auto sym_quad_all(const InterleavedMats &F, Span<double> grad, size_t num_threads = 1U) const
+        -> void;
+
     /**
      * @brief Return upper triangular matrix $R$ where $A = R^T R$
      *
@@ -167,4 +298,106 @@ class LDLTMgr {
             }
         }
     }
+
+  private:
+    /**
+     * @brief The LDLT factorization behind `factor` and `factor_with_allow_semidefinite`
+     *
+     * @tparam AllowSemidefinite restart after a zero pivot, special as an LMI oracle
+     * @tparam Fn
+     * @param[in] get_matrix_elem function to access the elements of A
+     * @param[in] num_same number of leading rows of A unchanged since the previous call
+     * @return true
+     * @return false
+     */
+    template <bool AllowSemidefinite, typename Fn>
+    auto _factor(Fn &get_matrix_elem, size_t num_same) -> bool {
+        constexpr auto w = ell_kernel::batch_block;
+        this->pos = {0U, 0U};
+        auto &start = this->pos.first;
+        auto &stop = this->pos.second;
+        auto *panel = &this->_panel[0];
+
+        for (auto i0 = std::min(num_same, this->_num_valid); i0 != this->_n;) {
+            const auto i1 = std::min(i0 + w, this->_n);
+
+            // the columns [start, i0) of the rows [i0, i1)
+            for (auto s = start; s != i0; ++s) {
+                double acc[w] = {};
+                for (auto i = i0; i != i1; ++i) {
+                    acc[i - i0] = get_matrix_elem(i, s);
+                }
+                ell_kernel::sub_panel(panel, this->_ld_row(s), acc, start, s);
+                for (auto i = i0; i != i1; ++i) {
+                    const auto d = acc[i - i0];
+                    this->_ld_row(i)[s] = d;
+                    this->T(i, s) = panel[s * w + i - i0] = d / this->T(s, s);
+                }
+            }
+
+            // the diagonal block, row by row
+            auto next = i1;
+            for (auto i = i0; i != i1 && next == i1; ++i) {
+                for (auto s = i0; s != i; ++s) {
+                    auto d = get_matrix_elem(i, s);
+                    const auto *ld_s = this->_ld_row(s);
+                    for (auto k = start; k != s; ++k) {
+                        d -= this->T(i, k) * ld_s[k];
+                    }
+                    this->_ld_row(i)[s] = d;
+                    this->T(i, s) = d / this->T(s, s);
+                }
+                auto d = get_matrix_elem(i, i);
+                const auto *ld_i = this->_ld_row(i);
+                for (auto k = start; k != i; ++k) {
+                    d -= this->T(i, k) * ld_i[k];
+                }
+                this->T(i, i) = d;
+
+                if (AllowSemidefinite ? d < 0.0 : d <= 0.0) {
+                    if (start == 0U) {
+                        this->_num_valid = i;
+                    }
+                    stop = i + 1;
+                    return false;
+                }
+                if (AllowSemidefinite && d == 0.0) {
+                    if (start == 0U) {
+                        this->_num_valid = i;
+                    }
+                    start = i + 1;
+                    next = start;  // restart at i + 1, special as an LMI oracle
+                }
+            }
+            i0 = next;
+        }
+        if (start == 0U) {
+            this->_num_valid = this->_n;
+        }
+        return this->is_spd();
+    }
+
+    /**
+     * @brief Row s of L D, i.e. the elements (s, 0), ..., (s, s - 1)
+     *
+     * It is kept in the upper triangle of the row n - 1 - s of T, which has
+     * exactly s elements, so that it can be read contiguously.
+     *
+     * @param[in] s
+     * @return double*
+     */
+    auto _ld_row(size_t s) -> double * {
+        return &this->T(0, 0) + (this->_n - s) * this->_n - s;
+    }
+
+    struct QuadJob;
+
+    /**
+     * @brief The share of the thread tid of `sym_quad_all`, of num_threads
+     *
+     * @param[in] arg the `QuadJob`
+     * @param[in] tid
+     * @param[in] num_threads
+     */
+    static auto _quad_share(const void *arg, size_t tid, size_t num_threads) -> void;
 };
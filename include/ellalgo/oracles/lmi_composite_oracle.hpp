@@ -0,0 +1,154 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <atomic>   // for atomic
+#include <cmath>    // for sqrt
+#include <cstddef>  // for size_t
+#include <memory>   // for unique_ptr
+#include <utility>  // for pair, move
+#include <vector>
+
+#include "../ell_kernel.hpp"
+#include "lmi_oracle.hpp"
+
+/**
+ * @brief Oracle for several independent Linear Matrix Inequalities
+ *
+ *    This oracle solves the following feasibility problem:
+ *
+ *        find  x
+ *        s.t.  (B_k - F_k * x) >= 0,  k = 0, ..., K - 1
+ *
+ * The blocks may be assessed together, on up to `num_threads` of the
+ * persistent threads of `ell_kernel::set_num_threads` (see
+ * `ell_kernel::run_on_threads`), so that a call takes about as long as the
+ * slowest block instead of the sum of all of them. The cut does not depend
+ * on the threads: it is the cut of the first infeasible block, in the
+ * order of `add_block`, just as with the blocks assessed one after the
+ * other.
+ *
+ * With `surrogate`, it is instead the sum of the cuts of all the
+ * infeasible blocks, each divided by the norm of its gradient. A
+ * nonnegative combination of valid cuts is valid, and it also cuts the
+ * region that several blocks exclude.
+ *
+ * Waking the threads up costs a few microseconds per call, which pays off
+ * for blocks of a few dozen rows or more. With `num_threads` 1, the
+ * default, and no `surrogate`, the blocks are assessed in order on the
+ * calling thread, stopping at the first infeasible one.
+ */
+template <typename Arr, typename Mat = Arr> class LmiCompositeOracle {
+    using Cut = std::pair<Arr, double>;
+    using Block = LmiOracle<Arr, Mat>;
+
+    std::vector<std::unique_ptr<Block>> _blocks;
+    std::vector<Cut *> _found;  //!< the cut of each block, null if it is feasible
+    Cut _cut;                   //!< the surrogate cut
+
+  public:
+    bool surrogate = false;
+    size_t num_threads = 1U;  //!< at most, of the threads of `ell_kernel::set_num_threads`
+
+    /**
+     * @brief Add the block B - F * x >= 0
+     *
+     * @param[in] ndim - the size of B
+     * @param[in] F - referenced, as by `LmiOracle`
+     * @param[in] B
+     * @return the block, e.g. to set its options before the first call
+     */
+    auto add_block(size_t ndim, const std::vector<Mat> &F, Mat B) -> Block & {
+        this->_blocks.push_back(std::make_unique<Block>(ndim, F, std::move(B)));
+        this->_found.push_back(nullptr);
+        return *this->_blocks.back();
+    }
+
+    auto num_blocks() const -> size_t { return this->_blocks.size(); }
+
+    /**
+     * @brief
+     *
+     * @param[in] x
+     * @return Cut* - null if x satisfies every block
+     */
+    auto assess_feas(const Arr &x) -> Cut * {
+        const auto num = this->_blocks.size();
+        if (this->num_threads == 1U && !this->surrogate) {
+            for (auto &block : this->_blocks) {
+                if (auto *cut = block->assess_feas(x)) {
+                    return cut;
+                }
+            }
+            return nullptr;
+        }
+        std::atomic<size_t> next{0U};
+        const auto job = Job{this, &x, &next, num};
+        ell_kernel::run_on_threads(_assess_share, &job, this->num_threads);
+        if (!this->surrogate) {
+            for (auto *cut : this->_found) {
+                if (cut != nullptr) {
+                    return cut;
+                }
+            }
+            return nullptr;
+        }
+        return this->_combine(x.size());
+    }
+
+    /**
+     * @brief
+     *
+     * @param[in] x
+     * @return Cut*
+     */
+    auto operator()(const Arr &x) -> Cut * { return this->assess_feas(x); }
+
+  private:
+    struct Job {
+        LmiCompositeOracle *self;
+        const Arr *x;
+        std::atomic<size_t> *next;  //!< the next block to assess
+        size_t num;
+    };
+
+    /** The threads take the blocks one at a time, a short one leaving them for the others */
+    static void _assess_share(const void *arg, size_t /* tid */, size_t /* num_threads */) {
+        const auto &job = *static_cast<const Job *>(arg);
+        for (auto k = job.next->fetch_add(1U); k < job.num; k = job.next->fetch_add(1U)) {
+            job.self->_found[k] = job.self->_blocks[k]->assess_feas(*job.x);
+        }
+    }
+
+    auto _combine(size_t n) -> Cut * {
+        auto &g = this->_cut.first;
+        auto num_cuts = 0U;
+        for (auto *cut : this->_found) {
+            if (cut == nullptr) {
+                continue;
+            }
+            auto norm = 0.0;
+            for (auto i = 0U; i != n; ++i) {
+                norm += cut->first[i] * cut->first[i];
+            }
+            if (norm == 0.0) {
+                return cut;  // infeasible for every x
+            }
+            const auto weight = 1.0 / std::sqrt(norm);
+            if (num_cuts++ == 0U) {
+                if (g.size() != n) {
+                    g = cut->first;  // allocated once
+                }
+                for (auto i = 0U; i != n; ++i) {
+                    g[i] = weight * cut->first[i];
+                }
+                this->_cut.second = weight * cut->second;
+                continue;
+            }
+            for (auto i = 0U; i != n; ++i) {
+                g[i] += weight * cut->first[i];
+            }
+            this->_cut.second += weight * cut->second;
+        }
+        return num_cuts == 0U ? nullptr : &this->_cut;
+    }
+};
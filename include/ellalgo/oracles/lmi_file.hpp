@@ -0,0 +1,187 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint64_t
+#include <cstdio>   // for FILE
+#include <string>
+#include <vector>
+
+#include "../ell_matrix.hpp"
+#include "structured_sym.hpp"
+
+/**
+ * @brief Read-only view of a dense m x m matrix, stored row by row
+ *
+ * For the `Mat` parameter of the LMI oracles, e.g. on the blocks of an
+ * `LmiFile`.
+ */
+class MatrixView {
+    const double *_data = nullptr;
+    size_t _m = 0U;
+
+  public:
+    MatrixView() = default;
+
+    /**
+     * @brief Construct a new matrix view object
+     *
+     * @param[in] data m * m elements, row by row
+     * @param[in] m dimension
+     */
+    MatrixView(const double *data, size_t m) : _data{data}, _m{m} {}
+
+    auto size() const -> size_t { return this->_m; }
+
+    auto operator()(size_t i, size_t j) const -> double { return this->_data[i * this->_m + j]; }
+};
+
+/**
+ * @brief Binary file of the coefficient matrices of LMIs, mapped into memory
+ *
+ * The file starts with a header of 64 bytes:
+ *
+ *        char     magic[8]      "ELLLMI\0\1"
+ *        uint64_t m             dimension of the matrices
+ *        uint64_t num_mats      number of matrices
+ *        uint64_t table_offset  offset of the table of the matrices
+ *
+ * The table has one entry {kind, offset, count} of three uint64_t per
+ * matrix. A dense block (kind 0) is the m * m doubles of the matrix, row by
+ * row; a sparse block (kind 1) is `count` elements {i, j, value} of its
+ * lower triangle, as two uint64_t and a double. All the blocks start at a
+ * multiple of 64 bytes, in the byte order of the machine.
+ *
+ * The file is mapped read-only, so that the processes of a node that load
+ * the same file share its pages, and nothing is read before it is used.
+ * The dense blocks are seen in place through `MatrixView`; the sparse
+ * blocks, small by nature, are copied into a `SparseSym`.
+ */
+class LmiFile {
+    const char *_base = nullptr;
+    size_t _size = 0U;
+    std::vector<char> _buffer;  //!< the contents, where the file cannot be mapped
+    size_t _m = 0U;
+    size_t _num_mats = 0U;
+    const std::uint64_t *_table = nullptr;
+
+  public:
+    enum class Kind : std::uint64_t { Dense = 0U, Sparse = 1U };
+
+    /**
+     * @brief Map a file into memory
+     *
+     * @param[in] path
+     * @throws std::runtime_error if the file cannot be read, or is not an LMI file
+     */
+    explicit LmiFile(const std::string &path);
+
+    ~LmiFile();
+    LmiFile(const LmiFile &) = delete;
+    LmiFile &operator=(const LmiFile &) = delete;
+
+    /**
+     * @brief Dimension of the matrices
+     *
+     * @return size_t
+     */
+    auto dim() const -> size_t { return this->_m; }
+
+    /**
+     * @brief Number of matrices
+     *
+     * @return size_t
+     */
+    auto num_mats() const -> size_t { return this->_num_mats; }
+
+    /**
+     * @brief Kind of the block of the matrix k
+     *
+     * @param[in] k
+     * @return Kind
+     */
+    auto kind(size_t k) const -> Kind { return static_cast<Kind>(this->_table[3 * k]); }
+
+    /**
+     * @brief The dense matrix k, in place
+     *
+     * @param[in] k
+     * @return MatrixView
+     */
+    auto matrix(size_t k) const -> MatrixView;
+
+    /**
+     * @brief The dense matrices [first, last), in place
+     *
+     * @param[in] first
+     * @param[in] last
+     * @return std::vector<MatrixView>
+     */
+    auto matrices(size_t first, size_t last) const -> std::vector<MatrixView>;
+
+    /**
+     * @brief A copy of the sparse matrix k
+     *
+     * @param[in] k
+     * @return SparseSym
+     * @throws std::runtime_error if an element is out of the m x m matrix
+     */
+    auto sparse(size_t k) const -> SparseSym;
+
+  private:
+    auto _unmap() -> void;
+};
+
+/**
+ * @brief Writes an `LmiFile`, block by block
+ *
+ * The file is written under `path` + ".tmp" and renamed to `path` by
+ * `close`. A writer destroyed without `close`, e.g. by an exception while
+ * the blocks are written, deletes the ".tmp" file, and leaves any previous
+ * file at `path` as it was.
+ */
+class LmiFileWriter {
+    std::FILE *_file;
+    std::string _path;
+    size_t _m;
+    std::vector<std::uint64_t> _table;
+
+  public:
+    /**
+     * @brief Create the file
+     *
+     * @param[in] path
+     * @param[in] m dimension of the matrices
+     * @throws std::runtime_error if the file cannot be created
+     */
+    LmiFileWriter(const std::string &path, size_t m);
+
+    ~LmiFileWriter();
+    LmiFileWriter(const LmiFileWriter &) = delete;
+    LmiFileWriter &operator=(const LmiFileWriter &) = delete;
+
+    /**
+     * @brief Append a dense block
+     *
+     * @param[in] M
+     */
+    auto add(const Matrix &M) -> void;
+
+    /**
+     * @brief Append a sparse block
+     *
+     * @param[in] S
+     */
+    auto add(const SparseSym &S) -> void;
+
+    /**
+     * @brief Write the table and the header, close the file, and move it to its path
+     *
+     * @throws std::runtime_error on a write error
+     */
+    auto close() -> void;
+
+  private:
+    auto _align() -> std::uint64_t;
+    auto _write(const void *data, size_t size) -> void;
+};
@@ -0,0 +1,161 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <memory>  // for unique_ptr
+#include <valarray>
+#include <vector>
+
+#include "../ell_kernel.hpp"
+#include "../ell_span.hpp"
+#include "ldlt_mgr.hpp"
+
+/**
+ * @brief Oracle for Linear Matrix Inequality, assembling the matrix incrementally
+ *
+ *    This oracle solves the following feasibility problem:
+ *
+ *        find  x
+ *        s.t.  (B - F * x) >= 0
+ *
+ * The same problem as `LmiOracle`, but A = B - F * x is kept between the
+ * calls instead of being recomputed entry by entry. A row of A is brought up
+ * to date only when the factorization reaches it, by applying the change of
+ * x since that row was last used:
+ *
+ *        A(i, :) -= sum_k (x[k] - x_i[k]) * F[k](i, :)
+ *
+ * which streams through the rows of F[k] with the SIMD kernels, and skips
+ * the unchanged variables. The rows of `Mat` must be contiguous, as in
+ * `Matrix`. To bound the rounding error, a row is assembled from scratch
+ * again after every `refresh` updates; with `refresh` = 1, the cuts are
+ * exactly those of `LmiOracle`.
+ */
+template <typename Arr036, typename Mat = Arr036> class LmiIncrOracle {
+    using Vec = std::valarray<double>;
+    using Cut = std::pair<Arr036, double>;
+
+    LDLTMgr _mgr;
+    const std::vector<Mat> &_F;
+    const Mat _F0;
+    const size_t _m;
+    const size_t _refresh;
+    Mat _A;                            //!< lower triangle of B - F * x_i, row by row
+    Vec _x_rows;                       //!< x_i of every row i, m x n
+    std::vector<size_t> _num_updates;  //!< since the last assembly from scratch
+    std::vector<size_t> _row_stamp;    //!< the call in which a row was last used
+    size_t _stamp = 0U;
+    std::vector<const double *> _rows;  //!< workspace, rows of the changed F[k]
+    Vec _dx;                            //!< workspace, the changes of x
+    std::unique_ptr<Cut> cut = std::make_unique<Cut>();
+
+  public:
+    /**
+     * @brief Construct a new incremental lmi oracle object
+     *
+     * @param[in] ndim    dimension of the matrices
+     * @param[in] F
+     * @param[in] B
+     * @param[in] refresh number of updates of a row before it is assembled from scratch again
+     */
+    LmiIncrOracle(size_t ndim, const std::vector<Mat> &F, Mat B, size_t refresh = 32U)
+        : _mgr{ndim},
+          _F{F},
+          _F0{std::move(B)},
+          _m{ndim},
+          _refresh{refresh},
+          _A{_F0},
+          _x_rows(0.0, ndim * F.size()),
+          _num_updates(ndim, 0U),
+          _row_stamp(ndim, 0U),
+          _rows(F.size()),
+          _dx(F.size()) {}
+
+    /**
+     * @brief Assess x, writing the cut (if any) into a buffer
+     *
+     * @param[in] x
+     * @param[out] grad gradient of the cut, of size n
+     * @param[out] beta
+     * @return true if x is infeasible, i.e. a cut was written
+     */
+    auto assess_feas(const Arr036 &x, Span<double> grad, double &beta) -> bool {
+        const auto n = x.size();
+        ++this->_stamp;
+
+        auto getA = [&x, this](size_t i, size_t j) -> double {
+            if (this->_row_stamp[i] != this->_stamp) {
+                this->_update_row(i, x);
+            }
+            return this->_A(i, j);
+        };
+
+        if (this->_mgr.factor(getA)) {
+            return false;
+        }
+
+        beta = this->_mgr.witness();  // call before sym_quad() !!!
+        for (auto i = 0U; i != n; ++i) {
+            grad[i] = this->_mgr.sym_quad(this->_F[i]);
+        }
+        return true;
+    }
+
+    /**
+     * @brief
+     *
+     * @param[in] x
+     * @return Cut*
+     */
+    auto assess_feas(const Arr036 &x) -> Cut * {
+        auto &g = this->cut->first;
+        if (g.size() != x.size()) {
+            g = x;  // allocated once
+        }
+        if (!this->assess_feas(x, make_span(g), this->cut->second)) {
+            return nullptr;
+        }
+        return this->cut.get();
+    }
+
+    /**
+     * @brief
+     *
+     * @param[in] x
+     * @return Cut*
+     */
+    auto operator()(const Arr036 &x) -> Cut * { return assess_feas(x); }
+
+  private:
+    /**
+     * @brief Bring the lower triangle of row i of A up to date with x
+     *
+     * @param[in] i
+     * @param[in] x
+     */
+    auto _update_row(size_t i, const Arr036 &x) -> void {
+        const auto n = x.size();
+        auto *x_row = &this->_x_rows[i * n];
+        if (++this->_num_updates[i] == this->_refresh) {  // from scratch
+            this->_num_updates[i] = 0U;
+            for (auto j = 0U; j <= i; ++j) {
+                this->_A(i, j) = this->_F0(i, j);
+            }
+            for (auto k = 0U; k != n; ++k) {
+                x_row[k] = 0.0;
+            }
+        }
+        auto num = 0U;
+        for (auto k = 0U; k != n; ++k) {
+            const auto dx = x[k] - x_row[k];
+            if (dx != 0.0) {
+                x_row[k] = x[k];
+                this->_rows[num] = &this->_F[k](i, 0);
+                this->_dx[num] = dx;
+                ++num;
+            }
+        }
+        ell_kernel::sub_combination(&this->_A(i, 0), this->_rows.data(), &this->_dx[0], num,
+                                    i + 1);
+        this->_row_stamp[i] = this->_stamp;
+    }
+};
@@ -4,6 +4,7 @@
 #include <memory>  // for unique_ptr
 #include <vector>
 
+#include "../ell_span.hpp"
 #include "ldlt_mgr.hpp"
 
 /**
@@ -32,12 +33,14 @@ template <typename Arr036, typename Mat = Arr036> class LmiOldOracle {
     LmiOldOracle(size_t ndim, const std::vector<Mat> &F, Mat B)
         : _mgr{ndim}, _F{F}, _F0{std::move(B)} {}
     /**
-     * @brief
+     * @brief Assess x, writing the cut (if any) into a buffer
      *
      * @param[in] x
-     * @return std::optional<Cut>
+     * @param[out] grad gradient of the cut, of size n
+     * @param[out] beta
+     * @return true if x is infeasible, i.e. a cut was written
      */
-    auto assess_feas(const Arr036 &x) -> Cut * {
+    auto assess_feas(const Arr036 &x, Span<double> grad, double &beta) -> bool {
         const auto n = x.size();
 
         Mat A{this->_F0};
@@ -50,16 +53,30 @@ template <typename Arr036, typename Mat = Arr036> class LmiOldOracle {
         }
 
         if (this->_mgr.factorize(A)) {
-            return nullptr;
+            return false;
         }
 
-        auto ep = this->_mgr.witness();  // call before sym_quad() !!!
-        Arr036 g{x};
+        beta = this->_mgr.witness();  // call before sym_quad() !!!
         for (auto i = 0U; i != n; ++i) {
-            g[i] = this->_mgr.sym_quad(this->_F[i]);
+            grad[i] = this->_mgr.sym_quad(this->_F[i]);
+        }
+        return true;
+    }
+
+    /**
+     * @brief
+     *
+     * @param[in] x
+     * @return std::optional<Cut>
+     */
+    auto assess_feas(const Arr036 &x) -> Cut * {
+        auto &g = this->cut->first;
+        if (g.size() != x.size()) {
+            g = x;  // allocated once
+        }
+        if (!this->assess_feas(x, make_span(g), this->cut->second)) {
+            return nullptr;
         }
-        this->cut->first = std::move(g);
-        this->cut->second = std::move(ep);
         return this->cut.get();
     }
 
@@ -1,10 +1,15 @@
 // -*- coding: utf-8 -*-
 #pragma once
 
-#include <memory>  // for unique_ptr
+#include <memory>       // for unique_ptr
+#include <type_traits>  // for false_type, true_type
 #include <vector>
 
+#include "../ell_span.hpp"
+#include "interleaved_mats.hpp"
 #include "ldlt_mgr.hpp"
+#include "structured_sym.hpp"
+#include "unchanged_rows.hpp"
 
 /**
  * @brief Oracle for Linear Matrix Inequality.
@@ -13,6 +18,18 @@
  *
  *        find  x
  *        s.t.  (B - F * x) >= 0
+ *
+ * With `reuse_prefix` set, the leading rows of the matrix that no changed
+ * variable reaches keep their factorization from the previous call (see
+ * `UnchangedRows`), and only the trailing rows are factored again. With
+ * `stacked_grad` set, the gradient of a cut is evaluated for all the
+ * variables in one pass over an interleaved copy of F (see
+ * `LDLTMgr::sym_quad_all`), which pays off for hundreds of variables.
+ *
+ * `Mat` may also be `SparseSym` or `LowRankSym`, for very sparse or low
+ * rank F[k]: the matrix is then assembled by scattering the F[k] in
+ * O(nnz) (or O(rank m^2)) instead of element by element, and the gradient
+ * costs O(nnz) (or O(rank m)).
  */
 template <typename Arr036, typename Mat = Arr036> class LmiOracle {
     using Cut = std::pair<Arr036, double>;
@@ -20,9 +37,16 @@ template <typename Arr036, typename Mat = Arr036> class LmiOracle {
     LDLTMgr _mgr;
     const std::vector<Mat> &_F;
     const Mat _F0;
+    UnchangedRows _unchanged;
+    std::unique_ptr<InterleavedMats> _stacked;  //!< made at the first cut with `stacked_grad`
+    Matrix _A;  //!< the assembled matrix, for `SparseSym` or `LowRankSym` only
     std::unique_ptr<Cut> cut = std::make_unique<Cut>();
 
   public:
+    bool reuse_prefix = false;  //!< to be set before the first call
+    bool stacked_grad = false;
+    size_t num_grad_threads = 1U;  //!< for `stacked_grad`, see `LDLTMgr::sym_quad_all`
+
     /**
      * @brief Construct a new lmi oracle object
      *
@@ -31,7 +55,37 @@ template <typename Arr036, typename Mat = Arr036> class LmiOracle {
      * @param[in] B
      */
     LmiOracle(size_t ndim, const std::vector<Mat> &F, Mat B)
-        : _mgr{ndim}, _F{F}, _F0{std::move(B)} {}
+        : _mgr{ndim},
+          _F{F},
+          _F0{std::move(B)},
+          _A{is_structured_sym<Mat>::value ? ndim : 0U} {}
+
+    /**
+     * @brief Assess x, writing the cut (if any) into a buffer
+     *
+     * @param[in] x
+     * @param[out] grad gradient of the cut, of size n
+     * @param[out] beta
+     * @return true if x is infeasible, i.e. a cut was written
+     */
+    auto assess_feas(const Arr036 &x, Span<double> grad, double &beta) -> bool {
+        const auto n = x.size();
+        const auto num_same
+            = this->reuse_prefix ? this->_unchanged.count(this->_F, this->_mgr._n, x) : 0U;
+        if (this->_factor(x, num_same, is_structured_sym<Mat>{})) {
+            return false;
+        }
+
+        beta = this->_mgr.witness();  // call before sym_quad() !!!
+        if (this->stacked_grad) {
+            this->_mgr.sym_quad_all(this->_get_stacked(), grad, this->num_grad_threads);
+            return true;
+        }
+        for (auto i = 0U; i != n; ++i) {
+            grad[i] = this->_mgr.sym_quad(this->_F[i]);
+        }
+        return true;
+    }
 
     /**
      * @brief
@@ -40,6 +94,27 @@ template <typename Arr036, typename Mat = Arr036> class LmiOracle {
      * @return Cut*
      */
     auto assess_feas(const Arr036 &x) -> Cut * {
+        auto &g = this->cut->first;
+        if (g.size() != x.size()) {
+            g = x;  // allocated once
+        }
+        if (!this->assess_feas(x, make_span(g), this->cut->second)) {
+            return nullptr;
+        }
+        return this->cut.get();
+    }
+
+    /**
+     * @brief
+     *
+     * @param[in] x
+     * @return Cut*
+     */
+    auto operator()(const Arr036 &x) -> Cut * { return assess_feas(x); }
+
+  private:
+    auto _factor(const Arr036 &x, size_t num_same, std::false_type /* element by element */)
+        -> bool {
         const auto n = x.size();
 
         auto getA = [&n, &x, this](size_t i, size_t j) -> double {
@@ -50,25 +125,29 @@ template <typename Arr036, typename Mat = Arr036> class LmiOracle {
             return a;
         };
 
-        if (this->_mgr.factor(getA)) {
-            return nullptr;
-        }
+        return this->_mgr.factor(getA, num_same);
+    }
 
-        auto ep = this->_mgr.witness();  // call before sym_quad() !!!
-        Arr036 g{x};
-        for (auto i = 0U; i != n; ++i) {
-            g[i] = this->_mgr.sym_quad(this->_F[i]);
+    auto _factor(const Arr036 &x, size_t num_same, std::true_type /* structured */) -> bool {
+        auto &A = this->_A;
+        for (auto i = 0U; i != this->_mgr._n; ++i) {
+            for (auto j = 0U; j <= i; ++j) {
+                A(i, j) = 0.0;
+            }
         }
-        this->cut->first = std::move(g);
-        this->cut->second = std::move(ep);
-        return this->cut.get();
+        this->_F0.add_to(A, 1.0);
+        for (auto k = 0U; k != x.size(); ++k) {
+            if (x[k] != 0.0) {
+                this->_F[k].add_to(A, -x[k]);
+            }
+        }
+        return this->_mgr.factor([&A](size_t i, size_t j) { return A(i, j); }, num_same);
     }
 
-    /**
-     * @brief
-     *
-     * @param[in] x
-     * @return Cut*
-     */
-    auto operator()(const Arr036 &x) -> Cut * { return assess_feas(x); }
+    auto _get_stacked() -> const InterleavedMats & {
+        if (!this->_stacked) {
+            this->_stacked = std::make_unique<InterleavedMats>(this->_F, this->_mgr._n);
+        }
+        return *this->_stacked;
+    }
 };
@@ -2,9 +2,13 @@
 #pragma once
 
 // #include <limits>
+#include <algorithm>
+#include <complex>
 #include <cstddef>
+#include <functional>
 #include <tuple>
 #include <valarray>
+#include <vector>
 
 // Modified from CVX code by Almir Mutapcic in 2006.
 // Adapted in 2010 for impulse response peak-minimization by convex iteration by
@@ -44,16 +48,73 @@
  *        min   \gamma
  *        s.t.  L^2(\omega) \le R(\omega) \le U^2(\omega), \forall \omega \in
  * [0, \pi] R(\omega) > 0, \forall \omega \in [0, \pi]
+ *
+ * The matrix A of the spectrum is kept in one contiguous buffer, column by
+ * column, and the spectrum A * x is evaluated for blocks of frequencies
+ * at a time by a SIMD kernel, each of them summed in the same order as a
+ * plain inner product. The constraints are still checked one frequency
+ * after the other, in round-robin order, and the first violated one gives
+ * the cut. The blocks start small and grow up to `spectrum_block`, so
+ * that little is evaluated in vain when a constraint near the start of the
+ * scan is violated.
+ *
+ * With `use_fft`, the whole spectrum is computed at once instead, as the
+ * DFT x[0] + 2 x[1] e^{-i w} + ... of the coefficients, by a chirp-z
+ * transform (FFTs of a power of two not less than m + n - 1): in
+ * O(m log m) rather than O(m n). The values differ from A * x by rounding
+ * only, which may change the cuts that are chosen, and the iterations.
+ *
+ * The `selection` of the cut among the violated constraints is either the
+ * first one in the scan above, or, over the whole spectrum, the one of the
+ * largest violation beta, or of the largest normalized depth
+ * beta / sqrt(g' Q g) in the search space given by `metric`. The last two
+ * cost a full scan per call, but may save iterations.
+ *
+ * With `stopband_active` > 0, the frequencies of the stopband of the
+ * largest and the smallest R(w) at the last full scan of the stopband are
+ * kept as an active set. As |A(k, :) * d| <= |d[0]| + 2 (|d[1]| + ...),
+ * the other ones cannot be violated, nor be the maximum, as long as x stays
+ * close enough to that of the scan; the active set alone is then scanned,
+ * in the same round-robin order, with the same result as the full scan.
+ * Otherwise the full scan is done, and the active set is rebuilt.
+ *
+ * The cut, the spectrum and the round-robin state are kept in the object:
+ * distinct objects may be used by distinct threads at the same time, an
+ * object by one thread at a time. The cut returned by `assess_feas` is
+ * overwritten by the next call.
  */
 class LowpassOracle {
     using Vec = std::valarray<double>;
-    using Mat = std::valarray<Vec>;
     using ParallelCut = std::pair<Vec, Vec>;
 
     double _fmax = -1e100;
     int _kmax = 0;
+    ParallelCut _cut = ParallelCut{Vec{0.0}, Vec{0.0}};
 
-    Mat A;
+    size_t _m;   //!< number of frequencies
+    size_t _n;   //!< number of coefficients
+    Vec _At;     //!< A(k, j) at _At[j * _m + k]
+    Vec _v;      //!< (A * x)(k), valid for k in [_lo, _hi)
+    size_t _lo = 0U;
+    size_t _hi = 0U;
+    size_t _num_cols = 0U;  //!< of A used, i.e. the size of x
+    size_t _fft_cols = 0U;  //!< the size of x of the FFT tables
+    size_t _block = 0U;     //!< frequencies evaluated next, doubled up to `spectrum_block`
+    Vec _neg_x;                        //!< workspace
+    Vec _g;                            //!< workspace
+    std::vector<const double *> _cols;  //!< workspace
+    std::vector<std::complex<double>> _chirp;    //!< e^{-i pi t^2 / P}, P = 2 (m - 1)
+    std::vector<std::complex<double>> _kernel;   //!< FFT of the conjugate chirp, over L
+    std::vector<std::complex<double>> _twiddle;  //!< e^{-2 pi i t / L}, t < L / 2
+    std::vector<std::complex<double>> _work;     //!< workspace, of size L
+    std::vector<size_t> _active;  //!< active frequencies of the stopband, in order
+    Vec _active_At;               //!< A(_active[i], j) at _active_At[j * _active.size() + i]
+    Vec _active_v;                //!< (A * x)(_active[i])
+    Vec _x_ref;                   //!< x of the last full scan of the stopband
+    double _ref_norm = 0.0;       //!< |x_ref[0]| + 2 (|x_ref[1]| + ...)
+    double _ref_lo = 0.0;         //!< least R(w) outside the active set, at x_ref
+    double _ref_hi = 0.0;         //!< greatest R(w) outside the active set, at x_ref
+    std::vector<size_t> _order;   //!< workspace
     double Lpsq;
     double Upsq;
     int nwpass;
@@ -98,6 +159,40 @@ class LowpassOracle {
     auto operator()(const Vec &x, double &Spsq) -> std::tuple<ParallelCut, bool> {
         return this->assess_optim(x, Spsq);
     }
+
+    enum class Selection { FirstViolation, MaxViolation, MaxDepth };
+
+    bool use_fft = false;  //!< compute the whole spectrum by FFT, in each call
+    Selection selection = Selection::FirstViolation;  //!< of the cut
+    std::function<double(const Vec &)> metric;  //!< g' Q g, for Selection::MaxDepth
+    size_t stopband_active = 0U;  //!< size of each end of the active set, 0 for none
+
+    static const size_t spectrum_block = 64U;  //!< most frequencies evaluated at once
+
+  private:
+    /*!
+     * @brief (A * x)(k), evaluating the block of frequencies [k, last) if need be
+     *
+     * @param[in] k
+     * @param[in] last end of the band of k
+     */
+    auto _spectrum(size_t k, size_t last) -> double {
+        if (k < this->_lo || k >= this->_hi) {
+            this->_eval(k, std::min(k + this->_block, last));
+            this->_block = std::min(2 * this->_block, spectrum_block);
+        }
+        return this->_v[k];
+    }
+
+    auto _assess_all(const Vec &x, const double &Spsq, ParallelCut &cut) -> ParallelCut *;
+    enum class Scan { Violated, Feasible, Unknown };
+
+    auto _scan_active(const Vec &x, double Spsq, ParallelCut &cut) -> Scan;
+    auto _build_active(const Vec &x) -> void;
+    auto _eval(size_t first, size_t last) -> void;
+    auto _eval_fft() -> void;
+    auto _init_fft() -> void;
+    auto _row(Vec &g, size_t k, double sign) const -> void;
 };
 
 // Filter specs
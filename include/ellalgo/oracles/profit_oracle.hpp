@@ -1,9 +1,16 @@
 // -*- coding: utf-8 -*-
 #pragma once
 
-#include <cmath>  // for log
-#include <tuple>  // for tuple
+#include <array>          // for array
+#include <cmath>          // for log
+#include <cstddef>        // for size_t
+#include <functional>     // for hash
+#include <tuple>          // for tuple
+#include <unordered_map>  // for unordered_map
 #include <valarray>
+#include <vector>         // for vector
+
+#include "../ell_span.hpp"
 
 /**
  * @brief Oracle for a profit maximization problem.
@@ -22,18 +29,33 @@
  *        x: input quantity
  *        v: output price
  *        k: a given constant that restricts the quantity of x1
+ *
+ * The cuts and the round-robin state are kept in the object: distinct
+ * objects may be used by distinct threads at the same time, an object by
+ * one thread at a time.
  */
 class ProfitOracle {
     using Vec = std::valarray<double>;
     using Cut = std::pair<Vec, double>;
 
+  public:
+    /**
+     * @brief The terms at a point y that do not depend on gamma, see `terms`
+     */
+    struct Terms {
+        std::array<double, 2> x;  //!< exp(y)
+        double log_Cobb;          //!< log(p A x1^alpha x2^beta)
+        double vx;                //!< v1 x1 + v2 x2
+    };
+
+  private:
     int idx = -1;
     const double _log_pA;
     const double _log_k;
     const Vec _price_out;
-    double _log_Cobb = 0.0;
-    double _vx = 0.0;
     Vec _elasticities;
+    Cut _cut1 = Cut{Vec{1.0, 0.0}, 0.0};   //!< of y0 <= log k
+    Cut _cut2 = Cut{Vec{-1.0, 1.0}, 0.0};  //!< of the Cobb-Douglas constraint
 
   public:
     /**
@@ -61,6 +83,17 @@ class ProfitOracle {
     */
     auto set_elasticities(const Vec &elasticities) { this->_elasticities = elasticities; }
 
+    /**
+     * @brief The terms at y that do not depend on gamma
+     *
+     * They may be kept to assess y again (see `ProfitOracleQ`), as long as
+     * the elasticities stay as they are.
+     *
+     * @param[in] y input quantity (in log scale)
+     * @return Terms
+     */
+    auto terms(const Vec &y) const -> Terms;
+
     /**
      * @brief
      *
@@ -68,7 +101,19 @@ class ProfitOracle {
      * @param[in] gamma the best-so-far optimal value
      * @return std::tuple<Cut, double> Cut and the updated best-so-far value
      */
-    auto assess_feas(const Vec &y, const double &gamma) -> Cut *;
+    auto assess_feas(const Vec &y, const double &gamma) -> Cut * {
+        return this->assess_feas(y, this->terms(y), gamma);
+    }
+
+    /**
+     * @brief Same as above, with the terms at y given
+     *
+     * @param[in] y input quantity (in log scale)
+     * @param[in] terms `terms(y)`
+     * @param[in] gamma the best-so-far optimal value
+     * @return the cut, or nullptr if y is feasible
+     */
+    auto assess_feas(const Vec &y, const Terms &terms, const double &gamma) -> Cut *;
 
     /**
      * @brief
@@ -78,6 +123,32 @@ class ProfitOracle {
      * @return std::tuple<Cut, double> Cut and the updated best-so-far value
      */
     auto assess_optim(const Vec &y, double &gamma) -> std::tuple<Cut, bool>;
+
+    /**
+     * @brief Same as above, but writes the cut into a buffer
+     *
+     * @param[in] y input quantity (in log scale)
+     * @param[in,out] gamma the best-so-far optimal value
+     * @param[out] grad gradient of the cut, of size 2
+     * @param[out] beta
+     * @return true if gamma was shrunk
+     */
+    auto assess_optim(const Vec &y, double &gamma, Span<double> grad, double &beta) -> bool {
+        return this->assess_optim(y, this->terms(y), gamma, grad, beta);
+    }
+
+    /**
+     * @brief Same as above, with the terms at y given
+     *
+     * @param[in] y input quantity (in log scale)
+     * @param[in] terms `terms(y)`
+     * @param[in,out] gamma the best-so-far optimal value
+     * @param[out] grad gradient of the cut, of size 2
+     * @param[out] beta
+     * @return true if gamma was shrunk
+     */
+    auto assess_optim(const Vec &y, const Terms &terms, double &gamma, Span<double> grad,
+                      double &beta) -> bool;
 };
 
 /**
@@ -103,8 +174,18 @@ class ProfitOracleRb {
 
     const Vec _uie;
     Vec _elasticities;
+    Vec _a_rb;  //!< the elasticities of the last assessment
     ProfitOracle _P;
 
+    /**
+     * @brief The elasticities of the worst case at y, into `_P`
+     */
+    void _set_worst_case(const Vec &y) {
+        this->_a_rb[0] = this->_elasticities[0] + (y[0] > 0.0 ? -this->_uie[0] : this->_uie[0]);
+        this->_a_rb[1] = this->_elasticities[1] + (y[1] > 0.0 ? -this->_uie[1] : this->_uie[1]);
+        this->_P.set_elasticities(this->_a_rb);  // the same size, no allocation
+    }
+
   public:
     /**
      * @brief Construct a new profit rb oracle object
@@ -119,7 +200,7 @@ class ProfitOracleRb {
      */
     ProfitOracleRb(double p, double A, double k, const Vec &a, const Vec &v, const Vec &e,
                    double e3)
-        : _uie{e}, _elasticities{a}, _P(p - e3, A, k - e3, a, v + Vec{e3, e3}) {}
+        : _uie{e}, _elasticities{a}, _a_rb{a}, _P(p - e3, A, k - e3, a, v + Vec{e3, e3}) {}
 
     /**
      * @brief Make object callable for cutting_plane_optim()
@@ -131,12 +212,113 @@ class ProfitOracleRb {
      * @see cutting_plane_optim
      */
     auto assess_optim(const Vec &y, double &gamma) -> std::tuple<Cut, bool> {
-        auto a_rb = this->_elasticities;
-        a_rb[0] += y[0] > 0.0 ? -this->_uie[0] : this->_uie[0];
-        a_rb[1] += y[1] > 0.0 ? -this->_uie[1] : this->_uie[1];
-        this->_P.set_elasticities(a_rb);
+        this->_set_worst_case(y);
         return this->_P.assess_optim(y, gamma);
     }
+
+    /**
+     * @brief Same as above, but writes the cut into a buffer
+     *
+     * @param[in] y input quantity (in log scale)
+     * @param[in,out] gamma the best-so-far optimal value
+     * @param[out] grad gradient of the cut, of size 2
+     * @param[out] beta
+     * @return true if gamma was shrunk
+     */
+    auto assess_optim(const Vec &y, double &gamma, Span<double> grad, double &beta) -> bool {
+        this->_set_worst_case(y);
+        return this->_P.assess_optim(y, gamma, grad, beta);
+    }
+};
+
+/**
+ * @brief Many scenarios of the profit maximization problem, assessed at once
+ *
+ * The oracle of `cutting_plane_optim_batch` for K scenarios of
+ * `ProfitOracle` (or, with the uncertainties, of `ProfitOracleRb`), each
+ * with its own p, A, k, a and v, with the centers in the layout of
+ * `EllBatch`. An assessment runs pass by pass over the arrays of all
+ * scenarios: the exponentials of the centers, then the logarithms of the
+ * Cobb-Douglas terms, and only then the choice of the cut of each scenario.
+ * The passes are plain loops over contiguous arrays, for the compiler (and
+ * a vector math library, where allowed); they call `std::exp` and
+ * `std::log`, so that every scenario gets the cuts of its own
+ * `ProfitOracle`, bit for bit. Nothing is allocated.
+ *
+ * The parameters a, v and e of the scenario k are at `[k]` (alpha, v1 and
+ * e1) and at `[K + k]` (beta, v2 and e2).
+ *
+ * @see ProfitOracle, ProfitOracleRb
+ */
+class ProfitOracleBatch {
+    using Vec = std::valarray<double>;
+    using Mask = std::valarray<bool>;
+
+    const size_t _num;
+    const size_t _stride;
+    Vec _log_pA;
+    Vec _log_k;
+    Vec _price_out;     //!< in the layout of `EllBatch`
+    Vec _elasticities;  //!< in the layout of `EllBatch`
+    Vec _uie;           //!< in the layout of `EllBatch`, empty unless robust
+    std::vector<int> _idx;  //!< round robin, as `ProfitOracle`
+
+    // Workspace, so that an assessment does not allocate
+    Vec _x;  //!< exp(y), in the layout of `EllBatch`
+    Vec _a;  //!< the elasticities of the assessment (robust)
+    Vec _log_Cobb;
+    Vec _vx;
+    Vec _te;
+    Vec _f_Cobb;
+
+  public:
+    /**
+     * @brief Construct K scenarios of `ProfitOracle`
+     *
+     * @param[in] p the market prices per unit, of size K
+     * @param[in] A the scales of production, of size K
+     * @param[in] k the limits of x1, of size K
+     * @param[in] a the output elasticities, of size 2K
+     * @param[in] v output prices, of size 2K
+     * @param[in] stride as `EllBatch::stride` of the search space
+     */
+    ProfitOracleBatch(const Vec &p, const Vec &A, const Vec &k, const Vec &a, const Vec &v,
+                      size_t stride);
+
+    /**
+     * @brief Construct K scenarios of `ProfitOracleRb`
+     *
+     * @param[in] p the market prices per unit, of size K
+     * @param[in] A the scales of production, of size K
+     * @param[in] k the limits of x1, of size K
+     * @param[in] a the output elasticities, of size 2K
+     * @param[in] v output prices, of size 2K
+     * @param[in] e uncertainties of the elasticities, of size 2K
+     * @param[in] e3 uncertainties of p, k and v, of size K
+     * @param[in] stride as `EllBatch::stride` of the search space
+     */
+    ProfitOracleBatch(const Vec &p, const Vec &A, const Vec &k, const Vec &a, const Vec &v,
+                      const Vec &e, const Vec &e3, size_t stride);
+
+    /**
+     * @brief Number of scenarios K
+     *
+     * @return size_t
+     */
+    auto size() const -> size_t { return this->_num; }
+
+    /**
+     * @brief Assess the centers of all active scenarios, see `cutting_plane_optim_batch`
+     *
+     * @param[in] xc centers, in the layout of `EllBatch`
+     * @param[in,out] gamma the best-so-far optimal values, one per lane
+     * @param[in] active
+     * @param[out] grad gradients of the cuts, in the layout of `EllBatch`
+     * @param[out] beta one per lane
+     * @param[out] shrunk whether gamma was shrunk, one per lane
+     */
+    void assess_optim_batch(const Vec &xc, Vec &gamma, const Mask &active, Vec &grad, Vec &beta,
+                            Mask &shrunk);
 };
 
 /**
@@ -157,14 +339,44 @@ class ProfitOracleRb {
  *        v: output price
  *        k: a given constant that restricts the quantity of x1
  *
+ * The terms at the point y are computed once for both its cut and its
+ * rounding, and those at the integer point are kept for a retry. With
+ * `use_cache`, the terms at all the integer points are kept (see
+ * `ProfitOracle::terms`), so that an integer point that comes again, e.g.
+ * in the next solve by the same oracle, is assessed without its
+ * exponentials and logarithms; the cuts are those without the cache, bit
+ * for bit. A lookup costs about as much as the two exponentials and two
+ * logarithms that it saves, so the cache is off by default. Each point
+ * kept costs about 100 bytes; the cache is emptied when it reaches
+ * `max_cached` points, and by `clear_cache`.
+ *
  * @see ProfitOracle
  */
 class ProfitOracleQ {
     using Vec = std::valarray<double>;
     using Cut = std::pair<Vec, double>;
+    using Point = std::array<double, 2>;
+
+    /**
+     * @brief An integer point assessed before
+     */
+    struct Entry {
+        Point yd;  //!< log(x)
+        ProfitOracle::Terms terms;
+    };
+
+    struct PointHash {
+        auto operator()(const Point &x) const -> size_t {
+            const auto h0 = std::hash<double>{}(x[0]);
+            return h0 ^ (std::hash<double>{}(x[1]) + 0x9e3779b9U + (h0 << 6U) + (h0 >> 2U));
+        }
+    };
 
     ProfitOracle _P;
-    Vec _yd{};
+    Vec _yd;                         //!< the integer point of the last assessment, in log scale
+    ProfitOracle::Terms _terms_d{};  //!< the terms at _yd
+    std::unordered_map<Point, Entry, PointHash> _cache;
+    size_t _num_hits = 0U;
 
   public:
     /**
@@ -176,7 +388,33 @@ class ProfitOracleQ {
      * @param[in] a the output elasticities
      * @param[in] v output price
      */
-    ProfitOracleQ(double p, double A, double k, const Vec &a, const Vec &v) : _P{p, A, k, a, v} {}
+    ProfitOracleQ(double p, double A, double k, const Vec &a, const Vec &v)
+        : _P{p, A, k, a, v}, _yd(2) {}
+
+    bool use_cache = false;  //!< keep the terms at the integer points, about 100 bytes each
+    size_t max_cached = 65536U;  //!< the points kept at most, about 6.5 MB
+
+    /**
+     * @brief Forget the integer points kept, and release their memory
+     */
+    auto clear_cache() -> void {
+        this->_cache.clear();
+        this->_cache.rehash(0U);
+    }
+
+    /**
+     * @brief Number of integer points kept
+     *
+     * @return size_t
+     */
+    auto num_cached() const -> size_t { return this->_cache.size(); }
+
+    /**
+     * @brief Number of assessments of an integer point that was kept
+     *
+     * @return size_t
+     */
+    auto num_hits() const -> size_t { return this->_num_hits; }
 
     /**
      * @brief Make object callable for cutting_plane_optim_q()
@@ -190,4 +428,33 @@ class ProfitOracleQ {
      */
     auto assess_optim_q(const Vec &y, double &gamma, bool retry)
         -> std::tuple<Cut, bool, Vec, bool>;
+
+    /**
+     * @brief Same as above, but writes the cut into a buffer
+     *
+     * @param[in] y input quantity (in log scale)
+     * @param[in,out] gamma the best-so-far optimal value
+     * @param[in] retry whether it is a retry
+     * @param[out] grad gradient of the cut, of size 2
+     * @param[out] beta
+     * @param[out] more_alt whether an alternative cut may be asked for by a retry
+     * @return the integer point (in log scale) if gamma was shrunk, else nullptr
+     */
+    auto assess_optim_q(const Vec &y, double &gamma, bool retry, Span<double> grad, double &beta,
+                        bool &more_alt) -> const Vec *;
+
+  private:
+    /**
+     * @brief The cut at y if it is infeasible, else round y into `_yd`
+     *
+     * @return true if y was cut
+     */
+    auto _cut_or_round(const Vec &y, double &gamma, Span<double> grad, double &beta) -> bool;
+
+    /**
+     * @brief The cut at `_yd`, moved to y
+     *
+     * @return true if gamma was shrunk
+     */
+    auto _assess_discrete(const Vec &y, double &gamma, Span<double> grad, double &beta) -> bool;
 };
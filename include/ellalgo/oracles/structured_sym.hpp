@@ -0,0 +1,267 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <algorithm>    // for min, swap
+#include <cstddef>      // for size_t
+#include <type_traits>  // for false_type, true_type
+#include <valarray>
+#include <vector>
+
+/**
+ * @brief Sparse symmetric matrix, as a list (COO) of the elements of its lower triangle
+ *
+ * For the matrices F[k] of an LMI with a few nonzero elements each. The LMI
+ * oracles assemble B - F * x from the elements in O(nnz), and `LDLTMgr`
+ * evaluates v' F v over the active block in O(nnz).
+ */
+class SparseSym {
+  public:
+    struct Entry {
+        size_t i;
+        size_t j;  //!< j <= i
+        double val;
+    };
+
+  private:
+    size_t _m;
+    std::vector<Entry> _entries;
+
+  public:
+    /**
+     * @brief Construct a new sparse sym object (zero)
+     *
+     * @param[in] m dimension
+     */
+    explicit SparseSym(size_t m) : _m{m} {}
+
+    /**
+     * @brief Add val to the elements (i, j) and (j, i), as in the COO format
+     *
+     * @param[in] i
+     * @param[in] j
+     * @param[in] val
+     */
+    auto add(size_t i, size_t j, double val) -> void {
+        if (i < j) {
+            std::swap(i, j);
+        }
+        this->_entries.push_back(Entry{i, j, val});
+    }
+
+    /**
+     * @brief Dimension
+     *
+     * @return size_t
+     */
+    auto size() const -> size_t { return this->_m; }
+
+    /**
+     * @brief Number of stored elements (of the lower triangle)
+     *
+     * @return size_t
+     */
+    auto nnz() const -> size_t { return this->_entries.size(); }
+
+    /**
+     * @brief The stored elements
+     *
+     * @return const std::vector<Entry>&
+     */
+    auto entries() const -> const std::vector<Entry> & { return this->_entries; }
+
+    /**
+     * @brief Element (i, j), in O(nnz)
+     *
+     * @param[in] i
+     * @param[in] j
+     * @return double
+     */
+    auto operator()(size_t i, size_t j) const -> double {
+        if (i < j) {
+            std::swap(i, j);
+        }
+        auto res = 0.0;
+        for (const auto &entry : this->_entries) {
+            if (entry.i == i && entry.j == j) {
+                res += entry.val;
+            }
+        }
+        return res;
+    }
+
+    /**
+     * @brief The first row with a stored nonzero element, or m if none
+     *
+     * @return size_t
+     */
+    auto first_row() const -> size_t {
+        auto row = this->_m;
+        for (const auto &entry : this->_entries) {
+            if (entry.val != 0.0) {
+                row = std::min(row, entry.i);
+            }
+        }
+        return row;
+    }
+
+    /**
+     * @brief A += alpha * this, on the lower triangle of A
+     *
+     * @tparam Mat
+     * @param[in,out] A
+     * @param[in] alpha
+     */
+    template <typename Mat> auto add_to(Mat &A, double alpha) const -> void {
+        for (const auto &entry : this->_entries) {
+            A(entry.i, entry.j) += alpha * entry.val;
+        }
+    }
+
+    /**
+     * @brief v' * this(start:stop, start:stop) * v
+     *
+     * @param[in] v
+     * @param[in] start
+     * @param[in] stop
+     * @return double
+     */
+    auto quad(const std::valarray<double> &v, size_t start, size_t stop) const -> double {
+        auto res = 0.0;
+        for (const auto &entry : this->_entries) {
+            if (entry.j >= start && entry.i < stop) {
+                const auto vv = v[entry.i] * v[entry.j];
+                res += (entry.i == entry.j ? vv : 2.0 * vv) * entry.val;
+            }
+        }
+        return res;
+    }
+};
+
+/**
+ * @brief Symmetric matrix of low rank, d[0] u[0] u[0]' + ... + d[r-1] u[r-1] u[r-1]'
+ *
+ * For the rank-one (or low rank) matrices F[k] of an LMI. `LDLTMgr`
+ * evaluates v' F v over the active block in O(r m), as a sum of squares
+ * of inner products.
+ */
+class LowRankSym {
+    size_t _m;
+    std::vector<double> _d;
+    std::vector<double> _u;  //!< u[0], ..., u[r-1], one after the other
+
+  public:
+    /**
+     * @brief Construct a new low rank sym object (zero)
+     *
+     * @param[in] m dimension
+     */
+    explicit LowRankSym(size_t m) : _m{m} {}
+
+    /**
+     * @brief this += d * u * u'
+     *
+     * @tparam Arr
+     * @param[in] d
+     * @param[in] u of size m
+     */
+    template <typename Arr> auto add_term(double d, const Arr &u) -> void {
+        this->_d.push_back(d);
+        for (auto i = 0U; i != this->_m; ++i) {
+            this->_u.push_back(u[i]);
+        }
+    }
+
+    /**
+     * @brief Rank (number of terms)
+     *
+     * @return size_t
+     */
+    auto rank() const -> size_t { return this->_d.size(); }
+
+    /**
+     * @brief Element (i, j), in O(r)
+     *
+     * @param[in] i
+     * @param[in] j
+     * @return double
+     */
+    auto operator()(size_t i, size_t j) const -> double {
+        auto res = 0.0;
+        for (auto r = 0U; r != this->rank(); ++r) {
+            const auto *u = &this->_u[r * this->_m];
+            res += this->_d[r] * u[i] * u[j];
+        }
+        return res;
+    }
+
+    /**
+     * @brief The first row with a nonzero element, or m if none
+     *
+     * @return size_t
+     */
+    auto first_row() const -> size_t {
+        auto row = this->_m;
+        for (auto r = 0U; r != this->rank(); ++r) {
+            const auto *u = &this->_u[r * this->_m];
+            auto i = 0U;
+            while (i != row && (this->_d[r] == 0.0 || u[i] == 0.0)) {
+                ++i;
+            }
+            row = i;
+        }
+        return row;
+    }
+
+    /**
+     * @brief A += alpha * this, on the lower triangle of A
+     *
+     * @tparam Mat
+     * @param[in,out] A
+     * @param[in] alpha
+     */
+    template <typename Mat> auto add_to(Mat &A, double alpha) const -> void {
+        for (auto r = 0U; r != this->rank(); ++r) {
+            const auto *u = &this->_u[r * this->_m];
+            const auto c = alpha * this->_d[r];
+            for (auto i = 0U; i != this->_m; ++i) {
+                const auto ci = c * u[i];
+                if (ci == 0.0) {
+                    continue;
+                }
+                for (auto j = 0U; j <= i; ++j) {
+                    A(i, j) += ci * u[j];
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief v' * this(start:stop, start:stop) * v
+     *
+     * @param[in] v
+     * @param[in] start
+     * @param[in] stop
+     * @return double
+     */
+    auto quad(const std::valarray<double> &v, size_t start, size_t stop) const -> double {
+        auto res = 0.0;
+        for (auto r = 0U; r != this->rank(); ++r) {
+            const auto *u = &this->_u[r * this->_m];
+            auto s = 0.0;
+            for (auto i = start; i != stop; ++i) {
+                s += u[i] * v[i];
+            }
+            res += this->_d[r] * s * s;
+        }
+        return res;
+    }
+};
+
+/**
+ * @brief Whether the LMI oracles assemble a matrix of type T by `add_to`
+ *
+ * Otherwise its elements are read one by one, as those of `Matrix`.
+ */
+template <typename T> struct is_structured_sym : std::false_type {};
+template <> struct is_structured_sym<SparseSym> : std::true_type {};
+template <> struct is_structured_sym<LowRankSym> : std::true_type {};
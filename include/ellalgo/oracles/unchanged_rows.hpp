@@ -0,0 +1,88 @@
+// -*- coding: utf-8 -*-
+#pragma once
+
+#include <algorithm>  // for min
+#include <cstddef>    // for size_t
+#include <valarray>
+#include <vector>
+
+#include "structured_sym.hpp"
+
+/**
+ * @brief The first row i of F with a nonzero element F(i, j), j <= i, or m if none
+ *
+ * @tparam Mat
+ * @param[in] F
+ * @param[in] m dimension
+ * @return size_t
+ */
+template <typename Mat> inline auto first_nonzero_row(const Mat &F, size_t m) -> size_t {
+    for (auto i = 0U; i != m; ++i) {
+        for (auto j = 0U; j <= i; ++j) {
+            if (F(i, j) != 0.0) {
+                return i;
+            }
+        }
+    }
+    return m;
+}
+
+inline auto first_nonzero_row(const SparseSym &F, size_t /* m */) -> size_t {
+    return F.first_row();
+}
+
+inline auto first_nonzero_row(const LowRankSym &F, size_t /* m */) -> size_t {
+    return F.first_row();
+}
+
+/**
+ * @brief Number of leading rows of A(x) = B -/+ F * x unchanged since the last x
+ *
+ * For every variable k, the first row in which F[k] has a nonzero element
+ * (in its lower triangle) is found once. A change of x[k] then leaves the
+ * rows of A before it unchanged, bit for bit. This is the case for
+ * structured LMIs, e.g. block-diagonal or banded ones, where each variable
+ * enters only a part of the matrix; with dense F[k], every change of x
+ * reaches all the rows, and nothing is saved.
+ */
+class UnchangedRows {
+    using Vec = std::valarray<double>;
+
+    std::vector<size_t> _first_row;  //!< first row of F[k] with a nonzero element
+    Vec _x_last;                     //!< x of the previous call
+
+  public:
+    /**
+     * @brief Count the unchanged rows, and remember x for the next call
+     *
+     * @tparam Mat
+     * @tparam Arr036
+     * @param[in] F
+     * @param[in] m dimension of the matrices
+     * @param[in] x
+     * @return the number of leading rows unchanged since the previous call (0 on the first)
+     */
+    template <typename Mat, typename Arr036>
+    auto count(const std::vector<Mat> &F, size_t m, const Arr036 &x) -> size_t {
+        const auto n = x.size();
+        if (this->_first_row.size() != n) {  // first call
+            this->_first_row.resize(n);
+            for (auto k = 0U; k != n; ++k) {
+                this->_first_row[k] = first_nonzero_row(F[k], m);
+            }
+            this->_x_last.resize(n);
+            for (auto k = 0U; k != n; ++k) {
+                this->_x_last[k] = x[k];
+            }
+            return 0U;
+        }
+        auto num_same = m;
+        for (auto k = 0U; k != n; ++k) {
+            if (x[k] != this->_x_last[k]) {
+                num_same = std::min(num_same, this->_first_row[k]);
+                this->_x_last[k] = x[k];
+            }
+        }
+        return num_same;
+    }
+};
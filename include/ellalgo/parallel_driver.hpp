@@ -0,0 +1,412 @@
+#pragma once
+
+#include <cassert>      // for assert
+#include <cstddef>      // for size_t
+#include <functional>   // for function
+#include <iterator>     // for distance
+#include <memory>       // for unique_ptr
+#include <tuple>        // for tuple
+#include <utility>      // for declval, move, pair
+#include <vector>
+
+#include "cutting_plane.hpp"
+#include "ell_config.hpp"
+#include "half_nonnegative.hpp"
+
+/**
+ * @brief Run fn(0), ..., fn(num_jobs - 1) on a pool of threads
+ *
+ * The jobs are handed out one at a time from a shared counter, so that a
+ * thread that has finished a short job immediately takes the next one, and
+ * no thread stays idle while jobs are left. The calls of fn must be
+ * independent of each other.
+ *
+ * If a call of fn throws, no more jobs are handed out; the jobs already
+ * running finish, the threads are joined, and the first exception is
+ * rethrown on the calling thread.
+ *
+ * @param[in] num_jobs
+ * @param[in] fn
+ * @param[in] num_threads - 0 for the number of hardware threads
+ */
+extern auto parallel_run(size_t num_jobs, const std::function<void(size_t)> &fn,
+                         size_t num_threads = 0U) -> void;
+
+/**
+ * @brief A thread that runs one task at a time in the background
+ *
+ * `post` hands it a task and returns at once; `wait` returns once the
+ * task is done. The thread is started by the constructor and joined by
+ * the destructor, so that a task costs a wake-up, not a thread start.
+ */
+class BackgroundWorker {
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+
+  public:
+    BackgroundWorker();
+    ~BackgroundWorker();
+    BackgroundWorker(const BackgroundWorker &) = delete;
+    auto operator=(const BackgroundWorker &) -> BackgroundWorker & = delete;
+
+    /**
+     * @brief Run task on the thread; the previous task must be waited for
+     *
+     * @param[in] task
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * @brief Wait until the posted task, if any, is done
+     */
+    void wait();
+};
+
+/**
+ * @brief One problem of the parallel drivers below
+ *
+ * The oracle and the search space are referenced, and must only be used
+ * by this job; `gamma` holds the best-so-far value of the job.
+ *
+ * @tparam Oracle
+ * @tparam Space
+ * @tparam Num
+ */
+template <typename Oracle, typename Space, typename Num = double> struct CuttingPlaneJob {
+    Oracle &omega;
+    Space &space;
+    Num gamma;
+};
+
+template <typename JobIt> using CuttingPlaneJobResult = std::tuple<
+    CuttingPlaneArrayType<decltype(std::declval<JobIt>()->space)>, size_t>;
+
+/**
+ * @brief Run `cutting_plane_optim` over the jobs [first, last) in parallel
+ *
+ * @tparam JobIt random access iterator to `CuttingPlaneJob`
+ * @param[in] first
+ * @param[in] last
+ * @param[in] options     maximum iteration and error tolerance etc.
+ * @param[in] num_threads 0 for the number of hardware threads
+ * @return the results of the jobs, in input order
+ */
+template <typename JobIt>
+inline auto parallel_cutting_plane_optim(JobIt first, JobIt last,
+                                         const Options &options = Options(),
+                                         size_t num_threads = 0U)
+    -> std::vector<CuttingPlaneJobResult<JobIt>> {
+    const auto num_jobs = static_cast<size_t>(std::distance(first, last));
+    auto results = std::vector<CuttingPlaneJobResult<JobIt>>(num_jobs);
+    parallel_run(
+        num_jobs,
+        [&](size_t idx) {
+            auto &job = first[static_cast<std::ptrdiff_t>(idx)];
+            results[idx] = cutting_plane_optim(job.omega, job.space, job.gamma, options);
+        },
+        num_threads);
+    return results;
+}
+
+/**
+ * @brief Run `cutting_plane_feas` over the jobs [first, last) in parallel
+ *
+ * The `gamma` of the jobs is not used.
+ *
+ * @tparam JobIt random access iterator to `CuttingPlaneJob`
+ * @param[in] first
+ * @param[in] last
+ * @param[in] options     maximum iteration and error tolerance etc.
+ * @param[in] num_threads 0 for the number of hardware threads
+ * @return the results of the jobs, in input order
+ */
+template <typename JobIt>
+inline auto parallel_cutting_plane_feas(JobIt first, JobIt last,
+                                        const Options &options = Options(),
+                                        size_t num_threads = 0U)
+    -> std::vector<CuttingPlaneJobResult<JobIt>> {
+    const auto num_jobs = static_cast<size_t>(std::distance(first, last));
+    auto results = std::vector<CuttingPlaneJobResult<JobIt>>(num_jobs);
+    parallel_run(
+        num_jobs,
+        [&](size_t idx) {
+            auto &job = first[static_cast<std::ptrdiff_t>(idx)];
+            results[idx] = cutting_plane_feas(job.omega, job.space, options);
+        },
+        num_threads);
+    return results;
+}
+
+/**
+ * @brief Run `cutting_plane_optim_q` over the jobs [first, last) in parallel
+ *
+ * @tparam JobIt random access iterator to `CuttingPlaneJob`
+ * @param[in] first
+ * @param[in] last
+ * @param[in] options     maximum iteration and error tolerance etc.
+ * @param[in] num_threads 0 for the number of hardware threads
+ * @return the results of the jobs, in input order
+ */
+template <typename JobIt>
+inline auto parallel_cutting_plane_optim_q(JobIt first, JobIt last,
+                                           const Options &options = Options(),
+                                           size_t num_threads = 0U)
+    -> std::vector<CuttingPlaneJobResult<JobIt>> {
+    const auto num_jobs = static_cast<size_t>(std::distance(first, last));
+    auto results = std::vector<CuttingPlaneJobResult<JobIt>>(num_jobs);
+    parallel_run(
+        num_jobs,
+        [&](size_t idx) {
+            auto &job = first[static_cast<std::ptrdiff_t>(idx)];
+            results[idx] = cutting_plane_optim_q(job.omega, job.space, job.gamma, options);
+        },
+        num_threads);
+    return results;
+}
+
+/**
+ * @brief Adaptor for `bsearch_parallel`: assesses several values of gamma at once
+ *
+ * Every probe runs `cutting_plane_feas` with its own oracle, on its own copy
+ * of the search space, on a thread of its own. The copies are made once,
+ * and every round copies the space into them again (see `Ell::copy_into`)
+ * instead of allocating new ones.
+ *
+ * @tparam Oracle
+ * @tparam Space
+ */
+template <typename Oracle, typename Space>  //
+class ParallelBSearchAdaptor {
+    using ArrayType = typename Space::ArrayType;
+
+    std::vector<Oracle *> _oracles;  //!< independent instances, one per probe
+    Space &_space;
+    const Options _options;
+    const size_t _num_threads;
+    std::vector<Space> _work;  //!< one per probe
+
+  public:
+    /**
+     * @brief Construct a new parallel bsearch adaptor object
+     *
+     * @param[in,out] oracles     independent oracles, one per probe (at least one)
+     * @param[in,out] space       search space containing x*
+     * @param[in]     options     maximum iteration and error tolerance etc.
+     * @param[in]     num_threads 0 for the number of hardware threads
+     */
+    ParallelBSearchAdaptor(std::vector<Oracle *> oracles, Space &space,
+                           const Options &options = Options(), size_t num_threads = 0U)
+        : _oracles{std::move(oracles)},
+          _space{space},
+          _options{options},
+          _num_threads{num_threads} {
+        this->_work.reserve(this->_oracles.size());
+        for (auto idx = 0U; idx != this->_oracles.size(); ++idx) {
+            this->_work.push_back(space.copy());
+        }
+    }
+
+    /**
+     * @brief Number of values of gamma assessed at once
+     *
+     * @return size_t
+     */
+    auto num_probes() const -> size_t { return this->_oracles.size(); }
+
+    /**
+     * @brief get best x, as the space gives its centre (e.g. without a copy)
+     *
+     * @return auto
+     */
+    auto x_best() const -> decltype(std::declval<const Space &>().xc()) {
+        return this->_space.xc();
+    }
+
+    /**
+     * @brief Assess the values of gamma (in ascending order) in parallel
+     *
+     * @tparam Num
+     * @param[in] gammas - `num_probes()` values
+     * @return the index of the first feasible gamma, or `num_probes()` if none
+     */
+    template <typename Num> auto assess_bs(const std::vector<Num> &gammas) -> size_t {
+        const auto num = this->num_probes();
+        auto x_feas = std::vector<ArrayType>(num);
+        parallel_run(
+            num,
+            [&](size_t idx) {
+                auto &space = this->_work[idx];
+                this->_space.copy_into(space);  // no allocation
+                auto &omega = *this->_oracles[idx];
+                omega.update(gammas[idx]);
+                x_feas[idx] = std::get<0>(cutting_plane_feas(omega, space, this->_options));
+            },
+            this->_num_threads);
+        for (auto idx = 0U; idx != num; ++idx) {
+            if (x_feas[idx].size() != 0U) {
+                this->_space.set_xc(x_feas[idx]);
+                return idx;
+            }
+        }
+        return num;
+    }
+};
+
+/**
+ * @brief k-ary search, assessing k - 1 values of gamma per round in parallel
+ *
+ * The parallel version of `bsearch`, with k - 1 = `omega.num_probes()`:
+ * every round splits the interval into k equal parts, and keeps the one
+ * containing the first feasible value. It thus takes about log2(k) times
+ * fewer rounds than `bsearch`, and is the same as `bsearch` for k = 2.
+ *
+ * @tparam Oracle e.g. `ParallelBSearchAdaptor`
+ * @tparam T
+ * @param[in,out] omega   perform assessment on gammas
+ * @param[in,out] intvl   interval containing x*
+ * @param[in]     options maximum iteration and error tolerance etc.
+ * @return the upper bound, and the number of rounds
+ */
+template <typename Oracle, typename T>
+inline auto bsearch_parallel(Oracle &omega, const std::pair<T, T> &intvl,
+                             const Options &options = Options()) -> std::tuple<T, size_t> {
+    // assume monotone
+    auto lower = intvl.first;
+    auto upper = intvl.second;
+    assert(lower <= upper);
+    const auto num = omega.num_probes();
+    assert(num >= 1U);
+    auto gammas = std::vector<T>(num, lower);
+
+    for (auto niter = 0U; niter < options.max_iters; ++niter) {
+        const auto width = upper - lower;
+        if (algo::half_nonnegative(width) < options.tolerance) {  // no more
+            return {upper, niter};
+        }
+        for (auto idx = 0U; idx != num; ++idx) {
+            gammas[idx] = lower;  // l may be `int` or `Fraction`
+            gammas[idx] += width * static_cast<T>(idx + 1) / static_cast<T>(num + 1);
+        }
+        const auto first = omega.assess_bs(gammas);
+        if (first != num) {  // feasible sol'n obtained
+            upper = gammas[first];
+        }
+        if (first != 0U) {
+            lower = gammas[first - 1];
+        }
+    }
+    return {upper, options.max_iters};
+}
+
+namespace detail {
+    /**
+     * @brief The observer of the pipelined methods
+     *
+     * Applies the pending update of the space on the worker while the
+     * oracle runs, then hands the iteration over to the observer.
+     */
+    template <typename Space, typename Observer> class PipelineObserver {
+        Space &_space;
+        Observer &_observer;
+        BackgroundWorker _worker;
+
+      public:
+        PipelineObserver(Space &space, Observer &observer)
+            : _space{space}, _observer{observer} {}
+
+        void oracle_begin() {
+            this->_observer.oracle_begin();
+            auto &space = this->_space;
+            this->_worker.post([&space]() { space.flush(); });
+        }
+
+        void oracle_end() {
+            this->_observer.oracle_end();
+            this->_worker.wait();  // before the next update, which reads mq
+        }
+
+        void update_end(const CutRecord &record) { this->_observer.update_end(record); }
+
+        auto stop_now(double gamma) -> bool { return detail::stop_now(this->_observer, gamma); }
+    };
+}  // namespace detail
+
+/**
+ * @brief `cutting_plane_feas`, updating the space while the oracle runs
+ *
+ * The update of the ellipsoid by a cut is split in two: the center moves
+ * at once, while the O(n^2) update of the shape matrix is deferred (see
+ * `Ell::flush`). Here, that deferred part is done on a worker thread while
+ * the oracle assesses the new center, instead of in the next update. Both
+ * orders give the same iterates bit for bit, so that the result is that
+ * of `cutting_plane_feas`, in about max(oracle, update) per iteration
+ * instead of their sum, for an oracle and a dimension large enough to
+ * hide a thread wake-up.
+ *
+ * The oracle must not touch the space while it runs, except through the
+ * (copied) center and `grad_buffer()` it is given; the observer's
+ * `update_seconds` then also counts the wait for the worker.
+ *
+ * @tparam OracleFeas
+ * @tparam SearchSpace e.g. `Ell` or `EllStable`, with `flush()`
+ * @tparam Observer e.g. `SolverStats`, see `NullObserver`
+ * @param[in,out] omega    perform assessment on x0
+ * @param[in,out] space    search Space containing x*
+ * @param[in]     options  maximum iteration and error tolerance etc.
+ * @param[in,out] observer notified of every iteration
+ * @return Information of Cutting-plane method
+ */
+template <typename OracleFeas, typename SearchSpace, typename Observer>
+inline auto cutting_plane_feas_pipelined(OracleFeas &omega, SearchSpace &space,
+                                         const Options &options, Observer &observer)
+    -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    detail::PipelineObserver<SearchSpace, Observer> pipeline{space, observer};
+    return cutting_plane_feas(omega, space, options, pipeline);
+}
+
+/**
+ * @brief `cutting_plane_feas_pipelined`, without an observer
+ */
+template <typename OracleFeas, typename SearchSpace>
+inline auto cutting_plane_feas_pipelined(OracleFeas &omega, SearchSpace &space,
+                                         const Options &options = Options())
+    -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    auto observer = NullObserver{};
+    return cutting_plane_feas_pipelined(omega, space, options, observer);
+}
+
+/**
+ * @brief `cutting_plane_optim`, updating the space while the oracle runs
+ *
+ * See `cutting_plane_feas_pipelined`: the result is that of
+ * `cutting_plane_optim`, bit for bit.
+ *
+ * @tparam OracleOptim
+ * @tparam SearchSpace e.g. `Ell` or `EllStable`, with `flush()`
+ * @tparam Num
+ * @tparam Observer e.g. `SolverStats`, see `NullObserver`
+ * @param[in,out] omega    perform assessment on x0
+ * @param[in,out] space    search Space containing x*
+ * @param[in,out] gamma    best-so-far optimal sol'n
+ * @param[in]     options  maximum iteration and error tolerance etc.
+ * @param[in,out] observer notified of every iteration
+ * @return Information of Cutting-plane method
+ */
+template <typename OracleOptim, typename SearchSpace, typename Num, typename Observer>
+inline auto cutting_plane_optim_pipelined(OracleOptim &omega, SearchSpace &space, Num &gamma,
+                                          const Options &options, Observer &observer)
+    -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    detail::PipelineObserver<SearchSpace, Observer> pipeline{space, observer};
+    return cutting_plane_optim(omega, space, gamma, options, pipeline);
+}
+
+/**
+ * @brief `cutting_plane_optim_pipelined`, without an observer
+ */
+template <typename OracleOptim, typename SearchSpace, typename Num>
+inline auto cutting_plane_optim_pipelined(OracleOptim &omega, SearchSpace &space, Num &gamma,
+                                          const Options &options = Options())
+    -> std::tuple<CuttingPlaneArrayType<SearchSpace>, size_t> {
+    auto observer = NullObserver{};
+    return cutting_plane_optim_pipelined(omega, space, gamma, options, observer);
+}
@@ -0,0 +1,275 @@
+#include <algorithm>                           // for sort
+#include <cmath>                               // for sqrt
+#include <ellalgo/cg_engine.hpp>               // for SymCsrMatrix, Ic0Preconditioner
+#include <ellalgo/oracles/structured_sym.hpp>  // for SparseSym
+#include <stdexcept>                           // for runtime_error
+#include <tuple>                               // for tie
+#include <vector>                              // for vector
+
+auto cg_kernel::dot(const double *x, const double *y, size_t n) -> double {
+    auto res = 0.0;
+    for (size_t i = 0; i != n; ++i) {
+        res += x[i] * y[i];
+    }
+    return res;
+}
+
+auto cg_kernel::axpy(double alpha, const double *x, double *y, size_t n) -> void {
+    for (size_t i = 0; i != n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+auto cg_kernel::xpby(const double *z, double beta, double *p, size_t n) -> void {
+    for (size_t i = 0; i != n; ++i) {
+        p[i] = z[i] + beta * p[i];
+    }
+}
+
+auto cg_kernel::update_x_r(double alpha, const double *p, const double *ap, double *x, double *r,
+                           size_t n) -> double {
+    auto rr = 0.0;
+    for (size_t i = 0; i != n; ++i) {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * ap[i];
+        rr += r[i] * r[i];
+    }
+    return rr;
+}
+
+auto cg_kernel::dot_block(const double *x, const double *y, size_t n, size_t k, double *res)
+    -> void {
+    for (size_t j = 0; j != k; ++j) {
+        res[j] = 0.0;
+    }
+    for (size_t i = 0; i != n; ++i) {
+        for (size_t j = 0; j != k; ++j) {
+            res[j] += x[i * k + j] * y[i * k + j];
+        }
+    }
+}
+
+auto cg_kernel::xpby_block(const double *z, const double *beta, double *p, size_t n, size_t k)
+    -> void {
+    for (size_t i = 0; i != n; ++i) {
+        for (size_t j = 0; j != k; ++j) {
+            p[i * k + j] = z[i * k + j] + beta[j] * p[i * k + j];
+        }
+    }
+}
+
+auto cg_kernel::update_x_r_block(const double *alpha, const double *p, const double *ap, double *x,
+                                 double *r, size_t n, size_t k, double *rr) -> void {
+    for (size_t j = 0; j != k; ++j) {
+        rr[j] = 0.0;
+    }
+    for (size_t i = 0; i != n; ++i) {
+        for (size_t j = 0; j != k; ++j) {
+            x[i * k + j] += alpha[j] * p[i * k + j];
+            r[i * k + j] -= alpha[j] * ap[i * k + j];
+            rr[j] += r[i * k + j] * r[i * k + j];
+        }
+    }
+}
+
+SymCsrMatrix::SymCsrMatrix(const SparseSym &mat) : _n{mat.size()}, _row_start(mat.size() + 1) {
+    struct Triplet {
+        size_t i;
+        size_t j;
+        double val;
+    };
+    auto triplets = std::vector<Triplet>{};
+    triplets.reserve(2 * mat.nnz());
+    for (const auto &entry : mat.entries()) {
+        triplets.push_back(Triplet{entry.i, entry.j, entry.val});
+        if (entry.i != entry.j) {
+            triplets.push_back(Triplet{entry.j, entry.i, entry.val});
+        }
+    }
+    std::sort(triplets.begin(), triplets.end(), [](const Triplet &a, const Triplet &b) {
+        return std::tie(a.i, a.j) < std::tie(b.i, b.j);
+    });
+
+    this->_col.reserve(triplets.size());
+    this->_val.reserve(triplets.size());
+    for (auto k = 0U; k != triplets.size(); ++k) {
+        const auto &t = triplets[k];
+        if (k != 0U && t.i == triplets[k - 1].i && t.j == triplets[k - 1].j) {
+            this->_val.back() += t.val;  // given more than once
+            continue;
+        }
+        this->_col.push_back(t.j);
+        this->_val.push_back(t.val);
+        ++this->_row_start[t.i + 1];
+    }
+    for (auto i = 0U; i != this->_n; ++i) {
+        this->_row_start[i + 1] += this->_row_start[i];
+    }
+}
+
+auto SymCsrMatrix::apply(const double *x, double *y) const -> void {
+    const auto *row_start = this->_row_start.data();
+    const auto *col = this->_col.data();
+    const auto *val = this->_val.data();
+    for (size_t i = 0; i != this->_n; ++i) {
+        auto sum = 0.0;
+        for (auto k = row_start[i]; k != row_start[i + 1]; ++k) {
+            sum += val[k] * x[col[k]];
+        }
+        y[i] = sum;
+    }
+}
+
+auto SymCsrMatrix::apply_block(const double *X, double *Y, size_t k) const -> void {
+    const auto *row_start = this->_row_start.data();
+    const auto *col = this->_col.data();
+    const auto *val = this->_val.data();
+    for (size_t i = 0; i != this->_n; ++i) {
+        auto *y = Y + i * k;
+        for (size_t j = 0; j != k; ++j) {
+            y[j] = 0.0;
+        }
+        for (auto p = row_start[i]; p != row_start[i + 1]; ++p) {
+            const auto a = val[p];
+            const auto *x = X + col[p] * k;
+            for (size_t j = 0; j != k; ++j) {
+                y[j] += a * x[j];
+            }
+        }
+    }
+}
+
+auto SymCsrMatrix::diagonal() const -> std::vector<double> {
+    auto diag = std::vector<double>(this->_n, 0.0);
+    for (auto i = 0U; i != this->_n; ++i) {
+        for (auto k = this->_row_start[i]; k != this->_row_start[i + 1]; ++k) {
+            if (this->_col[k] == i) {
+                diag[i] = this->_val[k];
+            }
+        }
+    }
+    return diag;
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const std::vector<double> &diag)
+    : _inv_diag(diag.size()) {
+    for (auto i = 0U; i != diag.size(); ++i) {
+        if (!(diag[i] > 0.0)) {
+            throw std::runtime_error("JacobiPreconditioner: diagonal element not positive");
+        }
+        this->_inv_diag[i] = 1.0 / diag[i];
+    }
+}
+
+/* Row by row, L(i, j) = (A(i, j) - L(i, 0:j) * L(j, 0:j)') / L(j, j) on the pattern of A, where
+the sparse products merge the two rows, both in increasing column order. */
+Ic0Preconditioner::Ic0Preconditioner(const SymCsrMatrix &mat) : _row_start(mat.size() + 1) {
+    const auto n = mat.size();
+    const auto &row_start = mat.row_start();
+    const auto &col = mat.col();
+    const auto &val = mat.val();
+    for (auto i = 0U; i != n; ++i) {
+        auto diag = 0.0;
+        for (auto k = row_start[i]; k != row_start[i + 1]; ++k) {
+            if (col[k] < i) {
+                this->_col.push_back(col[k]);
+                this->_val.push_back(val[k]);
+            } else if (col[k] == i) {
+                diag = val[k];
+            }
+        }
+        this->_col.push_back(i);
+        this->_val.push_back(diag);
+        this->_row_start[i + 1] = this->_col.size();
+
+        const auto start_i = this->_row_start[i];
+        for (auto k = start_i; k != this->_row_start[i + 1]; ++k) {
+            const auto j = this->_col[k];
+            // L(i, 0:j) * L(j, 0:j)', the diagonal of row j excluded
+            auto sum = 0.0;
+            auto p = start_i;
+            auto q = this->_row_start[j];
+            const auto q_end = this->_row_start[j + 1] - (j == i ? 0U : 1U);
+            while (p != k && q != q_end) {
+                if (this->_col[p] < this->_col[q]) {
+                    ++p;
+                } else if (this->_col[q] < this->_col[p]) {
+                    ++q;
+                } else {
+                    sum += this->_val[p++] * this->_val[q++];
+                }
+            }
+            if (j != i) {
+                this->_val[k] = (this->_val[k] - sum) / this->_val[this->_row_start[j + 1] - 1];
+                continue;
+            }
+            const auto pivot = this->_val[k] - sum;
+            if (!(pivot > 0.0)) {
+                throw std::runtime_error("Ic0Preconditioner: pivot not positive");
+            }
+            this->_val[k] = std::sqrt(pivot);
+        }
+    }
+}
+
+auto Ic0Preconditioner::apply(const double *r, double *z, size_t n) const -> void {
+    const auto *row_start = this->_row_start.data();
+    const auto *col = this->_col.data();
+    const auto *val = this->_val.data();
+    // L y = r
+    for (size_t i = 0; i != n; ++i) {
+        auto sum = r[i];
+        const auto last = row_start[i + 1] - 1;
+        for (auto k = row_start[i]; k != last; ++k) {
+            sum -= val[k] * z[col[k]];
+        }
+        z[i] = sum / val[last];
+    }
+    // L' z = y, by the columns of L'
+    for (auto i = n; i-- != 0;) {
+        const auto last = row_start[i + 1] - 1;
+        z[i] /= val[last];
+        for (auto k = row_start[i]; k != last; ++k) {
+            z[col[k]] -= val[k] * z[i];
+        }
+    }
+}
+
+auto Ic0Preconditioner::apply_block(const double *R, double *Z, size_t n, size_t k) const -> void {
+    const auto *row_start = this->_row_start.data();
+    const auto *col = this->_col.data();
+    const auto *val = this->_val.data();
+    // L Y = R
+    for (size_t i = 0; i != n; ++i) {
+        auto *z = Z + i * k;
+        for (size_t j = 0; j != k; ++j) {
+            z[j] = R[i * k + j];
+        }
+        const auto last = row_start[i + 1] - 1;
+        for (auto p = row_start[i]; p != last; ++p) {
+            const auto a = val[p];
+            const auto *zc = Z + col[p] * k;
+            for (size_t j = 0; j != k; ++j) {
+                z[j] -= a * zc[j];
+            }
+        }
+        for (size_t j = 0; j != k; ++j) {
+            z[j] /= val[last];
+        }
+    }
+    // L' Z = Y, by the columns of L'
+    for (auto i = n; i-- != 0;) {
+        auto *z = Z + i * k;
+        const auto last = row_start[i + 1] - 1;
+        for (size_t j = 0; j != k; ++j) {
+            z[j] /= val[last];
+        }
+        for (auto p = row_start[i]; p != last; ++p) {
+            const auto a = val[p];
+            auto *zc = Z + col[p] * k;
+            for (size_t j = 0; j != k; ++j) {
+                zc[j] -= a * z[j];
+            }
+        }
+    }
+}
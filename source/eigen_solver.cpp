@@ -0,0 +1,259 @@
+#include <algorithm>                 // for max, min, swap
+#include <cmath>                     // for sqrt, abs, sin
+#include <ellalgo/eigen_solver.hpp>  // for eigen_kernel
+
+auto eigen_kernel::sym_eigen(double *a, size_t m, double *vecs, double *vals) -> void {
+    for (size_t i = 0; i != m * m; ++i) {
+        vecs[i] = 0.0;
+    }
+    for (size_t i = 0; i != m; ++i) {
+        vecs[i * m + i] = 1.0;
+    }
+    for (auto sweep = 0; sweep != 100; ++sweep) {
+        auto off = 0.0;
+        auto total = 0.0;
+        for (size_t p = 0; p != m; ++p) {
+            total += a[p * m + p] * a[p * m + p];
+            for (auto q = p + 1; q != m; ++q) {
+                off += a[p * m + q] * a[p * m + q];
+            }
+        }
+        if (off <= 1e-32 * total) {
+            break;
+        }
+        for (size_t p = 0; p != m; ++p) {
+            for (auto q = p + 1; q != m; ++q) {
+                const auto apq = a[p * m + q];
+                if (apq == 0.0) {
+                    continue;
+                }
+                // the rotation J with J' A J (p, q) = 0, the smaller angle
+                const auto phi = (a[q * m + q] - a[p * m + p]) / (2.0 * apq);
+                const auto t
+                    = (phi >= 0.0 ? 1.0 : -1.0) / (std::abs(phi) + std::sqrt(phi * phi + 1.0));
+                const auto c = 1.0 / std::sqrt(t * t + 1.0);
+                const auto s = t * c;
+                for (size_t r = 0; r != m; ++r) {  // A J
+                    const auto arp = a[r * m + p];
+                    const auto arq = a[r * m + q];
+                    a[r * m + p] = c * arp - s * arq;
+                    a[r * m + q] = s * arp + c * arq;
+                }
+                for (size_t r = 0; r != m; ++r) {  // J' (A J)
+                    const auto apr = a[p * m + r];
+                    const auto aqr = a[q * m + r];
+                    a[p * m + r] = c * apr - s * aqr;
+                    a[q * m + r] = s * apr + c * aqr;
+                }
+                for (size_t r = 0; r != m; ++r) {  // V J
+                    const auto vrp = vecs[r * m + p];
+                    const auto vrq = vecs[r * m + q];
+                    vecs[r * m + p] = c * vrp - s * vrq;
+                    vecs[r * m + q] = s * vrp + c * vrq;
+                }
+            }
+        }
+    }
+
+    // in decreasing order, by selection
+    for (size_t i = 0; i != m; ++i) {
+        vals[i] = a[i * m + i];
+    }
+    for (size_t i = 0; i != m; ++i) {
+        auto best = i;
+        for (auto j = i + 1; j != m; ++j) {
+            if (vals[j] > vals[best]) {
+                best = j;
+            }
+        }
+        if (best != i) {
+            std::swap(vals[i], vals[best]);
+            for (size_t r = 0; r != m; ++r) {
+                std::swap(vecs[r * m + i], vecs[r * m + best]);
+            }
+        }
+    }
+}
+
+/* The number of eigenvalues of T less than x is the number of negative pivots of T - x I (Sturm),
+and the bisection starts from the Gershgorin interval. */
+auto eigen_kernel::tridiag_eigenvalue(const double *diag, const double *offdiag, size_t m, size_t j)
+    -> double {
+    auto lo = diag[0];
+    auto hi = diag[0];
+    for (size_t i = 0; i != m; ++i) {
+        const auto radius = (i != 0 ? std::abs(offdiag[i - 1]) : 0.0)
+                            + (i + 1 != m ? std::abs(offdiag[i]) : 0.0);
+        lo = std::min(lo, diag[i] - radius);
+        hi = std::max(hi, diag[i] + radius);
+    }
+    const auto num_less = [&](double x) -> size_t {
+        auto count = size_t{0};
+        auto q = diag[0] - x;
+        for (size_t i = 0;; ++i) {
+            if (q == 0.0) {
+                q = -1e-300;
+            }
+            count += q < 0.0 ? 1U : 0U;
+            if (i + 1 == m) {
+                return count;
+            }
+            q = diag[i + 1] - x - offdiag[i] * offdiag[i] / q;
+        }
+    };
+    for (auto it = 0; it != 200; ++it) {
+        const auto mid = 0.5 * (lo + hi);
+        if (mid <= lo || mid >= hi) {
+            break;
+        }
+        if (num_less(mid) >= m - j) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    return hi;
+}
+
+/* As LAPACK's dgttrf and dgtts2: the U factor has two superdiagonals, du and du2, after the row
+interchanges, and a zero pivot is replaced by a tiny one, as for an eigenvalue theta. */
+auto eigen_kernel::tridiag_eigenvector(const double *diag, const double *offdiag, size_t m,
+                                       double theta, double *s, double *work) -> void {
+    auto *d = work;
+    auto *dl = work + m;
+    auto *du = work + 2 * m;
+    auto *du2 = work + 3 * m;
+    auto *swapped = work + 4 * m;  // whether the rows i and i + 1 were interchanged
+    auto scale = 0.0;
+    for (size_t i = 0; i != m; ++i) {
+        d[i] = diag[i] - theta;
+        dl[i] = du[i] = i + 1 != m ? offdiag[i] : 0.0;
+        du2[i] = 0.0;
+        swapped[i] = 0.0;
+        scale = std::max(scale, std::abs(diag[i]) + std::abs(dl[i]));
+    }
+    const auto tiny = 1e-16 * (scale > 0.0 ? scale : 1.0);
+    for (size_t i = 0; i + 1 < m; ++i) {
+        if (std::abs(d[i]) >= std::abs(dl[i])) {
+            if (d[i] == 0.0) {
+                d[i] = tiny;
+            }
+            dl[i] /= d[i];
+            d[i + 1] -= dl[i] * du[i];
+        } else {
+            const auto fact = d[i] / dl[i];
+            d[i] = dl[i];
+            dl[i] = fact;
+            const auto temp = du[i];
+            du[i] = d[i + 1];
+            d[i + 1] = temp - fact * d[i + 1];
+            if (i + 2 < m) {
+                du2[i] = du[i + 1];
+                du[i + 1] = -fact * du[i + 1];
+            }
+            swapped[i] = 1.0;
+        }
+    }
+    if (d[m - 1] == 0.0) {
+        d[m - 1] = tiny;
+    }
+
+    for (size_t i = 0; i != m; ++i) {
+        s[i] = 1.0;
+    }
+    for (auto step = 0; step != 2; ++step) {
+        for (size_t i = 0; i + 1 < m; ++i) {  // L
+            if (swapped[i] != 0.0) {
+                const auto temp = s[i];
+                s[i] = s[i + 1];
+                s[i + 1] = temp - dl[i] * s[i];
+            } else {
+                s[i + 1] -= dl[i] * s[i];
+            }
+        }
+        for (auto i = m; i-- != 0;) {  // U
+            auto sum = s[i];
+            if (i + 1 < m) {
+                sum -= du[i] * s[i + 1];
+            }
+            if (i + 2 < m) {
+                sum -= du2[i] * s[i + 2];
+            }
+            s[i] = sum / d[i];
+        }
+        auto nrm = 0.0;
+        for (size_t i = 0; i != m; ++i) {
+            nrm += s[i] * s[i];
+        }
+        nrm = std::sqrt(nrm);
+        for (size_t i = 0; i != m; ++i) {
+            s[i] /= nrm;
+        }
+    }
+}
+
+auto eigen_kernel::orthonormalize(double *X, size_t n, size_t k) -> void {
+    for (size_t j = 0; j != k; ++j) {
+        for (auto attempt = 0; attempt != 2; ++attempt) {
+            for (auto pass = 0; pass != 2; ++pass) {
+                for (size_t a = 0; a != j; ++a) {
+                    auto d = 0.0;
+                    for (size_t i = 0; i != n; ++i) {
+                        d += X[i * k + a] * X[i * k + j];
+                    }
+                    for (size_t i = 0; i != n; ++i) {
+                        X[i * k + j] -= d * X[i * k + a];
+                    }
+                }
+            }
+            auto nrm = 0.0;
+            for (size_t i = 0; i != n; ++i) {
+                nrm += X[i * k + j] * X[i * k + j];
+            }
+            nrm = std::sqrt(nrm);
+            if (nrm > 1e-150) {
+                for (size_t i = 0; i != n; ++i) {
+                    X[i * k + j] /= nrm;
+                }
+                break;
+            }
+            for (size_t i = 0; i != n; ++i) {  // vanished: start again from a fixed vector
+                X[i * k + j] = std::sin(1.0 + double(i) + 0.7 * double(j));
+            }
+        }
+    }
+}
+
+auto eigen_kernel::project(const double *X, const double *Y, size_t n, size_t k, double *proj)
+    -> void {
+    for (size_t a = 0; a != k * k; ++a) {
+        proj[a] = 0.0;
+    }
+    for (size_t i = 0; i != n; ++i) {
+        for (size_t a = 0; a != k; ++a) {
+            for (size_t b = 0; b != k; ++b) {
+                proj[a * k + b] += X[i * k + a] * Y[i * k + b];
+            }
+        }
+    }
+    for (size_t a = 0; a != k; ++a) {
+        for (size_t b = 0; b != a; ++b) {
+            proj[a * k + b] = proj[b * k + a] = 0.5 * (proj[a * k + b] + proj[b * k + a]);
+        }
+    }
+}
+
+auto eigen_kernel::rotate(double *X, size_t n, size_t k, const double *S, double *row) -> void {
+    for (size_t i = 0; i != n; ++i) {
+        auto *x = X + i * k;
+        for (size_t b = 0; b != k; ++b) {
+            row[b] = 0.0;
+            for (size_t a = 0; a != k; ++a) {
+                row[b] += x[a] * S[a * k + b];
+            }
+        }
+        for (size_t b = 0; b != k; ++b) {
+            x[b] = row[b];
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#include <cassert>                  // for assert
+#include <ellalgo/ell1d_batch.hpp>  // for Ell1dBatch
+#include <ellalgo/ell_config.hpp>   // for CutStatus, CutStatus::Success
+#include <ellalgo/ell_kernel.hpp>   // for batch_interval_cut
+#include <valarray>                 // for valarray
+#include <vector>                   // for vector
+
+using Vec = std::valarray<double>;
+
+static auto round_up(size_t num, size_t block) -> size_t {
+    return (num + block - 1) / block * block;
+}
+
+Ell1dBatch::Ell1dBatch(const Vec &l, const Vec &u)
+    : _num{l.size()},
+      _stride{round_up(_num, lane_block)},
+      _xc(0.0, _stride),
+      _r(0.0, _stride),
+      _tsq(0.0, _stride),
+      _active(false, _stride),
+      _status(_stride, CutStatus::Success),
+      _g(0.0, _stride),
+      _none(false, _stride),
+      _code(0.0, _stride) {
+    assert(this->_num != 0U);
+    assert(u.size() == this->_num);
+    for (auto k = 0U; k != this->_num; ++k) {
+        this->_active[k] = true;
+        this->_r[k] = (u[k] - l[k]) / 2;  // as ell1d
+        this->_xc[k] = l[k] + this->_r[k];
+    }
+}
+
+Ell1dBatch::Ell1dBatch(double l, double u, size_t num) : Ell1dBatch{Vec(l, num), Vec(u, num)} {}
+
+auto Ell1dBatch::num_active() const -> size_t {
+    auto count = 0U;
+    for (auto k = 0U; k != this->_num; ++k) {
+        count += this->_active[k] ? 1U : 0U;
+    }
+    return count;
+}
+
+auto Ell1dBatch::update_bias_cut(const Vec &grad, const Vec &beta) -> void {
+    this->_update(grad, beta, this->_none);
+}
+
+auto Ell1dBatch::update_central_cut(const Vec &grad, const Vec &beta) -> void {
+    this->_update(grad, beta, this->_active);  // central where active
+}
+
+auto Ell1dBatch::update_optim_cut(const Vec &grad, const Vec &beta, const Mask &central) -> void {
+    this->_update(grad, beta, central);
+}
+
+auto Ell1dBatch::_update(const Vec &grad, const Vec &beta, const Mask &central) -> void {
+    assert(grad.size() >= this->_stride && beta.size() >= this->_stride);
+    assert(central.size() >= this->_stride);
+    ell_kernel::batch_interval_cut(&grad[0], &beta[0], &this->_active[0], &central[0],
+                                   &this->_xc[0], &this->_r[0], &this->_tsq[0], &this->_code[0],
+                                   this->_stride);
+    for (auto k = 0U; k != this->_num; ++k) {  // as they were where masked off
+        this->_status[k] = static_cast<CutStatus>(static_cast<int>(this->_code[k]));
+    }
+}
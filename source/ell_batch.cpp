@@ -0,0 +1,126 @@
+#include <cassert>                 // for assert
+#include <ellalgo/ell_batch.hpp>   // for EllBatch
+#include <ellalgo/ell_calc.hpp>    // for EllCalc, CutBatch
+#include <ellalgo/ell_config.hpp>  // for CutStatus, CutStatus::Success
+#include <ellalgo/ell_kernel.hpp>  // for batch_matvec, batch_rank_one
+#include <tuple>                   // for tuple
+#include <valarray>                // for valarray
+#include <vector>                  // for vector
+
+using Vec = std::valarray<double>;
+
+static auto round_up(size_t num, size_t block) -> size_t {
+    return (num + block - 1) / block * block;
+}
+
+EllBatch::EllBatch(const Vec &val, const Vec &x0, size_t num)
+    : _n{x0.size()},
+      _num{num},
+      _stride{round_up(num, lane_block)},
+      _xc(0.0, _n * _stride),
+      _mq(0.0, _n * (_n + 1) / 2 * _stride),
+      _kappa(1.0, _stride),
+      _tsq(0.0, _stride),
+      _active(false, _stride),
+      _status(_stride, CutStatus::Success),
+      _helper{_n},
+      _g(0.0, _n * _stride),
+      _qg(0.0, _n * _stride),
+      _omega(0.0, _stride),
+      _r(0.0, _stride),
+      _s(0.0, _stride),
+      _rho(0.0, 2 * _stride),
+      _sigma(0.0, 2 * _stride),
+      _delta(0.0, 2 * _stride),
+      _cut_status(2 * _stride, CutStatus::Success) {
+    assert(num != 0U);
+    assert(val.size() == this->_n);
+    for (auto k = 0U; k != num; ++k) {
+        this->_active[k] = true;
+        this->set_xc(k, x0);
+        for (auto i = 0U; i != this->_n; ++i) {
+            this->_mq[this->_pos(i, i) * this->_stride + k] = val[i];
+        }
+    }
+}
+
+EllBatch::EllBatch(double alpha, const Vec &x0, size_t num)
+    : EllBatch{Vec(1.0, x0.size()), x0, num} {
+    for (auto k = 0U; k != num; ++k) {
+        this->_kappa[k] = alpha;
+    }
+}
+
+auto EllBatch::xc(size_t k) const -> Vec {
+    auto x = Vec(this->_n);
+    for (auto i = 0U; i != this->_n; ++i) {
+        x[i] = this->_xc[i * this->_stride + k];
+    }
+    return x;
+}
+
+auto EllBatch::set_xc(size_t k, const Vec &x) -> void {
+    for (auto i = 0U; i != this->_n; ++i) {
+        this->_xc[i * this->_stride + k] = x[i];
+    }
+}
+
+auto EllBatch::num_active() const -> size_t {
+    auto count = 0U;
+    for (auto k = 0U; k != this->_num; ++k) {
+        count += this->_active[k] ? 1U : 0U;
+    }
+    return count;
+}
+
+auto EllBatch::update_bias_cut(const Vec &grad, const Vec &beta) -> void {
+    this->_update_core(grad, [this, &beta](const double *tsq) {
+        this->_helper.calc_bias_cut_batch(&beta[0], tsq, this->_num, this->_cuts(0U));
+    });
+}
+
+auto EllBatch::update_central_cut(const Vec &grad, const Vec & /* beta */) -> void {
+    this->_update_core(grad, [this](const double *tsq) {
+        this->_helper.calc_central_cut_batch(tsq, this->_num, this->_cuts(0U));
+    });
+}
+
+auto EllBatch::update_q(const Vec &grad, const Vec &beta) -> void {
+    this->_update_core(grad, [this, &beta](const double *tsq) {
+        this->_helper.calc_bias_cut_q_batch(&beta[0], tsq, this->_num, this->_cuts(0U));
+    });
+}
+
+auto EllBatch::update_optim_cut(const Vec &grad, const Vec &beta, const Mask &central) -> void {
+    this->_update_core(grad, [this, &beta, &central](const double *tsq) {
+        const auto S = this->_stride;
+        this->_helper.calc_bias_cut_batch(&beta[0], tsq, this->_num, this->_cuts(0U));
+        this->_helper.calc_central_cut_batch(tsq, this->_num, this->_cuts(S));
+        for (auto k = 0U; k != this->_num; ++k) {
+            const auto c = central[k];
+            this->_cut_status[k] = c ? this->_cut_status[S + k] : this->_cut_status[k];
+            this->_rho[k] = c ? this->_rho[S + k] : this->_rho[k];
+            this->_sigma[k] = c ? this->_sigma[S + k] : this->_sigma[k];
+            this->_delta[k] = c ? this->_delta[S + k] : this->_delta[k];
+        }
+    });
+}
+
+auto EllBatch::_load(const Vec &grad) -> void {
+    const auto S = this->_stride;
+    for (auto i = 0U; i != this->_n; ++i) {
+        for (auto k = 0U; k != S; ++k) {
+            this->_g[i * S + k] = this->_active[k] ? grad[i * S + k] : 0.0;
+        }
+    }
+}
+
+auto EllBatch::_matvec() -> void {
+    ell_kernel::batch_matvec(&this->_mq[0], &this->_g[0], &this->_qg[0], &this->_omega[0],
+                             this->_n, this->_stride);
+}
+
+auto EllBatch::_rank_one() -> void {
+    ell_kernel::batch_rank_one(&this->_mq[0], &this->_qg[0], &this->_r[0], &this->_s[0],
+                               &this->_xc[0], this->_n, this->_stride);
+}
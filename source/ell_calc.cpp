@@ -1,11 +1,585 @@
 #include <cassert>
-#include <cmath>                      // for sqrt
+#include <cmath>                      // for sqrt, log
+#include <cstddef>                    // for size_t
+#include <cstdint>                    // for int32_t
 #include <ellalgo/ell_assert.hpp>     // for ELL_UNLIKELY
-#include <ellalgo/ell_calc.hpp>       // for EllCalc
-#include <ellalgo/ell_calc_core.hpp>  // for EllCalcCore
+#include <ellalgo/ell_calc.hpp>       // for EllCalc, CutBatch
+#include <ellalgo/ell_calc_core.hpp>  // for EllCalcCore, EllCalcConsts
 #include <ellalgo/ell_config.hpp>     // for CutStatus, CutStatus::Success
+#include <ellalgo/ell_kernel.hpp>     // for active_isa, Isa
 #include <tuple>                      // for tuple
 
+#if !defined(ELL_KERNEL_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#    define ELL_CALC_X86 1
+#    include <immintrin.h>
+#    define ELL_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+// the batches must round as the single cuts, see ell_calc_core.cpp
+#    pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace {
+
+    /**
+     * @brief rho, sigma and delta of a cut in one lane of a batch
+     */
+    struct Lane {
+        double rho;
+        double sigma;
+        double delta;
+    };
+
+    /*
+     * The formulas of `EllCalcCore`, operation for operation, without the
+     * tests of `EllCalc`, for the loops of the batches.
+     */
+
+    inline auto bias_lane(const EllCalcConsts &c, double beta, double tau) -> Lane {
+        const auto eta = tau + c.n_f * beta;
+        const auto alpha = beta / tau;
+        return {eta / c.n_plus_1, c.cst2 * eta / (tau + beta), c.cst1 * (1.0 - alpha * alpha)};
+    }
+
+    inline auto central_lane(const EllCalcConsts &c, double tau) -> Lane {
+        return {tau / c.n_plus_1, c.cst2, c.cst1};
+    }
+
+    inline auto parallel_lane(const EllCalcConsts &c, double beta0, double beta1, double tsq)
+        -> Lane {
+        const auto b0b1 = beta0 * beta1;
+        const auto eta = tsq + c.n_f * b0b1;
+        const auto bavg = 0.5 * (beta0 + beta1);
+        const auto bavgsq = bavg * bavg;
+        const auto h = 0.5 * (tsq + b0b1) + c.n_f * bavgsq;
+        const auto k = h + std::sqrt(h * h - c.n_plus_1 * eta * bavgsq);
+        const auto inv_mu_plus_1 = eta / k;
+        const auto inv_mu = eta / (k - eta);
+        return {bavg * inv_mu_plus_1, inv_mu_plus_1,
+                (tsq + inv_mu * (bavgsq * inv_mu_plus_1 - b0b1)) / tsq};
+    }
+
+    inline auto parallel_central_lane(const EllCalcConsts &c, double beta1, double tsq) -> Lane {
+        const auto b1sq = beta1 * beta1;
+        const auto a1sq = b1sq / tsq;
+        const auto k = c.half_n * a1sq;
+        const auto r = k + std::sqrt(1.0 - a1sq + k * k);
+        const auto r_plus_1 = r + 1.0;
+        return {beta1 / r_plus_1, 2.0 / r_plus_1, r / (r - c.inv_n)};
+    }
+
+    /**
+     * @brief log of the ratio of delta^n * (1 - sigma), parallel over single
+     */
+    inline auto log_volume_ratio(const EllCalcConsts &c, double sigma_p, double delta_p,
+                                 double sigma_s, double delta_s) -> double {
+        return c.n_f * std::log(delta_p / delta_s) + std::log((1.0 - sigma_p) / (1.0 - sigma_s));
+    }
+
+    /**
+     * @brief The cuts of a block of lanes, both sides of every test, in structure-of-arrays form
+     *
+     * A lane takes its single cut where `single` is set, its parallel cut
+     * otherwise. The adaptive mode compares the two where `compared` is set,
+     * and may set `single` then. The batches of single cuts only fill the
+     * `s_` arrays.
+     */
+    struct Block {
+        static constexpr size_t size = 64U;
+        double s_rho[size];
+        double s_sigma[size];
+        double s_delta[size];
+        double p_rho[size];
+        double p_sigma[size];
+        double p_delta[size];
+        CutStatus s_status[size];
+        CutStatus p_status[size];
+        bool single[size];
+        bool compared[size];
+
+        inline auto set_single(size_t i, CutStatus status, const Lane &v) -> void {
+            this->s_status[i] = status;
+            this->s_rho[i] = v.rho;
+            this->s_sigma[i] = v.sigma;
+            this->s_delta[i] = v.delta;
+        }
+
+        inline auto set_parallel(size_t i, CutStatus status, const Lane &v) -> void {
+            this->p_status[i] = status;
+            this->p_rho[i] = v.rho;
+            this->p_sigma[i] = v.sigma;
+            this->p_delta[i] = v.delta;
+        }
+    };
+
+    enum class Mode { Single, Parallel, Adaptive };
+
+    /**
+     * @brief Store the cut of lane k, see `EllCalc::calc_bias_cut_batch`
+     *
+     * A lane that fails gets {0, 0, 0}, or {0, 0, 1} if no effect.
+     */
+    inline auto store(CutBatch out, size_t k, CutStatus status, double rho, double sigma,
+                      double delta) -> void {
+        const auto ok = status == CutStatus::Success;
+        out.status[k] = status;
+        out.rho[k] = ok ? rho : 0.0;
+        out.sigma[k] = ok ? sigma : 0.0;
+        out.delta[k] = ok ? delta : (status == CutStatus::NoEffect ? 1.0 : 0.0);
+    }
+
+    /**
+     * @brief Store the cuts of the lanes 0, ..., num - 1, block by block
+     *
+     * `fill(k0, len, block)` computes the cuts of the lanes [k0, k0 + len)
+     * into the block, each lane once, without a branch. The adaptive mode
+     * then takes the logs of the volume ratios only for the lanes that
+     * compare them, as the method for one cut does, and adds up its choices.
+     */
+    template <Mode mode, typename Fn>
+    inline auto run_blocks(const EllCalcConsts &c, size_t num, CutBatch out,
+                           size_t &num_parallel, size_t &num_single, Fn &&fill) -> void {
+        Block block;
+        for (auto k0 = size_t(0U); k0 < num; k0 += Block::size) {
+            const auto len = num - k0 < Block::size ? num - k0 : Block::size;
+            fill(k0, len, block);
+            if (mode == Mode::Adaptive) {
+                for (auto i = size_t(0U); i != len; ++i) {
+                    if (!block.compared[i]) {
+                        continue;
+                    }
+                    const auto prefer = log_volume_ratio(c, block.p_sigma[i], block.p_delta[i],
+                                                         block.s_sigma[i], block.s_delta[i])
+                                        <= 0.0;
+                    ++(prefer ? num_parallel : num_single);
+                    block.single[i] = !prefer;
+                }
+            }
+            for (auto i = size_t(0U); i != len; ++i) {
+                if (mode == Mode::Single || block.single[i]) {
+                    store(out, k0 + i, block.s_status[i], block.s_rho[i], block.s_sigma[i],
+                          block.s_delta[i]);
+                } else {
+                    store(out, k0 + i, block.p_status[i], block.p_rho[i], block.p_sigma[i],
+                          block.p_delta[i]);
+                }
+            }
+        }
+    }
+
+    /*
+     * The cuts of a lane, for the blocks of each batch. A lane without a
+     * solution gets NoSoln on both sides.
+     */
+
+    inline auto parallel_bias_fill(const EllCalcConsts &c, bool use_parallel, bool adaptive,
+                                   double b0, double b1, double t, Block &block, size_t i)
+        -> void {
+        const auto no_soln = b1 < b0;
+        const auto single_path = (b1 > 0 && t <= b1 * b1) || !use_parallel;
+        const auto single_status
+            = no_soln || t < b0 * b0 ? CutStatus::NoSoln : CutStatus::Success;
+        block.set_single(i, single_status, bias_lane(c, b0, std::sqrt(t)));
+        block.set_parallel(i, no_soln ? CutStatus::NoSoln : CutStatus::Success,
+                           parallel_lane(c, b0, b1, t));
+        block.single[i] = single_path;
+        block.compared[i] = adaptive && !no_soln && !single_path && b0 >= 0.0
+                            && single_status == CutStatus::Success;
+    }
+
+    inline auto parallel_central_fill(const EllCalcConsts &c, bool use_parallel, bool adaptive,
+                                      double b1, double t, Block &block, size_t i) -> void {
+        const auto no_soln = b1 < 0.0;
+        const auto single_path = t < b1 * b1 || !use_parallel;
+        const auto status = no_soln ? CutStatus::NoSoln : CutStatus::Success;
+        block.set_single(i, status, central_lane(c, std::sqrt(t)));
+        block.set_parallel(i, status, parallel_central_lane(c, b1, t));
+        block.single[i] = single_path;
+        block.compared[i] = adaptive && !no_soln && !single_path;
+    }
+
+    inline auto parallel_bias_q_fill(const EllCalcConsts &c, bool use_parallel, bool adaptive,
+                                     double b0, double b1, double t, Block &block, size_t i)
+        -> void {
+        const auto no_soln = b1 < b0;
+        const auto single_path = (b1 > 0.0 && t <= b1 * b1) || !use_parallel;
+        const auto tau = std::sqrt(t);
+        const auto single_status = no_soln || tau < b0        ? CutStatus::NoSoln
+                                   : tau + c.n_f * b0 <= 0.0 ? CutStatus::NoEffect
+                                                              : CutStatus::Success;
+        const auto parallel_status = no_soln                           ? CutStatus::NoSoln
+                                     : t + c.n_f * (b0 * b1) <= 0.0 ? CutStatus::NoEffect
+                                                                     : CutStatus::Success;
+        block.set_single(i, single_status, bias_lane(c, b0, tau));
+        block.set_parallel(i, parallel_status, parallel_lane(c, b0, b1, t));
+        block.single[i] = single_path;
+        block.compared[i] = adaptive && !no_soln && !single_path
+                            && parallel_status == CutStatus::Success
+                            && single_status == CutStatus::Success;
+    }
+
+    inline auto bias_fill(const EllCalcConsts &c, double b, double t, Block &block, size_t i)
+        -> void {
+        block.set_single(i, t < b * b ? CutStatus::NoSoln : CutStatus::Success,
+                         bias_lane(c, b, std::sqrt(t)));
+    }
+
+    inline auto central_fill(const EllCalcConsts &c, double t, Block &block, size_t i) -> void {
+        block.set_single(i, CutStatus::Success, central_lane(c, std::sqrt(t)));
+    }
+
+    inline auto bias_q_fill(const EllCalcConsts &c, double b, double t, Block &block, size_t i)
+        -> void {
+        const auto tau = std::sqrt(t);
+        const auto status = tau < b                   ? CutStatus::NoSoln
+                            : tau + c.n_f * b <= 0.0 ? CutStatus::NoEffect
+                                                      : CutStatus::Success;
+        block.set_single(i, status, bias_lane(c, b, tau));
+    }
+
+#ifdef ELL_CALC_X86
+
+    /*
+     * The same with AVX2, four lanes at a time. The comparisons would stay
+     * branches in the loops above (they may trap), which the compiler does
+     * not vectorize, so they are spelled out here as masks and blends. The
+     * arithmetic is the one of the lanes above, operation for operation, so
+     * that the results are the same bit for bit.
+     */
+
+    struct Consts4 {
+        __m256d n_f;
+        __m256d n_plus_1;
+        __m256d half_n;
+        __m256d inv_n;
+        __m256d cst1;
+        __m256d cst2;
+    };
+
+    struct Lane4 {
+        __m256d rho;
+        __m256d sigma;
+        __m256d delta;
+    };
+
+    ELL_TARGET("avx2")
+    inline auto consts4(const EllCalcConsts &c) -> Consts4 {
+        return {_mm256_set1_pd(c.n_f),   _mm256_set1_pd(c.n_plus_1), _mm256_set1_pd(c.half_n),
+                _mm256_set1_pd(c.inv_n), _mm256_set1_pd(c.cst1),     _mm256_set1_pd(c.cst2)};
+    }
+
+    ELL_TARGET("avx2")
+    inline auto bias_lane4(const Consts4 &c, __m256d beta, __m256d tau) -> Lane4 {
+        const auto eta = _mm256_add_pd(tau, _mm256_mul_pd(c.n_f, beta));
+        const auto alpha = _mm256_div_pd(beta, tau);
+        return {_mm256_div_pd(eta, c.n_plus_1),
+                _mm256_div_pd(_mm256_mul_pd(c.cst2, eta), _mm256_add_pd(tau, beta)),
+                _mm256_mul_pd(c.cst1,
+                              _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(alpha, alpha)))};
+    }
+
+    ELL_TARGET("avx2")
+    inline auto central_lane4(const Consts4 &c, __m256d tau) -> Lane4 {
+        return {_mm256_div_pd(tau, c.n_plus_1), c.cst2, c.cst1};
+    }
+
+    ELL_TARGET("avx2")
+    inline auto parallel_lane4(const Consts4 &c, __m256d beta0, __m256d beta1, __m256d tsq)
+        -> Lane4 {
+        const auto half = _mm256_set1_pd(0.5);
+        const auto b0b1 = _mm256_mul_pd(beta0, beta1);
+        const auto eta = _mm256_add_pd(tsq, _mm256_mul_pd(c.n_f, b0b1));
+        const auto bavg = _mm256_mul_pd(half, _mm256_add_pd(beta0, beta1));
+        const auto bavgsq = _mm256_mul_pd(bavg, bavg);
+        const auto h = _mm256_add_pd(_mm256_mul_pd(half, _mm256_add_pd(tsq, b0b1)),
+                                     _mm256_mul_pd(c.n_f, bavgsq));
+        const auto n_plus_1_eta = _mm256_mul_pd(c.n_plus_1, eta);
+        const auto k = _mm256_add_pd(
+            h, _mm256_sqrt_pd(_mm256_sub_pd(_mm256_mul_pd(h, h),
+                                            _mm256_mul_pd(n_plus_1_eta, bavgsq))));
+        const auto inv_mu_plus_1 = _mm256_div_pd(eta, k);
+        const auto inv_mu = _mm256_div_pd(eta, _mm256_sub_pd(k, eta));
+        const auto delta = _mm256_div_pd(
+            _mm256_add_pd(tsq, _mm256_mul_pd(inv_mu, _mm256_sub_pd(_mm256_mul_pd(bavgsq,
+                                                                                 inv_mu_plus_1),
+                                                                   b0b1))),
+            tsq);
+        return {_mm256_mul_pd(bavg, inv_mu_plus_1), inv_mu_plus_1, delta};
+    }
+
+    ELL_TARGET("avx2")
+    inline auto parallel_central_lane4(const Consts4 &c, __m256d beta1, __m256d tsq) -> Lane4 {
+        const auto one = _mm256_set1_pd(1.0);
+        const auto b1sq = _mm256_mul_pd(beta1, beta1);
+        const auto a1sq = _mm256_div_pd(b1sq, tsq);
+        const auto k = _mm256_mul_pd(c.half_n, a1sq);
+        const auto r = _mm256_add_pd(
+            k, _mm256_sqrt_pd(_mm256_add_pd(_mm256_sub_pd(one, a1sq), _mm256_mul_pd(k, k))));
+        const auto r_plus_1 = _mm256_add_pd(r, one);
+        return {_mm256_div_pd(beta1, r_plus_1), _mm256_div_pd(_mm256_set1_pd(2.0), r_plus_1),
+                _mm256_div_pd(r, _mm256_sub_pd(r, c.inv_n))};
+    }
+
+    /** The statuses of four lanes, from the masks of NoSoln and NoEffect */
+    ELL_TARGET("avx2")
+    inline auto store_status4(CutStatus *status, __m256d no_soln, __m256d no_effect) -> void {
+        static_assert(sizeof(CutStatus) == sizeof(std::int32_t), "stored as int32");
+        const auto code = _mm256_blendv_pd(
+            _mm256_and_pd(no_effect, _mm256_set1_pd(double(CutStatus::NoEffect))),
+            _mm256_set1_pd(double(CutStatus::NoSoln)), no_soln);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(status), _mm256_cvttpd_epi32(code));
+    }
+
+    ELL_TARGET("avx2")
+    inline auto store_mask4(bool *flags, __m256d mask) -> void {
+        const auto bits = _mm256_movemask_pd(mask);
+        for (auto l = 0; l != 4; ++l) {
+            flags[l] = ((bits >> l) & 1) != 0;
+        }
+    }
+
+    ELL_TARGET("avx2")
+    inline auto store_lane4(double *rho, double *sigma, double *delta, const Lane4 &v) -> void {
+        _mm256_storeu_pd(rho, v.rho);
+        _mm256_storeu_pd(sigma, v.sigma);
+        _mm256_storeu_pd(delta, v.delta);
+    }
+
+    ELL_TARGET("avx2")
+    inline auto all_if(bool cond) -> __m256d {
+        return _mm256_castsi256_pd(_mm256_set1_epi64x(cond ? -1 : 0));
+    }
+
+    ELL_TARGET("avx2")
+    void parallel_bias_fill_avx2(const EllCalcConsts &c, bool use_parallel, bool adaptive,
+                                 const double *beta0, const double *beta1, const double *tsq,
+                                 size_t k0, size_t len, Block &block) {
+        const auto c4 = consts4(c);
+        const auto zero = _mm256_setzero_pd();
+        const auto serial = all_if(!use_parallel);
+        const auto compare = all_if(adaptive);
+        auto i = size_t(0U);
+        for (; i + 4 <= len; i += 4) {
+            const auto b0 = _mm256_loadu_pd(beta0 + k0 + i);
+            const auto b1 = _mm256_loadu_pd(beta1 + k0 + i);
+            const auto t = _mm256_loadu_pd(tsq + k0 + i);
+            const auto no_soln = _mm256_cmp_pd(b1, b0, _CMP_LT_OQ);
+            const auto single_path = _mm256_or_pd(
+                _mm256_and_pd(_mm256_cmp_pd(b1, zero, _CMP_GT_OQ),
+                              _mm256_cmp_pd(t, _mm256_mul_pd(b1, b1), _CMP_LE_OQ)),
+                serial);
+            const auto single_fail
+                = _mm256_or_pd(no_soln, _mm256_cmp_pd(t, _mm256_mul_pd(b0, b0), _CMP_LT_OQ));
+            store_status4(block.s_status + i, single_fail, zero);
+            store_lane4(block.s_rho + i, block.s_sigma + i, block.s_delta + i,
+                        bias_lane4(c4, b0, _mm256_sqrt_pd(t)));
+            store_status4(block.p_status + i, no_soln, zero);
+            store_lane4(block.p_rho + i, block.p_sigma + i, block.p_delta + i,
+                        parallel_lane4(c4, b0, b1, t));
+            store_mask4(block.single + i, single_path);
+            store_mask4(block.compared + i,
+                        _mm256_andnot_pd(_mm256_or_pd(single_path, single_fail),
+                                         _mm256_and_pd(compare,
+                                                       _mm256_cmp_pd(b0, zero, _CMP_GE_OQ))));
+        }
+        for (; i != len; ++i) {
+            const auto k = k0 + i;
+            parallel_bias_fill(c, use_parallel, adaptive, beta0[k], beta1[k], tsq[k], block, i);
+        }
+    }
+
+    ELL_TARGET("avx2")
+    void parallel_central_fill_avx2(const EllCalcConsts &c, bool use_parallel, bool adaptive,
+                                    const double *beta1, const double *tsq, size_t k0,
+                                    size_t len, Block &block) {
+        const auto c4 = consts4(c);
+        const auto zero = _mm256_setzero_pd();
+        const auto serial = all_if(!use_parallel);
+        const auto compare = all_if(adaptive);
+        auto i = size_t(0U);
+        for (; i + 4 <= len; i += 4) {
+            const auto b1 = _mm256_loadu_pd(beta1 + k0 + i);
+            const auto t = _mm256_loadu_pd(tsq + k0 + i);
+            const auto no_soln = _mm256_cmp_pd(b1, zero, _CMP_LT_OQ);
+            const auto single_path
+                = _mm256_or_pd(_mm256_cmp_pd(t, _mm256_mul_pd(b1, b1), _CMP_LT_OQ), serial);
+            store_status4(block.s_status + i, no_soln, zero);
+            store_lane4(block.s_rho + i, block.s_sigma + i, block.s_delta + i,
+                        central_lane4(c4, _mm256_sqrt_pd(t)));
+            store_status4(block.p_status + i, no_soln, zero);
+            store_lane4(block.p_rho + i, block.p_sigma + i, block.p_delta + i,
+                        parallel_central_lane4(c4, b1, t));
+            store_mask4(block.single + i, single_path);
+            store_mask4(block.compared + i,
+                        _mm256_andnot_pd(_mm256_or_pd(single_path, no_soln), compare));
+        }
+        for (; i != len; ++i) {
+            const auto k = k0 + i;
+            parallel_central_fill(c, use_parallel, adaptive, beta1[k], tsq[k], block, i);
+        }
+    }
+
+    ELL_TARGET("avx2")
+    void parallel_bias_q_fill_avx2(const EllCalcConsts &c, bool use_parallel, bool adaptive,
+                                   const double *beta0, const double *beta1, const double *tsq,
+                                   size_t k0, size_t len, Block &block) {
+        const auto c4 = consts4(c);
+        const auto zero = _mm256_setzero_pd();
+        const auto serial = all_if(!use_parallel);
+        const auto compare = all_if(adaptive);
+        auto i = size_t(0U);
+        for (; i + 4 <= len; i += 4) {
+            const auto b0 = _mm256_loadu_pd(beta0 + k0 + i);
+            const auto b1 = _mm256_loadu_pd(beta1 + k0 + i);
+            const auto t = _mm256_loadu_pd(tsq + k0 + i);
+            const auto tau = _mm256_sqrt_pd(t);
+            const auto no_soln = _mm256_cmp_pd(b1, b0, _CMP_LT_OQ);
+            const auto single_path = _mm256_or_pd(
+                _mm256_and_pd(_mm256_cmp_pd(b1, zero, _CMP_GT_OQ),
+                              _mm256_cmp_pd(t, _mm256_mul_pd(b1, b1), _CMP_LE_OQ)),
+                serial);
+            const auto s_no_soln = _mm256_or_pd(no_soln, _mm256_cmp_pd(tau, b0, _CMP_LT_OQ));
+            const auto s_no_effect = _mm256_cmp_pd(
+                _mm256_add_pd(tau, _mm256_mul_pd(c4.n_f, b0)), zero, _CMP_LE_OQ);
+            const auto p_no_effect = _mm256_cmp_pd(
+                _mm256_add_pd(t, _mm256_mul_pd(c4.n_f, _mm256_mul_pd(b0, b1))), zero,
+                _CMP_LE_OQ);
+            store_status4(block.s_status + i, s_no_soln, s_no_effect);
+            store_lane4(block.s_rho + i, block.s_sigma + i, block.s_delta + i,
+                        bias_lane4(c4, b0, tau));
+            store_status4(block.p_status + i, no_soln, p_no_effect);
+            store_lane4(block.p_rho + i, block.p_sigma + i, block.p_delta + i,
+                        parallel_lane4(c4, b0, b1, t));
+            store_mask4(block.single + i, single_path);
+            const auto fail = _mm256_or_pd(_mm256_or_pd(single_path, s_no_soln),
+                                           _mm256_or_pd(s_no_effect, p_no_effect));
+            store_mask4(block.compared + i, _mm256_andnot_pd(fail, compare));
+        }
+        for (; i != len; ++i) {
+            const auto k = k0 + i;
+            parallel_bias_q_fill(c, use_parallel, adaptive, beta0[k], beta1[k], tsq[k], block, i);
+        }
+    }
+
+    ELL_TARGET("avx2")
+    void bias_fill_avx2(const EllCalcConsts &c, const double *beta, const double *tsq, size_t k0,
+                        size_t len, Block &block) {
+        const auto c4 = consts4(c);
+        const auto zero = _mm256_setzero_pd();
+        auto i = size_t(0U);
+        for (; i + 4 <= len; i += 4) {
+            const auto b = _mm256_loadu_pd(beta + k0 + i);
+            const auto t = _mm256_loadu_pd(tsq + k0 + i);
+            store_status4(block.s_status + i, _mm256_cmp_pd(t, _mm256_mul_pd(b, b), _CMP_LT_OQ),
+                          zero);
+            store_lane4(block.s_rho + i, block.s_sigma + i, block.s_delta + i,
+                        bias_lane4(c4, b, _mm256_sqrt_pd(t)));
+        }
+        for (; i != len; ++i) {
+            bias_fill(c, beta[k0 + i], tsq[k0 + i], block, i);
+        }
+    }
+
+    ELL_TARGET("avx2")
+    void central_fill_avx2(const EllCalcConsts &c, const double *tsq, size_t k0, size_t len,
+                           Block &block) {
+        const auto c4 = consts4(c);
+        const auto zero = _mm256_setzero_pd();
+        auto i = size_t(0U);
+        for (; i + 4 <= len; i += 4) {
+            const auto t = _mm256_loadu_pd(tsq + k0 + i);
+            store_status4(block.s_status + i, zero, zero);
+            store_lane4(block.s_rho + i, block.s_sigma + i, block.s_delta + i,
+                        central_lane4(c4, _mm256_sqrt_pd(t)));
+        }
+        for (; i != len; ++i) {
+            central_fill(c, tsq[k0 + i], block, i);
+        }
+    }
+
+    ELL_TARGET("avx2")
+    void bias_q_fill_avx2(const EllCalcConsts &c, const double *beta, const double *tsq,
+                          size_t k0, size_t len, Block &block) {
+        const auto c4 = consts4(c);
+        const auto zero = _mm256_setzero_pd();
+        auto i = size_t(0U);
+        for (; i + 4 <= len; i += 4) {
+            const auto b = _mm256_loadu_pd(beta + k0 + i);
+            const auto tau = _mm256_sqrt_pd(_mm256_loadu_pd(tsq + k0 + i));
+            const auto no_soln = _mm256_cmp_pd(tau, b, _CMP_LT_OQ);
+            const auto no_effect = _mm256_cmp_pd(_mm256_add_pd(tau, _mm256_mul_pd(c4.n_f, b)),
+                                                 zero, _CMP_LE_OQ);
+            store_status4(block.s_status + i, no_soln, no_effect);
+            store_lane4(block.s_rho + i, block.s_sigma + i, block.s_delta + i,
+                        bias_lane4(c4, b, tau));
+        }
+        for (; i != len; ++i) {
+            bias_q_fill(c, beta[k0 + i], tsq[k0 + i], block, i);
+        }
+    }
+
+#endif  // ELL_CALC_X86
+
+    /**
+     * @brief Whether the batches take the AVX2 code, as the kernels do (see `ell_kernel::set_isa`)
+     */
+    inline auto use_avx2() -> bool {
+#ifdef ELL_CALC_X86
+        const auto isa = ell_kernel::active_isa();
+        return isa == ell_kernel::Isa::Avx2 || isa == ell_kernel::Isa::Avx512;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief `run_blocks` in the mode of a parallel batch, by `fill_avx2` or lane by lane
+     */
+    template <typename Simd, typename Fill>
+    inline auto run_parallel(const EllCalcConsts &c, bool adaptive, size_t num, CutBatch out,
+                             size_t &num_parallel, size_t &num_single, Simd &&fill_avx2,
+                             Fill &&fill) -> void {
+        const auto by_lane = [&](size_t k0, size_t len, Block &block) {
+            for (auto i = size_t(0U); i != len; ++i) {
+                fill(k0 + i, block, i);
+            }
+        };
+        if (use_avx2()) {
+            if (adaptive) {
+                run_blocks<Mode::Adaptive>(c, num, out, num_parallel, num_single, fill_avx2);
+            } else {
+                run_blocks<Mode::Parallel>(c, num, out, num_parallel, num_single, fill_avx2);
+            }
+        } else if (adaptive) {
+            run_blocks<Mode::Adaptive>(c, num, out, num_parallel, num_single, by_lane);
+        } else {
+            run_blocks<Mode::Parallel>(c, num, out, num_parallel, num_single, by_lane);
+        }
+    }
+
+    /**
+     * @brief `run_blocks` for a batch of single cuts
+     */
+    template <typename Simd, typename Fill>
+    inline auto run_single(const EllCalcConsts &c, size_t num, CutBatch out, Simd &&fill_avx2,
+                           Fill &&fill) -> void {
+        auto unused = size_t(0U);
+        if (use_avx2()) {
+            run_blocks<Mode::Single>(c, num, out, unused, unused, fill_avx2);
+            return;
+        }
+        run_blocks<Mode::Single>(c, num, out, unused, unused,
+                                 [&](size_t k0, size_t len, Block &block) {
+                                     for (auto i = size_t(0U); i != len; ++i) {
+                                         fill(k0 + i, block, i);
+                                     }
+                                 });
+    }
+
+}  // namespace
+
 /**
  * @brief Parallel- or deep-cut
  *
@@ -33,6 +607,13 @@ auto EllCalc::calc_parallel_bias_cut(const double &beta0, const double &beta1,
         return this->calc_bias_cut(beta0, tsq);
     }
     auto &&result = this->_helper.calc_parallel_cut(beta0, beta1, tsq);
+    if (this->adaptive_parallel_cut && beta0 >= 0.0) {  // a single cut may not be shallow
+        auto &&single = this->calc_bias_cut(beta0, tsq);
+        if (std::get<0>(single) == CutStatus::Success
+            && !this->_prefer_parallel(result, std::get<1>(single))) {
+            return single;
+        }
+    }
     return {CutStatus::Success, result};
 }
 
@@ -61,6 +642,12 @@ auto EllCalc::calc_parallel_central_cut(const double &beta1, const double &tsq)
         return this->calc_central_cut(tsq);
     }
     auto &&result = this->_helper.calc_parallel_central_cut(beta1, tsq);
+    if (this->adaptive_parallel_cut) {
+        auto &&single = this->calc_central_cut(tsq);
+        if (!this->_prefer_parallel(result, std::get<1>(single))) {
+            return single;
+        }
+    }
     return {CutStatus::Success, result};
     // this->_mu ???
 }
@@ -150,11 +737,18 @@ auto EllCalc::calc_parallel_bias_cut_q(const double &beta0, const double &beta1,
     }
 
     const auto b0b1 = beta0 * beta1;
-    const auto eta = tsq + this->_n_f * b0b1;
+    const auto eta = tsq + this->_helper.consts().n_f * b0b1;
     if (ELL_UNLIKELY(eta <= 0.0)) {
         return {CutStatus::NoEffect, {0.0, 0.0, 1.0}};  // no effect
     }
     auto &&result = this->_helper.calc_parallel_cut_fast(beta0, beta1, tsq, b0b1, eta);
+    if (this->adaptive_parallel_cut) {
+        auto &&single = this->calc_bias_cut_q(beta0, tsq);
+        if (std::get<0>(single) == CutStatus::Success
+            && !this->_prefer_parallel(result, std::get<1>(single))) {
+            return single;
+        }
+    }
     return {CutStatus::Success, result};
 }
 
@@ -175,10 +769,96 @@ auto EllCalc::calc_bias_cut_q(const double &beta, const double &tsq) const
     if (tau < beta) {
         return {CutStatus::NoSoln, {0.0, 0.0, 0.0}};  // no sol'n
     }
-    const auto eta = tau + this->_n_f * beta;
+    const auto eta = tau + this->_helper.consts().n_f * beta;
     if (ELL_UNLIKELY(eta <= 0.0)) {
         return {CutStatus::NoEffect, {0.0, 0.0, 1.0}};  // no effect
     }
     auto &&result = this->_helper.calc_bias_cut_fast(beta, tau, eta);
     return {CutStatus::Success, result};
 }
+
+auto EllCalc::_prefer_parallel(const std::tuple<double, double, double> &parallel,
+                               const std::tuple<double, double, double> &single) const -> bool {
+    const auto log_ratio
+        = log_volume_ratio(this->_helper.consts(), std::get<1>(parallel), std::get<2>(parallel),
+                           std::get<1>(single), std::get<2>(single));
+    if (log_ratio <= 0.0) {
+        ++this->_num_parallel;
+        return true;
+    }
+    ++this->_num_single;
+    return false;
+}
+
+#ifdef ELL_CALC_X86
+#    define ELL_CALC_AVX2(call) [&](size_t k0, size_t len, Block &block) { call; }
+#else
+#    define ELL_CALC_AVX2(call) [](size_t, size_t, Block &) {}
+#endif
+
+auto EllCalc::calc_parallel_bias_cut_batch(const double *beta0, const double *beta1,
+                                           const double *tsq, size_t num, CutBatch out) const
+    -> void {
+    const auto &c = this->_helper.consts();
+    const auto use_parallel = this->use_parallel_cut;
+    const auto adaptive = this->adaptive_parallel_cut;
+    run_parallel(
+        c, adaptive, num, out, this->_num_parallel, this->_num_single,
+        ELL_CALC_AVX2(parallel_bias_fill_avx2(c, use_parallel, adaptive, beta0, beta1, tsq, k0,
+                                              len, block)),
+        [&](size_t k, Block &block, size_t i) {
+            parallel_bias_fill(c, use_parallel, adaptive, beta0[k], beta1[k], tsq[k], block, i);
+        });
+}
+
+auto EllCalc::calc_parallel_central_cut_batch(const double *beta1, const double *tsq, size_t num,
+                                              CutBatch out) const -> void {
+    const auto &c = this->_helper.consts();
+    const auto use_parallel = this->use_parallel_cut;
+    const auto adaptive = this->adaptive_parallel_cut;
+    run_parallel(
+        c, adaptive, num, out, this->_num_parallel, this->_num_single,
+        ELL_CALC_AVX2(
+            parallel_central_fill_avx2(c, use_parallel, adaptive, beta1, tsq, k0, len, block)),
+        [&](size_t k, Block &block, size_t i) {
+            parallel_central_fill(c, use_parallel, adaptive, beta1[k], tsq[k], block, i);
+        });
+}
+
+auto EllCalc::calc_bias_cut_batch(const double *beta, const double *tsq, size_t num,
+                                  CutBatch out) const -> void {
+    const auto &c = this->_helper.consts();
+    run_single(c, num, out, ELL_CALC_AVX2(bias_fill_avx2(c, beta, tsq, k0, len, block)),
+               [&](size_t k, Block &block, size_t i) { bias_fill(c, beta[k], tsq[k], block, i); });
+}
+
+auto EllCalc::calc_central_cut_batch(const double *tsq, size_t num, CutBatch out) const
+    -> void {
+    const auto &c = this->_helper.consts();
+    run_single(c, num, out, ELL_CALC_AVX2(central_fill_avx2(c, tsq, k0, len, block)),
+               [&](size_t k, Block &block, size_t i) { central_fill(c, tsq[k], block, i); });
+}
+
+auto EllCalc::calc_parallel_bias_cut_q_batch(const double *beta0, const double *beta1,
+                                             const double *tsq, size_t num, CutBatch out) const
+    -> void {
+    const auto &c = this->_helper.consts();
+    const auto use_parallel = this->use_parallel_cut;
+    const auto adaptive = this->adaptive_parallel_cut;
+    run_parallel(
+        c, adaptive, num, out, this->_num_parallel, this->_num_single,
+        ELL_CALC_AVX2(parallel_bias_q_fill_avx2(c, use_parallel, adaptive, beta0, beta1, tsq, k0,
+                                                len, block)),
+        [&](size_t k, Block &block, size_t i) {
+            parallel_bias_q_fill(c, use_parallel, adaptive, beta0[k], beta1[k], tsq[k], block, i);
+        });
+}
+
+auto EllCalc::calc_bias_cut_q_batch(const double *beta, const double *tsq, size_t num,
+                                    CutBatch out) const -> void {
+    const auto &c = this->_helper.consts();
+    run_single(c, num, out, ELL_CALC_AVX2(bias_q_fill_avx2(c, beta, tsq, k0, len, block)),
+               [&](size_t k, Block &block, size_t i) {
+                   bias_q_fill(c, beta[k], tsq[k], block, i);
+               });
+}
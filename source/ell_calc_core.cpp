@@ -1,6 +1,57 @@
+#include <atomic>                     // for atomic
 #include <cmath>                      // for sqrt
-#include <ellalgo/ell_calc_core.hpp>  // for EllCalcCore
+#include <ellalgo/ell_calc_core.hpp>  // for EllCalcCore, EllCalcConsts
+#include <mutex>                      // for mutex, lock_guard
 #include <tuple>                      // for tuple
+#include <vector>                     // for vector
+
+#if defined(__GNUC__) && !defined(__clang__)
+// no fused multiply-add, so that the batches of EllCalc round the same way
+#    pragma GCC optimize("fp-contract=off")
+#endif
+
+auto EllCalcConsts::intern(size_t ndim) -> const EllCalcConsts & {
+    static const size_t num_small = 64U;
+    static const auto small = [] {
+        auto table = std::vector<EllCalcConsts>{};
+        table.reserve(num_small);
+        for (auto n = 0U; n != num_small; ++n) {
+            table.emplace_back(n);
+        }
+        return table;
+    }();
+    if (ndim < num_small) {
+        return small[ndim];
+    }
+    // The others are in a list, only ever prepended to, whose nodes are
+    // published by a release store: a lookup reads it without a lock, and
+    // only an insertion takes the mutex. There are few large dimensions
+    // in a program, so that the list stays short.
+    struct Node {
+        size_t ndim;
+        EllCalcConsts consts;
+        const Node *next;
+    };
+    static std::atomic<const Node *> head{nullptr};
+    static std::mutex mutex;
+    const auto find = [ndim](const Node *node) -> const Node * {
+        while (node != nullptr && node->ndim != ndim) {
+            node = node->next;
+        }
+        return node;
+    };
+    if (const auto *node = find(head.load(std::memory_order_acquire))) {
+        return node->consts;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto *first = head.load(std::memory_order_relaxed);
+    if (const auto *node = find(first)) {
+        return node->consts;  // inserted in the meantime
+    }
+    const auto *node = new Node{ndim, EllCalcConsts(ndim), first};  // kept for the program
+    head.store(node, std::memory_order_release);
+    return node->consts;
+}
 
 /**
  * The function calculates and returns three values (rho, sigma, and delta) based on the input
@@ -34,8 +85,8 @@ auto EllCalcCore::calc_parallel_cut_fast(const double& beta0, const double& beta
     -> std::tuple<double, double, double> {
     auto bavg = 0.5 * (beta0 + beta1);
     auto bavgsq = bavg * bavg;
-    auto h = 0.5 * (tsq + b0b1) + this->_n_f * bavgsq;
-    auto k = h + std::sqrt(h * h - this->_n_plus_1 * eta * bavgsq);
+    auto h = 0.5 * (tsq + b0b1) + this->_c->n_f * bavgsq;
+    auto k = h + std::sqrt(h * h - this->_c->n_plus_1 * eta * bavgsq);
     auto inv_mu_plus_1 = eta / k;
     auto inv_mu = eta / (k - eta);
     auto&& rho = bavg * inv_mu_plus_1;
@@ -77,12 +128,12 @@ auto EllCalcCore::calc_parallel_central_cut(const double& beta1, const double& t
     -> std::tuple<double, double, double> {
     auto b1sq = beta1 * beta1;
     auto a1sq = b1sq / tsq;
-    auto k = this->_half_n * a1sq;
+    auto k = this->_c->half_n * a1sq;
     auto r = k + std::sqrt(1.0 - a1sq + k * k);
     auto r_plus_1 = r + 1.0;
     auto&& rho = beta1 / r_plus_1;
     auto&& sigma = 2.0 / r_plus_1;
-    auto&& delta = r / (r - this->_inv_n);
+    auto&& delta = r / (r - this->_c->inv_n);
     return {rho, sigma, delta};
 }
 
@@ -119,9 +170,9 @@ auto EllCalcCore::calc_parallel_central_cut(const double& beta1, const double& t
 auto EllCalcCore::calc_bias_cut_fast(const double& beta, const double& tau, const double& eta) const
     -> std::tuple<double, double, double> {
     auto alpha = beta / tau;
-    auto&& sigma = this->_cst2 * eta / (tau + beta);
-    auto&& rho = eta / this->_n_plus_1;
-    auto&& delta = this->_cst1 * (1.0 - alpha * alpha);
+    auto&& sigma = this->_c->cst2 * eta / (tau + beta);
+    auto&& rho = eta / this->_c->n_plus_1;
+    auto&& delta = this->_c->cst1 * (1.0 - alpha * alpha);
     return {rho, sigma, delta};
 }
 
@@ -153,8 +204,8 @@ auto EllCalcCore::calc_bias_cut_fast(const double& beta, const double& tau, cons
  * @return A tuple containing the values of rho, sigma, and delta.
  */
 auto EllCalcCore::calc_central_cut(const double& tau) const -> std::tuple<double, double, double> {
-    auto&& sigma = this->_cst2;
-    auto&& rho = tau / this->_n_plus_1;
-    auto&& delta = this->_cst1;
+    auto&& sigma = this->_c->cst2;
+    auto&& rho = tau / this->_c->n_plus_1;
+    auto&& delta = this->_c->cst1;
     return {rho, sigma, delta};
 }
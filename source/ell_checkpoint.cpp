@@ -0,0 +1,126 @@
+#include <cstdint>                    // for uint64_t
+#include <cstdio>                     // for fopen, fwrite, fclose, rename, remove
+#include <cstring>                    // for memcpy, memcmp
+#include <ellalgo/ell_checkpoint.hpp>  // for CheckpointWriter, CheckpointFile
+#include <fstream>                    // for ifstream
+#include <iterator>                   // for istreambuf_iterator
+#include <stdexcept>                  // for runtime_error
+#include <string>                     // for string, to_string
+#include <vector>                     // for vector
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <fcntl.h>     // for open
+#    include <sys/mman.h>  // for mmap, munmap
+#    include <sys/stat.h>  // for fstat
+#    include <unistd.h>    // for close
+#    define ELL_CHECKPOINT_MMAP
+#endif
+#ifdef _WIN32
+#    include <windows.h>  // for MoveFileExA
+#endif
+
+static const char checkpoint_magic[8] = {'E', 'L', 'L', 'C', 'K', 'P', '\0', '\1'};
+
+CheckpointWriter::CheckpointWriter(const std::string &path)
+    : _file{std::fopen((path + ".tmp").c_str(), "wb")}, _path{path} {
+    if (this->_file == nullptr) {
+        throw std::runtime_error("CheckpointWriter: cannot create " + path + ".tmp");
+    }
+    this->write(checkpoint_magic, sizeof(checkpoint_magic));
+}
+
+/* Not closed: an exception is on its way (e.g. the disk is full), so the file may be incomplete. */
+CheckpointWriter::~CheckpointWriter() {
+    if (this->_file != nullptr) {
+        std::fclose(this->_file);
+        std::remove((this->_path + ".tmp").c_str());
+    }
+}
+
+auto CheckpointWriter::write(const void *data, size_t size) -> void {
+    if (size != 0U && std::fwrite(data, 1, size, this->_file) != size) {
+        throw std::runtime_error("CheckpointWriter: write error");
+    }
+}
+
+/* rename replaces the previous checkpoint atomically on POSIX, and MoveFileEx does on Windows,
+where rename fails if the target exists. */
+auto CheckpointWriter::close() -> void {
+    const auto tmp = this->_path + ".tmp";
+    auto ok = std::fclose(this->_file) == 0;
+    this->_file = nullptr;
+    if (ok) {
+#ifdef _WIN32
+        ok = ::MoveFileExA(tmp.c_str(), this->_path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        ok = std::rename(tmp.c_str(), this->_path.c_str()) == 0;
+#endif
+    }
+    if (!ok) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("CheckpointWriter: write error");
+    }
+}
+
+CheckpointFile::CheckpointFile(const std::string &path) {
+#ifdef ELL_CHECKPOINT_MMAP
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("CheckpointFile: cannot open " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        this->_size = static_cast<size_t>(st.st_size);
+        auto *addr = ::mmap(nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            this->_base = static_cast<const char *>(addr);
+        }
+    }
+    ::close(fd);
+#endif
+    if (this->_base == nullptr) {  // read it all instead
+        auto file = std::ifstream(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("CheckpointFile: cannot open " + path);
+        }
+        this->_buffer.assign(std::istreambuf_iterator<char>(file),
+                             std::istreambuf_iterator<char>());
+        this->_size = this->_buffer.size();
+        this->_base = this->_buffer.data();
+    }
+    if (this->_size < sizeof(checkpoint_magic)
+        || std::memcmp(this->_base, checkpoint_magic, sizeof(checkpoint_magic)) != 0) {
+        this->_unmap();
+        throw std::runtime_error("CheckpointFile: not a checkpoint: " + path);
+    }
+    this->_pos = sizeof(checkpoint_magic);
+}
+
+CheckpointFile::~CheckpointFile() { this->_unmap(); }
+
+auto CheckpointFile::_unmap() -> void {
+#ifdef ELL_CHECKPOINT_MMAP
+    if (this->_base != nullptr && this->_buffer.empty()) {
+        ::munmap(const_cast<char *>(this->_base), this->_size);
+    }
+#endif
+    this->_base = nullptr;
+}
+
+auto CheckpointFile::read(void *data, size_t size) -> void {
+    if (size > this->remaining()) {
+        throw std::runtime_error("CheckpointFile: truncated file");
+    }
+    if (size != 0U) {
+        std::memcpy(data, this->_base + this->_pos, size);
+    }
+    this->_pos += size;
+}
+
+auto CheckpointFile::expect(std::uint64_t value, const char *what) -> void {
+    const auto found = this->read_value<std::uint64_t>();
+    if (found != value) {
+        throw std::runtime_error(std::string("CheckpointFile: ") + what + " " + std::to_string(found)
+                                 + ", expected " + std::to_string(value));
+    }
+}
@@ -0,0 +1,1796 @@
+#include <algorithm>                   // for fill, copy, min, max
+#include <atomic>                      // for atomic
+#include <condition_variable>          // for condition_variable
+#include <cstdint>                     // for int32_t
+#include <cstring>                     // for memcpy
+#include <ellalgo/ell_kernel.hpp>      // for Isa, sym_matvec, ...
+#include <ellalgo/ell_sym_matrix.hpp>  // for SymMatrix, SymMatrixF
+#include <mutex>                       // for mutex, lock_guard, unique_lock
+#include <thread>                      // for thread, yield
+#include <vector>                      // for vector
+
+#if !defined(ELL_KERNEL_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#    define ELL_KERNEL_X86 1
+#    include <immintrin.h>
+#    define ELL_TARGET(isa) __attribute__((target(isa)))
+#elif !defined(ELL_KERNEL_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#    define ELL_KERNEL_NEON 1
+#    include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+// inlined into the code of each instruction set, and vectorized there
+#    define ELL_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#    define ELL_ALWAYS_INLINE inline
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+// keep a * b + c as two roundings in every code path (AVX-512 implies FMA)
+#    pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace ell_kernel {
+
+    namespace {
+
+        constexpr size_t lanes = 8U;
+
+        /**
+         * @brief Primitives of one instruction set
+         */
+        struct Primitives {
+            Isa isa;
+            /**
+             * On the tile of the columns [col0, col1) and the rows [row0,
+             * row1), either a diagonal one (row0 == col0, the rows from the
+             * diagonal down) or one below it (row0 >= col1): Q -= r * u * u'
+             * (if u is not null), then each out[i] of the tile gets the terms
+             * Q(i, j) * g[j] of its columns in order. The tile (0, n, 0, n)
+             * gives out += Q * g.
+             */
+            void (*matvec)(SymMatrix &mq, double r, const double *u, const double *g,
+                           double *out, size_t col0, size_t col1, size_t row0, size_t row1);
+            /** sum of a[k] * b[k] */
+            double (*dot)(const double *a, const double *b, size_t len);
+            /** y[k] -= a[k] * alpha */
+            void (*sub_scaled)(const double *a, double *y, double alpha, size_t len);
+            /** a[k] -= r * v[k] * alpha */
+            void (*rank_one)(double *a, const double *v, double r, double alpha, size_t len);
+            /** v[k] -= a[k] * alpha, then a[k] += beta * v[k] */
+            void (*ldl_col)(double *a, double *v, double alpha, double beta, size_t len);
+            /** see `ell_kernel::batch_matvec` */
+            void (*batch_matvec)(const double *mq, const double *g, double *qg, double *omega,
+                                 size_t ndim, size_t stride);
+            /** see `ell_kernel::batch_rank_one` */
+            void (*batch_rank_one)(double *mq, const double *qg, const double *r, const double *s,
+                                   double *xc, size_t ndim, size_t stride);
+            /** see `ell_kernel::batch_interval_cut` */
+            void (*batch_interval_cut)(const double *g, const double *beta, const bool *active,
+                                       const bool *central, double *xc, double *r, double *tsq,
+                                       double *code, size_t stride);
+            /** see `ell_kernel::sub_combination` */
+            void (*sub_combination)(double *y, const double *const *a, const double *alpha,
+                                    size_t num, size_t len);
+            /** see `ell_kernel::sub_panel` */
+            void (*sub_panel)(const double *panel, const double *v, double *acc, size_t first,
+                              size_t last);
+            /** as `matvec`, on float elements */
+            double (*matvec_f32)(SymMatrixF &mq, double r, const double *u, const double *g,
+                                 double *out);
+        };
+
+        // The scalar code below is also the tail of every SIMD primitive.
+
+        inline void rank_one_tail(double *a, const double *v, double r, double alpha, size_t k,
+                                  size_t len) {
+            for (; k != len; ++k) {
+                a[k] -= r * v[k] * alpha;
+            }
+        }
+
+        /**
+         * The plain column-by-column product for the columns [j, col1) of the
+         * tile with the rows [row0, row1). Each out[i] is summed over the
+         * columns 0, 1, ..., n - 1 in order; the SIMD versions keep exactly
+         * this order.
+         *
+         * With `Fused`, each column first gets the rank-one update
+         * -r * u * u', so that it is read from memory only once.
+         */
+        template <bool Fused>
+        inline void matvec_columns(SymMatrix &mq, double r, const double *u, const double *g,
+                                   double *out, size_t j, size_t col1, size_t row0, size_t row1) {
+            for (; j != col1; ++j) {
+                auto *col = mq.column(j);
+                const auto len = row1 - j;
+                auto k = row0 <= j ? size_t(0U) : row0 - j;  // the diagonal, or the first row
+                if (Fused) {
+                    rank_one_tail(col, u + j, r, u[j], k, len);
+                }
+                const auto gj = g[j];
+                auto s = out[j];
+                if (k == 0U) {
+                    s += col[0] * gj;
+                    k = 1U;
+                }
+                for (; k != len; ++k) {
+                    s += col[k] * g[j + k];
+                    out[j + k] += col[k] * gj;
+                }
+                out[j] = s;
+            }
+        }
+
+        /**
+         * The diagonal block of the columns [j0, j0 + w): acc[l] gets the
+         * partial sum of out[j0 + l] up to the row j0 + w.
+         */
+        template <bool Fused>
+        inline void matvec_diag(SymMatrix &mq, double r, const double *u, const double *g,
+                                double *out, size_t j0, size_t w, double *acc) {
+            for (size_t l = 0U; l != w; ++l) {
+                auto *col = mq.column(j0 + l);
+                if (Fused) {
+                    rank_one_tail(col, u + j0 + l, r, u[j0 + l], 0U, w - l);
+                }
+                const auto gj = g[j0 + l];
+                auto s = out[j0 + l] + col[0] * gj;
+                for (size_t k = 1U; k != w - l; ++k) {
+                    s += col[k] * g[j0 + l + k];
+                    out[j0 + l + k] += col[k] * gj;
+                }
+                acc[l] = s;
+            }
+        }
+
+        /**
+         * The start of the block of the columns [j0, j0 + w) of a tile: in a
+         * diagonal tile, its diagonal block; in a tile below, acc[l] is just
+         * out[j0 + l]. Returns the first row of the block below that.
+         */
+        template <bool Fused>
+        inline auto matvec_head(SymMatrix &mq, double r, const double *u, const double *g,
+                                double *out, size_t j0, size_t w, size_t row0, double *acc)
+            -> size_t {
+            if (row0 <= j0) {
+                matvec_diag<Fused>(mq, r, u, g, out, j0, w, acc);
+                return j0 + w;
+            }
+            std::copy(out + j0, out + j0 + w, acc);
+            return row0;
+        }
+
+        /**
+         * The rows [t, m) below the diagonal block, where p[l][t] is the
+         * element in the column l of the block, the suffix b denotes the
+         * block part of a vector, and the suffix r the part below the block.
+         */
+        template <bool Fused>
+        inline void matvec_rows(double *const *p, double r, const double *ub, const double *ur,
+                                const double *gb, const double *gr, double *outr, size_t t,
+                                size_t m, size_t w, double *acc) {
+            for (; t != m; ++t) {
+                for (size_t l = 0U; l != w; ++l) {
+                    if (Fused) {
+                        p[l][t] -= r * ur[t] * ub[l];
+                    }
+                    const auto q = p[l][t];
+                    acc[l] += q * gr[t];
+                    outr[t] += q * gb[l];
+                }
+            }
+        }
+
+        inline auto reduce(const double *acc) -> double {
+            return ((acc[0] + acc[4]) + (acc[2] + acc[6]))
+                   + ((acc[1] + acc[5]) + (acc[3] + acc[7]));
+        }
+
+        /** The inner products are split over eight lanes (lane = k mod 8) */
+        inline auto dot_tail(double *acc, const double *a, const double *b, size_t k, size_t len)
+            -> double {
+            for (; k != len; ++k) {
+                acc[k % lanes] += a[k] * b[k];
+            }
+            return reduce(acc);
+        }
+
+        inline void sub_scaled_tail(const double *a, double *y, double alpha, size_t k,
+                                    size_t len) {
+            for (; k != len; ++k) {
+                y[k] -= a[k] * alpha;
+            }
+        }
+
+        inline void ldl_col_tail(double *a, double *v, double alpha, double beta, size_t k,
+                                 size_t len) {
+            for (; k != len; ++k) {
+                v[k] -= a[k] * alpha;
+                a[k] += beta * v[k];
+            }
+        }
+
+        void matvec_scalar(SymMatrix &mq, double r, const double *u, const double *g, double *out,
+                           size_t col0, size_t col1, size_t row0, size_t row1) {
+            if (u == nullptr) {
+                matvec_columns<false>(mq, r, u, g, out, col0, col1, row0, row1);
+            } else {
+                matvec_columns<true>(mq, r, u, g, out, col0, col1, row0, row1);
+            }
+        }
+
+        auto dot_scalar(const double *a, const double *b, size_t len) -> double {
+            double acc[lanes] = {};
+            return dot_tail(acc, a, b, 0U, len);
+        }
+
+        void sub_scaled_scalar(const double *a, double *y, double alpha, size_t len) {
+            sub_scaled_tail(a, y, alpha, 0U, len);
+        }
+
+        void rank_one_scalar(double *a, const double *v, double r, double alpha, size_t len) {
+            rank_one_tail(a, v, r, alpha, 0U, len);
+        }
+
+        void ldl_col_scalar(double *a, double *v, double alpha, double beta, size_t len) {
+            ldl_col_tail(a, v, alpha, beta, 0U, len);
+        }
+
+        /*
+         * The batched kernels work on one block of `batch_block` lanes at a
+         * time, with the partial sums in local arrays, so that the innermost
+         * loops have a fixed trip count and no aliasing. They are written
+         * once, and vectorized by the compiler for each instruction set.
+         */
+
+        ELL_ALWAYS_INLINE void batch_matvec_body(const double *mq, const double *g, double *qg,
+                                                 double *omega, size_t ndim, size_t stride) {
+            constexpr size_t w = batch_block;
+            for (size_t k0 = 0U; k0 != stride; k0 += w) {
+                double acc[w] = {};
+                for (size_t i = 0U; i != ndim; ++i) {
+                    for (size_t l = 0U; l != w; ++l) {
+                        qg[i * stride + k0 + l] = 0.0;
+                    }
+                }
+                const auto *col = mq + k0;
+                for (size_t j = 0U; j != ndim; ++j) {
+                    // the plain loop of `matvec_columns`, lane by lane
+                    double gj[w];
+                    double s[w];
+                    for (size_t l = 0U; l != w; ++l) {
+                        gj[l] = g[j * stride + k0 + l];
+                        s[l] = qg[j * stride + k0 + l] + col[l] * gj[l];
+                    }
+                    for (size_t t = 1U; t != ndim - j; ++t) {
+                        double q[w];
+                        double gt[w];
+                        double out[w];
+                        for (size_t l = 0U; l != w; ++l) {
+                            q[l] = col[t * stride + l];
+                            gt[l] = g[(j + t) * stride + k0 + l];
+                            out[l] = qg[(j + t) * stride + k0 + l];
+                        }
+                        for (size_t l = 0U; l != w; ++l) {
+                            s[l] += q[l] * gt[l];
+                            out[l] += q[l] * gj[l];
+                        }
+                        for (size_t l = 0U; l != w; ++l) {
+                            qg[(j + t) * stride + k0 + l] = out[l];
+                        }
+                    }
+                    for (size_t l = 0U; l != w; ++l) {
+                        qg[j * stride + k0 + l] = s[l];
+                        acc[l] += s[l] * gj[l];
+                    }
+                    col += (ndim - j) * stride;
+                }
+                for (size_t l = 0U; l != w; ++l) {
+                    omega[k0 + l] = acc[l];
+                }
+            }
+        }
+
+        ELL_ALWAYS_INLINE void batch_rank_one_body(double *mq, const double *qg, const double *r,
+                                                   const double *s, double *xc, size_t ndim,
+                                                   size_t stride) {
+            constexpr size_t w = batch_block;
+            for (size_t k0 = 0U; k0 != stride; k0 += w) {
+                auto *col = mq + k0;
+                for (size_t j = 0U; j != ndim; ++j) {
+                    double qj[w];
+                    for (size_t l = 0U; l != w; ++l) {
+                        qj[l] = qg[j * stride + k0 + l];
+                    }
+                    for (size_t t = 0U; t != ndim - j; ++t) {  // as `rank_one_tail`
+                        double a[w];
+                        for (size_t l = 0U; l != w; ++l) {
+                            a[l] = col[t * stride + l]
+                                   - r[k0 + l] * qg[(j + t) * stride + k0 + l] * qj[l];
+                        }
+                        for (size_t l = 0U; l != w; ++l) {
+                            col[t * stride + l] = a[l];
+                        }
+                    }
+                    for (size_t l = 0U; l != w; ++l) {
+                        xc[j * stride + k0 + l] -= qj[l] * s[k0 + l];
+                    }
+                    col += (ndim - j) * stride;
+                }
+            }
+        }
+
+        /*
+         * One lane of `ell1d::update`, or of `ell1d::update_central_cut` if
+         * central, with the branches turned into selections: the new
+         * interval is computed in every lane, and kept where it succeeded.
+         * The compiler keeps the comparisons as branches (they may trap), so
+         * the SIMD versions below spell out the same selections as blends, and
+         * store only the lanes that change.
+         */
+        ELL_ALWAYS_INLINE void batch_interval_cut_body(const double *g, const double *beta,
+                                                       const bool *active, const bool *central,
+                                                       double *xc, double *r, double *tsq,
+                                                       double *code, size_t stride) {
+            for (size_t k = 0U; k != stride; ++k) {
+                const auto gk = g[k];
+                const auto bk = beta[k];
+                const auto xk = xc[k];
+                const auto rk = r[k];
+                const auto rg = rk * gk;
+                const auto tau = rg > 0.0 ? rg : -rg;
+                const auto no_soln = !central[k] & (bk > tau);
+                const auto no_effect = !central[k] & (bk < -tau);
+                const auto ok = active[k] & !no_soln & !no_effect;
+                const auto bound = xk - bk / gk;
+                const auto u = gk > 0.0 ? bound : xk + rk;
+                const auto lo = gk > 0.0 ? xk - rk : bound;
+                const auto r_deep = (u - lo) / 2;
+                const auto r_central = rk / 2;
+                const auto xc_central = xk + (gk > 0.0 ? -r_central : r_central);
+                xc[k] = ok ? (central[k] ? xc_central : lo + r_deep) : xk;
+                r[k] = ok ? (central[k] ? r_central : r_deep) : rk;
+                tsq[k] = active[k] ? tau * tau : tsq[k];
+                code[k] = active[k] ? (no_soln ? 1.0 : no_effect ? 2.0 : 0.0) : code[k];
+            }
+        }
+
+        /*
+         * A linear combination, w elements of y at a time, which stay in
+         * registers while the terms are subtracted one by one.
+         */
+        ELL_ALWAYS_INLINE void sub_combination_body(double *y, const double *const *a,
+                                                    const double *alpha, size_t num, size_t len) {
+            constexpr size_t w = lanes;
+            size_t j = 0U;
+            for (; j + w <= len; j += w) {
+                double acc[w];
+                for (size_t l = 0U; l != w; ++l) {
+                    acc[l] = y[j + l];
+                }
+                for (size_t k = 0U; k != num; ++k) {
+                    const auto *ak = a[k] + j;
+                    const auto alpha_k = alpha[k];
+                    for (size_t l = 0U; l != w; ++l) {
+                        acc[l] -= ak[l] * alpha_k;
+                    }
+                }
+                for (size_t l = 0U; l != w; ++l) {
+                    y[j + l] = acc[l];
+                }
+            }
+            for (; j != len; ++j) {
+                auto acc = y[j];
+                for (size_t k = 0U; k != num; ++k) {
+                    acc -= a[k][j] * alpha[k];
+                }
+                y[j] = acc;
+            }
+        }
+
+        ELL_ALWAYS_INLINE void sub_panel_body(const double *panel, const double *v, double *acc,
+                                              size_t first, size_t last) {
+            constexpr size_t w = batch_block;
+            double a[w];
+            for (size_t l = 0U; l != w; ++l) {
+                a[l] = acc[l];
+            }
+            for (size_t k = first; k != last; ++k) {
+                const auto *col = panel + k * w;
+                const auto vk = v[k];
+                for (size_t l = 0U; l != w; ++l) {
+                    a[l] -= col[l] * vk;
+                }
+            }
+            for (size_t l = 0U; l != w; ++l) {
+                acc[l] = a[l];
+            }
+        }
+
+        /*
+         * The product on float elements. Each element is converted to double
+         * as it is loaded, so that only the storage is in single precision.
+         * The element (i, j), i > j, is added to the lane i mod 8 of the
+         * inner product of the column j; the SIMD versions take a block of
+         * columns at a time, over the rows of the same eight lanes, but keep
+         * this order. `p` points to the column j minus j, so that p[i] is the
+         * element (i, j).
+         */
+        template <bool Fused>
+        ELL_ALWAYS_INLINE void matvec_f32_element(float *p, size_t i, double r, const double *u,
+                                                  double uj, const double *g, double gj,
+                                                  double *out, double *acc) {
+            if (Fused) {  // as `sym_rank_one`
+                p[i] = float(p[i] - r * u[i] * uj);
+            }
+            const double q = p[i];
+            acc[i % lanes] += q * g[i];
+            out[i] += q * gj;
+        }
+
+        /** out[j] is complete; returns its share of omega */
+        ELL_ALWAYS_INLINE auto matvec_f32_finish(const float *p, size_t j, const double *g,
+                                                 double *out, const double *acc) -> double {
+            const auto s = out[j] + double(p[j]) * g[j] + reduce(acc);
+            out[j] = s;
+            return s * g[j];
+        }
+
+        /** The plain column-by-column product for the columns [j0, n) */
+        template <bool Fused>
+        ELL_ALWAYS_INLINE auto matvec_f32_columns(SymMatrixF &mq, double r, const double *u,
+                                                  const double *g, double *out, size_t j0,
+                                                  double omega) -> double {
+            const auto ndim = mq.size();
+            for (auto j = j0; j != ndim; ++j) {
+                auto *p = mq.column(j) - j;
+                const auto uj = Fused ? u[j] : 0.0;
+                if (Fused) {
+                    p[j] = float(p[j] - r * u[j] * uj);
+                }
+                double acc[lanes] = {};
+                for (auto i = j + 1U; i != ndim; ++i) {
+                    matvec_f32_element<Fused>(p, i, r, u, uj, g, g[j], out, acc);
+                }
+                omega += matvec_f32_finish(p, j, g, out, acc);
+            }
+            return omega;
+        }
+
+        /** The rows [first, last) of the block of the columns [j0, j0 + B) */
+        template <bool Fused, size_t B>
+        ELL_ALWAYS_INLINE void matvec_f32_rows(float **p, double r, const double *u,
+                                               const double *g, double *out, size_t j0,
+                                               size_t first, size_t last, double (*acc)[lanes]) {
+            for (auto i = first; i != last; ++i) {
+                for (size_t c = 0U; c != B && j0 + c < i; ++c) {
+                    const auto j = j0 + c;
+                    matvec_f32_element<Fused>(p[c], i, r, u, Fused ? u[j] : 0.0, g, g[j], out,
+                                              acc[c]);
+                }
+            }
+        }
+
+        /**
+         * The block of the columns [j0, j0 + B): the rows before the first
+         * multiple of eight past the diagonal, element by element, with
+         * their lanes then in acc; the body is left to the SIMD loop.
+         * Returns the first row of the body.
+         */
+        template <bool Fused, size_t B>
+        ELL_ALWAYS_INLINE auto matvec_f32_head(SymMatrixF &mq, float **p, double r,
+                                               const double *u, const double *g, double *out,
+                                               size_t j0, double (*acc)[lanes]) -> size_t {
+            const auto ndim = mq.size();
+            for (size_t c = 0U; c != B; ++c) {
+                const auto j = j0 + c;
+                p[c] = mq.column(j) - j;
+                if (Fused) {
+                    p[c][j] = float(p[c][j] - r * u[j] * u[j]);
+                }
+                for (size_t l = 0U; l != lanes; ++l) {
+                    acc[c][l] = 0.0;
+                }
+            }
+            const auto first = std::min(ndim, (j0 + B + lanes - 1U) / lanes * lanes);
+            matvec_f32_rows<Fused, B>(p, r, u, g, out, j0, j0 + 1U, first, acc);
+            return first;
+        }
+
+        auto matvec_f32_scalar(SymMatrixF &mq, double r, const double *u, const double *g,
+                               double *out) -> double {
+            return u == nullptr ? matvec_f32_columns<false>(mq, r, u, g, out, 0U, 0.0)
+                                : matvec_f32_columns<true>(mq, r, u, g, out, 0U, 0.0);
+        }
+
+        void batch_matvec_scalar(const double *mq, const double *g, double *qg, double *omega,
+                                 size_t ndim, size_t stride) {
+            batch_matvec_body(mq, g, qg, omega, ndim, stride);
+        }
+
+        void batch_rank_one_scalar(double *mq, const double *qg, const double *r, const double *s,
+                                   double *xc, size_t ndim, size_t stride) {
+            batch_rank_one_body(mq, qg, r, s, xc, ndim, stride);
+        }
+
+        void batch_interval_cut_scalar(const double *g, const double *beta, const bool *active,
+                                       const bool *central, double *xc, double *r, double *tsq,
+                                       double *code, size_t stride) {
+            batch_interval_cut_body(g, beta, active, central, xc, r, tsq, code, stride);
+        }
+
+        void sub_combination_scalar(double *y, const double *const *a, const double *alpha,
+                                    size_t num, size_t len) {
+            sub_combination_body(y, a, alpha, num, len);
+        }
+
+        void sub_panel_scalar(const double *panel, const double *v, double *acc, size_t first,
+                              size_t last) {
+            sub_panel_body(panel, v, acc, first, last);
+        }
+
+        const Primitives scalar_primitives{
+            Isa::Scalar,            matvec_scalar,         dot_scalar,
+            sub_scaled_scalar,      rank_one_scalar,       ldl_col_scalar,
+            batch_matvec_scalar,    batch_rank_one_scalar, batch_interval_cut_scalar,
+            sub_combination_scalar, sub_panel_scalar,      matvec_f32_scalar};
+
+        /*
+         * The SIMD products work on blocks of w columns. Below the diagonal
+         * block, a w-by-w tile is loaded column by column, which gives the
+         * update of out directly, and is transposed in registers for the
+         * inner products, so that every lane still adds up its column in the
+         * original order.
+         */
+
+#ifdef ELL_KERNEL_X86
+
+        // AVX2: a block of 4 columns; two 4-wide registers hold the dot lanes 0-3 and 4-7.
+
+        template <bool Fused>
+        ELL_TARGET("avx2")
+        void matvec_avx2_impl(SymMatrix &mq, double r, const double *u, const double *g,
+                              double *out, size_t col0, size_t col1, size_t row0, size_t row1) {
+            constexpr size_t w = 4U;
+            size_t j0 = col0;
+            for (; j0 + w <= col1; j0 += w) {
+                double acc[w];
+                const auto first = matvec_head<Fused>(mq, r, u, g, out, j0, w, row0, acc);
+                double *p[w];
+                for (size_t l = 0U; l != w; ++l) {
+                    p[l] = mq.column(j0 + l) + (first - j0 - l);
+                }
+                const auto *gb = g + j0;
+                const auto *ub = Fused ? u + j0 : nullptr;
+                const auto *ur = Fused ? u + first : nullptr;
+                const auto *gr = g + first;
+                auto *outr = out + first;
+                const auto m = row1 - first;
+                const auto g0 = _mm256_set1_pd(gb[0]);
+                const auto g1 = _mm256_set1_pd(gb[1]);
+                const auto g2 = _mm256_set1_pd(gb[2]);
+                const auto g3 = _mm256_set1_pd(gb[3]);
+                const auto vr = _mm256_set1_pd(r);
+                const auto vu0 = _mm256_set1_pd(Fused ? ub[0] : 0.0);
+                const auto vu1 = _mm256_set1_pd(Fused ? ub[1] : 0.0);
+                const auto vu2 = _mm256_set1_pd(Fused ? ub[2] : 0.0);
+                const auto vu3 = _mm256_set1_pd(Fused ? ub[3] : 0.0);
+                auto vacc = _mm256_loadu_pd(acc);
+                size_t t = 0U;
+                for (; t + w <= m; t += w) {
+                    auto r0 = _mm256_loadu_pd(p[0] + t);
+                    auto r1 = _mm256_loadu_pd(p[1] + t);
+                    auto r2 = _mm256_loadu_pd(p[2] + t);
+                    auto r3 = _mm256_loadu_pd(p[3] + t);
+                    if (Fused) {  // rank-one update of the tile, in place
+                        const auto ru = _mm256_mul_pd(vr, _mm256_loadu_pd(ur + t));
+                        r0 = _mm256_sub_pd(r0, _mm256_mul_pd(ru, vu0));
+                        _mm256_storeu_pd(p[0] + t, r0);
+                        r1 = _mm256_sub_pd(r1, _mm256_mul_pd(ru, vu1));
+                        _mm256_storeu_pd(p[1] + t, r1);
+                        r2 = _mm256_sub_pd(r2, _mm256_mul_pd(ru, vu2));
+                        _mm256_storeu_pd(p[2] + t, r2);
+                        r3 = _mm256_sub_pd(r3, _mm256_mul_pd(ru, vu3));
+                        _mm256_storeu_pd(p[3] + t, r3);
+                    }
+                    auto o = _mm256_loadu_pd(outr + t);
+                    o = _mm256_add_pd(o, _mm256_mul_pd(r0, g0));
+                    o = _mm256_add_pd(o, _mm256_mul_pd(r1, g1));
+                    o = _mm256_add_pd(o, _mm256_mul_pd(r2, g2));
+                    o = _mm256_add_pd(o, _mm256_mul_pd(r3, g3));
+                    _mm256_storeu_pd(outr + t, o);
+                    const auto u0 = _mm256_unpacklo_pd(r0, r1);
+                    const auto u1 = _mm256_unpackhi_pd(r0, r1);
+                    const auto u2 = _mm256_unpacklo_pd(r2, r3);
+                    const auto u3 = _mm256_unpackhi_pd(r2, r3);
+                    const auto t0 = _mm256_permute2f128_pd(u0, u2, 0x20);  // row t
+                    const auto t1 = _mm256_permute2f128_pd(u1, u3, 0x20);
+                    const auto t2 = _mm256_permute2f128_pd(u0, u2, 0x31);
+                    const auto t3 = _mm256_permute2f128_pd(u1, u3, 0x31);
+                    vacc = _mm256_add_pd(vacc, _mm256_mul_pd(t0, _mm256_set1_pd(gr[t])));
+                    vacc = _mm256_add_pd(vacc, _mm256_mul_pd(t1, _mm256_set1_pd(gr[t + 1])));
+                    vacc = _mm256_add_pd(vacc, _mm256_mul_pd(t2, _mm256_set1_pd(gr[t + 2])));
+                    vacc = _mm256_add_pd(vacc, _mm256_mul_pd(t3, _mm256_set1_pd(gr[t + 3])));
+                }
+                _mm256_storeu_pd(acc, vacc);
+                matvec_rows<Fused>(p, r, ub, ur, gb, gr, outr, t, m, w, acc);
+                std::copy(acc, acc + w, out + j0);
+            }
+            matvec_columns<Fused>(mq, r, u, g, out, j0, col1, row0, row1);
+        }
+
+        ELL_TARGET("avx2")
+        void matvec_avx2(SymMatrix &mq, double r, const double *u, const double *g, double *out,
+                         size_t col0, size_t col1, size_t row0, size_t row1) {
+            if (u == nullptr) {
+                matvec_avx2_impl<false>(mq, r, u, g, out, col0, col1, row0, row1);
+            } else {
+                matvec_avx2_impl<true>(mq, r, u, g, out, col0, col1, row0, row1);
+            }
+        }
+
+        ELL_TARGET("avx2")
+        auto dot_avx2(const double *a, const double *b, size_t len) -> double {
+            auto lo = _mm256_setzero_pd();
+            auto hi = _mm256_setzero_pd();
+            size_t k = 0U;
+            for (; k + lanes <= len; k += lanes) {
+                const auto ab = _mm256_mul_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k));
+                lo = _mm256_add_pd(lo, ab);
+                hi = _mm256_add_pd(
+                    hi, _mm256_mul_pd(_mm256_loadu_pd(a + k + 4), _mm256_loadu_pd(b + k + 4)));
+            }
+            double acc[lanes];
+            _mm256_storeu_pd(acc, lo);
+            _mm256_storeu_pd(acc + 4, hi);
+            return dot_tail(acc, a, b, k, len);
+        }
+
+        ELL_TARGET("avx2")
+        void sub_scaled_avx2(const double *a, double *y, double alpha, size_t len) {
+            const auto va = _mm256_set1_pd(alpha);
+            size_t k = 0U;
+            for (; k + 4 <= len; k += 4) {
+                _mm256_storeu_pd(y + k, _mm256_sub_pd(_mm256_loadu_pd(y + k),
+                                                      _mm256_mul_pd(_mm256_loadu_pd(a + k), va)));
+            }
+            sub_scaled_tail(a, y, alpha, k, len);
+        }
+
+        ELL_TARGET("avx2")
+        void rank_one_avx2(double *a, const double *v, double r, double alpha, size_t len) {
+            const auto vr = _mm256_set1_pd(r);
+            const auto va = _mm256_set1_pd(alpha);
+            size_t k = 0U;
+            for (; k + 4 <= len; k += 4) {
+                const auto t = _mm256_mul_pd(_mm256_mul_pd(vr, _mm256_loadu_pd(v + k)), va);
+                _mm256_storeu_pd(a + k, _mm256_sub_pd(_mm256_loadu_pd(a + k), t));
+            }
+            rank_one_tail(a, v, r, alpha, k, len);
+        }
+
+        ELL_TARGET("avx2")
+        void ldl_col_avx2(double *a, double *v, double alpha, double beta, size_t len) {
+            const auto va = _mm256_set1_pd(alpha);
+            const auto vb = _mm256_set1_pd(beta);
+            size_t k = 0U;
+            for (; k + 4 <= len; k += 4) {
+                const auto ak = _mm256_loadu_pd(a + k);
+                const auto vk = _mm256_sub_pd(_mm256_loadu_pd(v + k), _mm256_mul_pd(ak, va));
+                _mm256_storeu_pd(v + k, vk);
+                _mm256_storeu_pd(a + k, _mm256_add_pd(ak, _mm256_mul_pd(vb, vk)));
+            }
+            ldl_col_tail(a, v, alpha, beta, k, len);
+        }
+
+        ELL_TARGET("avx2")
+        void batch_matvec_avx2(const double *mq, const double *g, double *qg, double *omega,
+                               size_t ndim, size_t stride) {
+            batch_matvec_body(mq, g, qg, omega, ndim, stride);
+        }
+
+        ELL_TARGET("avx2")
+        void batch_rank_one_avx2(double *mq, const double *qg, const double *r, const double *s,
+                                 double *xc, size_t ndim, size_t stride) {
+            batch_rank_one_body(mq, qg, r, s, xc, ndim, stride);
+        }
+
+        /** lanes [k, k + 4) of a bool mask, as a mask of doubles */
+        ELL_TARGET("avx2")
+        ELL_ALWAYS_INLINE auto load_mask_avx2(const bool *mask, size_t k) -> __m256d {
+            std::int32_t bytes;
+            std::memcpy(&bytes, mask + k, sizeof(bytes));
+            const auto wide = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes));
+            return _mm256_castsi256_pd(_mm256_cmpgt_epi64(wide, _mm256_setzero_si256()));
+        }
+
+        ELL_TARGET("avx2")
+        void batch_interval_cut_avx2(const double *g, const double *beta, const bool *active,
+                                     const bool *central, double *xc, double *r, double *tsq,
+                                     double *code, size_t stride) {
+            const auto zero = _mm256_setzero_pd();
+            const auto half = _mm256_set1_pd(0.5);  // x / 2, exactly
+            const auto one = _mm256_set1_pd(1.0);
+            const auto two = _mm256_set1_pd(2.0);
+            const auto sign = _mm256_set1_pd(-0.0);
+            for (size_t k = 0U; k != stride; k += 4) {
+                const auto vg = _mm256_loadu_pd(g + k);
+                const auto vb = _mm256_loadu_pd(beta + k);
+                const auto vx = _mm256_loadu_pd(xc + k);
+                const auto vr = _mm256_loadu_pd(r + k);
+                const auto act = load_mask_avx2(active, k);
+                const auto cen = load_mask_avx2(central, k);
+                const auto tau = _mm256_andnot_pd(sign, _mm256_mul_pd(vr, vg));
+                const auto no_soln = _mm256_andnot_pd(cen, _mm256_cmp_pd(vb, tau, _CMP_GT_OQ));
+                const auto no_effect = _mm256_andnot_pd(
+                    cen, _mm256_cmp_pd(vb, _mm256_xor_pd(tau, sign), _CMP_LT_OQ));
+                const auto ok = _mm256_andnot_pd(_mm256_or_pd(no_soln, no_effect), act);
+                const auto fail
+                    = _mm256_or_pd(_mm256_and_pd(no_soln, one), _mm256_and_pd(no_effect, two));
+                const auto bound = _mm256_sub_pd(vx, _mm256_div_pd(vb, vg));
+                const auto g_pos = _mm256_cmp_pd(vg, zero, _CMP_GT_OQ);
+                const auto u = _mm256_blendv_pd(_mm256_add_pd(vx, vr), bound, g_pos);
+                const auto lo = _mm256_blendv_pd(bound, _mm256_sub_pd(vx, vr), g_pos);
+                const auto r_deep = _mm256_mul_pd(_mm256_sub_pd(u, lo), half);
+                const auto r_central = _mm256_mul_pd(vr, half);
+                const auto xc_central = _mm256_add_pd(
+                    vx, _mm256_blendv_pd(r_central, _mm256_xor_pd(r_central, sign), g_pos));
+                const auto xc_ok = _mm256_blendv_pd(_mm256_add_pd(lo, r_deep), xc_central, cen);
+                const auto r_ok = _mm256_blendv_pd(r_deep, r_central, cen);
+                _mm256_storeu_pd(xc + k, _mm256_blendv_pd(vx, xc_ok, ok));
+                _mm256_storeu_pd(r + k, _mm256_blendv_pd(vr, r_ok, ok));
+                _mm256_maskstore_pd(tsq + k, _mm256_castpd_si256(act), _mm256_mul_pd(tau, tau));
+                _mm256_maskstore_pd(code + k, _mm256_castpd_si256(act), fail);
+            }
+        }
+
+        ELL_TARGET("avx2")
+        void sub_combination_avx2(double *y, const double *const *a, const double *alpha,
+                                  size_t num, size_t len) {
+            sub_combination_body(y, a, alpha, num, len);
+        }
+
+        ELL_TARGET("avx2")
+        void sub_panel_avx2(const double *panel, const double *v, double *acc, size_t first,
+                            size_t last) {
+            sub_panel_body(panel, v, acc, first, last);
+        }
+
+        // AVX2 on float elements: a block of 4 columns, over 8 rows at a time, as two 4-wide
+        // registers (lanes 0-3 and 4-7).
+
+        template <bool Fused>
+        ELL_TARGET("avx2")
+        ELL_ALWAYS_INLINE void matvec_f32_step_avx2(float *pc, __m256d ru0, __m256d ru1,
+                                                    __m256d vu, __m256d vg, __m256d g0, __m256d g1,
+                                                    __m256d &acc0, __m256d &acc1, __m256d &o0,
+                                                    __m256d &o1) {
+            auto f = _mm256_loadu_ps(pc);
+            if (Fused) {  // rank-one update, in place
+                const auto a0 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(f)),
+                                              _mm256_mul_pd(ru0, vu));
+                const auto a1 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(f, 1)),
+                                              _mm256_mul_pd(ru1, vu));
+                f = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(a0)),
+                                         _mm256_cvtpd_ps(a1), 1);
+                _mm256_storeu_ps(pc, f);
+            }
+            const auto q0 = _mm256_cvtps_pd(_mm256_castps256_ps128(f));
+            const auto q1 = _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1));
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(q0, g0));
+            acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(q1, g1));
+            o0 = _mm256_add_pd(o0, _mm256_mul_pd(q0, vg));
+            o1 = _mm256_add_pd(o1, _mm256_mul_pd(q1, vg));
+        }
+
+        template <bool Fused>
+        ELL_TARGET("avx2")
+        auto matvec_f32_avx2_impl(SymMatrixF &mq, double r, const double *u, const double *g,
+                                  double *out) -> double {
+            constexpr size_t B = 4U;
+            const auto ndim = mq.size();
+            const auto vr = _mm256_set1_pd(r);
+            auto omega = 0.0;
+            size_t j0 = 0U;
+            for (; j0 + B <= ndim; j0 += B) {
+                float *p[B];
+                double acc[B][lanes];
+                auto i = matvec_f32_head<Fused, B>(mq, p, r, u, g, out, j0, acc);
+                auto a00 = _mm256_loadu_pd(acc[0]);
+                auto a01 = _mm256_loadu_pd(acc[0] + 4);
+                auto a10 = _mm256_loadu_pd(acc[1]);
+                auto a11 = _mm256_loadu_pd(acc[1] + 4);
+                auto a20 = _mm256_loadu_pd(acc[2]);
+                auto a21 = _mm256_loadu_pd(acc[2] + 4);
+                auto a30 = _mm256_loadu_pd(acc[3]);
+                auto a31 = _mm256_loadu_pd(acc[3] + 4);
+                const auto vg0 = _mm256_set1_pd(g[j0]);
+                const auto vg1 = _mm256_set1_pd(g[j0 + 1]);
+                const auto vg2 = _mm256_set1_pd(g[j0 + 2]);
+                const auto vg3 = _mm256_set1_pd(g[j0 + 3]);
+                const auto vu0 = _mm256_set1_pd(Fused ? u[j0] : 0.0);
+                const auto vu1 = _mm256_set1_pd(Fused ? u[j0 + 1] : 0.0);
+                const auto vu2 = _mm256_set1_pd(Fused ? u[j0 + 2] : 0.0);
+                const auto vu3 = _mm256_set1_pd(Fused ? u[j0 + 3] : 0.0);
+                for (; i + lanes <= ndim; i += lanes) {
+                    auto o0 = _mm256_loadu_pd(out + i);
+                    auto o1 = _mm256_loadu_pd(out + i + 4);
+                    const auto g0 = _mm256_loadu_pd(g + i);
+                    const auto g1 = _mm256_loadu_pd(g + i + 4);
+                    const auto ru0 = Fused ? _mm256_mul_pd(vr, _mm256_loadu_pd(u + i)) : vr;
+                    const auto ru1 = Fused ? _mm256_mul_pd(vr, _mm256_loadu_pd(u + i + 4)) : vr;
+                    matvec_f32_step_avx2<Fused>(p[0] + i, ru0, ru1, vu0, vg0, g0, g1, a00, a01, o0,
+                                                o1);
+                    matvec_f32_step_avx2<Fused>(p[1] + i, ru0, ru1, vu1, vg1, g0, g1, a10, a11, o0,
+                                                o1);
+                    matvec_f32_step_avx2<Fused>(p[2] + i, ru0, ru1, vu2, vg2, g0, g1, a20, a21, o0,
+                                                o1);
+                    matvec_f32_step_avx2<Fused>(p[3] + i, ru0, ru1, vu3, vg3, g0, g1, a30, a31, o0,
+                                                o1);
+                    _mm256_storeu_pd(out + i, o0);
+                    _mm256_storeu_pd(out + i + 4, o1);
+                }
+                _mm256_storeu_pd(acc[0], a00);
+                _mm256_storeu_pd(acc[0] + 4, a01);
+                _mm256_storeu_pd(acc[1], a10);
+                _mm256_storeu_pd(acc[1] + 4, a11);
+                _mm256_storeu_pd(acc[2], a20);
+                _mm256_storeu_pd(acc[2] + 4, a21);
+                _mm256_storeu_pd(acc[3], a30);
+                _mm256_storeu_pd(acc[3] + 4, a31);
+                matvec_f32_rows<Fused, B>(p, r, u, g, out, j0, i, ndim, acc);
+                for (size_t c = 0U; c != B; ++c) {
+                    omega += matvec_f32_finish(p[c], j0 + c, g, out, acc[c]);
+                }
+            }
+            return matvec_f32_columns<Fused>(mq, r, u, g, out, j0, omega);
+        }
+
+        ELL_TARGET("avx2")
+        auto matvec_f32_avx2(SymMatrixF &mq, double r, const double *u, const double *g,
+                             double *out) -> double {
+            return u == nullptr ? matvec_f32_avx2_impl<false>(mq, r, u, g, out)
+                                : matvec_f32_avx2_impl<true>(mq, r, u, g, out);
+        }
+
+        const Primitives avx2_primitives{
+            Isa::Avx2,            matvec_avx2,         dot_avx2,
+            sub_scaled_avx2,      rank_one_avx2,       ldl_col_avx2,
+            batch_matvec_avx2,    batch_rank_one_avx2, batch_interval_cut_avx2,
+            sub_combination_avx2, sub_panel_avx2,      matvec_f32_avx2};
+
+        // AVX-512: a block of 8 columns; one 8-wide register holds all the dot lanes.
+
+        template <bool Fused>
+        ELL_TARGET("avx512f")
+        void matvec_avx512_impl(SymMatrix &mq, double r, const double *u, const double *g,
+                                double *out, size_t col0, size_t col1, size_t row0, size_t row1) {
+            constexpr size_t w = 8U;
+            const auto ilo = _mm512_setr_epi64(0, 8, 2, 10, 4, 12, 6, 14);
+            const auto ihi = _mm512_setr_epi64(1, 9, 3, 11, 5, 13, 7, 15);
+            const auto i04 = _mm512_setr_epi64(0, 1, 4, 5, 8, 9, 12, 13);
+            const auto i26 = _mm512_setr_epi64(2, 3, 6, 7, 10, 11, 14, 15);
+            size_t j0 = col0;
+            for (; j0 + w <= col1; j0 += w) {
+                double acc[w];
+                const auto first = matvec_head<Fused>(mq, r, u, g, out, j0, w, row0, acc);
+                double *p[w];
+                for (size_t l = 0U; l != w; ++l) {
+                    p[l] = mq.column(j0 + l) + (first - j0 - l);
+                }
+                const auto *gb = g + j0;
+                const auto *ub = Fused ? u + j0 : nullptr;
+                const auto *ur = Fused ? u + first : nullptr;
+                const auto *gr = g + first;
+                auto *outr = out + first;
+                const auto m = row1 - first;
+                const auto g0 = _mm512_set1_pd(gb[0]);
+                const auto g1 = _mm512_set1_pd(gb[1]);
+                const auto g2 = _mm512_set1_pd(gb[2]);
+                const auto g3 = _mm512_set1_pd(gb[3]);
+                const auto g4 = _mm512_set1_pd(gb[4]);
+                const auto g5 = _mm512_set1_pd(gb[5]);
+                const auto g6 = _mm512_set1_pd(gb[6]);
+                const auto g7 = _mm512_set1_pd(gb[7]);
+                const auto vr = _mm512_set1_pd(r);
+                const auto vu0 = _mm512_set1_pd(Fused ? ub[0] : 0.0);
+                const auto vu1 = _mm512_set1_pd(Fused ? ub[1] : 0.0);
+                const auto vu2 = _mm512_set1_pd(Fused ? ub[2] : 0.0);
+                const auto vu3 = _mm512_set1_pd(Fused ? ub[3] : 0.0);
+                const auto vu4 = _mm512_set1_pd(Fused ? ub[4] : 0.0);
+                const auto vu5 = _mm512_set1_pd(Fused ? ub[5] : 0.0);
+                const auto vu6 = _mm512_set1_pd(Fused ? ub[6] : 0.0);
+                const auto vu7 = _mm512_set1_pd(Fused ? ub[7] : 0.0);
+                auto vacc = _mm512_loadu_pd(acc);
+                size_t t = 0U;
+                for (; t + w <= m; t += w) {
+                    auto r0 = _mm512_loadu_pd(p[0] + t);
+                    auto r1 = _mm512_loadu_pd(p[1] + t);
+                    auto r2 = _mm512_loadu_pd(p[2] + t);
+                    auto r3 = _mm512_loadu_pd(p[3] + t);
+                    auto r4 = _mm512_loadu_pd(p[4] + t);
+                    auto r5 = _mm512_loadu_pd(p[5] + t);
+                    auto r6 = _mm512_loadu_pd(p[6] + t);
+                    auto r7 = _mm512_loadu_pd(p[7] + t);
+                    if (Fused) {  // rank-one update of the tile, in place
+                        const auto ru = _mm512_mul_pd(vr, _mm512_loadu_pd(ur + t));
+                        r0 = _mm512_sub_pd(r0, _mm512_mul_pd(ru, vu0));
+                        _mm512_storeu_pd(p[0] + t, r0);
+                        r1 = _mm512_sub_pd(r1, _mm512_mul_pd(ru, vu1));
+                        _mm512_storeu_pd(p[1] + t, r1);
+                        r2 = _mm512_sub_pd(r2, _mm512_mul_pd(ru, vu2));
+                        _mm512_storeu_pd(p[2] + t, r2);
+                        r3 = _mm512_sub_pd(r3, _mm512_mul_pd(ru, vu3));
+                        _mm512_storeu_pd(p[3] + t, r3);
+                        r4 = _mm512_sub_pd(r4, _mm512_mul_pd(ru, vu4));
+                        _mm512_storeu_pd(p[4] + t, r4);
+                        r5 = _mm512_sub_pd(r5, _mm512_mul_pd(ru, vu5));
+                        _mm512_storeu_pd(p[5] + t, r5);
+                        r6 = _mm512_sub_pd(r6, _mm512_mul_pd(ru, vu6));
+                        _mm512_storeu_pd(p[6] + t, r6);
+                        r7 = _mm512_sub_pd(r7, _mm512_mul_pd(ru, vu7));
+                        _mm512_storeu_pd(p[7] + t, r7);
+                    }
+                    auto o = _mm512_loadu_pd(outr + t);
+                    o = _mm512_add_pd(o, _mm512_mul_pd(r0, g0));
+                    o = _mm512_add_pd(o, _mm512_mul_pd(r1, g1));
+                    o = _mm512_add_pd(o, _mm512_mul_pd(r2, g2));
+                    o = _mm512_add_pd(o, _mm512_mul_pd(r3, g3));
+                    o = _mm512_add_pd(o, _mm512_mul_pd(r4, g4));
+                    o = _mm512_add_pd(o, _mm512_mul_pd(r5, g5));
+                    o = _mm512_add_pd(o, _mm512_mul_pd(r6, g6));
+                    o = _mm512_add_pd(o, _mm512_mul_pd(r7, g7));
+                    _mm512_storeu_pd(outr + t, o);
+                    // 8x8 transpose: pairs, then pairs of pairs, then quadruples
+                    const auto u0 = _mm512_permutex2var_pd(r0, ilo, r1);  // rows 0, 2, 4, 6
+                    const auto u1 = _mm512_permutex2var_pd(r0, ihi, r1);  // rows 1, 3, 5, 7
+                    const auto u2 = _mm512_permutex2var_pd(r2, ilo, r3);
+                    const auto u3 = _mm512_permutex2var_pd(r2, ihi, r3);
+                    const auto u4 = _mm512_permutex2var_pd(r4, ilo, r5);
+                    const auto u5 = _mm512_permutex2var_pd(r4, ihi, r5);
+                    const auto u6 = _mm512_permutex2var_pd(r6, ilo, r7);
+                    const auto u7 = _mm512_permutex2var_pd(r6, ihi, r7);
+                    const auto v0 = _mm512_permutex2var_pd(u0, i04, u2);  // rows 0, 4
+                    const auto v1 = _mm512_permutex2var_pd(u1, i04, u3);  // rows 1, 5
+                    const auto v2 = _mm512_permutex2var_pd(u0, i26, u2);  // rows 2, 6
+                    const auto v3 = _mm512_permutex2var_pd(u1, i26, u3);  // rows 3, 7
+                    const auto v4 = _mm512_permutex2var_pd(u4, i04, u6);
+                    const auto v5 = _mm512_permutex2var_pd(u5, i04, u7);
+                    const auto v6 = _mm512_permutex2var_pd(u4, i26, u6);
+                    const auto v7 = _mm512_permutex2var_pd(u5, i26, u7);
+                    const auto *gt = gr + t;
+                    auto s = _mm512_mul_pd(_mm512_permutex2var_pd(v0, i04, v4),
+                                           _mm512_set1_pd(gt[0]));
+                    vacc = _mm512_add_pd(vacc, s);
+                    s = _mm512_mul_pd(_mm512_permutex2var_pd(v1, i04, v5), _mm512_set1_pd(gt[1]));
+                    vacc = _mm512_add_pd(vacc, s);
+                    s = _mm512_mul_pd(_mm512_permutex2var_pd(v2, i04, v6), _mm512_set1_pd(gt[2]));
+                    vacc = _mm512_add_pd(vacc, s);
+                    s = _mm512_mul_pd(_mm512_permutex2var_pd(v3, i04, v7), _mm512_set1_pd(gt[3]));
+                    vacc = _mm512_add_pd(vacc, s);
+                    s = _mm512_mul_pd(_mm512_permutex2var_pd(v0, i26, v4), _mm512_set1_pd(gt[4]));
+                    vacc = _mm512_add_pd(vacc, s);
+                    s = _mm512_mul_pd(_mm512_permutex2var_pd(v1, i26, v5), _mm512_set1_pd(gt[5]));
+                    vacc = _mm512_add_pd(vacc, s);
+                    s = _mm512_mul_pd(_mm512_permutex2var_pd(v2, i26, v6), _mm512_set1_pd(gt[6]));
+                    vacc = _mm512_add_pd(vacc, s);
+                    s = _mm512_mul_pd(_mm512_permutex2var_pd(v3, i26, v7), _mm512_set1_pd(gt[7]));
+                    vacc = _mm512_add_pd(vacc, s);
+                }
+                _mm512_storeu_pd(acc, vacc);
+                matvec_rows<Fused>(p, r, ub, ur, gb, gr, outr, t, m, w, acc);
+                std::copy(acc, acc + w, out + j0);
+            }
+            matvec_columns<Fused>(mq, r, u, g, out, j0, col1, row0, row1);
+        }
+
+        ELL_TARGET("avx512f")
+        void matvec_avx512(SymMatrix &mq, double r, const double *u, const double *g, double *out,
+                         size_t col0, size_t col1, size_t row0, size_t row1) {
+            if (u == nullptr) {
+                matvec_avx512_impl<false>(mq, r, u, g, out, col0, col1, row0, row1);
+            } else {
+                matvec_avx512_impl<true>(mq, r, u, g, out, col0, col1, row0, row1);
+            }
+        }
+
+        ELL_TARGET("avx512f")
+        auto dot_avx512(const double *a, const double *b, size_t len) -> double {
+            auto vs = _mm512_setzero_pd();
+            size_t k = 0U;
+            for (; k + lanes <= len; k += lanes) {
+                const auto ab = _mm512_mul_pd(_mm512_loadu_pd(a + k), _mm512_loadu_pd(b + k));
+                vs = _mm512_add_pd(vs, ab);
+            }
+            double acc[lanes];
+            _mm512_storeu_pd(acc, vs);
+            return dot_tail(acc, a, b, k, len);
+        }
+
+        ELL_TARGET("avx512f")
+        void sub_scaled_avx512(const double *a, double *y, double alpha, size_t len) {
+            const auto va = _mm512_set1_pd(alpha);
+            size_t k = 0U;
+            for (; k + lanes <= len; k += lanes) {
+                _mm512_storeu_pd(y + k, _mm512_sub_pd(_mm512_loadu_pd(y + k),
+                                                      _mm512_mul_pd(_mm512_loadu_pd(a + k), va)));
+            }
+            sub_scaled_tail(a, y, alpha, k, len);
+        }
+
+        ELL_TARGET("avx512f")
+        void rank_one_avx512(double *a, const double *v, double r, double alpha, size_t len) {
+            const auto vr = _mm512_set1_pd(r);
+            const auto va = _mm512_set1_pd(alpha);
+            size_t k = 0U;
+            for (; k + lanes <= len; k += lanes) {
+                const auto t = _mm512_mul_pd(_mm512_mul_pd(vr, _mm512_loadu_pd(v + k)), va);
+                _mm512_storeu_pd(a + k, _mm512_sub_pd(_mm512_loadu_pd(a + k), t));
+            }
+            rank_one_tail(a, v, r, alpha, k, len);
+        }
+
+        ELL_TARGET("avx512f")
+        void ldl_col_avx512(double *a, double *v, double alpha, double beta, size_t len) {
+            const auto va = _mm512_set1_pd(alpha);
+            const auto vb = _mm512_set1_pd(beta);
+            size_t k = 0U;
+            for (; k + lanes <= len; k += lanes) {
+                const auto ak = _mm512_loadu_pd(a + k);
+                const auto vk = _mm512_sub_pd(_mm512_loadu_pd(v + k), _mm512_mul_pd(ak, va));
+                _mm512_storeu_pd(v + k, vk);
+                _mm512_storeu_pd(a + k, _mm512_add_pd(ak, _mm512_mul_pd(vb, vk)));
+            }
+            ldl_col_tail(a, v, alpha, beta, k, len);
+        }
+
+        ELL_TARGET("avx512f")
+        void batch_matvec_avx512(const double *mq, const double *g, double *qg, double *omega,
+                               size_t ndim, size_t stride) {
+            batch_matvec_body(mq, g, qg, omega, ndim, stride);
+        }
+
+        ELL_TARGET("avx512f")
+        void batch_rank_one_avx512(double *mq, const double *qg, const double *r, const double *s,
+                                 double *xc, size_t ndim, size_t stride) {
+            batch_rank_one_body(mq, qg, r, s, xc, ndim, stride);
+        }
+
+        /** lanes [k, k + 8) of a bool mask */
+        ELL_TARGET("avx512f")
+        ELL_ALWAYS_INLINE auto load_mask_avx512(const bool *mask, size_t k) -> __mmask8 {
+            const auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(mask + k));
+            const auto wide = _mm512_maskz_cvtepu8_epi64(0xFF, bytes);
+            return _mm512_test_epi64_mask(wide, wide);
+        }
+
+        ELL_TARGET("avx512f")
+        void batch_interval_cut_avx512(const double *g, const double *beta, const bool *active,
+                                       const bool *central, double *xc, double *r, double *tsq,
+                                       double *code, size_t stride) {
+            const auto zero = _mm512_setzero_pd();
+            const auto half = _mm512_set1_pd(0.5);  // x / 2, exactly
+            const auto one = _mm512_set1_pd(1.0);
+            const auto two = _mm512_set1_pd(2.0);
+            const auto abs_mask = _mm512_set1_epi64(0x7fffffffffffffffLL);
+            for (size_t k = 0U; k != stride; k += 8) {
+                const auto vg = _mm512_loadu_pd(g + k);
+                const auto vb = _mm512_loadu_pd(beta + k);
+                const auto vx = _mm512_loadu_pd(xc + k);
+                const auto vr = _mm512_loadu_pd(r + k);
+                const auto act = load_mask_avx512(active, k);
+                const auto cen = load_mask_avx512(central, k);
+                const auto tau = _mm512_castsi512_pd(
+                    _mm512_and_epi64(_mm512_castpd_si512(_mm512_mul_pd(vr, vg)), abs_mask));
+                const auto no_soln = _mm512_kandn(cen, _mm512_cmp_pd_mask(vb, tau, _CMP_GT_OQ));
+                const auto no_effect = _mm512_kandn(
+                    cen, _mm512_cmp_pd_mask(vb, _mm512_sub_pd(zero, tau), _CMP_LT_OQ));
+                const auto ok = _mm512_kandn(_mm512_kor(no_soln, no_effect), act);
+                const auto fail = _mm512_mask_blend_pd(
+                    no_effect, _mm512_mask_blend_pd(no_soln, zero, one), two);
+                const auto bound = _mm512_sub_pd(vx, _mm512_div_pd(vb, vg));
+                const auto g_pos = _mm512_cmp_pd_mask(vg, zero, _CMP_GT_OQ);
+                const auto u = _mm512_mask_blend_pd(g_pos, _mm512_add_pd(vx, vr), bound);
+                const auto lo = _mm512_mask_blend_pd(g_pos, bound, _mm512_sub_pd(vx, vr));
+                const auto r_deep = _mm512_mul_pd(_mm512_sub_pd(u, lo), half);
+                const auto r_central = _mm512_mul_pd(vr, half);
+                const auto xc_central = _mm512_mask_blend_pd(g_pos, _mm512_add_pd(vx, r_central),
+                                                             _mm512_sub_pd(vx, r_central));
+                const auto xc_ok
+                    = _mm512_mask_blend_pd(cen, _mm512_add_pd(lo, r_deep), xc_central);
+                const auto r_ok = _mm512_mask_blend_pd(cen, r_deep, r_central);
+                _mm512_mask_storeu_pd(xc + k, ok, xc_ok);
+                _mm512_mask_storeu_pd(r + k, ok, r_ok);
+                _mm512_mask_storeu_pd(tsq + k, act, _mm512_mul_pd(tau, tau));
+                _mm512_mask_storeu_pd(code + k, act, fail);
+            }
+        }
+
+        ELL_TARGET("avx512f")
+        void sub_combination_avx512(double *y, const double *const *a, const double *alpha,
+                                    size_t num, size_t len) {
+            sub_combination_body(y, a, alpha, num, len);
+        }
+
+        ELL_TARGET("avx512f")
+        void sub_panel_avx512(const double *panel, const double *v, double *acc, size_t first,
+                              size_t last) {
+            sub_panel_body(panel, v, acc, first, last);
+        }
+
+        // AVX-512 on float elements: a block of 4 columns, over 8 rows at a time, as one
+        // 8-wide register. The maskz forms of the conversions have no undefined source.
+
+        template <bool Fused>
+        ELL_TARGET("avx512f")
+        ELL_ALWAYS_INLINE void matvec_f32_step_avx512(float *pc, __m512d ru, __m512d vu,
+                                                      __m512d vg, __m512d gi, __m512d &acc,
+                                                      __m512d &o) {
+            auto q = _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(pc));
+            if (Fused) {  // rank-one update, in place
+                const auto f
+                    = _mm512_maskz_cvtpd_ps(0xFF, _mm512_sub_pd(q, _mm512_mul_pd(ru, vu)));
+                _mm256_storeu_ps(pc, f);
+                q = _mm512_maskz_cvtps_pd(0xFF, f);
+            }
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(q, gi));
+            o = _mm512_add_pd(o, _mm512_mul_pd(q, vg));
+        }
+
+        template <bool Fused>
+        ELL_TARGET("avx512f")
+        auto matvec_f32_avx512_impl(SymMatrixF &mq, double r, const double *u, const double *g,
+                                    double *out) -> double {
+            constexpr size_t B = 4U;
+            const auto ndim = mq.size();
+            const auto vr = _mm512_set1_pd(r);
+            auto omega = 0.0;
+            size_t j0 = 0U;
+            for (; j0 + B <= ndim; j0 += B) {
+                float *p[B];
+                double acc[B][lanes];
+                auto i = matvec_f32_head<Fused, B>(mq, p, r, u, g, out, j0, acc);
+                auto a0 = _mm512_loadu_pd(acc[0]);
+                auto a1 = _mm512_loadu_pd(acc[1]);
+                auto a2 = _mm512_loadu_pd(acc[2]);
+                auto a3 = _mm512_loadu_pd(acc[3]);
+                const auto vg0 = _mm512_set1_pd(g[j0]);
+                const auto vg1 = _mm512_set1_pd(g[j0 + 1]);
+                const auto vg2 = _mm512_set1_pd(g[j0 + 2]);
+                const auto vg3 = _mm512_set1_pd(g[j0 + 3]);
+                const auto vu0 = _mm512_set1_pd(Fused ? u[j0] : 0.0);
+                const auto vu1 = _mm512_set1_pd(Fused ? u[j0 + 1] : 0.0);
+                const auto vu2 = _mm512_set1_pd(Fused ? u[j0 + 2] : 0.0);
+                const auto vu3 = _mm512_set1_pd(Fused ? u[j0 + 3] : 0.0);
+                for (; i + lanes <= ndim; i += lanes) {
+                    auto o = _mm512_loadu_pd(out + i);
+                    const auto gi = _mm512_loadu_pd(g + i);
+                    const auto ru = Fused ? _mm512_mul_pd(vr, _mm512_loadu_pd(u + i)) : vr;
+                    matvec_f32_step_avx512<Fused>(p[0] + i, ru, vu0, vg0, gi, a0, o);
+                    matvec_f32_step_avx512<Fused>(p[1] + i, ru, vu1, vg1, gi, a1, o);
+                    matvec_f32_step_avx512<Fused>(p[2] + i, ru, vu2, vg2, gi, a2, o);
+                    matvec_f32_step_avx512<Fused>(p[3] + i, ru, vu3, vg3, gi, a3, o);
+                    _mm512_storeu_pd(out + i, o);
+                }
+                _mm512_storeu_pd(acc[0], a0);
+                _mm512_storeu_pd(acc[1], a1);
+                _mm512_storeu_pd(acc[2], a2);
+                _mm512_storeu_pd(acc[3], a3);
+                matvec_f32_rows<Fused, B>(p, r, u, g, out, j0, i, ndim, acc);
+                for (size_t c = 0U; c != B; ++c) {
+                    omega += matvec_f32_finish(p[c], j0 + c, g, out, acc[c]);
+                }
+            }
+            return matvec_f32_columns<Fused>(mq, r, u, g, out, j0, omega);
+        }
+
+        ELL_TARGET("avx512f")
+        auto matvec_f32_avx512(SymMatrixF &mq, double r, const double *u, const double *g,
+                               double *out) -> double {
+            return u == nullptr ? matvec_f32_avx512_impl<false>(mq, r, u, g, out)
+                                : matvec_f32_avx512_impl<true>(mq, r, u, g, out);
+        }
+
+        const Primitives avx512_primitives{
+            Isa::Avx512,            matvec_avx512,         dot_avx512,
+            sub_scaled_avx512,      rank_one_avx512,       ldl_col_avx512,
+            batch_matvec_avx512,    batch_rank_one_avx512, batch_interval_cut_avx512,
+            sub_combination_avx512, sub_panel_avx512,      matvec_f32_avx512};
+
+#endif  // ELL_KERNEL_X86
+
+#ifdef ELL_KERNEL_NEON
+
+        // NEON: a block of 2 columns; four 2-wide registers hold the dot lanes.
+
+        template <bool Fused>
+        void matvec_neon_impl(SymMatrix &mq, double r, const double *u, const double *g,
+                              double *out, size_t col0, size_t col1, size_t row0, size_t row1) {
+            constexpr size_t w = 2U;
+            size_t j0 = col0;
+            for (; j0 + w <= col1; j0 += w) {
+                double acc[w];
+                const auto first = matvec_head<Fused>(mq, r, u, g, out, j0, w, row0, acc);
+                double *p[w] = {mq.column(j0) + (first - j0),
+                                mq.column(j0 + 1) + (first - j0 - 1)};
+                const auto *gb = g + j0;
+                const auto *ub = Fused ? u + j0 : nullptr;
+                const auto *ur = Fused ? u + first : nullptr;
+                const auto *gr = g + first;
+                auto *outr = out + first;
+                const auto m = row1 - first;
+                const auto g0 = vdupq_n_f64(gb[0]);
+                const auto g1 = vdupq_n_f64(gb[1]);
+                const auto vr = vdupq_n_f64(r);
+                const auto vu0 = vdupq_n_f64(Fused ? ub[0] : 0.0);
+                const auto vu1 = vdupq_n_f64(Fused ? ub[1] : 0.0);
+                auto vacc = vld1q_f64(acc);
+                size_t t = 0U;
+                for (; t + w <= m; t += w) {
+                    auto r0 = vld1q_f64(p[0] + t);
+                    auto r1 = vld1q_f64(p[1] + t);
+                    if (Fused) {  // rank-one update of the tile, in place
+                        const auto ru = vmulq_f64(vr, vld1q_f64(ur + t));
+                        r0 = vsubq_f64(r0, vmulq_f64(ru, vu0));
+                        vst1q_f64(p[0] + t, r0);
+                        r1 = vsubq_f64(r1, vmulq_f64(ru, vu1));
+                        vst1q_f64(p[1] + t, r1);
+                    }
+                    auto o = vld1q_f64(outr + t);
+                    o = vaddq_f64(o, vmulq_f64(r0, g0));
+                    o = vaddq_f64(o, vmulq_f64(r1, g1));
+                    vst1q_f64(outr + t, o);
+                    vacc = vaddq_f64(vacc, vmulq_f64(vzip1q_f64(r0, r1), vdupq_n_f64(gr[t])));
+                    vacc = vaddq_f64(vacc, vmulq_f64(vzip2q_f64(r0, r1), vdupq_n_f64(gr[t + 1])));
+                }
+                vst1q_f64(acc, vacc);
+                matvec_rows<Fused>(p, r, ub, ur, gb, gr, outr, t, m, w, acc);
+                std::copy(acc, acc + w, out + j0);
+            }
+            matvec_columns<Fused>(mq, r, u, g, out, j0, col1, row0, row1);
+        }
+
+        void matvec_neon(SymMatrix &mq, double r, const double *u, const double *g, double *out,
+                         size_t col0, size_t col1, size_t row0, size_t row1) {
+            if (u == nullptr) {
+                matvec_neon_impl<false>(mq, r, u, g, out, col0, col1, row0, row1);
+            } else {
+                matvec_neon_impl<true>(mq, r, u, g, out, col0, col1, row0, row1);
+            }
+        }
+
+        auto dot_neon(const double *a, const double *b, size_t len) -> double {
+            float64x2_t vs[4] = {vdupq_n_f64(0.0), vdupq_n_f64(0.0), vdupq_n_f64(0.0),
+                                 vdupq_n_f64(0.0)};
+            size_t k = 0U;
+            for (; k + lanes <= len; k += lanes) {
+                for (size_t i = 0U; i != 4U; ++i) {
+                    vs[i] = vaddq_f64(vs[i], vmulq_f64(vld1q_f64(a + k + 2 * i),
+                                                       vld1q_f64(b + k + 2 * i)));
+                }
+            }
+            double acc[lanes];
+            for (size_t i = 0U; i != 4U; ++i) {
+                vst1q_f64(acc + 2 * i, vs[i]);
+            }
+            return dot_tail(acc, a, b, k, len);
+        }
+
+        void sub_scaled_neon(const double *a, double *y, double alpha, size_t len) {
+            const auto va = vdupq_n_f64(alpha);
+            size_t k = 0U;
+            for (; k + 2 <= len; k += 2) {
+                vst1q_f64(y + k, vsubq_f64(vld1q_f64(y + k), vmulq_f64(vld1q_f64(a + k), va)));
+            }
+            sub_scaled_tail(a, y, alpha, k, len);
+        }
+
+        void rank_one_neon(double *a, const double *v, double r, double alpha, size_t len) {
+            const auto vr = vdupq_n_f64(r);
+            const auto va = vdupq_n_f64(alpha);
+            size_t k = 0U;
+            for (; k + 2 <= len; k += 2) {
+                const auto t = vmulq_f64(vmulq_f64(vr, vld1q_f64(v + k)), va);
+                vst1q_f64(a + k, vsubq_f64(vld1q_f64(a + k), t));
+            }
+            rank_one_tail(a, v, r, alpha, k, len);
+        }
+
+        void ldl_col_neon(double *a, double *v, double alpha, double beta, size_t len) {
+            const auto va = vdupq_n_f64(alpha);
+            const auto vb = vdupq_n_f64(beta);
+            size_t k = 0U;
+            for (; k + 2 <= len; k += 2) {
+                const auto ak = vld1q_f64(a + k);
+                const auto vk = vsubq_f64(vld1q_f64(v + k), vmulq_f64(ak, va));
+                vst1q_f64(v + k, vk);
+                vst1q_f64(a + k, vaddq_f64(ak, vmulq_f64(vb, vk)));
+            }
+            ldl_col_tail(a, v, alpha, beta, k, len);
+        }
+
+        // NEON is the baseline of AArch64, so the batched kernels are vectorized already
+        const Primitives neon_primitives{
+            Isa::Neon,              matvec_neon,           dot_neon,
+            sub_scaled_neon,        rank_one_neon,         ldl_col_neon,
+            batch_matvec_scalar,    batch_rank_one_scalar, batch_interval_cut_scalar,
+            sub_combination_scalar, sub_panel_scalar,      matvec_f32_scalar};
+
+#endif  // ELL_KERNEL_NEON
+
+        auto primitives_of(Isa isa) -> const Primitives * {
+#ifdef ELL_KERNEL_X86
+            __builtin_cpu_init();
+#endif
+            switch (isa) {
+#ifdef ELL_KERNEL_X86
+                case Isa::Avx512:
+                    return __builtin_cpu_supports("avx512f") ? &avx512_primitives : nullptr;
+                case Isa::Avx2:
+                    return __builtin_cpu_supports("avx2") ? &avx2_primitives : nullptr;
+#endif
+#ifdef ELL_KERNEL_NEON
+                case Isa::Neon:
+                    return &neon_primitives;
+#endif
+                case Isa::Scalar:
+                    return &scalar_primitives;
+                default:
+                    return nullptr;
+            }
+        }
+
+        auto detect() -> const Primitives * {
+            for (auto isa : {Isa::Avx512, Isa::Avx2, Isa::Neon}) {
+                if (const auto *prim = primitives_of(isa)) {
+                    return prim;
+                }
+            }
+            return &scalar_primitives;
+        }
+
+        auto best() -> const Primitives * {
+            static const auto *const prim = detect();
+            return prim;
+        }
+
+        auto active() -> std::atomic<const Primitives *> & {
+            static std::atomic<const Primitives *> prim{best()};
+            return prim;
+        }
+
+        inline auto current() -> const Primitives & {
+            return *active().load(std::memory_order_relaxed);
+        }
+
+        /**
+         * The persistent threads of the parallel kernels (see
+         * `ell_kernel::set_num_threads`). A job is a number of steps, run by
+         * all the threads, the caller being the thread 0, with a barrier
+         * after each step. The workers sleep between the jobs and spin at
+         * the barriers.
+         */
+        class Pool {
+          public:
+            using Task = void (*)(const void *job, size_t tid, size_t step);
+
+          private:
+            struct Run {
+                Task task;
+                const void *job;
+                size_t num_threads;
+                size_t num_steps;
+            };
+
+            std::mutex _busy;  // held for a job, or to resize
+            std::mutex _mutex;
+            std::condition_variable _wake;
+            std::vector<std::thread> _workers;
+            size_t _generation = 0U;  // of the jobs, under _mutex
+            bool _stop = false;
+            Run _run{};  // the current job, under _mutex
+            std::atomic<size_t> _arrived{0U};
+            std::atomic<size_t> _phase{0U};
+            std::atomic<size_t> _num_threads{1U};
+            std::atomic<size_t> _min_dim{0U};
+
+            void barrier(size_t num_threads) {
+                const auto phase = this->_phase.load(std::memory_order_acquire);
+                if (this->_arrived.fetch_add(1U, std::memory_order_acq_rel) + 1U == num_threads) {
+                    this->_arrived.store(0U, std::memory_order_relaxed);
+                    this->_phase.store(phase + 1U, std::memory_order_release);
+                    return;
+                }
+                for (auto spin = 0U; this->_phase.load(std::memory_order_acquire) == phase;
+                     ++spin) {
+                    if (spin >= 1024U) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            void work(const Run &run, size_t tid) {
+                for (auto step = size_t(0U); step != run.num_steps; ++step) {
+                    run.task(run.job, tid, step);
+                    this->barrier(run.num_threads);
+                }
+            }
+
+            void serve(size_t tid, size_t seen) {
+                for (;;) {
+                    auto run = Run{};
+                    {
+                        std::unique_lock<std::mutex> lock(this->_mutex);
+                        this->_wake.wait(
+                            lock, [&] { return this->_stop || this->_generation != seen; });
+                        if (this->_stop) {
+                            return;
+                        }
+                        seen = this->_generation;
+                        run = this->_run;
+                    }
+                    this->work(run, tid);
+                }
+            }
+
+            void join() {
+                {
+                    std::lock_guard<std::mutex> lock(this->_mutex);
+                    this->_stop = true;
+                }
+                this->_wake.notify_all();
+                for (auto &worker : this->_workers) {
+                    worker.join();
+                }
+                this->_workers.clear();
+                this->_stop = false;
+            }
+
+          public:
+            Pool() = default;
+            Pool(const Pool &) = delete;
+            auto operator=(const Pool &) -> Pool & = delete;
+            ~Pool() { this->join(); }
+
+            void resize(size_t num_threads, size_t min_dim) {
+                std::lock_guard<std::mutex> busy(this->_busy);
+                this->join();
+                num_threads = std::max(num_threads, size_t(1U));
+                const auto seen = this->_generation;  // no worker left to race with
+                for (auto tid = size_t(1U); tid != num_threads; ++tid) {
+                    this->_workers.emplace_back([this, tid, seen] { this->serve(tid, seen); });
+                }
+                this->_min_dim.store(min_dim, std::memory_order_relaxed);
+                this->_num_threads.store(num_threads, std::memory_order_relaxed);
+            }
+
+            /** The number of threads for a kernel of size ndim, 1 for serial */
+            auto threads_for(size_t ndim) const -> size_t {
+                const auto num_threads = this->_num_threads.load(std::memory_order_relaxed);
+                return ndim < this->_min_dim.load(std::memory_order_relaxed) ? 1U : num_threads;
+            }
+
+            auto size() const -> size_t {
+                return this->_num_threads.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * Run task(job, tid, step) for every thread tid and every step in
+             * order; false (having done nothing) if another job is running,
+             * or the threads have changed in the meantime.
+             */
+            auto try_run(Task task, const void *job, size_t num_threads, size_t num_steps)
+                -> bool {
+                std::unique_lock<std::mutex> busy(this->_busy, std::try_to_lock);
+                if (!busy || this->_workers.size() + 1U != num_threads) {
+                    return false;
+                }
+                const auto run = Run{task, job, num_threads, num_steps};
+                {
+                    std::lock_guard<std::mutex> lock(this->_mutex);
+                    this->_run = run;
+                    ++this->_generation;
+                }
+                this->_wake.notify_all();
+                this->work(run, 0U);
+                return true;
+            }
+        };
+
+        auto pool() -> Pool & {
+            static Pool threads;
+            return threads;
+        }
+
+        /**
+         * A product by square tiles of `tile` rows and columns. The tiles
+         * (I, J) of the lower triangle are done in the waves I + J = 0, 1,
+         * ..., each wave writing disjoint parts of `out`, so that every
+         * out[i] gets its terms in the serial order.
+         */
+        struct MatvecJob {
+            const Primitives *prim;
+            SymMatrix *mq;
+            double r;
+            const double *u;
+            const double *g;
+            double *out;
+            size_t tile;
+            size_t num_tiles;
+            size_t num_threads;
+        };
+
+        void matvec_wave(const void *arg, size_t tid, size_t step) {
+            const auto &job = *static_cast<const MatvecJob *>(arg);
+            const auto ndim = job.mq->size();
+            auto k = size_t(0U);  // the tiles of the wave are dealt out round robin
+            for (auto ti = (step + 1U) / 2U; ti <= step && ti != job.num_tiles; ++ti, ++k) {
+                if (k % job.num_threads != tid) {
+                    continue;
+                }
+                const auto col0 = (step - ti) * job.tile;
+                const auto row0 = ti * job.tile;
+                job.prim->matvec(*job.mq, job.r, job.u, job.g, job.out, col0,
+                                 std::min(col0 + job.tile, ndim), row0,
+                                 std::min(row0 + job.tile, ndim));
+            }
+        }
+
+        /** out += Q * g, after Q -= r * u * u' if u is not null */
+        void matvec_all(const Primitives &prim, SymMatrix &mq, double r, const double *u,
+                        const double *g, double *out) {
+            const auto ndim = mq.size();
+            const auto num_threads = pool().threads_for(ndim);
+            if (num_threads > 1U) {
+                // about 2 tiles per thread in the longest waves, of 64 rows at least
+                const auto tile = std::max(size_t(64U), (ndim / (4U * num_threads) + 7U) / 8U * 8U);
+                const auto num_tiles = (ndim + tile - 1U) / tile;
+                const auto job = MatvecJob{&prim, &mq, r, u, g, out, tile, num_tiles, num_threads};
+                if (pool().try_run(matvec_wave, &job, num_threads, 2U * num_tiles - 1U)) {
+                    return;
+                }
+            }
+            prim.matvec(mq, r, u, g, out, 0U, ndim, 0U, ndim);
+        }
+
+        auto matvec_omega(const double *g, const double *out, size_t ndim) -> double {
+            auto omega = 0.0;
+            for (auto j = 0U; j != ndim; ++j) {
+                omega += out[j] * g[j];
+            }
+            return omega;
+        }
+
+        struct RankOneJob {
+            const Primitives *prim;
+            SymMatrix *mq;
+            double r;
+            const double *v;
+            size_t num_threads;
+        };
+
+        void rank_one_share(const void *arg, size_t tid, size_t /* step */) {
+            const auto &job = *static_cast<const RankOneJob *>(arg);
+            const auto ndim = job.mq->size();
+            // blocks of 8 columns round robin, as the columns get shorter
+            for (auto j0 = tid * 8U; j0 < ndim; j0 += job.num_threads * 8U) {
+                for (auto j = j0; j != std::min(j0 + 8U, ndim); ++j) {
+                    job.prim->rank_one(job.mq->column(j), job.v + j, job.r, job.v[j], ndim - j);
+                }
+            }
+        }
+
+        struct SharedJob {
+            void (*task)(const void *arg, size_t tid, size_t num);
+            const void *arg;
+            size_t num_threads;
+        };
+
+        void shared_share(const void *arg, size_t tid, size_t /* step */) {
+            const auto &job = *static_cast<const SharedJob *>(arg);
+            if (tid < job.num_threads) {
+                job.task(job.arg, tid, job.num_threads);
+            }
+        }
+
+    }  // namespace
+
+    auto best_isa() -> Isa { return best()->isa; }
+
+    auto active_isa() -> Isa { return current().isa; }
+
+    auto set_isa(Isa isa) -> bool {
+        const auto *prim = primitives_of(isa);
+        if (prim == nullptr) {
+            return false;
+        }
+        active().store(prim, std::memory_order_relaxed);
+        return true;
+    }
+
+    auto isa_name(Isa isa) -> const char * {
+        switch (isa) {
+            case Isa::Avx2:
+                return "avx2";
+            case Isa::Avx512:
+                return "avx512";
+            case Isa::Neon:
+                return "neon";
+            default:
+                return "scalar";
+        }
+    }
+
+    auto set_num_threads(size_t num_threads, size_t min_dim) -> void {
+        pool().resize(num_threads, min_dim);
+    }
+
+    auto num_threads() -> size_t { return pool().size(); }
+
+    auto run_on_threads(void (*task)(const void *arg, size_t tid, size_t num), const void *arg,
+                        size_t max_threads) -> void {
+        const auto size = pool().size();
+        const auto num = std::min(size, max_threads);
+        if (num > 1U) {
+            const auto job = SharedJob{task, arg, num};
+            if (pool().try_run(shared_share, &job, size, 1U)) {
+                return;
+            }
+        }
+        task(arg, 0U, 1U);
+    }
+
+    auto sym_matvec(const SymMatrix &mq, const double *g, double *out) -> double {
+        const auto &prim = current();
+        std::fill(out, out + mq.size(), 0.0);
+        // mq is only written to with a rank-one update
+        matvec_all(prim, const_cast<SymMatrix &>(mq), 0.0, nullptr, g, out);
+        return matvec_omega(g, out, mq.size());
+    }
+
+    auto sym_update_matvec(SymMatrix &mq, double r, const double *u, const double *g, double *out)
+        -> double {
+        const auto &prim = current();
+        std::fill(out, out + mq.size(), 0.0);
+        matvec_all(prim, mq, r, u, g, out);
+        return matvec_omega(g, out, mq.size());
+    }
+
+    auto sym_matvec_multi(const SymMatrix &mq, const double *const *g, double *const *out,
+                          double *omega, size_t num) -> void {
+        const auto &prim = current();
+        const auto ndim = mq.size();
+        for (auto k = 0U; k != num; ++k) {
+            std::fill(out[k], out[k] + ndim, 0.0);
+        }
+        // panels of about 128 KiB, for the second and later vectors to find them in cache
+        const auto width = std::max(size_t(8U), 16384U / std::max(ndim, size_t(1U)) / 8U * 8U);
+        for (auto col0 = size_t(0U); col0 < ndim; col0 += width) {
+            const auto col1 = std::min(col0 + width, ndim);
+            for (auto k = 0U; k != num; ++k) {
+                // mq is only written to with a rank-one update
+                prim.matvec(const_cast<SymMatrix &>(mq), 0.0, nullptr, g[k], out[k], col0, col1,
+                            col0, ndim);
+            }
+        }
+        for (auto k = 0U; k != num; ++k) {
+            omega[k] = matvec_omega(g[k], out[k], ndim);
+        }
+    }
+
+    auto sym_rank_one(SymMatrix &mq, double r, const double *v) -> void {
+        const auto &prim = current();
+        const auto ndim = mq.size();
+        const auto num_threads = pool().threads_for(ndim);
+        const auto job = RankOneJob{&prim, &mq, r, v, num_threads};
+        if (num_threads > 1U && pool().try_run(rank_one_share, &job, num_threads, 1U)) {
+            return;
+        }
+        for (auto j = 0U; j != ndim; ++j) {
+            prim.rank_one(mq.column(j), v + j, r, v[j], ndim - j);
+        }
+    }
+
+    auto sym_matvec(const SymMatrixF &mq, const double *g, double *out) -> double {
+        const auto &prim = current();
+        std::fill(out, out + mq.size(), 0.0);
+        return prim.matvec_f32(const_cast<SymMatrixF &>(mq), 0.0, nullptr, g, out);
+    }
+
+    auto sym_update_matvec(SymMatrixF &mq, double r, const double *u, const double *g,
+                           double *out) -> double {
+        const auto &prim = current();
+        std::fill(out, out + mq.size(), 0.0);
+        return prim.matvec_f32(mq, r, u, g, out);
+    }
+
+    auto sym_rank_one(SymMatrixF &mq, double r, const double *v) -> void {
+        const auto ndim = mq.size();
+        for (auto j = 0U; j != ndim; ++j) {
+            auto *col = mq.column(j);
+            for (auto k = 0U; k != ndim - j; ++k) {
+                col[k] = float(col[k] - r * v[j + k] * v[j]);
+            }
+        }
+    }
+
+    auto lower_solve(const SymMatrix &mq, double *x) -> void {
+        const auto &prim = current();
+        const auto ndim = mq.size();
+        for (auto j = 0U; j + 1 < ndim; ++j) {
+            prim.sub_scaled(mq.column(j) + 1, x + j + 1, x[j], ndim - j - 1);
+        }
+    }
+
+    auto lower_transpose_solve(const SymMatrix &mq, double *x) -> void {
+        const auto &prim = current();
+        const auto ndim = mq.size();
+        for (auto i = ndim; i-- > 1;) {  // backward substitution, i = n - 1, ..., 1
+            x[i - 1] -= prim.dot(mq.column(i - 1) + 1, x + i, ndim - i);
+        }
+    }
+
+    auto ldl_rank_one(SymMatrix &mq, double *v, const double *inv_lg, const double *inv_d_inv_lg,
+                      double oldt) -> void {
+        const auto &prim = current();
+        const auto ndim = mq.size();
+        for (auto j = 0U; j != ndim; ++j) {
+            auto *col = mq.column(j);
+            const auto p = v[j];
+            const auto temp = inv_d_inv_lg[j];
+            const auto newt = oldt + p * temp;
+            const auto beta2 = temp / newt;
+            col[0] *= oldt / newt;  // update invD
+            // L(j + k, j) is read before its update
+            prim.ldl_col(col + 1, v + j + 1, inv_lg[j], beta2, ndim - j - 1);
+            oldt = newt;
+        }
+    }
+
+    auto ldl_update_solve(SymMatrix &mq, double *v, double oldt, double *x) -> void {
+        const auto &prim = current();
+        const auto ndim = mq.size();
+        for (auto j = 0U; j != ndim; ++j) {
+            auto *col = mq.column(j);
+            const auto p = v[j];  // the inv(L) * g of `lower_solve`, bitwise
+            const auto temp = p * col[0];
+            const auto newt = oldt + p * temp;
+            const auto beta2 = temp / newt;
+            col[0] *= oldt / newt;
+            prim.ldl_col(col + 1, v + j + 1, p, beta2, ndim - j - 1);
+            if (x != nullptr) {  // while the column is in cache
+                prim.sub_scaled(col + 1, x + j + 1, x[j], ndim - j - 1);
+            }
+            oldt = newt;
+        }
+    }
+
+    auto batch_matvec(const double *mq, const double *g, double *qg, double *omega, size_t ndim,
+                      size_t stride) -> void {
+        current().batch_matvec(mq, g, qg, omega, ndim, stride);
+    }
+
+    auto batch_rank_one(double *mq, const double *qg, const double *r, const double *s,
+                        double *xc, size_t ndim, size_t stride) -> void {
+        current().batch_rank_one(mq, qg, r, s, xc, ndim, stride);
+    }
+
+    auto batch_interval_cut(const double *g, const double *beta, const bool *active,
+                            const bool *central, double *xc, double *r, double *tsq, double *code,
+                            size_t stride) -> void {
+        current().batch_interval_cut(g, beta, active, central, xc, r, tsq, code, stride);
+    }
+
+    auto sub_combination(double *y, const double *const *a, const double *alpha, size_t num,
+                         size_t len) -> void {
+        current().sub_combination(y, a, alpha, num, len);
+    }
+
+    auto sub_panel(const double *panel, const double *v, double *acc, size_t first, size_t last)
+        -> void {
+        current().sub_panel(panel, v, acc, first, last);
+    }
+
+}  // namespace ell_kernel
@@ -0,0 +1,68 @@
+#include <ellalgo/ell_memory.hpp>  // for MemoryResource, PoolResource
+#include <mutex>                   // for lock_guard
+#include <new>                     // for operator new, operator delete
+#include <vector>                  // for vector
+
+namespace {
+class NewDeleteResource : public MemoryResource {
+  public:
+    auto allocate(size_t bytes) -> void * override { return ::operator new(bytes); }
+    auto deallocate(void *ptr, size_t /* bytes */) noexcept -> void override {
+        ::operator delete(ptr);
+    }
+};
+}  // namespace
+
+auto default_resource() noexcept -> MemoryResource * {
+    static NewDeleteResource resource;
+    return &resource;
+}
+
+PoolResource::~PoolResource() {
+    for (auto *ptr : this->_blocks) {
+        ::operator delete(ptr);
+    }
+}
+
+/* A bucket keeps room for all its blocks in its free list, so that deallocate never allocates. */
+auto PoolResource::allocate(size_t bytes) -> void * {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    auto it = this->_buckets.begin();
+    while (it != this->_buckets.end() && it->bytes != bytes) {
+        ++it;
+    }
+    if (it == this->_buckets.end()) {
+        this->_buckets.push_back(Bucket{bytes, 0U, {}});
+        it = this->_buckets.end() - 1;
+    }
+    if (!it->free.empty()) {
+        auto *ptr = it->free.back();
+        it->free.pop_back();
+        return ptr;
+    }
+    if (it->free.capacity() == it->num) {
+        it->free.reserve(2 * it->num + 1);
+    }
+    if (this->_blocks.capacity() == this->_blocks.size()) {
+        this->_blocks.reserve(2 * this->_blocks.size() + 1);
+    }
+    auto *ptr = ::operator new(bytes);
+    this->_blocks.push_back(ptr);
+    ++it->num;
+    return ptr;
+}
+
+auto PoolResource::deallocate(void *ptr, size_t bytes) noexcept -> void {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    for (auto &bucket : this->_buckets) {
+        if (bucket.bytes == bytes) {
+            bucket.free.push_back(ptr);
+            return;
+        }
+    }
+}
+
+auto PoolResource::num_blocks() -> size_t {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_blocks.size();
+}
@@ -1,33 +1,13 @@
+#include <algorithm>  // for min
+#include <ellalgo/ell_kernel.hpp>  // for run_on_threads, sub_combination
 #include <ellalgo/oracles/ldlt_mgr.hpp>
 #include <functional>
+#include <vector>  // for vector
 
 /* The `factor` function in the `LDLTMgr` class is responsible for performing the factorization of a
 matrix using the LDL^T decomposition. */
 auto LDLTMgr::factor(const std::function<double(size_t, size_t)> &get_matrix_elem) -> bool {
-    this->pos = {0U, 0U};
-    auto const &start = this->pos.first;
-    auto &stop = this->pos.second;
-
-    for (auto i = 0U; i != this->_n; ++i) {
-        auto d = get_matrix_elem(i, start);
-        for (auto j = start; j != i; ++j) {
-            this->T(j, i) = d;
-            this->T(i, j) = d / this->T(j, j);  // note: T(j, i) here!
-            auto s = j + 1;
-            d = get_matrix_elem(i, s);
-            for (auto k = start; k != s; ++k) {
-                d -= this->T(i, k) * this->T(k, s);
-            }
-        }
-        this->T(i, i) = d;
-
-        if (d <= 0.0) {
-            stop = i + 1;
-            break;
-        }
-    }
-
-    return this->is_spd();
+    return this->_factor<false>(get_matrix_elem, 0U);
 }
 
 /* The `factor_with_allow_semidefinite` function in the `LDLTMgr` class is responsible for
@@ -35,34 +15,7 @@ performing the factorization of a matrix using the LDL^T decomposition, allowing
 matrices. */
 auto LDLTMgr::factor_with_allow_semidefinite(
     const std::function<double(size_t, size_t)> &get_matrix_elem) -> bool {
-    this->pos = {0U, 0U};
-    auto &start = this->pos.first;
-    auto &stop = this->pos.second;
-
-    for (auto i = 0U; i != this->_n; ++i) {
-        auto d = get_matrix_elem(i, start);
-        for (auto j = start; j != i; ++j) {
-            this->T(j, i) = d;
-            this->T(i, j) = d / this->T(j, j);  // note: T(j, i) here!
-            auto s = j + 1;
-            d = get_matrix_elem(i, s);
-            for (auto k = start; k != s; ++k) {
-                d -= this->T(i, k) * this->T(k, s);
-            }
-        }
-        this->T(i, i) = d;
-
-        if (d < 0.0) {
-            // this->stop = i + 1;
-            stop = i + 1;
-            break;
-        }
-        if (d == 0.0) {
-            start = i + 1;
-            // restart at i + 1, special as an LMI oracle
-        }
-    }
-    return this->is_spd();
+    return this->_factor<true>(get_matrix_elem, 0U);
 }
 
 /**
@@ -86,3 +39,57 @@ auto LDLTMgr::witness() -> double {
     }
     return -this->T(m, m);
 }
+
+struct LDLTMgr::QuadJob {
+    const LDLTMgr *mgr;
+    const InterleavedMats *F;
+    double *grad;
+};
+
+/**
+ * The rows i of the active block are taken one at a time: the elements
+ * (i, j), j >= i, of all the matrices are combined by `sub_combination`,
+ * which keeps a slice of grad in registers while it walks over them. The
+ * thread tid takes the tid-th of num_threads slices of the matrices, in
+ * whole blocks of `batch_block`, with the tid-th part of the workspace.
+ */
+auto LDLTMgr::_quad_share(const void *arg, size_t tid, size_t num_threads) -> void {
+    const auto &job = *static_cast<const QuadJob *>(arg);
+    const auto &mgr = *job.mgr;
+    const auto &F = *job.F;
+    const auto n = F.num_mats();
+    const auto &start = mgr.pos.first;
+    const auto &stop = mgr.pos.second;
+    const auto &v = mgr.witness_vec;
+
+    constexpr auto w = ell_kernel::batch_block;
+    const auto chunk = ((n + num_threads - 1) / num_threads + w - 1) / w * w;
+    const auto k0 = std::min(tid * chunk, n);
+    const auto k1 = std::min(k0 + chunk, n);
+    if (k0 == k1) {
+        return;
+    }
+    auto *rows = &mgr._quad_rows[tid * mgr._n];
+    auto *alpha = &mgr._quad_alpha[tid * mgr._n];
+    for (auto k = k0; k != k1; ++k) {
+        job.grad[k] = 0.0;
+    }
+    for (auto i = start; i != stop; ++i) {
+        for (auto j = i; j != stop; ++j) {
+            rows[j - i] = F.block(i, j) + k0;
+            alpha[j - i] = -(j == i ? 1.0 : 2.0) * v[i] * v[j];  // subtracted
+        }
+        ell_kernel::sub_combination(&job.grad[k0], rows, alpha, stop - i, k1 - k0);
+    }
+}
+
+auto LDLTMgr::sym_quad_all(const InterleavedMats &F, Span<double> grad, size_t num_threads) const
+    -> void {
+    num_threads = std::max(std::min(num_threads, ell_kernel::num_threads()), size_t(1U));
+    if (this->_quad_rows.size() < num_threads * this->_n) {
+        this->_quad_rows.resize(num_threads * this->_n);
+        this->_quad_alpha.resize(num_threads * this->_n);
+    }
+    const auto job = QuadJob{this, &F, grad.data()};
+    ell_kernel::run_on_threads(_quad_share, &job, num_threads);
+}
@@ -0,0 +1,209 @@
+#include <cstdint>                        // for uint64_t
+#include <cstdio>                         // for fopen, fwrite, fseek, fclose, rename
+#include <cstring>                        // for memcpy, memcmp
+#include <ellalgo/oracles/lmi_file.hpp>  // for LmiFile, LmiFileWriter, MatrixView
+#include <fstream>                        // for ifstream
+#include <iterator>                       // for istreambuf_iterator
+#include <stdexcept>                      // for runtime_error
+#include <string>                         // for string
+#include <vector>                         // for vector
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <fcntl.h>     // for open
+#    include <sys/mman.h>  // for mmap, munmap
+#    include <sys/stat.h>  // for fstat
+#    include <unistd.h>    // for close
+#    define ELL_LMI_FILE_MMAP
+#endif
+#ifdef _WIN32
+#    include <windows.h>  // for MoveFileExA
+#endif
+
+static const char lmi_magic[8] = {'E', 'L', 'L', 'L', 'M', 'I', '\0', '\1'};
+static const std::uint64_t header_size = 64U;
+static const std::uint64_t block_align = 64U;
+
+LmiFile::LmiFile(const std::string &path) {
+#ifdef ELL_LMI_FILE_MMAP
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("LmiFile: cannot open " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        this->_size = static_cast<size_t>(st.st_size);
+        auto *addr = ::mmap(nullptr, this->_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            this->_base = static_cast<const char *>(addr);
+        }
+    }
+    ::close(fd);
+#endif
+    if (this->_base == nullptr) {  // read it all instead
+        auto file = std::ifstream(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("LmiFile: cannot open " + path);
+        }
+        this->_buffer.assign(std::istreambuf_iterator<char>(file),
+                             std::istreambuf_iterator<char>());
+        this->_size = this->_buffer.size();
+        this->_base = this->_buffer.data();
+    }
+
+    auto header = std::vector<std::uint64_t>(3);
+    if (this->_size < header_size || std::memcmp(this->_base, lmi_magic, 8) != 0) {
+        this->_unmap();
+        throw std::runtime_error("LmiFile: not an LMI file: " + path);
+    }
+    std::memcpy(header.data(), this->_base + 8, 3 * sizeof(std::uint64_t));
+    this->_m = static_cast<size_t>(header[0]);
+    this->_num_mats = static_cast<size_t>(header[1]);
+    const auto table_offset = header[2];
+    if (table_offset % block_align != 0U || table_offset > this->_size
+        || this->_num_mats > (this->_size - table_offset) / (3 * sizeof(std::uint64_t))) {
+        this->_unmap();
+        throw std::runtime_error("LmiFile: truncated file: " + path);
+    }
+    this->_table = reinterpret_cast<const std::uint64_t *>(this->_base + table_offset);
+    for (auto k = 0U; k != this->_num_mats; ++k) {
+        const auto kind = this->_table[3 * k];
+        const auto offset = this->_table[3 * k + 1];
+        const auto count = this->_table[3 * k + 2];
+        const auto elem_size = kind == 0U ? sizeof(double) : 24U;
+        if (kind > 1U || offset % block_align != 0U || offset > this->_size
+            || count > (this->_size - offset) / elem_size
+            || (kind == 0U && count != this->_m * this->_m)
+            || (kind == 0U && this->_m != 0U && count / this->_m != this->_m)) {  // m * m wraps
+            this->_unmap();
+            throw std::runtime_error("LmiFile: corrupt table: " + path);
+        }
+    }
+}
+
+LmiFile::~LmiFile() { this->_unmap(); }
+
+auto LmiFile::_unmap() -> void {
+#ifdef ELL_LMI_FILE_MMAP
+    if (this->_base != nullptr && this->_buffer.empty()) {
+        ::munmap(const_cast<char *>(this->_base), this->_size);
+    }
+#endif
+    this->_base = nullptr;
+}
+
+auto LmiFile::matrix(size_t k) const -> MatrixView {
+    if (this->kind(k) != Kind::Dense) {
+        throw std::runtime_error("LmiFile: the matrix is not dense");
+    }
+    const auto *data = reinterpret_cast<const double *>(this->_base + this->_table[3 * k + 1]);
+    return MatrixView{data, this->_m};
+}
+
+auto LmiFile::matrices(size_t first, size_t last) const -> std::vector<MatrixView> {
+    auto views = std::vector<MatrixView>{};
+    views.reserve(last - first);
+    for (auto k = first; k != last; ++k) {
+        views.push_back(this->matrix(k));
+    }
+    return views;
+}
+
+auto LmiFile::sparse(size_t k) const -> SparseSym {
+    if (this->kind(k) != Kind::Sparse) {
+        throw std::runtime_error("LmiFile: the matrix is not sparse");
+    }
+    const auto *block = this->_base + this->_table[3 * k + 1];
+    const auto count = static_cast<size_t>(this->_table[3 * k + 2]);
+    auto S = SparseSym(this->_m);
+    for (auto e = 0U; e != count; ++e) {
+        std::uint64_t ij[2];
+        double val;
+        std::memcpy(ij, block + 24 * e, sizeof(ij));
+        std::memcpy(&val, block + 24 * e + 16, sizeof(val));
+        if (ij[0] >= this->_m || ij[1] >= this->_m) {
+            throw std::runtime_error("LmiFile: element out of the matrix");
+        }
+        S.add(static_cast<size_t>(ij[0]), static_cast<size_t>(ij[1]), val);
+    }
+    return S;
+}
+
+LmiFileWriter::LmiFileWriter(const std::string &path, size_t m)
+    : _file{std::fopen((path + ".tmp").c_str(), "wb")}, _path{path}, _m{m} {
+    if (this->_file == nullptr) {
+        throw std::runtime_error("LmiFileWriter: cannot create " + path + ".tmp");
+    }
+    const char zeros[header_size] = {};
+    this->_write(zeros, header_size);  // the header comes last
+}
+
+/* Not closed: an exception is on its way, so the file may be incomplete. */
+LmiFileWriter::~LmiFileWriter() {
+    if (this->_file != nullptr) {
+        std::fclose(this->_file);
+        std::remove((this->_path + ".tmp").c_str());
+    }
+}
+
+auto LmiFileWriter::add(const Matrix &M) -> void {
+    const auto offset = this->_align();
+    for (auto i = 0U; i != this->_m; ++i) {
+        for (auto j = 0U; j != this->_m; ++j) {
+            const auto val = M(i, j);
+            this->_write(&val, sizeof(val));
+        }
+    }
+    this->_table.insert(this->_table.end(), {0U, offset, this->_m * this->_m});
+}
+
+auto LmiFileWriter::add(const SparseSym &S) -> void {
+    const auto offset = this->_align();
+    for (const auto &entry : S.entries()) {
+        const std::uint64_t ij[2] = {entry.i, entry.j};
+        this->_write(ij, sizeof(ij));
+        this->_write(&entry.val, sizeof(entry.val));
+    }
+    this->_table.insert(this->_table.end(), {1U, offset, S.nnz()});
+}
+
+auto LmiFileWriter::close() -> void {
+    auto ok = true;
+    try {
+        const auto table_offset = this->_align();
+        this->_write(this->_table.data(), this->_table.size() * sizeof(std::uint64_t));
+        const std::uint64_t header[3] = {this->_m, this->_table.size() / 3, table_offset};
+        ok = std::fseek(this->_file, 0L, SEEK_SET) == 0;
+        this->_write(lmi_magic, sizeof(lmi_magic));
+        this->_write(header, sizeof(header));
+    } catch (const std::runtime_error &) {
+        ok = false;
+    }
+    ok = std::fclose(this->_file) == 0 && ok;
+    this->_file = nullptr;
+    const auto tmp = this->_path + ".tmp";
+    if (ok) {
+#ifdef _WIN32
+        ok = ::MoveFileExA(tmp.c_str(), this->_path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        ok = std::rename(tmp.c_str(), this->_path.c_str()) == 0;
+#endif
+    }
+    if (!ok) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("LmiFileWriter: write error");
+    }
+}
+
+auto LmiFileWriter::_align() -> std::uint64_t {
+    const auto pos = static_cast<std::uint64_t>(std::ftell(this->_file));
+    const auto aligned = (pos + block_align - 1) / block_align * block_align;
+    const char zeros[block_align] = {};
+    this->_write(zeros, aligned - pos);
+    return aligned;
+}
+
+auto LmiFileWriter::_write(const void *data, size_t size) -> void {
+    if (size != 0U && std::fwrite(data, 1, size, this->_file) != size) {
+        throw std::runtime_error("LmiFileWriter: write error");
+    }
+}
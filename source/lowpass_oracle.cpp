@@ -1,16 +1,23 @@
 #include <stddef.h>  // for size_t
 
-#include <cmath>                               // for pow, log10, M_PI, cos
+#include <algorithm>                           // for min, nth_element, sort, upper_bound
+#include <cmath>                               // for pow, log10, M_PI, cos, sqrt, abs
+#include <complex>                             // for complex
+#include <cstddef>                             // for ptrdiff_t
+#include <ellalgo/ell_kernel.hpp>              // for sub_combination
 #include <ellalgo/oracles/lowpass_oracle.hpp>  // for LowpassOracle, filter_...
+#include <limits>                              // for numeric_limits
+#include <stdexcept>                           // for runtime_error
 #include <tuple>                               // for tuple
 #include <type_traits>                         // for move
 #include <valarray>                            // for valarray
 #include <vector>                              // for vector, vector<>::size_...
 
 using Vec = std::valarray<double>;
-using Mat = std::valarray<Vec>;
 using ParallelCut = std::pair<Vec, Vec>;
 
+const size_t LowpassOracle::spectrum_block;
+
 #ifndef M_PI
 #    define M_PI 3.14159265358979323846264338327950288
 #endif
@@ -31,7 +38,14 @@ using ParallelCut = std::pair<Vec, Vec>;
  * design process. It is a value between 0 and 1, where 1 corresponds to the Nyquist frequency.
  */
 LowpassOracle::LowpassOracle(size_t N, double Lpsq, double Upsq, double wpass, double wstop)
-    : Lpsq{Lpsq}, Upsq{Upsq} {
+    : _m{15 * N},
+      _n{N + 1},
+      _At(_m * _n),
+      _v(_m),
+      _neg_x(_n),
+      _cols(_n),
+      Lpsq{Lpsq},
+      Upsq{Upsq} {
     // *********************************************************************
     // optimization parameters
     // *********************************************************************
@@ -44,11 +58,10 @@ LowpassOracle::LowpassOracle(size_t N, double Lpsq, double Upsq, double wpass, d
 
     // A is the matrix used to compute the power spectrum
     // A(w,:) = [1 2*cos(w) 2*cos(2*w) ... 2*cos((N-1)*w)]
-    this->A = Mat(Vec(N + 1), m);
     for (auto i = 0U; i != m; ++i) {
-        this->A[i][0] = 1.0;
+        this->_At[i] = 1.0;
         for (auto j = 1U; j != N + 1; ++j) {
-            this->A[i][j] = 2.0 * std::cos(w[i] * j);
+            this->_At[j * m + i] = 2.0 * std::cos(w[i] * j);
         }
     }
     this->nwpass = int(std::floor(wpass * double(m - 1)) + 1);
@@ -73,18 +86,22 @@ LowpassOracle::LowpassOracle(size_t N, double Lpsq, double Upsq, double wpass, d
  * boolean value.
  */
 auto LowpassOracle::assess_feas(const Vec &x, const double &Spsq) -> ParallelCut * {
-    static ParallelCut cut = std::make_pair(Vec{0.0}, Vec{0.0});
+    auto &cut = this->_cut;
 
     // this->more_alt = true;
     auto n = x.size();
-
-    auto matrix_vector = [this, &x](size_t k) {
-        double sum = 0.0;
-        for (size_t j = 0U; j != x.size(); ++j) {
-            sum += this->A[k][j] * x[j];
-        }
-        return sum;
-    };
+    this->_num_cols = std::min(n, this->_n);
+    for (auto j = 0U; j != this->_num_cols; ++j) {
+        this->_neg_x[j] = -x[j];
+    }
+    this->_lo = this->_hi = 0U;  // x is new
+    this->_block = ell_kernel::batch_block;
+    if (this->use_fft) {
+        this->_eval_fft();
+    }
+    if (this->selection != Selection::FirstViolation) {
+        return this->_assess_all(x, Spsq, cut);
+    }
 
     // case 2,
     // 2.0 passband constraints
@@ -93,38 +110,42 @@ auto LowpassOracle::assess_feas(const Vec &x, const double &Spsq) -> ParallelCut
         if (this->idx1 == this->nwpass) {
             this->idx1 = 0;  // round robin
         }
-        double v = matrix_vector(size_t(this->idx1));
+        double v = this->_spectrum(size_t(this->idx1), size_t(this->nwpass));
         if (v > this->Upsq) {
             cut.second = Vec{v - this->Upsq, v - this->Lpsq};
-            cut.first = this->A[size_t(this->idx1)];
+            this->_row(cut.first, size_t(this->idx1), 1.0);
             return &cut;
         }
         if (v < this->Lpsq) {
             cut.second = Vec{-v + this->Lpsq, -v + this->Upsq};
-            cut.first = -this->A[size_t(this->idx1)];
+            this->_row(cut.first, size_t(this->idx1), -1.0);
             return &cut;
         }
     }
 
     // case 3,
     // 3.0 stopband constraint
-    auto N = int(A.size());
+    auto N = int(this->_m);
     this->_fmax = -1e100;  // std::numeric_limits<double>::min()
     this->_kmax = -1;
-    for (int __k = this->nwstop; __k != N; ++__k) {
+    const auto scan = this->_scan_active(x, Spsq, cut);
+    if (scan == Scan::Violated) {
+        return &cut;
+    }
+    for (int __k = this->nwstop; scan == Scan::Unknown && __k != N; ++__k) {
         ++this->idx3;
         if (this->idx3 == N) {
             this->idx3 = this->nwstop;  // round robin
         }
-        double v = matrix_vector(size_t(this->idx3));
+        double v = this->_spectrum(size_t(this->idx3), this->_m);
         if (v > Spsq) {
             cut.second = Vec{v - Spsq, v};
-            cut.first = this->A[size_t(this->idx3)];
+            this->_row(cut.first, size_t(this->idx3), 1.0);
             return &cut;
         }
         if (v < 0.0) {
             cut.second = Vec{-v, -v + Spsq};
-            cut.first = -this->A[size_t(this->idx3)];
+            this->_row(cut.first, size_t(this->idx3), -1.0);
             return &cut;
         }
         if (v > this->_fmax) {
@@ -132,6 +153,9 @@ auto LowpassOracle::assess_feas(const Vec &x, const double &Spsq) -> ParallelCut
             this->_kmax = this->idx3;
         }
     }
+    if (scan == Scan::Unknown) {
+        this->_build_active(x);
+    }
 
     // case 4,
     // 1.0 nonnegative-real constraint
@@ -140,10 +164,10 @@ auto LowpassOracle::assess_feas(const Vec &x, const double &Spsq) -> ParallelCut
         if (this->idx2 == this->nwstop) {
             this->idx2 = this->nwpass;  // round robin
         }
-        double v = matrix_vector(size_t(this->idx2));
+        double v = this->_spectrum(size_t(this->idx2), size_t(this->nwstop));
         if (v < 0.0) {
             cut.second = Vec{-v};
-            cut.first = -this->A[size_t(this->idx2)];
+            this->_row(cut.first, size_t(this->idx2), -1.0);
             return &cut;
         }
     }
@@ -182,5 +206,357 @@ auto LowpassOracle::assess_optim(const Vec &x, double &Spsq) -> std::tuple<Paral
     }
     // Begin objective function
     Spsq = this->_fmax;  // output
-    return {{this->A[size_t(this->_kmax)], Vec{0.0, this->_fmax}}, true};
+    auto g = Vec(this->_n);
+    this->_row(g, size_t(this->_kmax), 1.0);
+    return {{std::move(g), Vec{0.0, this->_fmax}}, true};
+}
+
+/**
+ * Selects the cut of the largest violation, or normalized depth, over all
+ * the constraints, and finds the maximum of the stopband on the way.
+ *
+ * @param[in] x
+ * @param[in] Spsq
+ * @param[out] cut
+ * @return the cut, or nullptr if x is feasible
+ */
+auto LowpassOracle::_assess_all(const Vec &x, const double &Spsq, ParallelCut &cut)
+    -> ParallelCut * {
+    const auto by_depth = this->selection == Selection::MaxDepth;
+    if (by_depth && !this->metric) {
+        throw std::runtime_error("LowpassOracle: no metric for Selection::MaxDepth");
+    }
+    if (this->_lo != 0U || this->_hi != this->_m) {
+        this->_eval(0U, this->_m);
+    }
+    const auto nwpass = size_t(this->nwpass);
+    const auto nwstop = size_t(this->nwstop);
+    auto k_best = this->_m;
+    auto score_best = 0.0;
+    auto sign_best = 1.0;
+    auto beta_best = std::make_pair(0.0, 0.0);
+    auto parallel_best = true;
+    this->_fmax = -1e100;
+    this->_kmax = -1;
+    for (auto k = 0U; k != this->_m; ++k) {
+        const auto v = this->_v[k];
+        auto sign = 1.0;
+        auto beta = std::make_pair(0.0, 0.0);  // beta.first > 0 if violated
+        auto parallel = true;
+        if (k < nwpass) {
+            if (v > this->Upsq) {
+                beta = std::make_pair(v - this->Upsq, v - this->Lpsq);
+            } else if (v < this->Lpsq) {
+                sign = -1.0;
+                beta = std::make_pair(-v + this->Lpsq, -v + this->Upsq);
+            }
+        } else if (k >= nwstop) {
+            if (v > Spsq) {
+                beta = std::make_pair(v - Spsq, v);
+            } else if (v < 0.0) {
+                sign = -1.0;
+                beta = std::make_pair(-v, -v + Spsq);
+            } else if (v > this->_fmax) {
+                this->_fmax = v;
+                this->_kmax = int(k);
+            }
+        } else if (v < 0.0) {
+            sign = -1.0;
+            beta.first = -v;
+            parallel = false;
+        }
+        if (!(beta.first > 0.0)) {
+            continue;
+        }
+        auto score = beta.first;
+        if (by_depth) {
+            this->_row(this->_g, k, 1.0);
+            score /= std::sqrt(this->metric(this->_g));
+        }
+        if (k_best == this->_m || score > score_best) {
+            k_best = k;
+            score_best = score;
+            sign_best = sign;
+            beta_best = beta;
+            parallel_best = parallel;
+        }
+    }
+    if (k_best != this->_m) {
+        cut.second = parallel_best ? Vec{beta_best.first, beta_best.second}
+                                   : Vec{beta_best.first};
+        this->_row(cut.first, k_best, sign_best);
+        return &cut;
+    }
+    if (x[0] < 0.0) {
+        Vec g(0.0, x.size());
+        g[0] = -1.0;
+        cut.second = Vec{-x[0]};
+        cut.first = g;
+        return &cut;
+    }
+    return nullptr;
+}
+
+/**
+ * Scans the active set of the stopband instead of the whole of it, if the
+ * other frequencies are known to be neither violated nor the maximum.
+ *
+ * @param[in] x
+ * @param[in] Spsq
+ * @param[out] cut
+ * @return Scan::Violated with the cut, Scan::Feasible with `_fmax` and
+ * `_kmax`, or Scan::Unknown if the whole stopband has to be scanned
+ */
+auto LowpassOracle::_scan_active(const Vec &x, double Spsq, ParallelCut &cut) -> Scan {
+    if (this->_active.empty() || this->use_fft || this->_x_ref.size() != this->_num_cols) {
+        return Scan::Unknown;
+    }
+    // R(w) outside the active set is within margin of its value at x_ref,
+    // including the rounding errors of both evaluations
+    auto dist = 0.0;
+    auto norm = 0.0;
+    for (auto j = 0U; j != this->_num_cols; ++j) {
+        const auto weight = j == 0U ? 1.0 : 2.0;
+        dist += weight * std::abs(x[j] - this->_x_ref[j]);
+        norm += weight * std::abs(x[j]);
+    }
+    const auto eps = 2.0 * double(this->_num_cols) * std::numeric_limits<double>::epsilon();
+    const auto margin = dist + eps * (dist + norm + this->_ref_norm);
+    if (!(this->_ref_lo - margin >= 0.0 && this->_ref_hi + margin <= Spsq)) {
+        return Scan::Unknown;
+    }
+
+    const auto num_active = this->_active.size();
+    auto &v_active = this->_active_v;
+    for (auto i = 0U; i != num_active; ++i) {
+        v_active[i] = 0.0;
+    }
+    for (auto j = 0U; j != this->_num_cols; ++j) {
+        this->_cols[j] = &this->_active_At[j * num_active];
+    }
+    ell_kernel::sub_combination(&v_active[0], this->_cols.data(), &this->_neg_x[0],
+                                this->_num_cols, num_active);
+
+    // in the round-robin order of the full scan, which starts after idx3
+    const auto start = size_t(
+        std::upper_bound(this->_active.begin(), this->_active.end(), size_t(this->idx3))
+        - this->_active.begin());
+    auto fmax = -1e100;
+    auto kmax = -1;
+    for (auto t = 0U; t != num_active; ++t) {
+        const auto i = (start + t) % num_active;
+        const auto k = this->_active[i];
+        const auto v = v_active[i];
+        if (v > Spsq) {
+            this->idx3 = int(k);
+            cut.second = Vec{v - Spsq, v};
+            this->_row(cut.first, k, 1.0);
+            return Scan::Violated;
+        }
+        if (v < 0.0) {
+            this->idx3 = int(k);
+            cut.second = Vec{-v, -v + Spsq};
+            this->_row(cut.first, k, -1.0);
+            return Scan::Violated;
+        }
+        if (v > fmax) {
+            fmax = v;
+            kmax = int(k);
+        }
+    }
+    if (!(fmax > this->_ref_hi + margin)) {  // the maximum may be outside
+        return Scan::Unknown;
+    }
+    this->_fmax = fmax;
+    this->_kmax = kmax;
+    return Scan::Feasible;
+}
+
+/**
+ * Rebuilds the active set from the spectrum of a full scan of the stopband.
+ *
+ * @param[in] x
+ */
+auto LowpassOracle::_build_active(const Vec &x) -> void {
+    this->_active.clear();
+    const auto first = size_t(this->nwstop);
+    const auto size = this->_m - first;
+    const auto num_end = std::min(this->stopband_active, size / 2);
+    if (num_end == 0U || this->use_fft) {
+        return;
+    }
+    auto &order = this->_order;
+    order.resize(size);
+    for (auto i = 0U; i != size; ++i) {
+        order[i] = first + i;
+    }
+    const auto by_value = [this](size_t a, size_t b) { return this->_v[a] < this->_v[b]; };
+    const auto top = order.end() - std::ptrdiff_t(num_end);
+    std::nth_element(order.begin(), order.begin() + std::ptrdiff_t(num_end), order.end(),
+                     by_value);
+    std::nth_element(order.begin() + std::ptrdiff_t(num_end), top, order.end(), by_value);
+    this->_ref_lo = std::numeric_limits<double>::infinity();
+    this->_ref_hi = -std::numeric_limits<double>::infinity();
+    for (auto it = order.begin() + std::ptrdiff_t(num_end); it != top; ++it) {
+        this->_ref_lo = std::min(this->_ref_lo, this->_v[*it]);
+        this->_ref_hi = std::max(this->_ref_hi, this->_v[*it]);
+    }
+    this->_active.assign(order.begin(), order.begin() + std::ptrdiff_t(num_end));
+    this->_active.insert(this->_active.end(), top, order.end());
+    std::sort(this->_active.begin(), this->_active.end());
+
+    const auto num_active = this->_active.size();
+    this->_active_At.resize(num_active * this->_num_cols);
+    for (auto j = 0U; j != this->_num_cols; ++j) {
+        for (auto i = 0U; i != num_active; ++i) {
+            this->_active_At[j * num_active + i] = this->_At[j * this->_m + this->_active[i]];
+        }
+    }
+    this->_active_v.resize(num_active);
+    this->_x_ref.resize(this->_num_cols);
+    this->_ref_norm = 0.0;
+    for (auto j = 0U; j != this->_num_cols; ++j) {
+        this->_x_ref[j] = x[j];
+        this->_ref_norm += (j == 0U ? 1.0 : 2.0) * std::abs(x[j]);
+    }
+}
+
+/**
+ * Evaluates (A * x)(k) for k in [first, last), with the columns of A as
+ * the vectors of `sub_combination`: 0 - A(k, 0) * (-x[0]) - ... is, bit
+ * for bit, the plain inner product A(k, 0) * x[0] + ....
+ *
+ * @param[in] first
+ * @param[in] last
+ */
+auto LowpassOracle::_eval(size_t first, size_t last) -> void {
+    for (auto k = first; k != last; ++k) {
+        this->_v[k] = 0.0;
+    }
+    for (auto j = 0U; j != this->_num_cols; ++j) {
+        this->_cols[j] = &this->_At[j * this->_m + first];
+    }
+    ell_kernel::sub_combination(&this->_v[first], this->_cols.data(), &this->_neg_x[0],
+                                this->_num_cols, last - first);
+    this->_lo = first;
+    this->_hi = last;
+}
+
+using Complex = std::complex<double>;
+
+/** a * b, without the checks for infinities of std::complex */
+static inline auto mul(const Complex &a, const Complex &b) -> Complex {
+    return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+}
+
+/**
+ * @brief In-place radix-2 FFT, the sum of a[t] e^{-/+2 pi i s t / L}
+ *
+ * @param[in,out] a of size L, a power of two
+ * @param[in] twiddle e^{-2 pi i t / L}, t < L / 2
+ * @param[in] inverse the sign + of the exponent instead, without the scaling by 1 / L
+ */
+static auto fft(std::vector<Complex> &a, const std::vector<Complex> &twiddle, bool inverse)
+    -> void {
+    const auto L = a.size();
+    for (auto i = size_t(1), j = size_t(0); i != L; ++i) {  // bit reversal
+        auto bit = L >> 1U;
+        for (; (j & bit) != 0U; bit >>= 1U) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    for (auto len = size_t(2); len <= L; len <<= 1U) {
+        const auto half = len / 2;
+        const auto step = L / len;
+        for (auto i = size_t(0); i != L; i += len) {
+            for (auto k = size_t(0); k != half; ++k) {
+                const auto &w = twiddle[k * step];
+                const auto v = mul(a[i + k + half], inverse ? std::conj(w) : w);
+                a[i + k + half] = a[i + k] - v;
+                a[i + k] += v;
+            }
+        }
+    }
+}
+
+/**
+ * Sets up the chirp-z transform of `_eval_fft` for x of size `_num_cols`.
+ */
+auto LowpassOracle::_init_fft() -> void {
+    const auto m = this->_m;
+    const auto n = this->_num_cols;
+    auto L = size_t(1);
+    while (L < m + n - 1) {
+        L <<= 1U;
+    }
+    const auto P = 2 * (m - 1);
+    this->_chirp.resize(m);
+    for (auto t = size_t(0); t != m; ++t) {
+        const auto t2 = (t * t) % (2 * P);  // exact, for the accuracy of the angle
+        this->_chirp[t] = std::polar(1.0, -M_PI * double(t2) / double(P));
+    }
+    this->_twiddle.resize(L / 2);
+    for (auto t = size_t(0); t != L / 2; ++t) {
+        this->_twiddle[t] = std::polar(1.0, -2.0 * M_PI * double(t) / double(L));
+    }
+    // the conjugate chirp at t in (-n, m), circularly, scaled for the inverse FFT
+    this->_kernel.assign(L, Complex{});
+    for (auto t = size_t(0); t != m; ++t) {
+        this->_kernel[t] = std::conj(this->_chirp[t]) / double(L);
+    }
+    for (auto t = size_t(1); t < n; ++t) {
+        this->_kernel[L - t] = std::conj(this->_chirp[t]) / double(L);
+    }
+    fft(this->_kernel, this->_twiddle, false);
+    this->_work.resize(L);
+}
+
+/**
+ * Evaluates (A * x)(k) for all the frequencies w_k = pi k / (m - 1), as
+ * the real part of the DFT X_k of c = (x[0], 2 x[1], ...) of size
+ * P = 2 (m - 1), by Bluestein's chirp-z transform: with jk = (j^2 + k^2 -
+ * (k - j)^2) / 2, X_k = chirp(k) * sum_j c_j chirp(j) conj(chirp(k - j)),
+ * a convolution done by FFTs of size L.
+ */
+auto LowpassOracle::_eval_fft() -> void {
+    const auto n = this->_num_cols;
+    if (this->_fft_cols != n) {
+        this->_fft_cols = n;
+        this->_init_fft();
+    }
+    auto &a = this->_work;
+    std::fill(a.begin(), a.end(), Complex{});
+    for (auto j = 0U; j != n; ++j) {
+        a[j] = this->_chirp[j] * (j == 0U ? -this->_neg_x[0] : -2.0 * this->_neg_x[j]);
+    }
+    fft(a, this->_twiddle, false);
+    for (auto t = size_t(0); t != a.size(); ++t) {
+        a[t] = mul(a[t], this->_kernel[t]);
+    }
+    fft(a, this->_twiddle, true);
+    for (auto k = 0U; k != this->_m; ++k) {
+        this->_v[k] = mul(this->_chirp[k], a[k]).real();
+    }
+    this->_lo = 0U;
+    this->_hi = this->_m;
+}
+
+/**
+ * @brief g = sign * A(k, :)
+ *
+ * @param[out] g
+ * @param[in] k
+ * @param[in] sign 1 or -1
+ */
+auto LowpassOracle::_row(Vec &g, size_t k, double sign) const -> void {
+    if (g.size() != this->_n) {
+        g.resize(this->_n);
+    }
+    for (auto j = 0U; j != this->_n; ++j) {
+        g[j] = sign * this->_At[j * this->_m + k];
+    }
 }
@@ -0,0 +1,102 @@
+#include <algorithm>                     // for min, max
+#include <atomic>                        // for atomic
+#include <condition_variable>            // for condition_variable
+#include <ellalgo/parallel_driver.hpp>  // for parallel_run, BackgroundWorker
+#include <exception>                     // for exception_ptr, current_exception
+#include <functional>                    // for function
+#include <mutex>                         // for mutex, unique_lock
+#include <thread>                        // for thread
+#include <utility>                       // for move
+#include <vector>                        // for vector
+
+auto parallel_run(size_t num_jobs, const std::function<void(size_t)> &fn, size_t num_threads)
+    -> void {
+    if (num_threads == 0U) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    num_threads = std::min(num_threads, num_jobs);
+    if (num_threads <= 1U) {
+        for (auto idx = size_t(0U); idx != num_jobs; ++idx) {
+            fn(idx);  // no thread needed
+        }
+        return;
+    }
+    std::atomic<size_t> next{0U};
+    std::mutex error_mutex;
+    std::exception_ptr error;  //!< the first exception of fn, if any
+    auto worker = [&]() {
+        for (auto idx = next.fetch_add(1U); idx < num_jobs; idx = next.fetch_add(1U)) {
+            try {
+                fn(idx);
+            } catch (...) {
+                auto lock = std::unique_lock<std::mutex>(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next.store(num_jobs);  // no more jobs handed out
+            }
+        }
+    };
+    auto threads = std::vector<std::thread>{};
+    threads.reserve(num_threads - 1U);
+    for (auto i = 1U; i != num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();  // the calling thread is one of the workers
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+struct BackgroundWorker::Impl {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::function<void()> task;  //!< the posted task, empty once it is done
+    bool stop = false;
+    std::thread thread;
+
+    void loop() {
+        auto lock = std::unique_lock<std::mutex>(this->mutex);
+        for (;;) {
+            this->cond.wait(lock, [this]() { return this->stop || this->task; });
+            if (!this->task) {
+                return;  // stopped
+            }
+            lock.unlock();
+            this->task();
+            lock.lock();
+            this->task = nullptr;
+            this->cond.notify_all();
+        }
+    }
+};
+
+BackgroundWorker::BackgroundWorker() : _impl{new Impl{}} {
+    this->_impl->thread = std::thread([this]() { this->_impl->loop(); });
+}
+
+BackgroundWorker::~BackgroundWorker() {
+    this->wait();
+    {
+        auto lock = std::unique_lock<std::mutex>(this->_impl->mutex);
+        this->_impl->stop = true;
+    }
+    this->_impl->cond.notify_all();
+    this->_impl->thread.join();
+}
+
+void BackgroundWorker::post(std::function<void()> task) {
+    {
+        auto lock = std::unique_lock<std::mutex>(this->_impl->mutex);
+        this->_impl->task = std::move(task);
+    }
+    this->_impl->cond.notify_all();
+}
+
+void BackgroundWorker::wait() {
+    auto lock = std::unique_lock<std::mutex>(this->_impl->mutex);
+    this->_impl->cond.wait(lock, [this]() { return !this->_impl->task; });
+}
@@ -2,6 +2,15 @@
 
 using Vec = std::valarray<double>;
 using Cut = std::pair<Vec, double>;
+using Mask = std::valarray<bool>;
+
+auto ProfitOracle::terms(const Vec &y) const -> Terms {
+    const auto x0 = std::exp(y[0]);
+    const auto x1 = std::exp(y[1]);
+    return Terms{{x0, x1},
+                 this->_log_pA + this->_elasticities[0] * y[0] + this->_elasticities[1] * y[1],
+                 this->_price_out[0] * x0 + this->_price_out[1] * x1};
+}
 
 /**
  * The function assess_feas assesses the feasibility of a given solution based on certain conditions
@@ -10,6 +19,7 @@ using Cut = std::pair<Vec, double>;
  * @param[in] y The parameter `y` is a vector of values. It is used to calculate various values in
  * the function. The specific meaning of each element in the vector depends on the context and the
  * specific implementation of the `ProfitOracle` class.
+ * @param[in] terms The terms at y, see `terms`.
  * @param[in,out] gamma The `gamma` parameter is a reference to a `double` variable. It is used to
  * store the best-so-far value for the feasibility process. The function `assess_feas` assesses
  * the feasibility of a given solution and updates the `gamma` value if necessary.
@@ -18,11 +28,7 @@ using Cut = std::pair<Vec, double>;
  * of type `Cut`, which is a struct or class that contains a vector `g` and a double `fj`. The
  * second element is of type `bool`.
  */
-auto ProfitOracle::assess_feas(const Vec &y, const double &gamma) -> Cut * {
-    static auto cut1 = Cut{Vec{1.0, 0.0}, 0.0};
-    static auto cut2 = Cut{Vec{-1.0, 1.0}, 0.0};
-
-    const Vec x = std::exp(y);
+auto ProfitOracle::assess_feas(const Vec &y, const Terms &terms, const double &gamma) -> Cut * {
     auto te = 0.0;
 
     for (int i = 0; i < 2; i++) {
@@ -36,11 +42,8 @@ auto ProfitOracle::assess_feas(const Vec &y, const double &gamma) -> Cut * {
                 fj = y[0] - this->_log_k;
                 break;
             case 1:
-                this->_log_Cobb
-                    = this->_log_pA + this->_elasticities[0] * y[0] + this->_elasticities[1] * y[1];
-                this->_vx = this->_price_out[0] * x[0] + this->_price_out[1] * x[1];
-                te = gamma + this->_vx;
-                fj = std::log(te) - this->_log_Cobb;
+                te = gamma + terms.vx;
+                fj = std::log(te) - terms.log_Cobb;
                 break;
             default:
                 exit(0);
@@ -48,12 +51,15 @@ auto ProfitOracle::assess_feas(const Vec &y, const double &gamma) -> Cut * {
         if (fj > 0.0) {
             switch (this->idx) {
                 case 0:
-                    cut1.second = fj;
-                    return &cut1;
+                    this->_cut1.second = fj;
+                    return &this->_cut1;
                 case 1:
-                    cut2.first = (this->_price_out * x) / te - this->_elasticities;
-                    cut2.second = fj;
-                    return &cut2;
+                    for (auto j = 0U; j != 2U; ++j) {
+                        this->_cut2.first[j]
+                            = (this->_price_out[j] * terms.x[j]) / te - this->_elasticities[j];
+                    }
+                    this->_cut2.second = fj;
+                    return &this->_cut2;
                 default:
                     exit(0);
             }
@@ -79,16 +85,41 @@ auto ProfitOracle::assess_feas(const Vec &y, const double &gamma) -> Cut * {
  * second element is of type `bool`.
  */
 auto ProfitOracle::assess_optim(const Vec &y, double &gamma) -> std::tuple<Cut, bool> {
-    auto cut = this->assess_feas(y, gamma);
+    auto cut = Cut{Vec(y.size()), 0.0};
+    const auto shrunk = this->assess_optim(y, gamma, make_span(cut.first), cut.second);
+    return {std::move(cut), shrunk};
+}
+
+/**
+ * The function assess_optim assesses the optimality of a given solution, like the function above,
+ * but writes the cut into the buffer `grad` (e.g. the one of the search space) instead.
+ *
+ * @param[in] y The input quantity (in log scale).
+ * @param[in] terms The terms at y, see `terms`.
+ * @param[in,out] gamma The best-so-far optimal value.
+ * @param[out] grad The gradient of the cut.
+ * @param[out] beta The beta of the cut.
+ *
+ * @return The function returns true if `gamma` was shrunk.
+ */
+auto ProfitOracle::assess_optim(const Vec &y, const Terms &terms, double &gamma,
+                                Span<double> grad, double &beta) -> bool {
+    const auto cut = this->assess_feas(y, terms, gamma);
     if (cut) {
-        return {*cut, false};
+        for (auto i = 0U; i != grad.size(); ++i) {
+            grad[i] = cut->first[i];
+        }
+        beta = cut->second;
+        return false;
     }
 
-    const Vec x = std::exp(y);
-    auto te = std::exp(this->_log_Cobb);
-    gamma = te - this->_vx;
-    Vec grad = (this->_price_out * x) / te - this->_elasticities;
-    return {{std::move(grad), 0.0}, true};
+    const auto te = std::exp(terms.log_Cobb);
+    gamma = te - terms.vx;
+    for (auto i = 0U; i != grad.size(); ++i) {
+        grad[i] = (this->_price_out[i] * terms.x[i]) / te - this->_elasticities[i];
+    }
+    beta = 0.0;
+    return true;
 }
 
 /**
@@ -105,28 +136,183 @@ auto ProfitOracle::assess_optim(const Vec &y, double &gamma) -> std::tuple<Cut,
  */
 auto ProfitOracleQ::assess_optim_q(const Vec &y, double &gamma, bool retry)
     -> std::tuple<Cut, bool, Vec, bool> {
-    if (!retry) {
-        auto cut = this->_P.assess_feas(y, gamma);
-        if (cut) {
-            return {*cut, false, y, true};
+    auto cut = Cut{Vec(y.size()), 0.0};
+    if (!retry && this->_cut_or_round(y, gamma, make_span(cut.first), cut.second)) {
+        return {std::move(cut), false, y, true};
+    }
+    const auto shrunk = this->_assess_discrete(y, gamma, make_span(cut.first), cut.second);
+    return {std::move(cut), shrunk, this->_yd, !retry};
+}
+
+auto ProfitOracleQ::assess_optim_q(const Vec &y, double &gamma, bool retry, Span<double> grad,
+                                   double &beta, bool &more_alt) -> const Vec * {
+    more_alt = !retry;
+    if (!retry && this->_cut_or_round(y, gamma, grad, beta)) {
+        return nullptr;
+    }
+    return this->_assess_discrete(y, gamma, grad, beta) ? &this->_yd : nullptr;
+}
+
+auto ProfitOracleQ::_cut_or_round(const Vec &y, double &gamma, Span<double> grad, double &beta)
+    -> bool {
+    const auto terms = this->_P.terms(y);
+    const auto *cut = this->_P.assess_feas(y, terms, gamma);
+    if (cut) {
+        for (auto i = 0U; i != grad.size(); ++i) {
+            grad[i] = cut->first[i];
         }
+        beta = cut->second;
+        return true;
+    }
 
-        Vec x = std::exp(y);
-        x = x.apply([](double n) { return std::round(n); });
-        if (x[0] == 0.0) {
-            x[0] = 1.0;  // nearest integer than 0
+    auto x = Point{std::round(terms.x[0]), std::round(terms.x[1])};
+    if (x[0] == 0.0) {
+        x[0] = 1.0;  // nearest integer than 0
+    }
+    if (x[1] == 0.0) {
+        x[1] = 1.0;
+    }
+    if (this->use_cache) {
+        const auto it = this->_cache.find(x);
+        if (it != this->_cache.end()) {
+            ++this->_num_hits;
+            this->_yd[0] = it->second.yd[0];
+            this->_yd[1] = it->second.yd[1];
+            this->_terms_d = it->second.terms;
+            return false;
         }
-        if (x[1] == 0.0) {
-            x[1] = 1.0;
+    }
+    this->_yd[0] = std::log(x[0]);
+    this->_yd[1] = std::log(x[1]);
+    this->_terms_d = this->_P.terms(this->_yd);
+    if (this->use_cache) {
+        if (this->_cache.size() >= this->max_cached) {
+            this->_cache.clear();  // bounded, and cheaper than evicting one by one
         }
-        this->_yd = std::log(x);
-    }
-    auto result1 = this->_P.assess_optim(this->_yd, gamma);
-    auto &cut = std::get<0>(result1);
-    auto &shrunk = std::get<1>(result1);
-    auto &grad = std::get<0>(cut);
-    auto &beta = std::get<1>(cut);
-    auto diff = this->_yd - y;
-    beta += grad[0] * diff[0] + grad[1] * diff[1];
-    return {std::move(cut), shrunk, this->_yd, !retry};
+        this->_cache.emplace(x, Entry{{this->_yd[0], this->_yd[1]}, this->_terms_d});
+    }
+    return false;
+}
+
+auto ProfitOracleQ::_assess_discrete(const Vec &y, double &gamma, Span<double> grad, double &beta)
+    -> bool {
+    const auto shrunk = this->_P.assess_optim(this->_yd, this->_terms_d, gamma, grad, beta);
+    beta += grad[0] * (this->_yd[0] - y[0]) + grad[1] * (this->_yd[1] - y[1]);
+    return shrunk;
+}
+
+/**
+ * @brief The parameters of size 2K in the layout of `EllBatch`, zero in the padding lanes
+ */
+static auto to_lanes(const Vec &par, size_t num, size_t stride) -> Vec {
+    auto res = Vec(0.0, 2 * stride);
+    for (auto k = 0U; k != num; ++k) {
+        res[k] = par[k];
+        res[stride + k] = par[num + k];
+    }
+    return res;
+}
+
+ProfitOracleBatch::ProfitOracleBatch(const Vec &p, const Vec &A, const Vec &k, const Vec &a,
+                                     const Vec &v, size_t stride)
+    : _num{p.size()},
+      _stride{stride},
+      _log_pA(_num),
+      _log_k(_num),
+      _price_out{to_lanes(v, _num, stride)},
+      _elasticities{to_lanes(a, _num, stride)},
+      _idx(_num, -1),
+      _x(0.0, 2 * stride),
+      _log_Cobb(_num),
+      _vx(_num),
+      _te(_num),
+      _f_Cobb(_num) {
+    for (auto j = 0U; j != this->_num; ++j) {
+        this->_log_pA[j] = std::log(p[j] * A[j]);
+        this->_log_k[j] = std::log(k[j]);
+    }
+}
+
+/**
+ * @brief [e3, e3], for v1 and v2
+ */
+static auto twice(const Vec &e3) -> Vec {
+    auto res = Vec(2 * e3.size());
+    res[std::slice(0, e3.size(), 1)] = e3;
+    res[std::slice(e3.size(), e3.size(), 1)] = e3;
+    return res;
+}
+
+/* As ProfitOracleRb, the scenario k is that of ProfitOracle(p - e3, A, k - e3, a, v + e3), with
+the elasticities of the worst case at y. */
+ProfitOracleBatch::ProfitOracleBatch(const Vec &p, const Vec &A, const Vec &k, const Vec &a,
+                                     const Vec &v, const Vec &e, const Vec &e3, size_t stride)
+    : ProfitOracleBatch{p - e3, A, k - e3, a, v + twice(e3), stride} {
+    this->_uie = to_lanes(e, this->_num, stride);
+    this->_a = this->_elasticities;
+}
+
+/* The round robin of ProfitOracle::assess_feas, lane by lane: the constraint after the last one
+that was violated is checked first. */
+void ProfitOracleBatch::assess_optim_batch(const Vec &xc, Vec &gamma, const Mask &active, Vec &grad,
+                                           Vec &beta, Mask &shrunk) {
+    const auto S = this->_stride;
+    const auto robust = this->_uie.size() != 0U;
+    const auto *y0 = &xc[0];
+    const auto *y1 = &xc[S];
+    auto *x0 = &this->_x[0];
+    auto *x1 = &this->_x[S];
+    const auto *v0 = &this->_price_out[0];
+    const auto *v1 = &this->_price_out[S];
+    const auto *a0 = robust ? &this->_a[0] : &this->_elasticities[0];
+    const auto *a1 = robust ? &this->_a[S] : &this->_elasticities[S];
+    for (auto k = 0U; k != this->_num; ++k) {
+        x0[k] = std::exp(y0[k]);
+        x1[k] = std::exp(y1[k]);
+    }
+    if (robust) {
+        for (auto k = 0U; k != this->_num; ++k) {
+            this->_a[k] = this->_elasticities[k] + (y0[k] > 0.0 ? -this->_uie[k] : this->_uie[k]);
+            this->_a[S + k] = this->_elasticities[S + k]
+                              + (y1[k] > 0.0 ? -this->_uie[S + k] : this->_uie[S + k]);
+        }
+    }
+    for (auto k = 0U; k != this->_num; ++k) {
+        this->_log_Cobb[k] = this->_log_pA[k] + a0[k] * y0[k] + a1[k] * y1[k];
+        this->_vx[k] = v0[k] * x0[k] + v1[k] * x1[k];
+        this->_te[k] = gamma[k] + this->_vx[k];
+    }
+    for (auto k = 0U; k != this->_num; ++k) {
+        this->_f_Cobb[k] = std::log(this->_te[k]) - this->_log_Cobb[k];
+    }
+
+    for (auto k = 0U; k != this->_num; ++k) {
+        if (!active[k]) {
+            continue;
+        }
+        const auto f_limit = y0[k] - this->_log_k[k];
+        const auto first = this->_idx[k] == 0 ? 1 : 0;
+        const auto f_first = first == 0 ? f_limit : this->_f_Cobb[k];
+        const auto f_second = first == 0 ? this->_f_Cobb[k] : f_limit;
+        const auto violated = f_first > 0.0 ? first : f_second > 0.0 ? 1 - first : -1;
+        this->_idx[k] = violated == first ? first : 1 - first;
+        shrunk[k] = false;
+        if (violated == 0) {  // y0 <= log k
+            grad[k] = 1.0;
+            grad[S + k] = 0.0;
+            beta[k] = f_limit;
+            continue;
+        }
+        auto te = this->_te[k];
+        if (violated == 1) {
+            beta[k] = this->_f_Cobb[k];
+        } else {
+            te = std::exp(this->_log_Cobb[k]);
+            gamma[k] = te - this->_vx[k];
+            beta[k] = 0.0;
+            shrunk[k] = true;
+        }
+        grad[k] = (v0[k] * x0[k]) / te - a0[k];
+        grad[S + k] = (v1[k] * x1[k]) / te - a1[k];
+    }
 }
@@ -0,0 +1,185 @@
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, CHECK, TestCase
+
+#include <cmath>                              // for sin, log
+#include <ellalgo/cutting_plane.hpp>          // for cutting_plane_optim
+#include <ellalgo/ell.hpp>                    // for Ell
+#include <ellalgo/ell_batch.hpp>              // for EllBatch, cutting_plane_optim_batch
+#include <ellalgo/oracles/profit_oracle.hpp>  // for ProfitOracle, ProfitOracleBatch
+#include <memory>                             // for unique_ptr
+#include <tuple>                              // for get
+#include <valarray>                           // for valarray
+#include <vector>                             // for vector
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief K profit oracles with different limits, assessed one after another
+ */
+class ProfitBatch {
+    std::vector<std::unique_ptr<ProfitOracle>> _oracles;
+    const size_t _stride;
+    Vec _y;
+    Vec _g;
+
+  public:
+    ProfitBatch(const std::vector<double> &limits, size_t stride) : _stride{stride}, _y(2), _g(2) {
+        for (const auto limit : limits) {
+            this->_oracles.emplace_back(new ProfitOracle{20.0, 40.0, limit, Vec{0.1, 0.4},
+                                                         Vec{10.0, 35.0}});
+        }
+    }
+
+    void assess_optim_batch(const Vec &xc, Vec &gamma, const EllBatch::Mask &active, Vec &grad,
+                            Vec &beta, EllBatch::Mask &shrunk) {
+        for (auto k = 0U; k != this->_oracles.size(); ++k) {
+            if (!active[k]) {
+                continue;
+            }
+            for (auto i = 0U; i != 2U; ++i) {
+                this->_y[i] = xc[i * this->_stride + k];
+            }
+            shrunk[k] = this->_oracles[k]->assess_optim(this->_y, gamma[k], make_span(this->_g),
+                                                        beta[k]);
+            for (auto i = 0U; i != 2U; ++i) {
+                grad[i * this->_stride + k] = this->_g[i];
+            }
+        }
+    }
+};
+
+TEST_CASE("EllBatch: same cuts as Ell, bit for bit") {
+    const auto ndim = 5U;
+    const auto num = 10U;  // two lane blocks, the second one partly padding
+    auto batch = EllBatch(10.0, Vec(0.0, ndim), num);
+    auto ells = std::vector<Ell<Vec>>{};
+    for (auto k = 0U; k != num; ++k) {
+        ells.emplace_back(10.0, Vec(0.0, ndim));
+    }
+    const auto S = batch.stride();
+    auto grad = Vec(0.0, ndim * S);
+    auto beta = Vec(0.0, S);
+    auto status = std::vector<CutStatus>(num);
+    for (auto it = 0U; it != 30U; ++it) {
+        if (it == 10U) {
+            batch.deactivate(3U);
+        }
+        for (auto k = 0U; k != num; ++k) {
+            auto g = Vec(ndim);
+            for (auto i = 0U; i != ndim; ++i) {
+                g[i] = std::sin(1.0 + 0.7 * it + 1.3 * i + 0.1 * k);
+                grad[i * S + k] = g[i];
+            }
+            beta[k] = 0.01 * k;
+            if (batch.active()[k]) {
+                status[k] = ells[k].update_bias_cut(std::make_pair(g, beta[k]));
+            }
+        }
+        batch.update_bias_cut(grad, beta);
+        for (auto k = 0U; k != num; ++k) {
+            if (batch.active()[k]) {
+                CHECK_EQ(batch.status()[k], status[k]);
+                CHECK_EQ(batch.tsq()[k], ells[k].tsq());
+            }
+        }
+    }
+    CHECK_EQ(batch.num_active(), num - 1);
+    for (auto k = 0U; k != num; ++k) {
+        const auto x1 = batch.xc(k);
+        const auto x2 = ells[k].xc();
+        for (auto i = 0U; i != ndim; ++i) {
+            CHECK_EQ(x1[i], x2[i]);
+        }
+    }
+}
+
+TEST_CASE("cutting_plane_optim_batch: profit problems in lockstep") {
+    const auto limits = std::vector<double>{30.5, 20.0, 40.0, 10.0, 25.0};
+    auto space = EllBatch(Vec{100.0, 100.0}, Vec{0.0, 0.0}, limits.size());
+    auto omega = ProfitBatch(limits, space.stride());
+    auto gamma = Vec(0.0, space.stride());
+    const auto result = cutting_plane_optim_batch(omega, space, gamma);
+    const auto &x_best = std::get<0>(result);
+    const auto &num_iters = std::get<1>(result);
+    CHECK_EQ(num_iters[0], 83U);  // as in test_profit.cpp
+    CHECK_EQ(space.num_active(), 0U);
+
+    for (auto k = 0U; k != limits.size(); ++k) {
+        Ell<Vec> ellip{Vec{100.0, 100.0}, Vec{0.0, 0.0}};
+        ProfitOracle P{20.0, 40.0, limits[k], Vec{0.1, 0.4}, Vec{10.0, 35.0}};
+        auto gamma_k = 0.0;
+        const auto result_k = cutting_plane_optim(P, ellip, gamma_k);
+        const auto &y = std::get<0>(result_k);
+        REQUIRE_EQ(y.size(), 2U);
+        CHECK(y[0] <= std::log(limits[k]));
+        CHECK_EQ(num_iters[k], std::get<1>(result_k));
+        CHECK_EQ(gamma[k], gamma_k);
+        CHECK_EQ(x_best[k], y[0]);
+        CHECK_EQ(x_best[space.stride() + k], y[1]);
+    }
+}
+
+/**
+ * @brief Scenario j of the tests below, of ProfitOracle(p[j], A[j], k[j], a(j), v(j))
+ */
+struct ProfitScenarios {
+    Vec p{20.0, 21.0, 19.5, 20.0, 22.0, 18.0, 20.5};
+    Vec A{40.0, 40.0, 38.0, 42.0, 40.0, 41.0, 39.0};
+    Vec k{30.5, 20.0, 40.0, 10.0, 25.0, 30.5, 35.0};
+    Vec a{0.1, 0.12, 0.09, 0.1, 0.11, 0.1, 0.08, 0.4, 0.38, 0.41, 0.4, 0.36, 0.42, 0.4};
+    Vec v{10.0, 11.0, 9.0, 10.0, 10.5, 9.5, 10.0, 35.0, 34.0, 36.0, 35.0, 33.0, 35.0, 37.0};
+
+    auto size() const -> size_t { return this->p.size(); }
+    auto a_of(size_t j) const -> Vec { return Vec{this->a[j], this->a[this->size() + j]}; }
+    auto v_of(size_t j) const -> Vec { return Vec{this->v[j], this->v[this->size() + j]}; }
+};
+
+template <typename Oracle>
+static auto check_as_scalar(const ProfitScenarios &sc, EllBatch &space, const Vec &gamma,
+                            const std::vector<size_t> &num_iters, const Vec &x_best,
+                            Oracle &&make_oracle) -> void {
+    for (auto j = 0U; j != sc.size(); ++j) {
+        Ell<Vec> ellip{Vec{100.0, 100.0}, Vec{0.0, 0.0}};
+        auto P = make_oracle(j);
+        auto gamma_j = 0.0;
+        const auto result_j = cutting_plane_optim(*P, ellip, gamma_j);
+        const auto &y = std::get<0>(result_j);
+        REQUIRE_EQ(y.size(), 2U);
+        CHECK_EQ(num_iters[j], std::get<1>(result_j));
+        CHECK_EQ(gamma[j], gamma_j);
+        CHECK_EQ(x_best[j], y[0]);
+        CHECK_EQ(x_best[space.stride() + j], y[1]);
+    }
+}
+
+TEST_CASE("ProfitOracleBatch: scenarios as ProfitOracle, bit for bit") {
+    const auto sc = ProfitScenarios{};
+    auto space = EllBatch(Vec{100.0, 100.0}, Vec{0.0, 0.0}, sc.size());
+    auto omega = ProfitOracleBatch(sc.p, sc.A, sc.k, sc.a, sc.v, space.stride());
+    CHECK_EQ(omega.size(), sc.size());
+    auto gamma = Vec(0.0, space.stride());
+    const auto result = cutting_plane_optim_batch(omega, space, gamma);
+    CHECK_EQ(std::get<1>(result)[0], 83U);  // as in test_profit.cpp
+    CHECK_EQ(space.num_active(), 0U);
+    check_as_scalar(sc, space, gamma, std::get<1>(result), std::get<0>(result), [&](size_t j) {
+        return std::unique_ptr<ProfitOracle>(
+            new ProfitOracle{sc.p[j], sc.A[j], sc.k[j], sc.a_of(j), sc.v_of(j)});
+    });
+}
+
+TEST_CASE("ProfitOracleBatch: scenarios as ProfitOracleRb, bit for bit") {
+    const auto sc = ProfitScenarios{};
+    const auto e = Vec{0.003, 0.002, 0.004, 0.003, 0.001, 0.003, 0.005,
+                       0.007, 0.006, 0.008, 0.007, 0.005, 0.007, 0.009};
+    const auto e3 = Vec{1.0, 0.5, 1.5, 1.0, 0.0, 2.0, 1.0};
+    auto space = EllBatch(Vec{100.0, 100.0}, Vec{0.0, 0.0}, sc.size());
+    auto omega = ProfitOracleBatch(sc.p, sc.A, sc.k, sc.a, sc.v, e, e3, space.stride());
+    auto gamma = Vec(0.0, space.stride());
+    const auto result = cutting_plane_optim_batch(omega, space, gamma);
+    CHECK_EQ(std::get<1>(result)[0], 90U);  // as in test_profit.cpp
+    check_as_scalar(sc, space, gamma, std::get<1>(result), std::get<0>(result), [&](size_t j) {
+        return std::unique_ptr<ProfitOracleRb>(
+            new ProfitOracleRb{sc.p[j], sc.A[j], sc.k[j], sc.a_of(j), sc.v_of(j),
+                               Vec{e[j], e[sc.size() + j]}, e3[j]});
+    });
+}
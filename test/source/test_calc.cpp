@@ -2,8 +2,11 @@
 #define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
 #include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK_EQ
 
-#include <ellalgo/ell_calc.hpp>  // for EllCalc
-#include <tuple>                 // for get, tuple
+#include <cmath>                   // for isnan
+#include <ellalgo/ell_calc.hpp>    // for EllCalc, CutBatch
+#include <ellalgo/ell_kernel.hpp>  // for set_isa, Isa
+#include <tuple>                   // for get, tuple
+#include <vector>                  // for vector
 
 TEST_CASE("EllCalc, test central cut") {
     auto ell_calc = EllCalc(4);
@@ -194,3 +197,147 @@ TEST_CASE("EllCalc, test parallel deep cut q") {
 //     CHECK_EQ(sigma, doctest::Approx(0.0));
 //     CHECK_EQ(delta, doctest::Approx(1.0));
 // }
+
+TEST_CASE("EllCalc, adaptive parallel cut") {
+    auto ell_calc = EllCalc(4);
+    auto ell_adaptive = EllCalc(4);
+    ell_adaptive.adaptive_parallel_cut = true;
+    const auto expected = ell_calc.calc_parallel_bias_cut(0.01, 0.04, 0.01);
+    const auto result = ell_adaptive.calc_parallel_bias_cut(0.01, 0.04, 0.01);
+    CHECK_EQ(std::get<0>(result), CutStatus::Success);
+    CHECK_EQ(std::get<1>(result), std::get<1>(expected));  // the parallel cut shrinks more
+    CHECK_EQ(std::get<1>(ell_adaptive.calc_parallel_central_cut(0.05, 0.01)),
+             std::get<1>(ell_calc.calc_parallel_central_cut(0.05, 0.01)));
+    CHECK_EQ(std::get<1>(ell_adaptive.calc_parallel_bias_cut_q(0.01, 0.04, 0.01)),
+             std::get<1>(ell_calc.calc_parallel_bias_cut_q(0.01, 0.04, 0.01)));
+    CHECK_EQ(ell_adaptive.num_parallel_chosen(), 3U);
+    CHECK_EQ(ell_adaptive.num_single_chosen(), 0U);
+    CHECK_EQ(ell_calc.num_parallel_chosen(), 0U);  // counted in the adaptive mode only
+
+    // the second constraint barely cuts: both are about the single cut
+    const auto tau = 0.1;
+    const auto beta1 = tau * (1.0 - 1e-12);
+    const auto near = ell_adaptive.calc_parallel_bias_cut(0.01, beta1, tau * tau);
+    const auto single = ell_calc.calc_bias_cut(0.01, tau * tau);
+    CHECK_EQ(std::get<1>(std::get<1>(near)), doctest::Approx(std::get<1>(std::get<1>(single))));
+    CHECK_EQ(ell_adaptive.num_parallel_chosen() + ell_adaptive.num_single_chosen(), 4U);
+
+    ell_adaptive.reset_counts();
+    CHECK_EQ(ell_adaptive.num_parallel_chosen(), 0U);
+    CHECK_EQ(ell_adaptive.num_single_chosen(), 0U);
+}
+
+/**
+ * @brief The cuts of the grid below, one per lane
+ */
+struct CutGrid {
+    std::vector<double> beta0;
+    std::vector<double> beta1;
+    std::vector<double> tsq;
+    std::vector<CutStatus> status;
+    std::vector<double> rho;
+    std::vector<double> sigma;
+    std::vector<double> delta;
+
+    CutGrid() {
+        const double betas[] = {-0.2, -0.05, 0.0, 0.01, 0.05, 0.099, 0.1, 0.2};
+        const double tsqs[] = {1e-6, 0.01, 0.04};
+        for (const auto b0 : betas) {
+            for (const auto b1 : betas) {
+                for (const auto t : tsqs) {
+                    this->beta0.push_back(b0);
+                    this->beta1.push_back(b1);
+                    this->tsq.push_back(t);
+                }
+            }
+        }
+        const auto num = this->tsq.size();
+        this->status.resize(num);
+        this->rho.resize(num);
+        this->sigma.resize(num);
+        this->delta.resize(num);
+    }
+
+    auto size() const -> size_t { return this->tsq.size(); }
+
+    auto out() -> CutBatch {
+        return {this->status.data(), this->rho.data(), this->sigma.data(), this->delta.data()};
+    }
+
+    /**
+     * @brief Whether the lane k holds result, bit for bit (NaN as NaN)
+     */
+    auto same(size_t k, const std::tuple<CutStatus, std::tuple<double, double, double>> &result)
+        const -> bool {
+        const auto &v = std::get<1>(result);
+        const auto eq
+            = [](double a, double b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+        return this->status[k] == std::get<0>(result) && eq(this->rho[k], std::get<0>(v))
+               && eq(this->sigma[k], std::get<1>(v)) && eq(this->delta[k], std::get<2>(v));
+    }
+};
+
+TEST_CASE("EllCalc, batches of cuts as one at a time") {
+    for (auto isa : {ell_kernel::Isa::Scalar, ell_kernel::Isa::Avx2}) {
+        if (!ell_kernel::set_isa(isa)) {
+            continue;  // not supported here
+        }
+        CAPTURE(ell_kernel::isa_name(isa));
+        for (const auto ndim : {2U, 4U, 11U}) {
+            for (auto mode = 0U; mode != 3U; ++mode) {
+                auto ell_calc = EllCalc(ndim);
+                ell_calc.use_parallel_cut = mode != 1U;
+                ell_calc.adaptive_parallel_cut = mode == 2U;
+                auto ell_batch = ell_calc;
+                auto grid = CutGrid();
+                const auto num = grid.size();
+                auto same = true;
+
+                ell_batch.calc_parallel_bias_cut_batch(grid.beta0.data(), grid.beta1.data(),
+                                                       grid.tsq.data(), num, grid.out());
+                for (auto k = 0U; k != num; ++k) {
+                    if (grid.beta0[k] >= 0.0) {  // as assumed by calc_bias_cut
+                        same = same
+                               && grid.same(k, ell_calc.calc_parallel_bias_cut(
+                                                   grid.beta0[k], grid.beta1[k], grid.tsq[k]));
+                    }
+                }
+                ell_batch.calc_parallel_bias_cut_q_batch(grid.beta0.data(), grid.beta1.data(),
+                                                         grid.tsq.data(), num, grid.out());
+                for (auto k = 0U; k != num; ++k) {
+                    same = same
+                           && grid.same(k, ell_calc.calc_parallel_bias_cut_q(
+                                               grid.beta0[k], grid.beta1[k], grid.tsq[k]));
+                }
+                ell_batch.calc_parallel_central_cut_batch(grid.beta1.data(), grid.tsq.data(), num,
+                                                          grid.out());
+                for (auto k = 0U; k != num; ++k) {
+                    same = same
+                           && grid.same(k, ell_calc.calc_parallel_central_cut(grid.beta1[k],
+                                                                              grid.tsq[k]));
+                }
+                ell_batch.calc_bias_cut_q_batch(grid.beta0.data(), grid.tsq.data(), num,
+                                                grid.out());
+                for (auto k = 0U; k != num; ++k) {
+                    same = same
+                           && grid.same(k, ell_calc.calc_bias_cut_q(grid.beta0[k], grid.tsq[k]));
+                }
+                ell_batch.calc_bias_cut_batch(grid.beta1.data(), grid.tsq.data(), num, grid.out());
+                for (auto k = 0U; k != num; ++k) {
+                    if (grid.beta1[k] >= 0.0) {
+                        same = same
+                               && grid.same(k, ell_calc.calc_bias_cut(grid.beta1[k], grid.tsq[k]));
+                    }
+                }
+                ell_batch.calc_central_cut_batch(grid.tsq.data(), num, grid.out());
+                for (auto k = 0U; k != num; ++k) {
+                    same = same && grid.same(k, ell_calc.calc_central_cut(grid.tsq[k]));
+                }
+                CHECK(same);
+                CHECK_EQ(ell_batch.num_parallel_chosen(), ell_calc.num_parallel_chosen());
+                CHECK_EQ(ell_batch.num_single_chosen(), ell_calc.num_single_chosen());
+            }
+        }
+    }
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
@@ -1,8 +1,10 @@
 #define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
 #include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK_EQ
 
-#include <ellalgo/ell_calc_core.hpp>  // for EllCalcCore
+#include <ellalgo/ell_calc_core.hpp>  // for EllCalcCore, EllCalcConsts
+#include <thread>                     // for thread
 #include <tuple>                      // for get, tuple
+#include <vector>                     // for vector
 
 TEST_CASE("EllCalcCore, test central cut") {
     auto ell_calc_core = EllCalcCore(4);
@@ -58,3 +60,42 @@ TEST_CASE("EllCalcCore, test parallel cut (no effect)") {
     CHECK_EQ(sigma, doctest::Approx(0.0));
     CHECK_EQ(delta, doctest::Approx(1.0));
 }
+
+TEST_CASE("EllCalcCore, shared constants") {
+    static constexpr auto consts4 = EllCalcConsts(4);
+    static_assert(consts4.cst2 == 0.4, "computed at compile time");
+    CHECK_EQ(sizeof(EllCalcCore), sizeof(void *));
+    for (const auto n : {2U, 4U, 63U, 64U, 1000U}) {
+        CHECK_EQ(&EllCalcConsts::intern(n), &EllCalcConsts::intern(n));
+        CHECK_EQ(&EllCalcCore(n).consts(), &EllCalcConsts::intern(n));
+        CHECK_EQ(EllCalcConsts::intern(n).cst1, EllCalcConsts(n).cst1);
+    }
+    CHECK_NE(&EllCalcConsts::intern(64), &EllCalcConsts::intern(65));
+    CHECK(EllCalcCore(consts4).calc_bias_cut(0.05, 0.1) == EllCalcCore(4).calc_bias_cut(0.05, 0.1));
+}
+
+TEST_CASE("EllCalcConsts, interned from several threads at once") {
+    const auto num_dims = 50U;
+    const auto num_threads = 4U;
+    auto found = std::vector<const EllCalcConsts *>(num_threads * num_dims);
+    auto threads = std::vector<std::thread>{};
+    for (auto t = 0U; t != num_threads; ++t) {
+        threads.emplace_back([&found, t]() {
+            for (auto k = 0U; k != num_dims; ++k) {
+                found[t * num_dims + k] = &EllCalcConsts::intern(2000U + k);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    auto same = true;
+    for (auto k = 0U; k != num_dims; ++k) {
+        const auto *consts = &EllCalcConsts::intern(2000U + k);
+        same = same && consts->n_f == 2000.0 + k;
+        for (auto t = 0U; t != num_threads; ++t) {
+            same = same && found[t * num_dims + k] == consts;
+        }
+    }
+    CHECK(same);
+}
@@ -0,0 +1,251 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK
+
+#include <cmath>                               // for sqrt
+#include <ellalgo/cg_engine.hpp>               // for ConjugateGradient, SymCsrMatrix
+#include <ellalgo/conjugate_gradient.hpp>      // for conjugate_gradient
+#include <ellalgo/ell_span.hpp>                // for make_span
+#include <ellalgo/oracles/structured_sym.hpp>  // for SparseSym
+#include <vector>                              // for vector
+
+/**
+ * @brief The 5-point Laplacian on a grid of m by m, with a shift
+ */
+static auto laplacian_2d(size_t m, double shift) -> SparseSym {
+    auto mat = SparseSym(m * m);
+    for (auto r = 0U; r != m; ++r) {
+        for (auto c = 0U; c != m; ++c) {
+            const auto i = r * m + c;
+            mat.add(i, i, 4.0 + shift);
+            if (c != 0U) {
+                mat.add(i, i - 1, -1.0);
+            }
+            if (r != 0U) {
+                mat.add(i, i - m, -1.0);
+            }
+        }
+    }
+    return mat;
+}
+
+static auto residual_norm(const SymCsrMatrix &A, const std::vector<double> &b,
+                          const std::vector<double> &x) -> double {
+    auto ax = std::vector<double>(b.size());
+    A.apply(x.data(), ax.data());
+    auto rr = 0.0;
+    for (auto i = 0U; i != b.size(); ++i) {
+        rr += (b[i] - ax[i]) * (b[i] - ax[i]);
+    }
+    return std::sqrt(rr);
+}
+
+TEST_CASE("SymCsrMatrix, from the lower triangle") {
+    auto mat = SparseSym(3);
+    mat.add(0, 0, 4.0);
+    mat.add(1, 0, 1.0);
+    mat.add(0, 1, 1.0);  // added up with (1, 0)
+    mat.add(1, 1, 3.0);
+    mat.add(2, 2, 5.0);
+    const auto A = SymCsrMatrix(mat);
+    CHECK_EQ(A.size(), 3U);
+    CHECK_EQ(A.num_nonzeros(), 5U);
+    const auto x = std::vector<double>{1.0, 2.0, 3.0};
+    auto y = std::vector<double>(3);
+    A.apply(x.data(), y.data());
+    CHECK_EQ(y[0], 8.0);
+    CHECK_EQ(y[1], 8.0);
+    CHECK_EQ(y[2], 15.0);
+    CHECK_EQ(A.diagonal(), std::vector<double>{4.0, 3.0, 5.0});
+}
+
+TEST_CASE("ConjugateGradient, as conjugate_gradient") {
+    Matrix0 A0(2, 2);
+    A0[0] = {4, 1};
+    A0[1] = {1, 3};
+    const auto x0 = conjugate_gradient(A0, Vector0({1, 2}));
+
+    auto mat = SparseSym(2);
+    mat.add(0, 0, 4.0);
+    mat.add(1, 0, 1.0);
+    mat.add(1, 1, 3.0);
+    const auto A = SymCsrMatrix(mat);
+    const auto b = std::vector<double>{1.0, 2.0};
+    auto x = std::vector<double>(2, 0.0);
+    auto solver = ConjugateGradient(2);
+    const auto info = solver.solve(A, make_span(b), make_span(x));
+    CHECK(info.converged);
+    CHECK_EQ(info.num_iters, 2U);
+    CHECK_EQ(x[0], doctest::Approx(x0[0]));
+    CHECK_EQ(x[1], doctest::Approx(x0[1]));
+
+    // from the solution
+    const auto again = solver.solve(A, make_span(b), make_span(x));
+    CHECK(again.converged);
+    CHECK_EQ(again.num_iters, 0U);
+}
+
+TEST_CASE("ConjugateGradient, preconditioned") {
+    const auto m = 60U;
+    const auto A = SymCsrMatrix(laplacian_2d(m, 0.01));
+    const auto n = A.size();
+    auto b = std::vector<double>(n);
+    for (auto i = 0U; i != n; ++i) {
+        b[i] = 1.0 + 0.5 * double(i % 7);
+    }
+    auto solver = ConjugateGradient(n);
+    solver.tolerance = 1e-8;
+
+    auto x_plain = std::vector<double>(n, 0.0);
+    const auto plain = solver.solve(A, make_span(b), make_span(x_plain));
+    auto x_jacobi = std::vector<double>(n, 0.0);
+    const auto jacobi
+        = solver.solve(A, make_span(b), make_span(x_jacobi), JacobiPreconditioner(A));
+    auto x_ic0 = std::vector<double>(n, 0.0);
+    const auto ic0 = solver.solve(A, make_span(b), make_span(x_ic0), Ic0Preconditioner(A));
+
+    REQUIRE(plain.converged);
+    REQUIRE(jacobi.converged);
+    REQUIRE(ic0.converged);
+    CHECK_LT(residual_norm(A, b, x_plain), 1e-7);
+    CHECK_LT(residual_norm(A, b, x_jacobi), 1e-7);
+    CHECK_LT(residual_norm(A, b, x_ic0), 1e-7);
+    CHECK_LE(jacobi.num_iters, plain.num_iters + 1);  // a constant diagonal
+    CHECK_LT(2 * ic0.num_iters, plain.num_iters);
+}
+
+TEST_CASE("ConjugateGradient, a matrix-free operator") {
+    // the 1D Laplacian, y(i) = -x(i - 1) + 2 x(i) - x(i + 1), the order of SymCsrMatrix
+    const auto n = 200U;
+    auto mat = SparseSym(n);
+    for (auto i = 0U; i != n; ++i) {
+        mat.add(i, i, 2.0);
+        if (i != 0U) {
+            mat.add(i, i - 1, -1.0);
+        }
+    }
+    const auto A = SymCsrMatrix(mat);
+    const auto op = make_operator(n, [n](const double *x, double *y) {
+        for (auto i = 0U; i != n; ++i) {
+            auto sum = 0.0;
+            if (i != 0U) {
+                sum += -1.0 * x[i - 1];
+            }
+            sum += 2.0 * x[i];
+            if (i + 1 != n) {
+                sum += -1.0 * x[i + 1];
+            }
+            y[i] = sum;
+        }
+    });
+    const auto b = std::vector<double>(n, 1.0);
+    auto solver = ConjugateGradient(n);
+    auto x_csr = std::vector<double>(n, 0.0);
+    const auto info_csr = solver.solve(A, make_span(b), make_span(x_csr));
+    auto x_op = std::vector<double>(n, 0.0);
+    const auto info_op = solver.solve(op, make_span(b), make_span(x_op));
+    CHECK(info_op.converged);
+    CHECK_EQ(info_op.num_iters, info_csr.num_iters);
+    CHECK_EQ(x_op, x_csr);
+
+    // to max_iters
+    solver.max_iters = 10U;
+    auto x_short = std::vector<double>(n, 0.0);
+    const auto info_short = solver.solve(op, make_span(b), make_span(x_short));
+    CHECK(!info_short.converged);
+    CHECK_EQ(info_short.num_iters, 10U);
+    CHECK_GT(info_short.residual_norm, solver.tolerance);
+}
+
+/**
+ * @brief The right-hand side j of a block of k, row by row, of vectors of size n
+ */
+static auto column(const std::vector<double> &block, size_t j, size_t k) -> std::vector<double> {
+    auto res = std::vector<double>(block.size() / k);
+    for (auto i = 0U; i != res.size(); ++i) {
+        res[i] = block[i * k + j];
+    }
+    return res;
+}
+
+TEST_CASE("BlockConjugateGradient, as one right-hand side at a time") {
+    const auto m = 20U;
+    const auto A = SymCsrMatrix(laplacian_2d(m, 0.05));
+    const auto n = A.size();
+    const auto k = 3U;
+    auto B = std::vector<double>(n * k);
+    for (auto i = 0U; i != n; ++i) {
+        B[i * k] = 1.0;
+        B[i * k + 1] = double(i % 5) - 2.0;
+        B[i * k + 2] = i == n / 2 ? 1.0 : 0.0;
+    }
+    const auto M = Ic0Preconditioner(A);
+    const auto op = make_operator(n, [&A](const double *x, double *y) { A.apply(x, y); });
+    auto single = ConjugateGradient(n);
+    auto block = BlockConjugateGradient(n, k);
+    block.keep_history = true;
+
+    // by apply_block, and vector by vector for the operator
+    auto X = std::vector<double>(n * k, 0.0);
+    const auto &info = block.solve(A, make_span(B), make_span(X), M);
+    auto X_op = std::vector<double>(n * k, 0.0);
+    const auto info_op = block.solve(op, make_span(B), make_span(X_op), M);
+    CHECK_EQ(X_op, X);
+    for (auto j = 0U; j != k; ++j) {
+        const auto b = column(B, j, k);
+        auto x = std::vector<double>(n, 0.0);
+        const auto expected = single.solve(A, make_span(b), make_span(x), M);
+        CHECK(info_op[j].converged);
+        CHECK_EQ(info_op[j].num_iters, expected.num_iters);
+        CHECK_EQ(info_op[j].residual_norm, expected.residual_norm);
+        CHECK_EQ(column(X, j, k), x);
+        const auto &history = block.residual_history(j);
+        REQUIRE_EQ(history.size(), expected.num_iters + 1);
+        CHECK_EQ(history.back(), expected.residual_norm);
+    }
+    CHECK_EQ(info[0].num_iters, info_op[0].num_iters);
+
+    // unpreconditioned, as ConjugateGradient too
+    auto X_plain = std::vector<double>(n * k, 0.0);
+    const auto info_plain = block.solve(A, make_span(B), make_span(X_plain));
+    const auto b1 = column(B, 1, k);
+    auto x1 = std::vector<double>(n, 0.0);
+    CHECK_EQ(info_plain[1].num_iters, single.solve(A, make_span(b1), make_span(x1)).num_iters);
+    CHECK_EQ(column(X_plain, 1, k), x1);
+}
+
+TEST_CASE("BlockConjugateGradient, warm started") {
+    const auto A = SymCsrMatrix(laplacian_2d(30U, 0.01));
+    const auto n = A.size();
+    const auto k = 2U;
+    auto B = std::vector<double>(n * k, 1.0);
+    auto block = BlockConjugateGradient(n, k);
+    block.tolerance = 1e-8;
+    auto X = std::vector<double>(n * k, 0.0);
+    const auto cold = block.solve(A, make_span(B), make_span(X), JacobiPreconditioner(A));
+    REQUIRE(cold[0].converged);
+    REQUIRE(cold[1].converged);
+
+    // a nearby right-hand side from the previous solutions, and the same one
+    for (auto i = 0U; i != n; ++i) {
+        B[i * k] = 1.01;
+    }
+    const auto warm = block.solve(A, make_span(B), make_span(X), JacobiPreconditioner(A));
+    CHECK(warm[0].converged);
+    CHECK_LT(warm[0].num_iters, cold[0].num_iters);
+    CHECK(warm[1].converged);
+    CHECK_EQ(warm[1].num_iters, 0U);
+    CHECK_LT(residual_norm(A, column(B, 0, k), column(X, 0, k)), 1e-7);
+
+    // to max_iters, with the partial solutions
+    block.max_iters = 5U;
+    X.assign(n * k, 0.0);
+    const auto partial = block.solve(A, make_span(B), make_span(X));
+    CHECK(!partial[0].converged);
+    CHECK_EQ(partial[0].num_iters, 5U);
+    CHECK_EQ(residual_norm(A, column(B, 0, k), column(X, 0, k)),
+             doctest::Approx(partial[0].residual_norm));
+    CHECK(block.residual_history(0).empty());
+}
@@ -0,0 +1,175 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, CHECK, TestCase
+
+#include <cstdio>                              // for remove
+#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim, cutting_plane_optim_q
+#include <ellalgo/cutting_plane_solver.hpp>    // for CuttingPlaneSolver, CuttingPlaneSolverQ
+#include <ellalgo/ell.hpp>                     // for Ell
+#include <ellalgo/ell_checkpoint.hpp>          // for CheckpointWriter, CheckpointFile
+#include <ellalgo/ell_stable.hpp>              // for EllStable
+#include <ellalgo/oracles/lowpass_oracle.hpp>  // for create_lowpass_case
+#include <ellalgo/oracles/profit_oracle.hpp>   // for ProfitOracleQ
+#include <fstream>                             // for ifstream
+#include <stdexcept>                           // for runtime_error
+#include <string>                              // for string
+#include <tuple>                               // for get, tuple
+#include <valarray>                            // for valarray
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief Solve the lowpass problem, from a checkpoint taken after `first` iterations
+ */
+template <typename Space> static auto lowpass_from_checkpoint(size_t first) -> void {
+    const auto path = std::string{"test_checkpoint_lowpass.bin"};
+    const auto lowpass = create_lowpass_case(32);
+    auto options = Options();
+    options.max_iters = 50000;
+    options.tolerance = 1e-14;
+    auto omega = lowpass.first;
+    auto ellip = Space(40.0, Vec(0.0, 32));
+    auto spsq = lowpass.second;
+    const auto expected = cutting_plane_optim(omega, ellip, spsq, options);
+
+    auto omega1 = lowpass.first;
+    auto ellip1 = Space(40.0, Vec(0.0, 32));
+    auto solver1 = make_cutting_plane_solver(omega1, ellip1, lowpass.second, options);
+    REQUIRE(!solver1.resume(first));
+    {
+        CheckpointWriter out{path};
+        solver1.save(out);
+        out.close();
+    }
+    auto ellip2 = Space(1.0, Vec(0.0, 32));
+    auto solver2 = make_cutting_plane_solver(omega1, ellip2, 0.0, options);  // the oracle goes on
+    {
+        CheckpointFile in{path};
+        solver2.load(in);
+        CHECK_EQ(in.remaining(), 0U);
+    }
+    CHECK_EQ(solver2.num_iters(), first);
+    CHECK_EQ(solver2.tsq(), solver1.tsq());
+    const auto result = solver2.run();
+    CHECK_EQ(std::get<1>(result), std::get<1>(expected));
+    CHECK_EQ(solver2.gamma(), spsq);
+    CHECK_EQ(ellip2.tsq(), ellip.tsq());
+    REQUIRE_EQ(std::get<0>(result).size(), 32U);
+    for (auto i = 0U; i != 32U; ++i) {
+        CHECK_EQ(std::get<0>(result)[i], std::get<0>(expected)[i]);
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Checkpoint, Ell in the middle of a solve") { lowpass_from_checkpoint<Ell<Vec>>(100U); }
+
+TEST_CASE("Checkpoint, EllStable in the middle of a solve") {
+    lowpass_from_checkpoint<EllStable<Vec>>(100U);
+}
+
+TEST_CASE("Checkpoint, cutting_plane_optim_q with retry") {
+    const auto path = std::string{"test_checkpoint_q.bin"};
+    const auto a = Vec{0.1, 0.4};
+    const auto v = Vec{10.0, 35.0};
+    ProfitOracleQ omega{20.0, 40.0, 30.5, a, v};
+    auto ellip = Ell<Vec>(100.0, Vec{0.0, 0.0});
+    auto gamma = 0.0;
+    const auto expected = cutting_plane_optim_q(omega, ellip, gamma);
+    REQUIRE_EQ(std::get<1>(expected), 29U);  // as in test_profit.cpp
+
+    for (auto first = 1U; first != 29U; ++first) {
+        ProfitOracleQ omega1{20.0, 40.0, 30.5, a, v};
+        auto ellip1 = Ell<Vec>(100.0, Vec{0.0, 0.0});
+        auto solver1 = make_cutting_plane_solver_q(omega1, ellip1, 0.0);
+        REQUIRE(!solver1.resume(first));
+        {
+            CheckpointWriter out{path};
+            solver1.save(out);
+            out.close();
+        }
+        auto ellip2 = Ell<Vec>(1.0, Vec{0.0, 0.0});
+        auto solver2 = make_cutting_plane_solver_q(omega1, ellip2, 0.0);  // the oracle goes on
+        {
+            CheckpointFile in{path};
+            solver2.load(in);
+        }
+        CHECK_EQ(solver2.retry(), solver1.retry());
+        const auto result = solver2.run();
+        CHECK_EQ(std::get<1>(result), 29U);
+        CHECK_EQ(solver2.gamma(), gamma);
+        REQUIRE_EQ(std::get<0>(result).size(), 2U);
+        CHECK_EQ(std::get<0>(result)[0], std::get<0>(expected)[0]);
+        CHECK_EQ(std::get<0>(result)[1], std::get<0>(expected)[1]);
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Checkpoint, errors") {
+    const auto path = std::string{"test_checkpoint_errors.bin"};
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    {
+        CheckpointWriter out{path};
+        ellip.save(out);
+        out.close();
+    }
+    auto other = Ell<Vec>(10.0, Vec{0.0, 0.0});  // another dimension
+    auto stable = EllStable<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    auto thrown = 0U;
+    try {
+        CheckpointFile in{path};
+        other.load(in);
+    } catch (const std::runtime_error &) {
+        ++thrown;
+    }
+    try {
+        CheckpointFile in{path};
+        stable.load(in);
+    } catch (const std::runtime_error &) {
+        ++thrown;
+    }
+    try {
+        CheckpointFile in{path};
+        ellip.load(in);
+        ellip.load(in);  // past the end
+    } catch (const std::runtime_error &) {
+        ++thrown;
+    }
+    try {
+        CheckpointFile in{"no_such_file.bin"};
+    } catch (const std::runtime_error &) {
+        ++thrown;
+    }
+    CHECK_EQ(thrown, 4U);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Checkpoint, a writer not closed keeps the previous checkpoint") {
+    const auto path = std::string{"test_checkpoint_unwind.bin"};
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    {
+        CheckpointWriter out{path};
+        ellip.save(out);
+        out.close();
+    }
+    auto other = Ell<Vec>(10.0, Vec{0.0, 0.0});
+    auto thrown = 0U;
+    try {
+        CheckpointWriter out{path};
+        other.save(out);
+        throw std::runtime_error("while writing");
+    } catch (const std::runtime_error &) {
+        ++thrown;
+    }
+    CHECK_EQ(thrown, 1U);
+    CHECK(std::ifstream(path + ".tmp").fail());  // deleted
+    auto restored = Ell<Vec>(1.0, Vec{1.0, 1.0, 1.0});
+    {
+        CheckpointFile in{path};
+        restored.load(in);  // the previous one, of dimension 3
+        CHECK_EQ(in.remaining(), 0U);
+    }
+    CHECK_EQ(restored.xc()[0], 0.0);
+    std::remove(path.c_str());
+}
@@ -2,7 +2,8 @@
 #define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
 #include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK_EQ
 
-#include <ellalgo/ell_core.hpp>  // for EllCore
+#include <cmath>                  // for sin, cos, isnan, isfinite, ldexp, log
+#include <ellalgo/ell_core.hpp>  // for EllCore, BasicEllCore
 
 using Vec = std::valarray<double>;
 
@@ -107,3 +108,184 @@ TEST_CASE("EllCore (stable), test parallel cut (no effect)") {
     CHECK_EQ(grad[0], doctest::Approx(0.5));
     CHECK_EQ(ell_core.tsq(), 0.01);
 }
+
+TEST_CASE("EllCore, checkpoint and restore") {
+    const auto grad_b = Vec{0.1, -0.4, 0.2, 0.3};
+    const auto grad_c = Vec{-0.3, 0.1, 0.4, 0.2};
+    auto ell_core = EllCore(0.01, 4);
+    auto grad = Vec{0.5, 0.2, -0.1, 0.3};
+    ell_core.update_bias_cut(grad, 0.01);  // leaves a pending rank-one update
+    auto snap = ell_core.snapshot();
+
+    auto grad1 = grad_b;
+    CHECK_EQ(ell_core.update_bias_cut(grad1, 0.0), CutStatus::Success);
+    const auto tsq1 = ell_core.tsq();
+    auto grad2 = grad_c;
+    CHECK_EQ(ell_core.update_central_cut(grad2, 0.0), CutStatus::Success);
+
+    ell_core.restore(snap);  // back to before grad_b
+    auto grad3 = grad_b;
+    ell_core.update_bias_cut(grad3, 0.0);
+    CHECK_EQ(ell_core.tsq(), tsq1);
+    CHECK_EQ(grad3[0], grad1[0]);
+    CHECK_EQ(grad3[3], grad1[3]);
+
+    ell_core.checkpoint(snap);  // reuse the buffer
+    auto grad4 = grad_c;
+    ell_core.update_central_cut(grad4, 0.0);
+    ell_core.restore(snap);
+    auto grad5 = grad_c;
+    ell_core.update_central_cut(grad5, 0.0);
+    CHECK_EQ(grad5[0], grad4[0]);
+    CHECK_EQ(grad5[0], grad2[0]);
+}
+
+TEST_CASE("EllCore (stable), checkpoint and restore") {
+    const auto grad_b = Vec{0.1, -0.4, 0.2, 0.3};
+    auto ell_core = EllCore(0.01, 4);
+    auto grad = Vec{0.5, 0.2, -0.1, 0.3};
+    ell_core.update_stable_bias_cut(grad, 0.01);  // leaves a pending update of L and D
+    auto snap = ell_core.snapshot();
+
+    auto grad1 = grad_b;
+    CHECK_EQ(ell_core.update_stable_bias_cut(grad1, 0.0), CutStatus::Success);
+    const auto tsq1 = ell_core.tsq();
+
+    ell_core.restore(snap);  // back to before grad_b
+    auto grad2 = grad_b;
+    ell_core.update_stable_bias_cut(grad2, 0.0);
+    CHECK_EQ(ell_core.tsq(), tsq1);
+    CHECK_EQ(grad2[0], grad1[0]);
+    CHECK_EQ(grad2[3], grad1[3]);
+
+    // the same cuts without the stable form: Q g, and g' Q g
+    auto ell_plain = EllCore(0.01, 4);
+    auto grad3 = Vec{0.5, 0.2, -0.1, 0.3};
+    ell_plain.update_bias_cut(grad3, 0.01);
+    auto grad4 = grad_b;
+    ell_plain.update_bias_cut(grad4, 0.0);
+    CHECK_EQ(ell_plain.tsq(), doctest::Approx(tsq1));
+    CHECK_EQ(grad4[0], doctest::Approx(grad1[0]));
+}
+
+TEST_CASE("EllCore, quad") {
+    auto ell_core = EllCore(0.01, 4);
+    auto grad = Vec{0.5, 0.2, -0.1, 0.3};
+    CHECK_EQ(ell_core.quad(&grad[0]), doctest::Approx(0.01 * 0.39));
+    ell_core.update_bias_cut(grad, 0.01);  // leaves a pending rank-one update
+    const auto grad_b = Vec{0.1, -0.4, 0.2, 0.3};
+    const auto q = ell_core.quad(&grad_b[0]);
+    auto grad1 = grad_b;
+    ell_core.update_bias_cut(grad1, 0.0);
+    CHECK_EQ(ell_core.tsq(), doctest::Approx(q));
+}
+
+TEST_CASE("EllCore, float matrix") {
+    auto ell_core = EllCore(Vec(1e12, 4), 4);  // far from 1, rescaled in float
+    auto ell_core_f = BasicEllCore<float>(Vec(1e12, 4), 4);
+    for (auto k = 0U; k != 20U; ++k) {
+        auto grad = Vec{std::sin(1.0 + k), std::cos(2.0 * k), 0.5, std::sin(0.3 * k)};
+        auto grad_f = grad;
+        const auto beta = 1e4 * (k % 3);
+        CHECK_EQ(ell_core.update_bias_cut(grad, beta), CutStatus::Success);
+        CHECK_EQ(ell_core_f.update_bias_cut(grad_f, beta), CutStatus::Success);
+        CHECK_EQ(ell_core_f.tsq(), doctest::Approx(ell_core.tsq()).epsilon(1e-4));
+        CHECK_EQ(grad_f[0], doctest::Approx(grad[0]).epsilon(1e-4));
+    }
+    auto refined = EllCore(ell_core_f);  // in double from here
+    const auto grad_b = Vec{0.1, -0.4, 0.2, 0.3};
+    CHECK_EQ(refined.quad(&grad_b[0]), doctest::Approx(ell_core.quad(&grad_b[0])).epsilon(1e-4));
+    CHECK_EQ(refined.quad(&grad_b[0]), doctest::Approx(ell_core_f.quad(&grad_b[0])));
+}
+
+TEST_CASE("EllCore, lazy rescale") {
+    auto ell_core = EllCore(1.0, 4);
+    auto ell_core_lazy = EllCore(1.0, 4);
+    ell_core_lazy.lazy_rescale = true;
+    auto same = true;
+    for (auto k = 0U; k != 7000U; ++k) {
+        auto grad = Vec{std::sin(1.0 + k), std::cos(2.0 * k), 0.5, std::sin(0.3 * k)};
+        auto grad_lazy = grad;
+        if (k % 2 == 0U) {
+            ell_core.update_bias_cut(grad, 0.0);
+            ell_core_lazy.update_bias_cut(grad_lazy, 0.0);
+        } else {
+            ell_core.update_central_cut(grad, 0.0);
+            ell_core_lazy.update_central_cut(grad_lazy, 0.0);
+        }
+        if (k < 5000U) {  // while mq of the defer trick is still a normal number
+            same = same && ell_core_lazy.tsq() == ell_core.tsq() && grad_lazy[0] == grad[0];
+        }
+    }
+    CHECK(same);
+    CHECK(ell_core_lazy.snapshot().kappa < std::ldexp(1.0, 65));
+    CHECK(std::isnan(ell_core.tsq()));  // mq underflowed
+    CHECK(ell_core_lazy.tsq() > 0.0);
+}
+
+TEST_CASE("EllCore, log volume") {
+    auto ell_core = EllCore(Vec{4.0, 9.0}, 2);
+    auto ell_stable = EllCore(Vec{4.0, 9.0}, 2);
+    CHECK_EQ(ell_core.log_volume(), doctest::Approx(std::log(6.0)));
+    const auto e1 = Vec{1.0, 0.0};
+    const auto e2 = Vec{0.0, 1.0};
+    const auto e12 = Vec{1.0, 1.0};
+    for (auto k = 0U; k != 10U; ++k) {
+        auto grad = Vec{std::sin(1.0 + k), std::cos(2.0 * k)};
+        auto grad_s = grad;
+        const auto beta = k % 2 == 0U ? 0.0 : 0.1;
+        CHECK_EQ(ell_core.update_bias_cut(grad, beta), CutStatus::Success);
+        CHECK_EQ(ell_stable.update_stable_bias_cut(grad_s, beta), CutStatus::Success);
+        // det(kappa * mq) from g' kappa mq g
+        const auto a = ell_core.quad(&e1[0]);
+        const auto b = ell_core.quad(&e2[0]);
+        const auto c = 0.5 * (ell_core.quad(&e12[0]) - a - b);
+        CHECK_EQ(ell_core.log_volume(), doctest::Approx(0.5 * std::log(a * b - c * c)));
+        CHECK_EQ(ell_stable.log_volume(), doctest::Approx(ell_core.log_volume()));
+    }
+    const auto snap = ell_core.snapshot();
+    auto grad = Vec{0.3, 0.4};
+    ell_core.update_central_cut(grad, 0.0);
+    ell_core.restore(snap);
+    CHECK_EQ(ell_core.log_volume(), snap.log_volume);
+}
+
+TEST_CASE("EllCore, log volume after mq underflows") {
+    auto ell_core = EllCore(1.0, 4);
+    auto ell_core_lazy = EllCore(1.0, 4);
+    ell_core_lazy.lazy_rescale = true;
+    for (auto k = 0U; k != 7000U; ++k) {
+        auto grad = Vec{std::sin(1.0 + k), std::cos(2.0 * k), 0.5, std::sin(0.3 * k)};
+        auto grad_lazy = grad;
+        ell_core.update_central_cut(grad, 0.0);
+        ell_core_lazy.update_central_cut(grad_lazy, 0.0);
+    }
+    CHECK(std::isfinite(ell_core.log_volume()));  // while det(mq) is 0
+    CHECK(ell_core.log_volume() < -800.0);
+    CHECK_EQ(ell_core_lazy.log_volume(), ell_core.log_volume());  // rescaling is exact
+}
+
+TEST_CASE("EllCore, axis widths and reset") {
+    auto ell_core = EllCore(Vec{4.0, 9.0}, 2);
+    const auto e1 = Vec{1.0, 0.0};
+    const auto e2 = Vec{0.0, 1.0};
+    for (auto k = 0U; k != 5U; ++k) {
+        auto grad = Vec{std::sin(1.0 + k), std::cos(2.0 * k)};
+        ell_core.update_bias_cut(grad, 0.1);
+    }
+    auto widths = Vec(2);
+    ell_core.axis_widths_sq(&widths[0]);  // with the update pending
+    CHECK_EQ(widths[0], doctest::Approx(ell_core.quad(&e1[0])));
+    CHECK_EQ(widths[1], doctest::Approx(ell_core.quad(&e2[0])));
+
+    // as a new one from the diagonal
+    ell_core.reset_diagonal(widths);
+    auto fresh = EllCore(widths, 2);
+    CHECK_EQ(ell_core.log_volume(), fresh.log_volume());
+    CHECK_EQ(ell_core.tsq(), 0.0);
+    auto grad = Vec{0.3, 0.4};
+    auto grad_fresh = grad;
+    CHECK_EQ(ell_core.update_bias_cut(grad, 0.05), fresh.update_bias_cut(grad_fresh, 0.05));
+    CHECK_EQ(ell_core.tsq(), fresh.tsq());
+    CHECK_EQ(ell_core.quad(&e1[0]), fresh.quad(&e1[0]));
+}
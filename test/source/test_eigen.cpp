@@ -0,0 +1,140 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK
+
+#include <cmath>                               // for sqrt, sin, pow
+#include <ellalgo/cg_engine.hpp>               // for SymCsrMatrix, make_operator
+#include <ellalgo/eigen_solver.hpp>            // for PowerIteration, Lanczos
+#include <ellalgo/ell_span.hpp>                // for make_span
+#include <ellalgo/oracles/structured_sym.hpp>  // for SparseSym
+#include <vector>                              // for vector
+
+/**
+ * @brief ||A x - lambda x|| / |lambda|
+ */
+static auto rel_residual(const SymCsrMatrix &A, const std::vector<double> &x, double lambda)
+    -> double {
+    auto ax = std::vector<double>(x.size());
+    A.apply(x.data(), ax.data());
+    auto rr = 0.0;
+    for (auto i = 0U; i != x.size(); ++i) {
+        rr += (ax[i] - lambda * x[i]) * (ax[i] - lambda * x[i]);
+    }
+    return std::sqrt(rr) / std::abs(lambda);
+}
+
+TEST_CASE("PowerIteration, Lanczos, as experiment/power_iteration.cpp") {
+    auto mat = SparseSym(3);
+    mat.add(0, 0, 3.7);
+    mat.add(1, 0, -3.6);
+    mat.add(1, 1, 4.3);
+    mat.add(2, 0, 0.7);
+    mat.add(2, 1, -2.8);
+    mat.add(2, 2, 5.4);
+    const auto A = SymCsrMatrix(mat);
+
+    auto power = PowerIteration(3);
+    power.tolerance = 1e-14;
+    auto x_power = std::vector<double>{0.3, 0.5, 0.4};
+    const auto info_power = power.solve(A, make_span(x_power));
+    CHECK(info_power.converged);
+    CHECK_LT(rel_residual(A, x_power, info_power.eigenvalue), 1e-6);
+
+    auto lanczos = Lanczos(3, 3);
+    auto x_lanczos = std::vector<double>{0.3, 0.5, 0.4};
+    const auto info_lanczos = lanczos.solve(A, make_span(x_lanczos));
+    CHECK(info_lanczos.converged);
+    CHECK_LE(info_lanczos.num_iters, 2U);
+    CHECK_EQ(info_lanczos.eigenvalue, doctest::Approx(info_power.eigenvalue));
+    CHECK_LT(rel_residual(A, x_lanczos, info_lanczos.eigenvalue), 1e-10);
+    const auto ritz = lanczos.ritz_values();
+    REQUIRE_EQ(ritz.size(), 3U);
+    CHECK_EQ(ritz[0] + ritz[1] + ritz[2], doctest::Approx(3.7 + 4.3 + 5.4));  // the trace
+}
+
+TEST_CASE("Lanczos, far fewer products than PowerIteration") {
+    // the spectrum spread over about [1, 2], of a small gap at the top
+    const auto n = 200U;
+    auto mat = SparseSym(n);
+    for (auto i = 0U; i != n; ++i) {
+        mat.add(i, i, 1.0 + double(i) / double(n));
+        if (i != 0U) {
+            mat.add(i, i - 1, -0.1);
+        }
+    }
+    const auto A = SymCsrMatrix(mat);
+    auto x0 = std::vector<double>(n);
+    for (auto i = 0U; i != n; ++i) {
+        x0[i] = std::sin(1.0 + 1.7 * double(i));
+    }
+
+    auto exact = Lanczos(n, n);
+    exact.tolerance = 1e-15;
+    auto x_exact = x0;
+    const auto lambda_max = exact.solve(A, make_span(x_exact)).eigenvalue;
+
+    auto lanczos = Lanczos(n, 100);
+    auto x_lanczos = x0;
+    const auto info_lanczos = lanczos.solve(A, make_span(x_lanczos));
+    CHECK(info_lanczos.converged);
+    CHECK_EQ(info_lanczos.eigenvalue, doctest::Approx(lambda_max).epsilon(1e-8));
+    CHECK_LT(rel_residual(A, x_lanczos, info_lanczos.eigenvalue), 1e-3);
+    CHECK_LE(lanczos.ritz_values().size(), 100U);
+
+    auto power = PowerIteration(n);
+    auto x_power = x0;
+    const auto info_power = power.solve(A, make_span(x_power));
+    CHECK(info_power.converged);
+    CHECK_EQ(info_power.eigenvalue, doctest::Approx(lambda_max).epsilon(1e-6));
+    CHECK_LT(10 * info_lanczos.num_iters, info_power.num_iters);
+}
+
+TEST_CASE("BlockPowerIteration, the top eigenpairs") {
+    // well separated at the top: the diagonal 1.1^i, coupled
+    const auto n = 60U;
+    auto mat = SparseSym(n);
+    for (auto i = 0U; i != n; ++i) {
+        mat.add(i, i, std::pow(1.1, double(i)));
+        if (i != 0U) {
+            mat.add(i, i - 1, -0.3);
+        }
+    }
+    const auto A = SymCsrMatrix(mat);
+    const auto k = 3U;
+    auto X = std::vector<double>(n * k);
+    for (auto i = 0U; i != n * k; ++i) {
+        X[i] = std::sin(0.3 + 1.7 * double(i));
+    }
+    auto block = BlockPowerIteration(n, k);
+    block.tolerance = 1e-12;
+    const auto &info = block.solve(A, make_span(X));
+
+    auto lanczos = Lanczos(n, n);
+    lanczos.tolerance = 1e-14;
+    auto x = std::vector<double>(n, 1.0);
+    lanczos.solve(A, make_span(x));
+    const auto ritz = lanczos.ritz_values();
+    for (auto j = 0U; j != k; ++j) {
+        CHECK(info[j].converged);
+        CHECK_EQ(info[j].eigenvalue, doctest::Approx(ritz[j]).epsilon(1e-9));
+        auto xj = std::vector<double>(n);
+        for (auto i = 0U; i != n; ++i) {
+            xj[i] = X[i * k + j];
+        }
+        CHECK_LT(rel_residual(A, xj, info[j].eigenvalue), 1e-5);
+    }
+    CHECK_GT(info[0].eigenvalue, info[1].eigenvalue);
+    CHECK_GT(info[1].eigenvalue, info[2].eigenvalue);
+
+    // the same through a matrix-free operator, vector by vector
+    const auto op = make_operator(n, [&A](const double *x1, double *y1) { A.apply(x1, y1); });
+    auto X_op = std::vector<double>(n * k);
+    for (auto i = 0U; i != n * k; ++i) {
+        X_op[i] = std::sin(0.3 + 1.7 * double(i));
+    }
+    const auto info_op = block.solve(op, make_span(X_op));
+    CHECK_EQ(info_op[0].num_iters, info[0].num_iters);
+    CHECK_EQ(X_op, X);
+}
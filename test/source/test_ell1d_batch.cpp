@@ -0,0 +1,144 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, CHECK, TestCase
+
+#include <cmath>                      // for exp, log, sin, cos
+#include <ellalgo/cutting_plane.hpp>  // for cutting_plane_optim
+#include <ellalgo/ell1d.hpp>          // for ell1d
+#include <ellalgo/ell1d_batch.hpp>    // for Ell1dBatch
+#include <ellalgo/ell_batch.hpp>      // for cutting_plane_optim_batch
+#include <ellalgo/ell_config.hpp>     // for CutStatus, Options
+#include <ellalgo/ell_kernel.hpp>     // for set_isa, Isa
+#include <tuple>                      // for get, make_tuple
+#include <utility>                    // for pair
+#include <valarray>                   // for valarray
+#include <vector>                     // for vector
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief min exp(x) - c * x, by the cuts of its subgradient
+ */
+class ExpOracle {
+    double _c;
+
+  public:
+    explicit ExpOracle(double c) : _c{c} {}
+
+    auto assess_optim(double x, double &gamma) const
+        -> std::tuple<std::pair<double, double>, bool> {
+        const auto f = std::exp(x) - this->_c * x;
+        const auto g = std::exp(x) - this->_c;
+        if (f < gamma) {
+            gamma = f;
+            return std::make_tuple(std::make_pair(g, 0.0), true);
+        }
+        return std::make_tuple(std::make_pair(g, f - gamma), false);
+    }
+};
+
+/**
+ * @brief K of `ExpOracle`, assessed one after another
+ */
+class ExpBatch {
+    std::vector<ExpOracle> _oracles;
+
+  public:
+    explicit ExpBatch(const std::vector<double> &cs) {
+        for (const auto c : cs) {
+            this->_oracles.emplace_back(c);
+        }
+    }
+
+    void assess_optim_batch(const Vec &xc, Vec &gamma, const Ell1dBatch::Mask &active, Vec &grad,
+                            Vec &beta, Ell1dBatch::Mask &shrunk) {
+        for (auto k = 0U; k != this->_oracles.size(); ++k) {
+            if (!active[k]) {
+                continue;
+            }
+            const auto result = this->_oracles[k].assess_optim(xc[k], gamma[k]);
+            grad[k] = std::get<0>(result).first;
+            beta[k] = std::get<0>(result).second;
+            shrunk[k] = std::get<1>(result);
+        }
+    }
+};
+
+TEST_CASE("Ell1dBatch: same cuts as ell1d, bit for bit") {
+    for (auto isa : {ell_kernel::Isa::Scalar, ell_kernel::Isa::Avx2, ell_kernel::Isa::Avx512,
+                     ell_kernel::Isa::Neon}) {
+        if (!ell_kernel::set_isa(isa)) {
+            continue;  // not supported here
+        }
+        CAPTURE(ell_kernel::isa_name(isa));
+        const auto num = 13U;
+        auto batch = Ell1dBatch(-2.0, 3.0, num);
+        auto singles = std::vector<ell1d>(num, ell1d(-2.0, 3.0));
+        const auto S = batch.stride();
+        REQUIRE_EQ(S % Ell1dBatch::lane_block, 0U);
+        auto grad = Vec(0.0, S);
+        auto beta = Vec(0.0, S);
+        auto central = Ell1dBatch::Mask(false, S);
+        for (auto it = 0U; it != 12U; ++it) {
+            for (auto k = 0U; k != num; ++k) {
+                grad[k] = std::sin(1.0 + 0.7 * it + 1.3 * k);
+                beta[k] = 0.3 * std::cos(0.4 * it + k);
+                central[k] = (it + k) % 3 == 0U;
+            }
+            beta[it] = -100.0;  // no effect
+            batch.update_optim_cut(grad, beta, central);
+            for (auto k = 0U; k != num; ++k) {
+                const auto cut = std::make_pair(grad[k], beta[k]);
+                const auto status = central[k] ? singles[k].update_central_cut(cut)
+                                               : singles[k].update_bias_cut(cut);
+                CHECK_EQ(batch.status()[k], status);
+                CHECK_EQ(batch.xc()[k], singles[k].xc());
+                CHECK_EQ(batch.tsq()[k], singles[k].tsq());
+            }
+        }
+
+        // no sol'n, and the lanes masked off are left as they are
+        batch.deactivate(1U);
+        const auto xc1 = batch.xc()[1];
+        const auto tsq1 = batch.tsq()[1];
+        grad = 1.0;
+        beta = 100.0;
+        batch.update_bias_cut(grad, beta);
+        CHECK_EQ(batch.status()[0], CutStatus::NoSoln);
+        CHECK_EQ(batch.xc()[0], singles[0].xc());
+        CHECK_EQ(batch.xc()[1], xc1);
+        CHECK_EQ(batch.tsq()[1], tsq1);
+        CHECK_EQ(batch.num_active(), num - 1);
+        batch.update_central_cut(grad, beta);
+        CHECK_EQ(batch.status()[0], CutStatus::Success);
+        CHECK_EQ(batch.xc()[1], xc1);
+    }
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
+
+TEST_CASE("cutting_plane_optim_batch: 1D problems in lockstep") {
+    auto cs = std::vector<double>{};
+    for (auto k = 0U; k != 50U; ++k) {
+        cs.push_back(0.5 + 0.1 * k);
+    }
+    const auto num = cs.size();
+    auto omega = ExpBatch(cs);
+    auto space = Ell1dBatch(-10.0, 10.0, num);
+    auto gamma = Vec(1e100, num);
+    const auto result = cutting_plane_optim_batch(omega, space, gamma);
+    const auto &x_best = std::get<0>(result);
+    const auto &num_iters = std::get<1>(result);
+
+    for (auto k = 0U; k != num; ++k) {
+        auto oracle = ExpOracle(cs[k]);
+        ell1d single(-10.0, 10.0);
+        auto gamma_k = 1e100;
+        const auto expected = cutting_plane_optim(oracle, single, gamma_k);
+        CHECK_EQ(x_best[k], std::get<0>(expected));
+        CHECK_EQ(num_iters[k], std::get<1>(expected));
+        CHECK_EQ(gamma[k], gamma_k);
+        CHECK_EQ(x_best[k], doctest::Approx(std::log(cs[k])).epsilon(1e-5));
+    }
+}
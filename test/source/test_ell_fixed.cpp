@@ -0,0 +1,100 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK_EQ
+
+#include <array>                      // for array
+#include <cmath>                      // for sin, cos
+#include <ellalgo/cutting_plane.hpp>  // for cutting_plane_optim
+#include <ellalgo/ell.hpp>            // for Ell
+#include <ellalgo/ell_config.hpp>     // for CutStatus, Options
+#include <ellalgo/ell_fixed.hpp>      // for EllFixed
+#include <tuple>                      // for get, tuple
+#include <valarray>                   // for valarray
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief The oracle of test_example1.cpp, for either array type
+ */
+template <typename Arr> struct MyFixedOracle {
+    using Cut = std::pair<Arr, double>;
+
+    int idx = -1;  // for round robin
+
+    auto assess_optim(const Arr &xc, double &gamma) -> std::tuple<Cut, bool> {
+        const auto x = xc[0];
+        const auto y = xc[1];
+        const auto f0 = x + y;
+        for (int i = 0; i != 3; i++) {
+            this->idx = this->idx == 2 ? 0 : this->idx + 1;
+            double fj;
+            if (this->idx == 0 && f0 > 3.0) {  // constraint 1: x + y <= 3
+                return {{Arr{1.0, 1.0}, f0 - 3.0}, false};
+            }
+            if (this->idx == 1 && (fj = -x + y + 1.0) > 0.0) {  // constraint 2: x - y >= 1
+                return {{Arr{-1.0, 1.0}, fj}, false};
+            }
+            if (this->idx == 2 && (fj = gamma - f0) > 0.0) {  // objective: maximize x + y
+                return {{Arr{-1.0, -1.0}, fj}, false};
+            }
+        }
+        gamma = f0;
+        return {{Arr{-1.0, -1.0}, 0.0}, true};
+    }
+};
+
+TEST_CASE("EllFixed, the iterates of Ell") {
+    using Arr = std::array<double, 2>;
+    auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto ell_fixed = EllFixed<2>(Arr{10.0, 10.0}, Arr{0.0, 0.0});
+    auto oracle = MyFixedOracle<Vec>{};
+    auto oracle_fixed = MyFixedOracle<Arr>{};
+    auto gamma = -1.0e100;
+    auto gamma_fixed = -1.0e100;
+    const auto options = Options{2000, 1e-10};
+    const auto result = cutting_plane_optim(oracle, ell, gamma, options);
+    const auto result_fixed = cutting_plane_optim(oracle_fixed, ell_fixed, gamma_fixed, options);
+    REQUIRE_NE(std::get<0>(result).size(), 0U);
+    CHECK_EQ(std::get<1>(result_fixed), std::get<1>(result));
+    CHECK_EQ(gamma_fixed, gamma);
+    CHECK_EQ(std::get<0>(result_fixed)[0], std::get<0>(result)[0]);
+    CHECK_EQ(std::get<0>(result_fixed)[1], std::get<0>(result)[1]);
+}
+
+TEST_CASE("EllFixed, deep, central and parallel cuts") {
+    using Arr = std::array<double, 4>;
+    auto ell = Ell<Vec>(0.01, Vec{0.0, 0.0, 0.0, 0.0});
+    auto ell_fixed = EllFixed<4>(0.01, Arr{0.0, 0.0, 0.0, 0.0});
+    for (auto k = 0U; k != 12U; ++k) {
+        const auto grad = Vec{std::sin(1.0 + k), std::cos(2.0 * k), 0.5, std::sin(0.3 * k)};
+        const auto grad_fixed = Arr{grad[0], grad[1], grad[2], grad[3]};
+        const auto beta = 0.001 * (k % 3);
+        CutStatus status;
+        CutStatus status_fixed;
+        switch (k % 4) {
+            case 0:
+                status = ell.update_bias_cut(std::make_pair(grad, beta));
+                status_fixed = ell_fixed.update_bias_cut(std::make_pair(grad_fixed, beta));
+                break;
+            case 1:
+                status = ell.update_central_cut(std::make_pair(grad, beta));
+                status_fixed = ell_fixed.update_central_cut(std::make_pair(grad_fixed, beta));
+                break;
+            case 2:
+                status = ell.update_bias_cut(std::make_pair(grad, Vec{beta, 0.002}));
+                status_fixed
+                    = ell_fixed.update_bias_cut(std::make_pair(grad_fixed, Vec{beta, 0.002}));
+                break;
+            default:
+                status = ell.update_q(std::make_pair(grad, Vec{-beta, 0.001}));
+                status_fixed = ell_fixed.update_q(std::make_pair(grad_fixed, Vec{-beta, 0.001}));
+        }
+        CHECK_EQ(status_fixed, status);
+        CHECK_EQ(ell_fixed.tsq(), ell.tsq());
+        for (auto i = 0U; i != 4U; ++i) {
+            CHECK_EQ(ell_fixed.xc()[i], ell.xc()[i]);
+        }
+    }
+}
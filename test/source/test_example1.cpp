@@ -1,10 +1,13 @@
 #define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
 #include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK_EQ
 
+#include <cmath>                      // for sqrt
 #include <ellalgo/cutting_plane.hpp>  // for cutting_plane_optim
 #include <ellalgo/ell.hpp>            // for Ell
 #include <ellalgo/ell_config.hpp>     // for CInfo, CutStatus, CutStatus::...
 #include <tuple>                      // for get, tuple
+#include <utility>                    // for pair
+#include <vector>                     // for vector
 
 using Vec = std::valarray<double>;
 
@@ -68,6 +71,35 @@ struct MyOracle {
     }
 };
 
+/**
+ * @brief The oracle above, reporting every violated constraint at once
+ */
+struct MyMultiOracle {
+    using Cut = std::pair<Vec, double>;
+
+    auto assess_optim_all(const Vec &xc, double &gamma, std::vector<Cut> &cuts) const -> bool {
+        const auto x = xc[0];
+        const auto y = xc[1];
+        const auto f0 = x + y;
+        if (f0 > 3.0) {  // constraint 1: x + y <= 3
+            cuts.push_back({Vec{1.0, 1.0}, f0 - 3.0});
+        }
+        const auto f1 = -x + y + 1.0;
+        if (f1 > 0.0) {  // constraint 2: x - y >= 1
+            cuts.push_back({Vec{-1.0, 1.0}, f1});
+        }
+        if (gamma - f0 > 0.0) {  // objective: maximize x + y
+            cuts.push_back({Vec{-1.0, -1.0}, gamma - f0});
+        }
+        if (!cuts.empty()) {
+            return false;
+        }
+        gamma = f0;
+        cuts.push_back({Vec{-1.0, -1.0}, 0.0});
+        return true;
+    }
+};
+
 TEST_CASE("Example 1, test feasible") {
     auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
     auto oracle = MyOracle{};
@@ -99,3 +131,45 @@ TEST_CASE("Example 1, test infeasible2") {
     const auto x = std::get<0>(result);
     CHECK_EQ(x.size(), 0U);
 }
+
+TEST_CASE("Example 1, the deepest of all the cuts") {
+    auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle = MyMultiOracle{};
+    auto gamma = -1.0e100;
+    const auto options = Options{2000, 1e-10};
+    const auto result = cutting_plane_optim(oracle, ell, gamma, options);
+    const auto &x = std::get<0>(result);
+    REQUIRE_NE(x.size(), 0U);
+    CHECK(x[0] >= 0.0);
+    CHECK_EQ(gamma, doctest::Approx(3.0).epsilon(1e-4));  // on x + y = 3
+    CHECK(x[0] - x[1] >= 1.0 - 1e-4);
+}
+
+TEST_CASE("Example 1, update_deepest_cut") {
+    auto ell = Ell<Vec>(Vec{10.0, 40.0}, Vec{0.0, 0.0});
+    auto ell_ref = Ell<Vec>(Vec{10.0, 40.0}, Vec{0.0, 0.0});
+    // depths 1 / sqrt(10), 2 / sqrt(40) and 1.5 / sqrt(50)
+    const auto cuts = std::vector<std::pair<Vec, double>>{
+        {Vec{1.0, 0.0}, 1.0}, {Vec{0.0, 1.0}, 2.0}, {Vec{1.0, 1.0}, 1.5}};
+    const auto result = ell.update_deepest_cut(cuts);
+    CHECK_EQ(result.first, CutStatus::Success);
+    CHECK_EQ(result.second, 0U);
+    CHECK_EQ(ell_ref.update_bias_cut(cuts[0]), CutStatus::Success);
+    CHECK_EQ(ell.tsq(), ell_ref.tsq());
+    CHECK_EQ(ell.xc()[0], ell_ref.xc()[0]);
+    CHECK_EQ(ell.xc()[1], ell_ref.xc()[1]);
+
+    // now with the pending rank-one update of the cut above
+    auto deepest = size_t(0U);
+    auto depth = 0.0;
+    for (auto k = 0U; k != cuts.size(); ++k) {
+        const auto depth_k = cuts[k].second / std::sqrt(ell.quad(make_span(cuts[k].first)));
+        if (depth_k > depth) {
+            deepest = k;
+            depth = depth_k;
+        }
+    }
+    CHECK_EQ(ell.update_deepest_cut(cuts).second, deepest);
+    CHECK_EQ(ell.update_deepest_cut(std::vector<std::pair<Vec, double>>{{Vec{0.0, 1.0}, 9.0}}),
+             std::make_pair(CutStatus::NoSoln, size_t(0U)));
+}
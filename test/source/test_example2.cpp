@@ -14,6 +14,8 @@ struct MyOracle {
     using Cut = std::pair<Vec, double>;
 
     int idx = -1;
+    Cut cut1 = Cut{Vec{1.0, 1.0}, 0.0};
+    Cut cut2 = Cut{Vec{-1.0, 1.0}, 0.0};
 
     /**
      * The function assess_feas assesses the feasibility of a given vector xc with respect to two
@@ -24,12 +26,9 @@ struct MyOracle {
      * `assess_feas`, the elements of `xc` are accessed as `x` and `y` respectively.
      *
      * @return A pointer to a `Cut` object is being returned. The `Cut` object being returned is
-     * either `cut1` or `cut2`, which are static variables initialized within the function.
+     * either `cut1` or `cut2`, which are members of the oracle.
      */
     auto assess_feas(const Vec &xc) -> Cut * {
-        static auto cut1 = Cut{Vec{1.0, 1.0}, 0.0};
-        static auto cut2 = Cut{Vec{-1.0, 1.0}, 0.0};
-
         const auto x = xc[0];
         const auto y = xc[1];
 
@@ -52,11 +51,11 @@ struct MyOracle {
             if (fj > 0.0) {
                 switch (this->idx) {
                     case 0:
-                        cut1.second = fj;
-                        return &cut1;
+                        this->cut1.second = fj;
+                        return &this->cut1;
                     case 1:
-                        cut2.second = fj;
-                        return &cut2;
+                        this->cut2.second = fj;
+                        return &this->cut2;
                     default:
                         exit(0);
                 }
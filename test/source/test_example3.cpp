@@ -5,6 +5,7 @@
 #include <ellalgo/ell.hpp>            // for ell
 #include <ellalgo/ell_config.hpp>     // for CInfo, CutStatus, CutStatus::...
 #include <utility>                    // for pair
+#include <valarray>                   // for valarray
 
 using Vec = std::valarray<double>;
 
@@ -14,6 +15,10 @@ struct MyOracle3 {
     using Cut = std::pair<Vec, double>;
 
     int idx = -1;
+    Cut cut1 = Cut{Vec{-1.0, 0.0}, 0.0};
+    Cut cut2 = Cut{Vec{0.0, -1.0}, 0.0};
+    Cut cut3 = Cut{Vec{1.0, 1.0}, 0.0};
+    Cut cut4 = Cut{Vec{2.0, -3.0}, 0.0};
     double target = -1e100;
 
     void update(double gamma) { this->target = gamma; }
@@ -27,15 +32,10 @@ struct MyOracle3 {
      * of `xc` are accessed as `x` and `y` using `xc[0]
      *
      * @return A pointer to a `Cut` object is being returned from the `assess_feas` function. The
-     * function returns a pointer to one of the static `Cut` objects (`cut1`, `cut2`, `cut3`,
+     * function returns a pointer to one of the member `Cut` objects (`cut1`, `cut2`, `cut3`,
      * `cut4`) based on the constraints being assessed.
      */
     auto assess_feas(const Vec &xc) -> Cut * {
-        static auto cut1 = Cut{Vec{-1.0, 0.0}, 0.0};
-        static auto cut2 = Cut{Vec{0.0, -1.0}, 0.0};
-        static auto cut3 = Cut{Vec{1.0, 1.0}, 0.0};
-        static auto cut4 = Cut{Vec{2.0, -3.0}, 0.0};
-
         const auto x = xc[0];
         const auto y = xc[1];
 
@@ -64,17 +64,17 @@ struct MyOracle3 {
             if (fj > 0.0) {
                 switch (this->idx) {
                     case 0:
-                        cut1.second = fj;
-                        return &cut1;
+                        this->cut1.second = fj;
+                        return &this->cut1;
                     case 1:
-                        cut2.second = fj;
-                        return &cut2;
+                        this->cut2.second = fj;
+                        return &this->cut2;
                     case 2:
-                        cut3.second = fj;
-                        return &cut3;
+                        this->cut3.second = fj;
+                        return &this->cut3;
                     case 3:
-                        cut4.second = fj;
-                        return &cut4;
+                        this->cut4.second = fj;
+                        return &this->cut4;
                     default:
                         exit(0);
                 }
@@ -94,3 +94,57 @@ TEST_CASE("Example 2, test feasible") {
     const auto num_iters = std::get<1>(result);
     CHECK_EQ(num_iters, 34);
 }
+
+/**
+ * @brief As MyOracle3, but with y >= -2 and 2 x - 3 y <= gamma, so feasible for gamma >= -8
+ */
+struct MyOracle4 {
+    using Cut = std::pair<Vec, double>;
+
+    int idx = -1;
+    double target = -1e100;
+    size_t num_calls = 0U;
+    Cut cuts[4] = {{Vec{-1.0, 0.0}, 0.0},
+                   {Vec{0.0, -1.0}, 0.0},
+                   {Vec{1.0, 1.0}, 0.0},
+                   {Vec{2.0, -3.0}, 0.0}};
+
+    void update(double gamma) { this->target = gamma; }
+
+    auto assess_feas(const Vec &xc) -> Cut * {
+        ++this->num_calls;
+        const auto x = xc[0];
+        const auto y = xc[1];
+        const double fj[4] = {-x - 1.0, -y - 2.0, x + y - 1.0, 2.0 * x - 3.0 * y - this->target};
+        for (int i = 0; i != 4; ++i) {
+            this->idx = (this->idx + 1) % 4;  // round robin
+            if (fj[this->idx] > 0.0) {
+                this->cuts[this->idx].second = fj[this->idx];
+                return &this->cuts[this->idx];
+            }
+        }
+        return nullptr;
+    }
+};
+
+TEST_CASE("Example 3, warm start") {
+    const auto options = Options{2000, 1e-8};
+    const auto intvl = std::pair<double, double>{-100.0, 100.0};
+
+    auto ellip1 = Ell<Vec>(Vec{100.0, 100.0}, Vec{0.0, 0.0});
+    auto omega1 = MyOracle4{};
+    BSearchAdaptor<MyOracle4, Ell<Vec> > adaptor1(omega1, ellip1, options);
+    const auto result1 = bsearch(adaptor1, intvl, options);
+
+    auto ellip2 = Ell<Vec>(Vec{100.0, 100.0}, Vec{0.0, 0.0});
+    auto omega2 = MyOracle4{};
+    BSearchAdaptor<MyOracle4, Ell<Vec> > adaptor2(omega2, ellip2, options);
+    adaptor2.warm_start = true;
+    const auto result2 = bsearch(adaptor2, intvl, options);
+
+    CHECK_EQ(std::get<1>(result2), std::get<1>(result1));
+    CHECK_EQ(std::get<0>(result1), doctest::Approx(-8.0).epsilon(1e-4));  // at x = -1, y = 2
+    CHECK_EQ(std::get<0>(result2), doctest::Approx(-8.0).epsilon(1e-4));
+    CHECK(omega2.num_calls < omega1.num_calls);
+}
+
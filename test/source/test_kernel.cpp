@@ -0,0 +1,362 @@
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK
+
+#include <cmath>                       // for sin, cos
+#include <ellalgo/ell_kernel.hpp>      // for sym_matvec, set_isa, ...
+#include <ellalgo/ell_sym_matrix.hpp>  // for SymMatrix, SymMatrixF
+#include <valarray>                    // for valarray
+#include <vector>                      // for vector
+
+using Vec = std::valarray<double>;
+
+static const auto N = 37U;  // not a multiple of the vector width
+
+static auto make_matrix() -> SymMatrix {
+    SymMatrix mq(N);
+    for (auto j = 0U; j != N; ++j) {
+        for (auto i = j; i != N; ++i) {
+            mq(i, j) = i == j ? 4.0 + 0.1 * i : 0.3 * std::sin(1.0 + i * 7 + j);
+        }
+    }
+    return mq;
+}
+
+static auto make_vector(double phase) -> Vec {
+    Vec v(N);
+    for (auto i = 0U; i != N; ++i) {
+        v[i] = std::cos(phase + 0.7 * i);
+    }
+    return v;
+}
+
+struct KernelResult {
+    double omega;
+    Vec mv;
+    SymMatrix q1;
+    Vec lg;
+    Vec ltg;
+    SymMatrix q2;
+    Vec v;
+};
+
+static auto run_kernels() -> KernelResult {
+    const auto g = make_vector(0.5);
+    Vec mv(N);
+    const auto mq = make_matrix();
+    const auto omega = ell_kernel::sym_matvec(mq, &g[0], &mv[0]);
+    auto q1 = mq;
+    ell_kernel::sym_rank_one(q1, 0.01, &mv[0]);
+    auto lg = make_vector(1.5);
+    ell_kernel::lower_solve(mq, &lg[0]);
+    auto ltg = make_vector(2.5);
+    ell_kernel::lower_transpose_solve(mq, &ltg[0]);
+    auto q2 = mq;
+    auto v = g;
+    const Vec d = lg * 0.25;
+    ell_kernel::ldl_rank_one(q2, &v[0], &lg[0], &d[0], 3.0);
+    return {omega, mv, q1, lg, ltg, q2, v};
+}
+
+TEST_CASE("Kernel: sym_matvec against the full product") {
+    REQUIRE(ell_kernel::set_isa(ell_kernel::Isa::Scalar));
+    const auto mq = make_matrix();
+    const auto g = make_vector(0.5);
+    Vec mv(N);
+    const auto omega = ell_kernel::sym_matvec(mq, &g[0], &mv[0]);
+    auto expected = 0.0;
+    for (auto i = 0U; i != N; ++i) {
+        auto s = 0.0;
+        for (auto j = 0U; j != N; ++j) {
+            s += mq(i, j) * g[j];
+        }
+        CHECK_EQ(mv[i], doctest::Approx(s));
+        expected += s * g[i];
+    }
+    CHECK_EQ(omega, doctest::Approx(expected));
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
+
+TEST_CASE("Kernel: solves") {
+    REQUIRE(ell_kernel::set_isa(ell_kernel::Isa::Scalar));
+    const auto mq = make_matrix();
+    const auto g = make_vector(1.5);
+    auto x = g;
+    ell_kernel::lower_solve(mq, &x[0]);
+    for (auto i = 0U; i != N; ++i) {  // L * x == g, with a unit diagonal
+        auto s = x[i];
+        for (auto j = 0U; j != i; ++j) {
+            s += mq(i, j) * x[j];
+        }
+        CHECK_EQ(s, doctest::Approx(g[i]));
+    }
+    auto y = g;
+    ell_kernel::lower_transpose_solve(mq, &y[0]);
+    for (auto i = 0U; i != N; ++i) {  // L' * y == g
+        auto s = y[i];
+        for (auto j = i + 1; j != N; ++j) {
+            s += mq(j, i) * y[j];
+        }
+        CHECK_EQ(s, doctest::Approx(g[i]));
+    }
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
+
+TEST_CASE("Kernel: every instruction set gives the scalar result") {
+    REQUIRE(ell_kernel::set_isa(ell_kernel::Isa::Scalar));
+    const auto ref = run_kernels();
+    for (auto isa : {ell_kernel::Isa::Avx2, ell_kernel::Isa::Avx512, ell_kernel::Isa::Neon}) {
+        if (!ell_kernel::set_isa(isa)) {
+            continue;  // not supported here
+        }
+        CAPTURE(ell_kernel::isa_name(isa));
+        const auto res = run_kernels();
+        CHECK_EQ(res.omega, ref.omega);
+        for (auto i = 0U; i != N; ++i) {
+            CHECK_EQ(res.mv[i], ref.mv[i]);
+            CHECK_EQ(res.lg[i], ref.lg[i]);
+            CHECK_EQ(res.ltg[i], ref.ltg[i]);
+            CHECK_EQ(res.v[i], ref.v[i]);
+            for (auto j = 0U; j <= i; ++j) {
+                CHECK_EQ(res.q1(i, j), ref.q1(i, j));
+                CHECK_EQ(res.q2(i, j), ref.q2(i, j));
+            }
+        }
+    }
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+    CHECK_EQ(ell_kernel::active_isa(), ell_kernel::best_isa());
+}
+
+TEST_CASE("Kernel: fused rank-one update and matvec") {
+    for (auto isa : {ell_kernel::Isa::Scalar, ell_kernel::Isa::Avx2, ell_kernel::Isa::Avx512,
+                     ell_kernel::Isa::Neon}) {
+        if (!ell_kernel::set_isa(isa)) {
+            continue;  // not supported here
+        }
+        CAPTURE(ell_kernel::isa_name(isa));
+        const auto u = make_vector(0.5);
+        const auto g = make_vector(1.5);
+        auto q1 = make_matrix();
+        Vec mv1(N);
+        ell_kernel::sym_rank_one(q1, 0.01, &u[0]);
+        const auto omega1 = ell_kernel::sym_matvec(q1, &g[0], &mv1[0]);
+        auto q2 = make_matrix();
+        Vec mv2(N);
+        const auto omega2 = ell_kernel::sym_update_matvec(q2, 0.01, &u[0], &g[0], &mv2[0]);
+        CHECK_EQ(omega1, omega2);
+        for (auto i = 0U; i != N; ++i) {
+            CHECK_EQ(mv1[i], mv2[i]);
+            for (auto j = 0U; j <= i; ++j) {
+                CHECK_EQ(q1(i, j), q2(i, j));
+            }
+        }
+    }
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
+
+TEST_CASE("Kernel: several products in one pass") {
+    const auto ndim = 613U;  // panels of 24 columns
+    auto mq = SymMatrix(ndim);
+    auto g = std::vector<Vec>(3U, Vec(ndim));
+    auto out = std::vector<Vec>(3U, Vec(ndim));
+    for (auto j = 0U; j != ndim; ++j) {
+        for (auto k = 0U; k != 3U; ++k) {
+            g[k][j] = std::cos(0.5 * k + 0.7 * j);
+        }
+        for (auto i = j; i != ndim; ++i) {
+            mq(i, j) = i == j ? 4.0 + 0.1 * i : 0.3 * std::sin(1.0 + i * 7 + j);
+        }
+    }
+    const double *gs[] = {&g[0][0], &g[1][0], &g[2][0]};
+    double *outs[] = {&out[0][0], &out[1][0], &out[2][0]};
+    double omega[3];
+    ell_kernel::sym_matvec_multi(mq, gs, outs, omega, 3U);
+    for (auto k = 0U; k != 3U; ++k) {
+        auto ref = Vec(ndim);
+        CHECK_EQ(omega[k], ell_kernel::sym_matvec(mq, &g[k][0], &ref[0]));
+        auto num_diff = 0U;
+        for (auto i = 0U; i != ndim; ++i) {
+            num_diff += out[k][i] != ref[i];
+        }
+        CHECK_EQ(num_diff, 0U);
+    }
+}
+
+TEST_CASE("Kernel: LDL' update and solve in one pass") {
+    for (auto isa : {ell_kernel::Isa::Scalar, ell_kernel::Isa::Avx2, ell_kernel::Isa::Avx512,
+                     ell_kernel::Isa::Neon}) {
+        if (!ell_kernel::set_isa(isa)) {
+            continue;  // not supported here
+        }
+        CAPTURE(ell_kernel::isa_name(isa));
+        const auto g = make_vector(0.5);
+        auto lg = g;
+        auto q1 = make_matrix();
+        ell_kernel::lower_solve(q1, &lg[0]);
+        Vec d(N);
+        for (auto i = 0U; i != N; ++i) {
+            d[i] = lg[i] * q1(i, i);
+        }
+        auto v1 = g;
+        ell_kernel::ldl_rank_one(q1, &v1[0], &lg[0], &d[0], 3.0);
+        auto x1 = make_vector(1.5);
+        ell_kernel::lower_solve(q1, &x1[0]);
+
+        auto q2 = make_matrix();
+        auto v2 = g;
+        auto x2 = make_vector(1.5);
+        ell_kernel::ldl_update_solve(q2, &v2[0], 3.0, &x2[0]);
+        for (auto i = 0U; i != N; ++i) {
+            CHECK_EQ(x2[i], x1[i]);
+            CHECK_EQ(v2[i], v1[i]);
+            for (auto j = 0U; j <= i; ++j) {
+                CHECK_EQ(q2(i, j), q1(i, j));
+            }
+        }
+    }
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
+
+TEST_CASE("Kernel: the threads give the serial result") {
+    const auto ndim = 613U;  // 10 tiles of 64, the last one partial
+    auto mq = SymMatrix(ndim);
+    auto u = Vec(ndim);
+    auto g = Vec(ndim);
+    for (auto j = 0U; j != ndim; ++j) {
+        u[j] = std::cos(0.5 + 0.7 * j);
+        g[j] = std::sin(1.5 + 0.3 * j);
+        for (auto i = j; i != ndim; ++i) {
+            mq(i, j) = i == j ? 4.0 + 0.1 * i : 0.3 * std::sin(1.0 + i * 7 + j);
+        }
+    }
+    auto run = [&](SymMatrix &q, Vec &mv) {
+        auto omega = ell_kernel::sym_update_matvec(q, 0.01, &u[0], &g[0], &mv[0]);
+        ell_kernel::sym_rank_one(q, 0.02, &mv[0]);
+        omega += ell_kernel::sym_matvec(q, &u[0], &mv[0]);
+        return omega;
+    };
+    for (auto isa : {ell_kernel::Isa::Scalar, ell_kernel::Isa::Avx2, ell_kernel::Isa::Avx512,
+                     ell_kernel::Isa::Neon}) {
+        if (!ell_kernel::set_isa(isa)) {
+            continue;  // not supported here
+        }
+        CAPTURE(ell_kernel::isa_name(isa));
+        auto q1 = mq;
+        auto mv1 = Vec(ndim);
+        const auto omega1 = run(q1, mv1);
+        ell_kernel::set_num_threads(4U, 100U);
+        CHECK_EQ(ell_kernel::num_threads(), 4U);
+        auto q2 = mq;
+        auto mv2 = Vec(ndim);
+        const auto omega2 = run(q2, mv2);
+        ell_kernel::set_num_threads(1U);
+        CHECK_EQ(omega1, omega2);
+        auto num_diff = 0U;
+        for (auto i = 0U; i != ndim; ++i) {
+            num_diff += mv1[i] != mv2[i];
+            for (auto j = 0U; j <= i; ++j) {
+                num_diff += q1(i, j) != q2(i, j);
+            }
+        }
+        CHECK_EQ(num_diff, 0U);
+    }
+    CHECK_EQ(ell_kernel::num_threads(), 1U);
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
+
+TEST_CASE("Kernel: batched kernels give the result of each lane") {
+    const auto ndim = 7U;
+    const auto num = 11U;
+    const auto stride = 16U;
+    auto mqs = std::vector<SymMatrix>{};
+    auto mq = Vec(0.0, ndim * (ndim + 1) / 2 * stride);
+    auto g = Vec(0.0, ndim * stride);
+    auto r = Vec(0.0, stride);
+    auto s = Vec(0.0, stride);
+    for (auto k = 0U; k != num; ++k) {
+        mqs.emplace_back(ndim);
+        auto pos = 0U;
+        for (auto j = 0U; j != ndim; ++j) {
+            for (auto i = j; i != ndim; ++i, ++pos) {
+                mqs[k](i, j) = i == j ? 4.0 + 0.1 * i : 0.3 * std::sin(1.0 + i * 7 + j + k);
+                mq[pos * stride + k] = mqs[k](i, j);
+            }
+            g[j * stride + k] = std::cos(0.5 + 0.7 * j + k);
+        }
+        r[k] = 0.01 * k;
+        s[k] = 0.1;
+    }
+    for (auto isa : {ell_kernel::Isa::Scalar, ell_kernel::Isa::Avx2, ell_kernel::Isa::Avx512,
+                     ell_kernel::Isa::Neon}) {
+        if (!ell_kernel::set_isa(isa)) {
+            continue;  // not supported here
+        }
+        CAPTURE(ell_kernel::isa_name(isa));
+        auto bq = mq;
+        auto qg = Vec(0.0, ndim * stride);
+        auto omega = Vec(0.0, stride);
+        auto xc = Vec(0.0, ndim * stride);
+        ell_kernel::batch_matvec(&bq[0], &g[0], &qg[0], &omega[0], ndim, stride);
+        ell_kernel::batch_rank_one(&bq[0], &qg[0], &r[0], &s[0], &xc[0], ndim, stride);
+        for (auto k = 0U; k != num; ++k) {
+            auto q1 = mqs[k];
+            auto gk = Vec(ndim);
+            for (auto i = 0U; i != ndim; ++i) {
+                gk[i] = g[i * stride + k];
+            }
+            auto mv = Vec(ndim);
+            CHECK_EQ(omega[k], ell_kernel::sym_matvec(q1, &gk[0], &mv[0]));
+            ell_kernel::sym_rank_one(q1, r[k], &mv[0]);
+            auto pos = 0U;
+            for (auto j = 0U; j != ndim; ++j) {
+                CHECK_EQ(qg[j * stride + k], mv[j]);
+                CHECK_EQ(xc[j * stride + k], -(mv[j] * s[k]));
+                for (auto i = j; i != ndim; ++i, ++pos) {
+                    CHECK_EQ(bq[pos * stride + k], q1(i, j));
+                }
+            }
+        }
+    }
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
+
+TEST_CASE("Kernel: float elements, double arithmetic") {
+    const auto u = make_vector(0.5);
+    const auto g = make_vector(1.5);
+    const auto mq = make_matrix();
+    auto mq_f = SymMatrixF(N);
+    for (auto j = 0U; j != N; ++j) {
+        for (auto i = j; i != N; ++i) {
+            mq_f(i, j) = float(mq(i, j));
+        }
+    }
+    REQUIRE(ell_kernel::set_isa(ell_kernel::Isa::Scalar));
+    auto ref_q = mq_f;
+    Vec ref_mv(N);
+    ell_kernel::sym_rank_one(ref_q, 0.01, &u[0]);
+    const auto ref_omega = ell_kernel::sym_matvec(ref_q, &g[0], &ref_mv[0]);
+
+    auto q1 = mq;  // the same product in double
+    Vec mv1(N);
+    ell_kernel::sym_rank_one(q1, 0.01, &u[0]);
+    CHECK_EQ(ref_omega, doctest::Approx(ell_kernel::sym_matvec(q1, &g[0], &mv1[0])).epsilon(1e-6));
+
+    for (auto isa : {ell_kernel::Isa::Scalar, ell_kernel::Isa::Avx2, ell_kernel::Isa::Avx512,
+                     ell_kernel::Isa::Neon}) {
+        if (!ell_kernel::set_isa(isa)) {
+            continue;  // not supported here
+        }
+        CAPTURE(ell_kernel::isa_name(isa));
+        auto q2 = mq_f;
+        Vec mv2(N);
+        const auto omega2 = ell_kernel::sym_update_matvec(q2, 0.01, &u[0], &g[0], &mv2[0]);
+        CHECK_EQ(omega2, ref_omega);
+        for (auto i = 0U; i != N; ++i) {
+            CHECK_EQ(mv2[i], ref_mv[i]);
+            CHECK_EQ(mv2[i], doctest::Approx(mv1[i]).epsilon(1e-6));
+            for (auto j = 0U; j <= i; ++j) {
+                CHECK_EQ(q2(i, j), ref_q(i, j));
+            }
+        }
+    }
+    CHECK(ell_kernel::set_isa(ell_kernel::best_isa()));
+}
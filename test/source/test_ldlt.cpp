@@ -1,8 +1,14 @@
 #define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
 #include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK
 
+#include <cmath>  // for sqrt
+#include <ellalgo/ell_kernel.hpp>  // for set_num_threads
 #include <ellalgo/ell_matrix.hpp>
 #include <ellalgo/oracles/ldlt_mgr.hpp>  // for LDLTMgr
+#include <functional>                    // for function
+#include <random>                        // for mt19937, normal_distribution
+#include <utility>                       // for pair
+#include <vector>                        // for vector
 
 using Vec = std::valarray<double>;
 
@@ -137,4 +143,224 @@ TEST_CASE("Cholesky test sqrt") {
     CHECK_EQ(R(2, 0), doctest::Approx(0.0));
     CHECK_EQ(R(2, 1), doctest::Approx(0.0));
     CHECK_EQ(R(2, 2), doctest::Approx(1.0));
-}
\ No newline at end of file
+}
+
+TEST_CASE("Cholesky test, std::function and inlined callable agree") {
+    Matrix m2(4U);
+    m2.row(0) = Vec{18.0, 22.0, 54.0, 42.0};
+    m2.row(1) = Vec{22.0, -70.0, 86.0, 62.0};
+    m2.row(2) = Vec{54.0, 86.0, -174.0, 134.0};
+    m2.row(3) = Vec{42.0, 62.0, 134.0, -106.0};
+    auto get_elem = [&m2](size_t i, size_t j) { return m2(i, j); };
+    const auto fn = std::function<double(size_t, size_t)>{get_elem};
+
+    auto ldlt_mgr1 = LDLTMgr(4);
+    auto ldlt_mgr2 = LDLTMgr(4);
+    CHECK_EQ(ldlt_mgr1.factor(fn), ldlt_mgr2.factor(get_elem));
+    CHECK_EQ(ldlt_mgr1.pos, ldlt_mgr2.pos);
+    CHECK_EQ(ldlt_mgr1.witness(), ldlt_mgr2.witness());
+
+    CHECK_EQ(ldlt_mgr1.factor_with_allow_semidefinite(fn),
+             ldlt_mgr2.factor_with_allow_semidefinite(get_elem));
+    CHECK_EQ(ldlt_mgr1.pos, ldlt_mgr2.pos);
+}
+
+/**
+ * @brief The row-by-row elimination, as a reference for the blocked one
+ *
+ * @return pos and T (L below, D on, L D above the diagonal)
+ */
+static auto reference_factor(const Matrix &A, size_t n, bool allow_semidefinite)
+    -> std::pair<std::pair<size_t, size_t>, Matrix> {
+    auto T = Matrix(n);
+    auto start = size_t{0U};
+    auto stop = size_t{0U};
+    for (auto i = 0U; i != n; ++i) {
+        auto d = A(i, start);
+        for (auto j = start; j != i; ++j) {
+            T(j, i) = d;
+            T(i, j) = d / T(j, j);
+            auto s = j + 1;
+            d = A(i, s);
+            for (auto k = start; k != s; ++k) {
+                d -= T(i, k) * T(k, s);
+            }
+        }
+        T(i, i) = d;
+        if (allow_semidefinite ? d < 0.0 : d <= 0.0) {
+            stop = i + 1;
+            break;
+        }
+        if (allow_semidefinite && d == 0.0) {
+            start = i + 1;
+        }
+    }
+    return {{start, stop}, T};
+}
+
+static auto random_sym(size_t n, double shift, unsigned seed) -> Matrix {
+    auto gen = std::mt19937{seed};
+    auto dist = std::normal_distribution<double>{};
+    auto A = Matrix(n);
+    for (auto i = 0U; i != n; ++i) {
+        for (auto j = 0U; j <= i; ++j) {
+            A(i, j) = A(j, i) = dist(gen);
+        }
+        A(i, i) += shift;
+    }
+    return A;
+}
+
+TEST_CASE("Cholesky test, blocked is the same as row by row") {
+    for (const auto n : {5U, 8U, 17U, 100U}) {
+        // spd, indefinite (stops somewhere inside), and with a zero pivot
+        const auto root_n = std::sqrt(1.0 * n);
+        for (const auto shift : {3.0 * root_n + 3.0, 0.5 * root_n, -1.0}) {
+            auto A = random_sym(n, shift < 0.0 ? 3.0 * root_n + 3.0 : shift, n);
+            if (shift < 0.0) {
+                const auto z = n / 2;
+                for (auto j = 0U; j != n; ++j) {
+                    A(z, j) = A(j, z) = 0.0;
+                }
+            }
+            for (const auto allow : {false, true}) {
+                const auto ref = reference_factor(A, n, allow);
+                auto ldlt_mgr = LDLTMgr(n);
+                const auto get_elem = [&A](size_t i, size_t j) { return A(i, j); };
+                const auto spd = allow ? ldlt_mgr.factor_with_allow_semidefinite(get_elem)
+                                       : ldlt_mgr.factor(get_elem);
+                CHECK_EQ(spd, ref.first.second == 0U);
+                CHECK_EQ(ldlt_mgr.pos, ref.first);
+                const auto &T = ref.second;
+                if (spd) {
+                    if (ldlt_mgr.pos.first == 0U) {
+                        auto R = Matrix(n);
+                        ldlt_mgr.sqrt(R);
+                        auto same = true;
+                        for (auto i = 0U; i != n; ++i) {
+                            const auto rii = std::sqrt(T(i, i));
+                            same = same && R(i, i) == rii;
+                            for (auto j = i + 1; j != n; ++j) {
+                                same = same && R(i, j) == T(j, i) * rii;
+                            }
+                        }
+                        CHECK(same);
+                    }
+                    continue;
+                }
+                const auto m = ref.first.second - 1;
+                CHECK_EQ(ldlt_mgr.witness(), -T(m, m));
+                auto v = Vec(0.0, n);
+                v[m] = 1.0;
+                for (auto i = m; i > ref.first.first; --i) {
+                    for (auto k = i; k != m + 1; ++k) {
+                        v[i - 1] -= T(k, i - 1) * v[k];
+                    }
+                }
+                auto same = true;
+                for (auto i = ref.first.first; i != m + 1; ++i) {
+                    same = same && ldlt_mgr.witness_vec[i] == v[i];
+                }
+                CHECK(same);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Is the factorization of ldlt_mgr1 the same as the one of ldlt_mgr2
+ */
+static auto same_factors(LDLTMgr &ldlt_mgr1, LDLTMgr &ldlt_mgr2) -> bool {
+    const auto n = ldlt_mgr1._n;
+    if (ldlt_mgr1.pos != ldlt_mgr2.pos) {
+        return false;
+    }
+    if (ldlt_mgr1.is_spd()) {
+        auto R1 = Matrix(n);
+        auto R2 = Matrix(n);
+        ldlt_mgr1.sqrt(R1);
+        ldlt_mgr2.sqrt(R2);
+        auto same = true;
+        for (auto i = 0U; i != n; ++i) {
+            for (auto j = 0U; j != n; ++j) {
+                same = same && R1(i, j) == R2(i, j);
+            }
+        }
+        return same;
+    }
+    auto same = ldlt_mgr1.witness() == ldlt_mgr2.witness();
+    for (auto i = ldlt_mgr1.pos.first; i != ldlt_mgr1.pos.second; ++i) {
+        same = same && ldlt_mgr1.witness_vec[i] == ldlt_mgr2.witness_vec[i];
+    }
+    return same;
+}
+
+TEST_CASE("Cholesky test, resuming after the unchanged rows") {
+    const auto n = 100U;
+    auto A = random_sym(n, 33.0, 1U);
+    auto resumed = LDLTMgr(n);
+    const auto get_elem = [&A](size_t i, size_t j) { return A(i, j); };
+    CHECK(resumed.factor(get_elem, n));  // nothing to reuse yet
+
+    // change the rows from `first` on, with a spd, an indefinite and a spd result
+    const auto firsts = {37U, 60U, 5U, 90U};
+    const auto shifts = {33.0, -40.0, 33.0, 33.0};
+    auto shift = shifts.begin();
+    for (const auto first : firsts) {
+        const auto B = random_sym(n, *shift++, first);
+        for (auto i = first; i != n; ++i) {
+            for (auto j = 0U; j <= i; ++j) {
+                A(i, j) = A(j, i) = B(i, j);
+            }
+        }
+        auto fresh = LDLTMgr(n);
+        CHECK_EQ(resumed.factor(get_elem, first), fresh.factor(get_elem));
+        CHECK(same_factors(resumed, fresh));
+    }
+
+    // the previous call stopped at row 1, before the unchanged rows end
+    A(0, 0) = 1e-3;
+    A(1, 1) = -1.0;
+    CHECK(!resumed.factor(get_elem, 0U));
+    CHECK_EQ(resumed.pos.second, 2U);
+    A(1, 1) = 33.0;
+    for (auto i = 2U; i != n; ++i) {
+        A(i, i) += 1e3;
+    }
+    auto fresh = LDLTMgr(n);
+    CHECK_EQ(resumed.factor_with_allow_semidefinite(get_elem, 1U),
+             fresh.factor_with_allow_semidefinite(get_elem));
+    CHECK(same_factors(resumed, fresh));
+}
+
+TEST_CASE("Cholesky test, sym_quad_all") {
+    const auto m = 20U;
+    const auto n = 37U;
+    auto F = std::vector<Matrix>{};
+    for (auto k = 0U; k != n; ++k) {
+        F.push_back(random_sym(m, 0.0, 100U + k));
+    }
+    const auto A = random_sym(m, 3.0, 3U);
+    auto ldlt_mgr = LDLTMgr(m);
+    REQUIRE(!ldlt_mgr.factorize(A));
+    ldlt_mgr.witness();
+    REQUIRE(ldlt_mgr.pos.second > 2U);
+
+    const auto stacked = InterleavedMats(F, m);
+    auto grad1 = Vec(n);
+    auto grad2 = Vec(n);
+    ldlt_mgr.sym_quad_all(stacked, make_span(grad1));
+    ell_kernel::set_num_threads(3U);
+    ldlt_mgr.sym_quad_all(stacked, make_span(grad2), 3U);
+    ell_kernel::set_num_threads(1U);
+    auto close = true;
+    auto same = true;
+    for (auto k = 0U; k != n; ++k) {
+        const auto expected = ldlt_mgr.sym_quad(F[k]);
+        close = close && grad1[k] == doctest::Approx(expected).epsilon(1e-12);
+        same = same && grad2[k] == grad1[k];  // the threads do not change the sums
+    }
+    CHECK(close);
+    CHECK(same);
+}
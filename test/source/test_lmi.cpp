@@ -4,14 +4,18 @@
 #define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
 #include <doctest/doctest.h>  // for ResultBuilder, CHECK, TestCase
 
-#include <ellalgo/cutting_plane.hpp>       // for cutting_plane_optim
-#include <ellalgo/ell.hpp>                 // for Ell
-#include <ellalgo/ell_matrix.hpp>          // for EllStable
-#include <ellalgo/ell_stable.hpp>          // for EllStable
-#include <ellalgo/oracles/lmi_oracle.hpp>  // for LmiOracle
-#include <tuple>                           // for tuple
+#include <ellalgo/cutting_plane.hpp>                 // for cutting_plane_optim
+#include <ellalgo/ell.hpp>                           // for Ell
+#include <ellalgo/ell_kernel.hpp>                    // for set_num_threads
+#include <ellalgo/ell_matrix.hpp>                    // for EllStable
+#include <ellalgo/ell_stable.hpp>                    // for EllStable
+#include <ellalgo/oracles/lmi0_oracle.hpp>           // for Lmi0Oracle
+#include <ellalgo/oracles/lmi_composite_oracle.hpp>  // for LmiCompositeOracle
+#include <ellalgo/oracles/lmi_oracle.hpp>            // for LmiOracle
+#include <ellalgo/oracles/structured_sym.hpp>        // for SparseSym, LowRankSym
+#include <tuple>                                     // for tuple
 #include <valarray>
-#include <vector>  // for vector
+#include <vector>                                    // for vector
 
 /**
  * @brief MyLMIOracle
@@ -43,10 +47,14 @@ class MyLMIOracle {
      * @param[in] B2 The parameter B2 is a matrix.
      * @param[in] c The parameter `c` is a vector of type `Vec`. It is being moved into the
      * `MyLMIOracle` object.
+     * @param[in] stacked_grad evaluate the gradients with `LDLTMgr::sym_quad_all`
      */
     MyLMIOracle(size_t m1, const std::vector<Matrix> &F1, const Matrix &B1, size_t m2,
-                const std::vector<Matrix> &F2, const Matrix &B2, Vec c)
-        : lmi1{m1, F1, B1}, lmi2{m2, F2, B2}, c{std::move(c)} {}
+                const std::vector<Matrix> &F2, const Matrix &B2, Vec c, bool stacked_grad = false)
+        : lmi1{m1, F1, B1}, lmi2{m2, F2, B2}, c{std::move(c)} {
+        this->lmi1.stacked_grad = stacked_grad;
+        this->lmi2.stacked_grad = stacked_grad;
+    }
 
     /**
      * The function assess_optim assesses the optimality of a given vector x by checking for certain
@@ -198,3 +206,398 @@ TEST_CASE("LMI test ") {
     CHECK_NE(x.size(), 0U);
     CHECK_EQ(num_iters, 281);
 }
+
+TEST_CASE("LMI test (stacked gradient)") {
+    using Vec = std::valarray<double>;
+    using M_t = std::vector<Matrix>;
+
+    auto c = Vec{1.0, -1.0, 1.0};
+
+    auto m0F1 = Matrix(2);
+    m0F1.row(0) = Vec{-7.0, -11.0};
+    m0F1.row(1) = Vec{-11.0, 3.0};
+
+    auto m1F1 = Matrix(2);
+    m1F1.row(0) = Vec{7.0, -18.0};
+    m1F1.row(1) = Vec{-18.0, 8.0};
+
+    auto m2F1 = Matrix(2);
+    m2F1.row(0) = Vec{-2.0, -8.0};
+    m2F1.row(1) = Vec{-8.0, 1.0};
+
+    auto F1 = M_t{m0F1, m1F1, m2F1};
+
+    auto B1 = Matrix(2);
+    B1.row(0) = Vec{33.0, -9.0};
+    B1.row(1) = Vec{-9.0, 26.0};
+
+    auto m0F2 = Matrix(3);
+    m0F2.row(0) = Vec{-21.0, -11.0, 0.0};
+    m0F2.row(1) = Vec{-11.0, 10.0, 8.0};
+    m0F2.row(2) = Vec{0.0, 8.0, 5.0};
+
+    auto m1F2 = Matrix(3);
+    m1F2.row(0) = Vec{0.0, 10.0, 16.0};
+    m1F2.row(1) = Vec{10.0, -10.0, -10.0};
+    m1F2.row(2) = Vec{16.0, -10.0, 3.0};
+
+    auto m2F2 = Matrix(3);
+    m2F2.row(0) = Vec{-5.0, 2.0, -17.0};
+    m2F2.row(1) = Vec{2.0, -6.0, 8.0};
+    m2F2.row(2) = Vec{-17.0, 8.0, 6.0};
+
+    auto F2 = M_t{m0F2, m1F2, m2F2};
+
+    auto B2 = Matrix(3);
+    B2.row(0) = Vec{14.0, 9.0, 40.0};
+    B2.row(1) = Vec{9.0, 91.0, 10.0};
+    B2.row(2) = Vec{40.0, 10.0, 15.0};
+
+    auto omega = MyLMIOracle(2, F1, B1, 3, F2, B2, std::move(c), true);
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+
+    auto gamma = 1e100;  // should be std::numeric_limits<double>::max()
+    const auto result = cutting_plane_optim(omega, ellip, gamma);
+    auto x = std::get<0>(result);
+    auto num_iters = std::get<1>(result);
+
+
+    CHECK_NE(x.size(), 0U);
+    CHECK_EQ(num_iters, 281);  // the cuts may differ in the last bits only
+}
+
+/**
+ * @brief Block-diagonal matrix of a 2 x 2 and a 3 x 3 block
+ */
+static auto block_diag(const Matrix &M1, const Matrix &M2) -> Matrix {
+    auto M = Matrix(5);
+    for (auto i = 0U; i != 2; ++i) {
+        for (auto j = 0U; j != 2; ++j) {
+            M(i, j) = M1(i, j);
+        }
+    }
+    for (auto i = 0U; i != 3; ++i) {
+        for (auto j = 0U; j != 3; ++j) {
+            M(i + 2, j + 2) = M2(i, j);
+        }
+    }
+    return M;
+}
+
+TEST_CASE("LMI test, reusing the unchanged rows") {
+    using Vec = std::valarray<double>;
+    using M_t = std::vector<Matrix>;
+
+    auto m1F1 = Matrix(2);
+    m1F1.row(0) = Vec{7.0, -18.0};
+    m1F1.row(1) = Vec{-18.0, 8.0};
+
+    auto m2F1 = Matrix(2);
+    m2F1.row(0) = Vec{-2.0, -8.0};
+    m2F1.row(1) = Vec{-8.0, 1.0};
+
+    auto B1 = Matrix(2);
+    B1.row(0) = Vec{33.0, -9.0};
+    B1.row(1) = Vec{-9.0, 26.0};
+
+    auto m0F2 = Matrix(3);
+    m0F2.row(0) = Vec{-21.0, -11.0, 0.0};
+    m0F2.row(1) = Vec{-11.0, 10.0, 8.0};
+    m0F2.row(2) = Vec{0.0, 8.0, 5.0};
+
+    auto m1F2 = Matrix(3);
+    m1F2.row(0) = Vec{0.0, 10.0, 16.0};
+    m1F2.row(1) = Vec{10.0, -10.0, -10.0};
+    m1F2.row(2) = Vec{16.0, -10.0, 3.0};
+
+    auto m2F2 = Matrix(3);
+    m2F2.row(0) = Vec{-5.0, 2.0, -17.0};
+    m2F2.row(1) = Vec{2.0, -6.0, 8.0};
+    m2F2.row(2) = Vec{-17.0, 8.0, 6.0};
+
+    auto B2 = Matrix(3);
+    B2.row(0) = Vec{14.0, 9.0, 40.0};
+    B2.row(1) = Vec{9.0, 91.0, 10.0};
+    B2.row(2) = Vec{40.0, 10.0, 15.0};
+
+    // x[0] enters only the second block, i.e. the rows 2 to 4
+    const auto F = M_t{block_diag(Matrix(2), m0F2), block_diag(m1F1, m1F2),
+                       block_diag(m2F1, m2F2)};
+    const auto B = block_diag(B1, B2);
+
+    auto omega1 = LmiOracle<Vec, Matrix>(5, F, B);
+    auto omega2 = LmiOracle<Vec, Matrix>(5, F, B);
+    omega2.reuse_prefix = true;
+    auto omega3 = Lmi0Oracle<Vec, Matrix>(5, F);
+    auto omega4 = Lmi0Oracle<Vec, Matrix>(5, F);
+    omega4.reuse_prefix = true;
+    const auto xs = {Vec{0.0, 0.0, 0.0}, Vec{-0.5, 0.0, 0.0}, Vec{-1.0, 0.0, 0.0},
+                     Vec{-1.0, 0.3, -0.2}, Vec{2.0, 0.3, -0.2}, Vec{2.0, 0.3, -0.2}};
+    auto num_cuts = 0U;
+    for (const auto &x : xs) {
+        const auto cut1 = omega1(x);
+        const auto cut2 = omega2(x);
+        REQUIRE_EQ(cut1 == nullptr, cut2 == nullptr);
+        if (cut1 != nullptr) {
+            ++num_cuts;
+            CHECK_EQ(cut1->second, cut2->second);
+            CHECK_EQ(cut1->first[0], cut2->first[0]);
+            CHECK_EQ(cut1->first[1], cut2->first[1]);
+            CHECK_EQ(cut1->first[2], cut2->first[2]);
+        }
+        const auto cut3 = omega3(x);
+        const auto cut4 = omega4(x);
+        REQUIRE_EQ(cut3 == nullptr, cut4 == nullptr);
+        if (cut3 != nullptr) {
+            CHECK_EQ(cut3->second, cut4->second);
+            CHECK_EQ(cut3->first[0], cut4->first[0]);
+        }
+    }
+    CHECK_NE(num_cuts, 0U);
+}
+
+/**
+ * @brief The lower triangle of a dense matrix, as a `SparseSym`
+ */
+static auto to_sparse(const Matrix &M, size_t m) -> SparseSym {
+    auto S = SparseSym(m);
+    for (auto i = 0U; i != m; ++i) {
+        for (auto j = 0U; j <= i; ++j) {
+            if (M(i, j) != 0.0) {
+                S.add(i, j, M(i, j));
+            }
+        }
+    }
+    return S;
+}
+
+TEST_CASE("LMI test, sparse and low-rank F") {
+    using Vec = std::valarray<double>;
+
+    // A tridiagonal B, one single nonzero element per F[k], and rank-one F[k]
+    const auto m = 6U;
+    auto B = Matrix(m);
+    for (auto i = 0U; i != m; ++i) {
+        B(i, i) = 4.0;
+        if (i + 1 != m) {
+            B(i, i + 1) = B(i + 1, i) = -1.0;
+        }
+    }
+    auto F = std::vector<Matrix>(3, Matrix(m));
+    F[0](1, 1) = 2.0;
+    F[1](4, 2) = F[1](2, 4) = 3.0;
+    F[2](5, 5) = -1.0;
+    auto F_sparse = std::vector<SparseSym>{};
+    for (const auto &Fk : F) {
+        F_sparse.push_back(to_sparse(Fk, m));
+    }
+    const auto B_sparse = to_sparse(B, m);
+
+    auto G = std::vector<Matrix>(2, Matrix(m));
+    auto G_low = std::vector<LowRankSym>(2, LowRankSym(m));
+    const auto u = std::vector<Vec>{Vec{1.0, 0.0, -2.0, 0.5, 0.0, 1.0},
+                                    Vec{0.0, 3.0, 1.0, 0.0, -1.0, 0.0}};
+    for (auto k = 0U; k != 2; ++k) {
+        for (auto r = 0U; r != 2; ++r) {
+            const auto d = k == r ? 1.0 : -0.5;
+            G_low[k].add_term(d, u[r]);
+            for (auto i = 0U; i != m; ++i) {
+                for (auto j = 0U; j != m; ++j) {
+                    G[k](i, j) += d * u[r][i] * u[r][j];
+                }
+            }
+        }
+    }
+    CHECK_EQ(F_sparse[1].nnz(), 1U);
+    CHECK_EQ(G_low[0].rank(), 2U);
+
+    auto omega1 = LmiOracle<Vec, Matrix>(m, F, B);
+    auto omega2 = LmiOracle<Vec, SparseSym>(m, F_sparse, B_sparse);
+    auto omega3 = Lmi0Oracle<Vec, Matrix>(m, G);
+    auto omega4 = Lmi0Oracle<Vec, LowRankSym>(m, G_low);
+    const auto xs = {Vec{0.0, 0.0, 0.0}, Vec{2.5, 0.0, 0.0}, Vec{0.0, 1.5, 0.0},
+                     Vec{-1.0, -1.2, 4.0}, Vec{1.0, 1.0, 1.0}};
+    auto num_cuts = 0U;
+    for (const auto &x : xs) {
+        const auto cut1 = omega1(x);
+        const auto cut2 = omega2(x);
+        REQUIRE_EQ(cut1 == nullptr, cut2 == nullptr);
+        if (cut1 != nullptr) {
+            ++num_cuts;
+            CHECK_EQ(cut1->second, cut2->second);  // the same matrix, bit for bit
+            for (auto k = 0U; k != 3; ++k) {
+                CHECK_EQ(cut1->first[k], doctest::Approx(cut2->first[k]));
+            }
+        }
+        const auto y = Vec{x[0], x[1] - 0.5};
+        const auto cut3 = omega3(y);
+        const auto cut4 = omega4(y);
+        REQUIRE_EQ(cut3 == nullptr, cut4 == nullptr);
+        if (cut3 != nullptr) {
+            ++num_cuts;
+            CHECK_EQ(cut3->second, doctest::Approx(cut4->second));
+            CHECK_EQ(cut3->first[0], doctest::Approx(cut4->first[0]));
+            CHECK_EQ(cut3->first[1], doctest::Approx(cut4->first[1]));
+        }
+    }
+    CHECK_GT(num_cuts, 4U);
+}
+
+TEST_CASE("LMI test, in float, refined in double") {
+    using Vec = std::valarray<double>;
+    using M_t = std::vector<Matrix>;
+
+    auto c = Vec{1.0, -1.0, 1.0};
+
+    auto m0F1 = Matrix(2);
+    m0F1.row(0) = Vec{-7.0, -11.0};
+    m0F1.row(1) = Vec{-11.0, 3.0};
+
+    auto m1F1 = Matrix(2);
+    m1F1.row(0) = Vec{7.0, -18.0};
+    m1F1.row(1) = Vec{-18.0, 8.0};
+
+    auto m2F1 = Matrix(2);
+    m2F1.row(0) = Vec{-2.0, -8.0};
+    m2F1.row(1) = Vec{-8.0, 1.0};
+
+    auto F1 = M_t{m0F1, m1F1, m2F1};
+
+    auto B1 = Matrix(2);
+    B1.row(0) = Vec{33.0, -9.0};
+    B1.row(1) = Vec{-9.0, 26.0};
+
+    auto m0F2 = Matrix(3);
+    m0F2.row(0) = Vec{-21.0, -11.0, 0.0};
+    m0F2.row(1) = Vec{-11.0, 10.0, 8.0};
+    m0F2.row(2) = Vec{0.0, 8.0, 5.0};
+
+    auto m1F2 = Matrix(3);
+    m1F2.row(0) = Vec{0.0, 10.0, 16.0};
+    m1F2.row(1) = Vec{10.0, -10.0, -10.0};
+    m1F2.row(2) = Vec{16.0, -10.0, 3.0};
+
+    auto m2F2 = Matrix(3);
+    m2F2.row(0) = Vec{-5.0, 2.0, -17.0};
+    m2F2.row(1) = Vec{2.0, -6.0, 8.0};
+    m2F2.row(2) = Vec{-17.0, 8.0, 6.0};
+
+    auto F2 = M_t{m0F2, m1F2, m2F2};
+
+    auto B2 = Matrix(3);
+    B2.row(0) = Vec{14.0, 9.0, 40.0};
+    B2.row(1) = Vec{9.0, 91.0, 10.0};
+    B2.row(2) = Vec{40.0, 10.0, 15.0};
+
+    auto omega = MyLMIOracle(2, F1, B1, 3, F2, B2, c);
+    auto gamma = 1e100;
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    const auto result = cutting_plane_optim(omega, ellip, gamma);
+    REQUIRE_NE(std::get<0>(result).size(), 0U);
+
+    auto omega_f = MyLMIOracle(2, F1, B1, 3, F2, B2, c);
+    auto gamma_f = 1e100;
+    auto ellip_f = Ell<Vec, float>(10.0, Vec{0.0, 0.0, 0.0});
+    const auto result_f = cutting_plane_optim(omega_f, ellip_f, gamma_f, Options(2000, 1e-10));
+    REQUIRE_NE(std::get<0>(result_f).size(), 0U);
+    CHECK_EQ(std::get<1>(result_f), 139U);
+    CHECK_EQ(gamma_f, doctest::Approx(gamma).epsilon(1e-4));
+
+    auto refined = Ell<Vec>(ellip_f);  // carry on in double
+    const auto result_d = cutting_plane_optim(omega_f, refined, gamma_f);
+    CHECK_LE(std::get<1>(result_f) + std::get<1>(result_d), std::get<1>(result));
+    CHECK_EQ(gamma_f, doctest::Approx(gamma).epsilon(1e-9));
+}
+
+/**
+ * @brief The problem of MyLMIOracle, with both blocks in a `LmiCompositeOracle`
+ */
+class MyCompositeOracle {
+    using Vec = std::valarray<double>;
+    using Cut = std::pair<Vec, double>;
+
+    const Vec c;
+
+  public:
+    LmiCompositeOracle<Vec, Matrix> lmi;
+
+    explicit MyCompositeOracle(Vec c) : c{std::move(c)} {}
+
+    auto assess_optim(const Vec &x, double &gamma) -> std::tuple<Cut, bool> {
+        if (const auto cut = this->lmi(x)) {
+            return {*cut, false};
+        }
+        const auto f0 = (this->c * x).sum();
+        const auto f1 = f0 - gamma;
+        if (f1 > 0.0) {
+            return {{this->c, f1}, false};
+        }
+        gamma = f0;
+        return {{this->c, 0.0}, true};
+    }
+};
+
+TEST_CASE("LMI test, the blocks on two threads") {
+    using Vec = std::valarray<double>;
+    using M_t = std::vector<Matrix>;
+
+    auto m0F1 = Matrix(2);
+    m0F1.row(0) = Vec{-7.0, -11.0};
+    m0F1.row(1) = Vec{-11.0, 3.0};
+    auto m1F1 = Matrix(2);
+    m1F1.row(0) = Vec{7.0, -18.0};
+    m1F1.row(1) = Vec{-18.0, 8.0};
+    auto m2F1 = Matrix(2);
+    m2F1.row(0) = Vec{-2.0, -8.0};
+    m2F1.row(1) = Vec{-8.0, 1.0};
+    const auto F1 = M_t{m0F1, m1F1, m2F1};
+    auto B1 = Matrix(2);
+    B1.row(0) = Vec{33.0, -9.0};
+    B1.row(1) = Vec{-9.0, 26.0};
+
+    auto m0F2 = Matrix(3);
+    m0F2.row(0) = Vec{-21.0, -11.0, 0.0};
+    m0F2.row(1) = Vec{-11.0, 10.0, 8.0};
+    m0F2.row(2) = Vec{0.0, 8.0, 5.0};
+    auto m1F2 = Matrix(3);
+    m1F2.row(0) = Vec{0.0, 10.0, 16.0};
+    m1F2.row(1) = Vec{10.0, -10.0, -10.0};
+    m1F2.row(2) = Vec{16.0, -10.0, 3.0};
+    auto m2F2 = Matrix(3);
+    m2F2.row(0) = Vec{-5.0, 2.0, -17.0};
+    m2F2.row(1) = Vec{2.0, -6.0, 8.0};
+    m2F2.row(2) = Vec{-17.0, 8.0, 6.0};
+    const auto F2 = M_t{m0F2, m1F2, m2F2};
+    auto B2 = Matrix(3);
+    B2.row(0) = Vec{14.0, 9.0, 40.0};
+    B2.row(1) = Vec{9.0, 91.0, 10.0};
+    B2.row(2) = Vec{40.0, 10.0, 15.0};
+
+    // the first infeasible block, in order: the iterates of "LMI test "
+    auto omega = MyCompositeOracle(Vec{1.0, -1.0, 1.0});
+    omega.lmi.add_block(2, F1, B1);
+    omega.lmi.add_block(3, F2, B2);
+    omega.lmi.num_threads = 2;
+    REQUIRE_EQ(omega.lmi.num_blocks(), 2U);
+    ell_kernel::set_num_threads(2U);
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    auto gamma = 1e100;
+    const auto result = cutting_plane_optim(omega, ellip, gamma);
+    CHECK_NE(std::get<0>(result).size(), 0U);
+    CHECK_EQ(std::get<1>(result), 281);
+
+    // the surrogate cut of both blocks
+    auto omega_s = MyCompositeOracle(Vec{1.0, -1.0, 1.0});
+    omega_s.lmi.add_block(2, F1, B1);
+    omega_s.lmi.add_block(3, F2, B2);
+    omega_s.lmi.num_threads = 2;
+    omega_s.lmi.surrogate = true;
+    auto ellip_s = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    auto gamma_s = 1e100;
+    const auto result_s = cutting_plane_optim(omega_s, ellip_s, gamma_s);
+    const auto &x = std::get<0>(result_s);
+    REQUIRE_NE(x.size(), 0U);
+    CHECK_EQ(gamma_s, doctest::Approx(gamma).epsilon(1e-4));
+    CHECK_EQ(omega_s.lmi(x), nullptr);  // x satisfies both blocks
+    ell_kernel::set_num_threads(1U);
+}
@@ -0,0 +1,197 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, CHECK, TestCase
+
+#include <cstdio>                              // for remove, fopen, fputs
+#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim
+#include <ellalgo/ell.hpp>                     // for Ell
+#include <ellalgo/ell_matrix.hpp>              // for Matrix
+#include <ellalgo/oracles/lmi_file.hpp>        // for LmiFile, LmiFileWriter, MatrixView
+#include <ellalgo/oracles/lmi_oracle.hpp>      // for LmiOracle
+#include <ellalgo/oracles/structured_sym.hpp>  // for SparseSym
+#include <stdexcept>                           // for runtime_error
+#include <string>                              // for string
+#include <tuple>                               // for tuple
+#include <valarray>                            // for valarray
+#include <vector>                              // for vector
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief The problem of test_lmi.cpp, with the matrices of the LMIs in files
+ */
+class MyFileOracle {
+    using Cut = std::pair<Vec, double>;
+    using Views = std::vector<MatrixView>;
+
+    LmiFile file1;
+    LmiFile file2;
+    const Views F1;
+    const Views F2;
+    LmiOracle<Vec, MatrixView> lmi1;
+    LmiOracle<Vec, MatrixView> lmi2;
+    const Vec c;
+
+  public:
+    MyFileOracle(const std::string &path1, const std::string &path2, Vec c)
+        : file1{path1},
+          file2{path2},
+          F1{file1.matrices(1, 4)},
+          F2{file2.matrices(1, 4)},
+          lmi1{file1.dim(), F1, file1.matrix(0)},
+          lmi2{file2.dim(), F2, file2.matrix(0)},
+          c{std::move(c)} {}
+
+    auto assess_optim(const Vec &x, double &gamma) -> std::tuple<Cut, bool> {
+        if (const auto cut1 = this->lmi1(x)) {
+            return {*cut1, false};
+        }
+        if (const auto cut2 = this->lmi2(x)) {
+            return {*cut2, false};
+        }
+        const auto f0 = (this->c * x).sum();
+        const auto f1 = f0 - gamma;
+        if (f1 > 0.0) {
+            return {{this->c, f1}, false};
+        }
+        gamma = f0;
+        return {{this->c, 0.0}, true};
+    }
+};
+
+TEST_CASE("LMI file, the LMI test on mapped matrices") {
+    auto B1 = Matrix(2);
+    B1.row(0) = Vec{33.0, -9.0};
+    B1.row(1) = Vec{-9.0, 26.0};
+    auto m0F1 = Matrix(2);
+    m0F1.row(0) = Vec{-7.0, -11.0};
+    m0F1.row(1) = Vec{-11.0, 3.0};
+    auto m1F1 = Matrix(2);
+    m1F1.row(0) = Vec{7.0, -18.0};
+    m1F1.row(1) = Vec{-18.0, 8.0};
+    auto m2F1 = Matrix(2);
+    m2F1.row(0) = Vec{-2.0, -8.0};
+    m2F1.row(1) = Vec{-8.0, 1.0};
+
+    auto B2 = Matrix(3);
+    B2.row(0) = Vec{14.0, 9.0, 40.0};
+    B2.row(1) = Vec{9.0, 91.0, 10.0};
+    B2.row(2) = Vec{40.0, 10.0, 15.0};
+    auto m0F2 = Matrix(3);
+    m0F2.row(0) = Vec{-21.0, -11.0, 0.0};
+    m0F2.row(1) = Vec{-11.0, 10.0, 8.0};
+    m0F2.row(2) = Vec{0.0, 8.0, 5.0};
+    auto m1F2 = Matrix(3);
+    m1F2.row(0) = Vec{0.0, 10.0, 16.0};
+    m1F2.row(1) = Vec{10.0, -10.0, -10.0};
+    m1F2.row(2) = Vec{16.0, -10.0, 3.0};
+    auto m2F2 = Matrix(3);
+    m2F2.row(0) = Vec{-5.0, 2.0, -17.0};
+    m2F2.row(1) = Vec{2.0, -6.0, 8.0};
+    m2F2.row(2) = Vec{-17.0, 8.0, 6.0};
+
+    const auto path1 = std::string{"test_lmi_file_1.bin"};
+    const auto path2 = std::string{"test_lmi_file_2.bin"};
+    {
+        LmiFileWriter writer{path1, 2};
+        for (const auto *M : {&B1, &m0F1, &m1F1, &m2F1}) {
+            writer.add(*M);
+        }
+        writer.close();
+    }
+    LmiFileWriter writer{path2, 3};
+    for (const auto *M : {&B2, &m0F2, &m1F2, &m2F2}) {
+        writer.add(*M);
+    }
+    writer.close();
+
+    {
+        const LmiFile file{path2};
+        REQUIRE_EQ(file.dim(), 3U);
+        REQUIRE_EQ(file.num_mats(), 4U);
+        CHECK(file.kind(3) == LmiFile::Kind::Dense);
+        CHECK_EQ(file.matrix(3)(2, 0), -17.0);
+    }
+
+    MyFileOracle omega{path1, path2, Vec{1.0, -1.0, 1.0}};
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    auto gamma = 1e100;
+    const auto result = cutting_plane_optim(omega, ellip, gamma);
+    CHECK_NE(std::get<0>(result).size(), 0U);
+    CHECK_EQ(std::get<1>(result), 281U);  // as in test_lmi.cpp
+
+    std::remove(path1.c_str());
+    std::remove(path2.c_str());
+}
+
+TEST_CASE("LMI file, sparse blocks and errors") {
+    const auto path = std::string{"test_lmi_file_3.bin"};
+    auto S = SparseSym(4);
+    S.add(3, 1, 2.5);
+    S.add(0, 0, -1.0);
+    {
+        LmiFileWriter writer{path, 4};
+        writer.add(Matrix(4, 1.0));
+        writer.add(S);
+        writer.close();
+    }
+    {
+        const LmiFile file{path};
+        REQUIRE_EQ(file.num_mats(), 2U);
+        REQUIRE(file.kind(1) == LmiFile::Kind::Sparse);
+        const auto T = file.sparse(1);
+        CHECK_EQ(T.nnz(), 2U);
+        CHECK_EQ(T(1, 3), 2.5);
+        CHECK_EQ(T(0, 0), -1.0);
+        CHECK_EQ(T(2, 2), 0.0);
+        auto thrown = false;
+        try {
+            file.matrix(1);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    {
+        LmiFileWriter writer{path, 4};  // not closed: the file above stays
+        writer.add(S);
+    }
+    CHECK_EQ(LmiFile{path}.num_mats(), 2U);
+    CHECK(std::fopen((path + ".tmp").c_str(), "rb") == nullptr);
+
+    auto T = SparseSym(5);
+    T.add(4, 1, 1.0);  // out of a 4 x 4 matrix
+    {
+        LmiFileWriter writer{path, 4};
+        writer.add(T);
+        writer.close();
+    }
+    {
+        const LmiFile file{path};
+        auto thrown = false;
+        try {
+            file.sparse(0);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    auto *fp = std::fopen(path.c_str(), "w");
+    REQUIRE(fp != nullptr);
+    std::fputs("not an LMI file, but long enough for a header ............................", fp);
+    std::fclose(fp);
+    for (const auto &name : {path, std::string{"no_such_file.bin"}}) {
+        auto thrown = false;
+        try {
+            const LmiFile file{name};
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,136 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, CHECK, TestCase
+
+#include <ellalgo/cutting_plane.hpp>            // for cutting_plane_optim
+#include <ellalgo/ell.hpp>                      // for Ell
+#include <ellalgo/ell_matrix.hpp>               // for Matrix
+#include <ellalgo/ell_stable.hpp>               // for EllStable
+#include <ellalgo/oracles/lmi_incr_oracle.hpp>  // for LmiIncrOracle
+#include <ellalgo/oracles/lmi_oracle.hpp>       // for LmiOracle
+#include <tuple>                                // for tuple
+#include <valarray>                             // for valarray
+#include <vector>                               // for vector
+
+using Vec = std::valarray<double>;
+using M_t = std::vector<Matrix>;
+
+/**
+ * @brief The problem of test_lmi.cpp, with an LMI oracle of choice
+ *
+ * @tparam Oracle
+ */
+template <typename Oracle> class MyIncrOracle {
+    using Cut = std::pair<Vec, double>;
+
+    Oracle lmi1;
+    Oracle lmi2;
+    const Vec c;
+
+  public:
+    template <typename... Args>
+    MyIncrOracle(size_t m1, const M_t &F1, const Matrix &B1, size_t m2, const M_t &F2,
+                 const Matrix &B2, Vec c, Args... args)
+        : lmi1{m1, F1, B1, args...}, lmi2{m2, F2, B2, args...}, c{std::move(c)} {}
+
+    auto assess_optim(const Vec &x, double &gamma) -> std::tuple<Cut, bool> {
+        if (const auto cut1 = this->lmi1(x)) {
+            return {*cut1, false};
+        }
+        if (const auto cut2 = this->lmi2(x)) {
+            return {*cut2, false};
+        }
+        const auto f0 = (this->c * x).sum();
+        const auto f1 = f0 - gamma;
+        if (f1 > 0.0) {
+            return {{this->c, f1}, false};
+        }
+        gamma = f0;
+        return {{this->c, 0.0}, true};
+    }
+};
+
+struct LmiProblem {
+    M_t F1;
+    Matrix B1{2};
+    M_t F2;
+    Matrix B2{3};
+
+    LmiProblem() {
+        auto m0F1 = Matrix(2);
+        m0F1.row(0) = Vec{-7.0, -11.0};
+        m0F1.row(1) = Vec{-11.0, 3.0};
+        auto m1F1 = Matrix(2);
+        m1F1.row(0) = Vec{7.0, -18.0};
+        m1F1.row(1) = Vec{-18.0, 8.0};
+        auto m2F1 = Matrix(2);
+        m2F1.row(0) = Vec{-2.0, -8.0};
+        m2F1.row(1) = Vec{-8.0, 1.0};
+        this->F1 = M_t{m0F1, m1F1, m2F1};
+        this->B1.row(0) = Vec{33.0, -9.0};
+        this->B1.row(1) = Vec{-9.0, 26.0};
+
+        auto m0F2 = Matrix(3);
+        m0F2.row(0) = Vec{-21.0, -11.0, 0.0};
+        m0F2.row(1) = Vec{-11.0, 10.0, 8.0};
+        m0F2.row(2) = Vec{0.0, 8.0, 5.0};
+        auto m1F2 = Matrix(3);
+        m1F2.row(0) = Vec{0.0, 10.0, 16.0};
+        m1F2.row(1) = Vec{10.0, -10.0, -10.0};
+        m1F2.row(2) = Vec{16.0, -10.0, 3.0};
+        auto m2F2 = Matrix(3);
+        m2F2.row(0) = Vec{-5.0, 2.0, -17.0};
+        m2F2.row(1) = Vec{2.0, -6.0, 8.0};
+        m2F2.row(2) = Vec{-17.0, 8.0, 6.0};
+        this->F2 = M_t{m0F2, m1F2, m2F2};
+        this->B2.row(0) = Vec{14.0, 9.0, 40.0};
+        this->B2.row(1) = Vec{9.0, 91.0, 10.0};
+        this->B2.row(2) = Vec{40.0, 10.0, 15.0};
+    }
+};
+
+TEST_CASE("LMI test (incremental)") {
+    const auto P = LmiProblem{};
+    auto omega = MyIncrOracle<LmiIncrOracle<Vec, Matrix>>(2, P.F1, P.B1, 3, P.F2, P.B2,
+                                                           Vec{1.0, -1.0, 1.0});
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    auto gamma = 1e100;  // should be std::numeric_limits<double>::max()
+    const auto result = cutting_plane_optim(omega, ellip, gamma);
+    CHECK_NE(std::get<0>(result).size(), 0U);
+    CHECK_EQ(std::get<1>(result), 281);  // as in test_lmi.cpp
+}
+
+TEST_CASE("LMI test (incremental, stable)") {
+    const auto P = LmiProblem{};
+    auto omega = MyIncrOracle<LmiIncrOracle<Vec, Matrix>>(2, P.F1, P.B1, 3, P.F2, P.B2,
+                                                           Vec{1.0, -1.0, 1.0});
+    auto ellip = EllStable<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    auto gamma = 1e100;
+    const auto result = cutting_plane_optim(omega, ellip, gamma);
+    CHECK_NE(std::get<0>(result).size(), 0U);
+    CHECK_EQ(std::get<1>(result), 281);
+}
+
+TEST_CASE("LMI test (incremental, refresh = 1): the same as LmiOracle") {
+    const auto P = LmiProblem{};
+    auto omega1 = MyIncrOracle<LmiOracle<Vec, Matrix>>(2, P.F1, P.B1, 3, P.F2, P.B2,
+                                                        Vec{1.0, -1.0, 1.0});
+    auto omega2 = MyIncrOracle<LmiIncrOracle<Vec, Matrix>>(2, P.F1, P.B1, 3, P.F2, P.B2,
+                                                            Vec{1.0, -1.0, 1.0}, 1U);
+    auto ellip1 = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    auto ellip2 = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    auto gamma1 = 1e100;
+    auto gamma2 = 1e100;
+    const auto result1 = cutting_plane_optim(omega1, ellip1, gamma1);
+    const auto result2 = cutting_plane_optim(omega2, ellip2, gamma2);
+    CHECK_EQ(std::get<1>(result2), std::get<1>(result1));
+    CHECK_EQ(gamma2, gamma1);
+    const auto x1 = std::get<0>(result1);
+    const auto x2 = std::get<0>(result2);
+    REQUIRE_EQ(x2.size(), x1.size());
+    for (auto i = 0U; i != x1.size(); ++i) {
+        CHECK_EQ(x2[i], x1[i]);
+    }
+}
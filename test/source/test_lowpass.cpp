@@ -5,6 +5,7 @@
 #include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim
 #include <ellalgo/ell.hpp>                     // for Ell
 #include <ellalgo/oracles/lowpass_oracle.hpp>  // for LowpassOracle, filter_...
+#include <random>                              // for mt19937, uniform_real_distribution
 #include <tuple>                               // for make_tuple, tuple
 #include <valarray>
 
@@ -16,13 +17,17 @@ using ParallelCut = std::pair<Vec, Vec>;
 // optimization
 // ********************************************************************
 
-auto run_lowpass(bool use_parallel_cut) {
+auto run_lowpass(bool use_parallel_cut, bool use_fft = false,
+                 LowpassOracle::Selection selection = LowpassOracle::Selection::FirstViolation) {
     constexpr int N = 32;
 
     auto r0 = Vec(0.0, N);  // initial x0
     auto ellip = Ell<Vec>(40.0, r0);
     auto result = create_lowpass_case(N);
     auto omega = result.first;
+    omega.use_fft = use_fft;
+    omega.selection = selection;
+    omega.metric = [&ellip](const Vec &g) { return ellip.quad(make_span(g)); };
     auto spsq = result.second;
     auto options = Options();
 
@@ -57,3 +62,66 @@ TEST_CASE("Lowpass Filter (w/o parallel cut)") {
     CHECK(num_iters >= 26399);
     CHECK(num_iters <= 30000);
 }
+
+TEST_CASE("Lowpass Filter, spectrum by FFT") {
+    auto dense = create_lowpass_case(32).first;
+    auto by_fft = dense;
+    by_fft.use_fft = true;
+    auto gen = std::mt19937(5);
+    auto dist = std::uniform_real_distribution<double>(-0.05, 0.05);
+    auto x = Vec(0.0, 33);
+    for (auto trial = 0; trial != 20; ++trial) {
+        x[0] = 1.0;
+        for (auto j = 1U; j != x.size(); ++j) {
+            x[j] = dist(gen);
+        }
+        const auto *cut1 = dense.assess_feas(x, 0.02);
+        const auto *cut2 = by_fft.assess_feas(x, 0.02);
+        REQUIRE_EQ(cut1 == nullptr, cut2 == nullptr);
+        if (cut1 != nullptr) {
+            REQUIRE_EQ(cut1->second.size(), cut2->second.size());
+            CHECK(cut1->second[0] == doctest::Approx(cut2->second[0]).epsilon(1e-9));
+            CHECK(((cut1->first - cut2->first) == 0.0).min());  // the same row of A
+        }
+    }
+
+    const auto result = run_lowpass(true, true);
+    CHECK(std::get<0>(result));
+    CHECK(std::get<1>(result) <= 13000);
+}
+
+TEST_CASE("Lowpass Filter, selection of the cut") {
+    using Selection = LowpassOracle::Selection;
+    for (const auto selection : {Selection::MaxViolation, Selection::MaxDepth}) {
+        const auto result = run_lowpass(true, false, selection);
+        CHECK(std::get<0>(result));
+        CHECK(std::get<1>(result) <= 12485);  // 12193 and 12200
+    }
+}
+
+TEST_CASE("Lowpass Filter, active set of the stopband") {
+    constexpr int N = 32;
+    auto result = create_lowpass_case(N);
+    auto omega = result.first;
+    omega.stopband_active = 16;
+    auto ellip = Ell<Vec>(40.0, Vec(0.0, N));
+    ellip.set_use_parallel_cut(true);
+    auto options = Options();
+    options.max_iters = 50000;
+    options.tolerance = 1e-14;
+    auto spsq = result.second;
+    const auto result2 = cutting_plane_optim(omega, ellip, spsq, options);
+    const auto r = std::get<0>(result2);
+    REQUIRE_NE(r.size(), 0U);
+    CHECK_EQ(std::get<1>(result2), std::get<1>(run_lowpass(true)));  // the same cuts
+
+    // at the same x, the active set is scanned alone, with the same result
+    auto spsq1 = 2.0 * spsq;
+    const auto cut1 = omega.assess_optim(r, spsq1);
+    auto spsq2 = 2.0 * spsq;
+    const auto cut2 = omega.assess_optim(r, spsq2);
+    CHECK(std::get<1>(cut1));
+    CHECK(std::get<1>(cut2));
+    CHECK_EQ(spsq1, spsq2);
+    CHECK(((std::get<0>(cut1).first - std::get<0>(cut2).first) == 0.0).min());
+}
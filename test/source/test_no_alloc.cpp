@@ -0,0 +1,236 @@
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, CHECK
+
+#include <algorithm>                           // for max
+#include <atomic>                              // for atomic
+#include <cstdlib>                             // for malloc, free
+#include <ellalgo/cg_engine.hpp>               // for ConjugateGradient, BlockConjugateGradient
+#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim
+#include <ellalgo/eigen_solver.hpp>            // for PowerIteration, Lanczos
+#include <ellalgo/ell.hpp>                     // for Ell
+#include <ellalgo/ell_memory.hpp>              // for PoolResource
+#include <ellalgo/ell_span.hpp>                // for Span
+#include <ellalgo/ell_stable.hpp>              // for EllStable
+#include <ellalgo/ell_sym_matrix.hpp>          // for SymMatrix
+#include <ellalgo/oracles/structured_sym.hpp>  // for SparseSym
+#include <new>                                 // for bad_alloc
+#include <utility>                             // for pair
+#include <valarray>                            // for valarray
+#include <vector>                              // for vector
+
+#if defined(__GNUC__) && !defined(__clang__)
+// the replaced operator delete below pairs with the replaced operator new
+#    pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Counts every heap allocation of this test program
+static std::atomic<size_t> num_allocs{0U};
+
+void *operator new(std::size_t size) {
+    num_allocs.fetch_add(1U, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size != 0U ? size : 1U)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+using Vec = std::valarray<double>;
+
+static auto make_grad(size_t ndim) -> Vec {
+    Vec grad(ndim);
+    for (auto i = 0U; i != ndim; ++i) {
+        grad[i] = 1.0 + 0.1 * i;
+    }
+    return grad;
+}
+
+template <typename Space> static auto allocs_per_cuts(Space &ellip, size_t ndim) -> size_t {
+    const auto bias_cut = std::make_pair(make_grad(ndim), 0.01);
+    const auto parallel_cut = std::make_pair(make_grad(ndim), Vec{0.0, 0.05});
+    ellip.update_central_cut(bias_cut);  // warm up
+    const auto before = num_allocs.load();
+    for (auto k = 0; k != 20; ++k) {
+        ellip.update_central_cut(bias_cut);
+        ellip.update_bias_cut(bias_cut);
+        ellip.update_q(bias_cut);
+        ellip.update_bias_cut(parallel_cut);
+    }
+    return num_allocs.load() - before;
+}
+
+TEST_CASE("Ell: cuts do not allocate") {
+    const auto ndim = 20U;
+    Ell<Vec> ellip{10.0, Vec(0.0, ndim)};
+    CHECK_EQ(allocs_per_cuts(ellip, ndim), 0U);
+}
+
+TEST_CASE("EllStable: cuts do not allocate") {
+    const auto ndim = 20U;
+    EllStable<Vec> ellip{10.0, Vec(0.0, ndim)};
+    CHECK_EQ(allocs_per_cuts(ellip, ndim), 0U);
+}
+
+template <typename Space> static auto copies_of_fan_out(size_t ndim) -> void {
+    const auto cut = std::make_pair(make_grad(ndim), 0.01);
+    Space ellip{10.0, Vec(0.0, ndim)};
+    ellip.update_bias_cut(cut);
+    ellip.update_central_cut(cut);  // with an update pending
+
+    // copy_into, as copy
+    Space expected = ellip.copy();
+    Space dst{1.0, Vec(1.0, ndim)};
+    dst.update_bias_cut(cut);
+    const auto before = num_allocs.load();
+    ellip.copy_into(dst);
+    CHECK_EQ(num_allocs.load() - before, 0U);
+    expected.update_bias_cut(cut);
+    dst.update_bias_cut(cut);
+    for (auto i = 0U; i != ndim; ++i) {
+        CHECK_EQ(dst.xc()[i], expected.xc()[i]);
+    }
+    CHECK_EQ(dst.tsq(), expected.tsq());
+
+    // a pooled copy takes the matrix of the last one
+    PoolResource pool;
+    {
+        const auto warm_up = ellip.copy(pool);
+    }
+    const auto before_plain = num_allocs.load();
+    {
+        const auto plain = ellip.copy();
+    }
+    const auto allocs_plain = num_allocs.load() - before_plain;
+    auto allocs_pooled = size_t(0U);  // the most of a copy
+    for (auto k = 0; k != 10; ++k) {
+        const auto before_pooled = num_allocs.load();
+        auto pooled = ellip.copy(pool);
+        allocs_pooled = std::max(allocs_pooled, num_allocs.load() - before_pooled);
+        pooled.update_bias_cut(cut);
+    }
+    CHECK_LT(allocs_pooled, allocs_plain);  // every copy, not only on average
+    const auto before_matrix = num_allocs.load();
+    {
+        const auto mq = SymMatrix(ndim, 0.0, &pool);
+    }
+    CHECK_EQ(num_allocs.load() - before_matrix, 0U);  // the matrix, once warmed up
+    CHECK_EQ(pool.num_blocks(), 1U);
+}
+
+TEST_CASE("Ell, EllStable: copy_into and copies from a pool") {
+    copies_of_fan_out<Ell<Vec>>(20U);
+    copies_of_fan_out<EllStable<Vec>>(20U);
+}
+
+/**
+ * @brief The problem of test_example1.cpp, writing its cuts into a span
+ */
+struct MySpanOracle {
+    int idx = -1;  // for round robin
+
+    auto assess_optim(const Vec &xc, double &gamma, Span<double> grad, double &beta) -> bool {
+        const auto x = xc[0];
+        const auto y = xc[1];
+        const auto f0 = x + y;
+        for (int i = 0; i != 3; i++) {
+            this->idx = this->idx == 2 ? 0 : this->idx + 1;
+            double fj;
+            if (this->idx == 0 && (fj = f0 - 3.0) > 0.0) {  // constraint 1: x + y <= 3
+                grad[0] = 1.0;
+                grad[1] = 1.0;
+                beta = fj;
+                return false;
+            }
+            if (this->idx == 1 && (fj = -x + y + 1.0) > 0.0) {  // constraint 2: x - y >= 1
+                grad[0] = -1.0;
+                grad[1] = 1.0;
+                beta = fj;
+                return false;
+            }
+            if (this->idx == 2 && (fj = gamma - f0) > 0.0) {  // objective: maximize x + y
+                grad[0] = -1.0;
+                grad[1] = -1.0;
+                beta = fj;
+                return false;
+            }
+        }
+        gamma = f0;
+        grad[0] = -1.0;
+        grad[1] = -1.0;
+        beta = 0.0;
+        return true;
+    }
+};
+
+template <typename Space> static auto allocs_of_solve(size_t max_iters) -> size_t {
+    Space ellip{10.0, Vec{0.0, 0.0}};
+    auto omega = MySpanOracle{};
+    auto gamma = -1e100;
+    const auto before = num_allocs.load();
+    const auto result = cutting_plane_optim(omega, ellip, gamma, Options{max_iters, 0.0});
+    REQUIRE_EQ(std::get<1>(result), max_iters);
+    return num_allocs.load() - before;
+}
+
+TEST_CASE("cutting_plane_optim: the iterations do not allocate") {
+    // x_best only, once
+    CHECK_EQ(allocs_of_solve<Ell<Vec>>(200U), allocs_of_solve<Ell<Vec>>(20U));
+    CHECK_EQ(allocs_of_solve<EllStable<Vec>>(200U), allocs_of_solve<EllStable<Vec>>(20U));
+}
+
+TEST_CASE("ConjugateGradient, BlockConjugateGradient: the solves do not allocate") {
+    const auto n = 100U;
+    auto mat = SparseSym(n);
+    for (auto i = 0U; i != n; ++i) {
+        mat.add(i, i, 2.5);
+        if (i != 0U) {
+            mat.add(i, i - 1, -1.0);
+        }
+    }
+    const auto A = SymCsrMatrix(mat);
+    const auto M = Ic0Preconditioner(A);
+    const auto b = std::vector<double>(n, 1.0);
+    auto x = std::vector<double>(n, 0.0);
+    auto solver = ConjugateGradient(n);
+    const auto before = num_allocs.load();
+    const auto info = solver.solve(A, make_span(b), make_span(x), M);
+    x.assign(n, 0.0);
+    solver.solve(A, make_span(b), make_span(x));
+    CHECK_EQ(num_allocs.load() - before, 0U);
+    CHECK(info.converged);
+
+    const auto B = std::vector<double>(3 * n, 1.0);
+    auto X = std::vector<double>(3 * n, 0.0);
+    auto block = BlockConjugateGradient(n, 3);
+    const auto before_block = num_allocs.load();
+    block.solve(A, make_span(B), make_span(X), M);
+    CHECK_EQ(num_allocs.load() - before_block, 0U);
+}
+
+TEST_CASE("PowerIteration, Lanczos, BlockPowerIteration: the solves do not allocate") {
+    const auto n = 50U;
+    auto mat = SparseSym(n);
+    for (auto i = 0U; i != n; ++i) {
+        mat.add(i, i, 1.0 + 0.1 * i);
+        if (i != 0U) {
+            mat.add(i, i - 1, -0.2);
+        }
+    }
+    const auto A = SymCsrMatrix(mat);
+    auto x = std::vector<double>(n, 1.0);
+    auto X = std::vector<double>(2 * n);
+    for (auto i = 0U; i != 2 * n; ++i) {
+        X[i] = 1.0 + 0.01 * double(i % 7);
+    }
+    auto power = PowerIteration(n);
+    auto lanczos = Lanczos(n, 30);
+    auto block = BlockPowerIteration(n, 2);
+    const auto before = num_allocs.load();
+    power.solve(A, make_span(x));
+    lanczos.solve(A, make_span(x));
+    block.solve(A, make_span(X));
+    CHECK_EQ(num_allocs.load() - before, 0U);
+}
@@ -0,0 +1,286 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK_EQ
+
+#include <cmath>  // for abs
+
+#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim, cutting_plane_feas
+#include <ellalgo/cutting_plane_observer.hpp>  // for SolverStats, CutKind, CutRecord, StoppingRule
+#include <ellalgo/cutting_plane_solver.hpp>    // for CuttingPlaneSolver, CuttingPlaneSolverQ
+#include <ellalgo/ell.hpp>                     // for Ell
+#include <ellalgo/ell_config.hpp>              // for CutStatus, Options
+#include <ellalgo/oracles/profit_oracle.hpp>   // for ProfitOracleQ
+#include <limits>                              // for numeric_limits
+#include <tuple>                               // for get, tuple
+#include <utility>                             // for pair
+#include <valarray>                            // for valarray
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief The oracle of test_example1.cpp
+ */
+struct MyObservedOracle {
+    using Cut = std::pair<Vec, double>;
+
+    int idx = -1;  // for round robin
+
+    auto assess_optim(const Vec &xc, double &gamma) -> std::tuple<Cut, bool> {
+        const auto x = xc[0];
+        const auto y = xc[1];
+        const auto f0 = x + y;
+        for (int i = 0; i != 3; i++) {
+            this->idx = this->idx == 2 ? 0 : this->idx + 1;
+            double fj;
+            if (this->idx == 0 && f0 > 3.0) {  // constraint 1: x + y <= 3
+                return {{Vec{1.0, 1.0}, f0 - 3.0}, false};
+            }
+            if (this->idx == 1 && (fj = -x + y + 1.0) > 0.0) {  // constraint 2: x - y >= 1
+                return {{Vec{-1.0, 1.0}, fj}, false};
+            }
+            if (this->idx == 2 && (fj = gamma - f0) > 0.0) {  // objective: maximize x + y
+                return {{Vec{-1.0, -1.0}, fj}, false};
+            }
+        }
+        gamma = f0;
+        return {{Vec{-1.0, -1.0}, 0.0}, true};
+    }
+};
+
+/**
+ * @brief Find x with 1 <= x + y <= 2 (a parallel cut) and y <= x - 1
+ */
+struct MyParallelOracle {
+    using Cut = std::pair<Vec, Vec>;
+
+    Cut cut{Vec{1.0, 1.0}, Vec{0.0, 0.0}};
+
+    auto assess_feas(const Vec &xc) -> Cut * {
+        const auto f0 = xc[0] + xc[1];
+        if (f0 > 2.0 || f0 < 1.0) {
+            this->cut = Cut{Vec{1.0, 1.0}, Vec{f0 - 2.0, f0 - 1.0}};
+            return &this->cut;
+        }
+        const auto f1 = xc[1] - xc[0] + 1.0;
+        if (f1 > 0.0) {
+            this->cut = Cut{Vec{-1.0, 1.0}, Vec{f1}};
+            return &this->cut;
+        }
+        return nullptr;
+    }
+};
+
+TEST_CASE("SolverStats, counts and trace of cutting_plane_optim") {
+    auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto ell_observed = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle = MyObservedOracle{};
+    auto oracle_observed = MyObservedOracle{};
+    auto gamma = -1.0e100;
+    auto gamma_observed = -1.0e100;
+    const auto options = Options{2000, 1e-10};
+    auto stats = SolverStats(8);
+    const auto result = cutting_plane_optim(oracle, ell, gamma, options);
+    const auto result_observed
+        = cutting_plane_optim(oracle_observed, ell_observed, gamma_observed, options, stats);
+    const auto niter = std::get<1>(result);
+    REQUIRE(niter > 8U);
+    CHECK_EQ(std::get<1>(result_observed), niter);  // the observer changes nothing
+    CHECK_EQ(gamma_observed, gamma);
+
+    CHECK_EQ(stats.num_oracle_calls(), niter + 1);  // the last one stops
+    CHECK_EQ(stats.num_updates(), niter + 1);
+    CHECK_GT(stats.count(CutKind::Central), 0U);
+    CHECK_EQ(stats.count(CutKind::Central) + stats.count(CutKind::Bias), niter + 1);
+    CHECK_EQ(stats.count(CutStatus::Success), niter + 1 - stats.count(CutStatus::NoSoln));
+    CHECK(stats.oracle_seconds() >= 0.0);
+    CHECK(stats.update_seconds() >= 0.0);
+
+    const auto trace = stats.trace();
+    REQUIRE_EQ(trace.size(), 8U);
+    for (auto k = 0U; k != 8U; ++k) {
+        CHECK_EQ(trace[k].niter, niter - 7 + k);
+    }
+    CHECK_EQ(trace.back().tsq, ell_observed.tsq());
+
+    stats.reset();
+    CHECK_EQ(stats.num_updates(), 0U);
+    CHECK_EQ(stats.trace().size(), 0U);
+}
+
+TEST_CASE("SolverStats, parallel cuts of cutting_plane_feas") {
+    auto ell = Ell<Vec>(10.0, Vec{0.0, 0.0});
+    auto oracle = MyParallelOracle{};
+    auto stats = SolverStats();
+    const auto result = cutting_plane_feas(oracle, ell, Options(), stats);
+    const auto &x = std::get<0>(result);
+    REQUIRE_NE(x.size(), 0U);
+    CHECK_EQ(stats.num_oracle_calls(), std::get<1>(result) + 1);  // the last one is feasible
+    CHECK_EQ(stats.num_updates(), std::get<1>(result));
+    CHECK_GT(stats.count(CutKind::Parallel), 0U);
+    CHECK_EQ(stats.count(CutKind::Parallel) + stats.count(CutKind::Bias), stats.num_updates());
+    CHECK_EQ(stats.trace().size(), 0U);
+}
+
+TEST_CASE("SolverStats, cutting_plane_optim_q") {
+    Ell<Vec> ellip{100.0, Vec{0.0, 0.0}};
+    ProfitOracleQ omega{20.0, 40.0, 30.5, Vec{0.1, 0.4}, Vec{10.0, 35.0}};
+    auto gamma = 0.0;
+    auto stats = SolverStats(4);
+    const auto result = cutting_plane_optim_q(omega, ellip, gamma, Options(), stats);
+    CHECK_EQ(std::get<1>(result), 29U);  // as in test_profit.cpp
+    CHECK_EQ(stats.num_oracle_calls(), stats.num_updates());
+    CHECK_EQ(stats.trace().back().niter, stats.num_updates() - 1);
+}
+
+TEST_CASE("StoppingRule, by the gap estimate") {
+    const auto options = Options{2000, 1e-10};
+    auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle = MyObservedOracle{};
+    auto gamma = -1.0e100;
+    const auto result = cutting_plane_optim(oracle, ell, gamma, options);
+
+    auto ell_r = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle_r = MyObservedOracle{};
+    auto gamma_r = -1.0e100;
+    auto rule = StoppingRule<SolverStats>();
+    rule.rel_gap = 1e-3;
+    const auto result_r = cutting_plane_optim(oracle_r, ell_r, gamma_r, options, rule);
+    CHECK(rule.reason() == StoppingRule<SolverStats>::Reason::Gap);
+    CHECK(std::get<1>(result_r) < std::get<1>(result));
+    CHECK(rule.gap() <= 1e-3 * std::abs(gamma_r));
+    CHECK(std::abs(gamma_r - gamma) <= 2e-3 * std::abs(gamma));  // within the gap
+    CHECK_EQ(rule.observer().num_updates(), std::get<1>(result_r) + 1);
+}
+
+TEST_CASE("StoppingRule, no gap estimate from a feasibility cut") {
+    auto rule = StoppingRule<>();
+    rule.rel_gap = 1e-3;
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+    rule.update_end({0U, CutKind::Central, CutStatus::Success, 1e-12, nan});  // of a constraint
+    CHECK_FALSE(rule.stop_now(1.0));
+    CHECK_EQ(rule.gap(), std::numeric_limits<double>::infinity());
+    rule.update_end({1U, CutKind::Central, CutStatus::Success, 1e-12, nan, true});
+    CHECK(rule.stop_now(1.0));
+    CHECK(rule.reason() == StoppingRule<>::Reason::Gap);
+}
+
+TEST_CASE("StoppingRule, stalled or out of time") {
+    const auto options = Options{2000, 1e-10};
+    auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle = MyObservedOracle{};
+    auto gamma = -1.0e100;
+    const auto result = cutting_plane_optim(oracle, ell, gamma, options);
+
+    auto ell_s = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle_s = MyObservedOracle{};
+    auto gamma_s = -1.0e100;
+    auto stalled = StoppingRule<>();
+    stalled.window = 10U;
+    stalled.rel_improvement = 1e-4;
+    const auto result_s = cutting_plane_optim(oracle_s, ell_s, gamma_s, options, stalled);
+    CHECK(stalled.reason() == StoppingRule<>::Reason::Stalled);
+    CHECK(std::get<1>(result_s) < std::get<1>(result));
+    CHECK(std::get<1>(result_s) >= 10U);
+
+    auto ell_t = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle_t = MyObservedOracle{};
+    auto gamma_t = -1.0e100;
+    auto budget = StoppingRule<>();
+    budget.max_seconds = 1e-12;
+    const auto result_t = cutting_plane_optim(oracle_t, ell_t, gamma_t, options, budget);
+    CHECK(budget.reason() == StoppingRule<>::Reason::OutOfTime);
+    CHECK_EQ(std::get<1>(result_t), 0U);  // right after the first iteration
+
+    auto unset = StoppingRule<>();  // no criterion: as without it
+    auto ell_u = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle_u = MyObservedOracle{};
+    auto gamma_u = -1.0e100;
+    const auto result_u = cutting_plane_optim(oracle_u, ell_u, gamma_u, options, unset);
+    CHECK(unset.reason() == StoppingRule<>::Reason::None);
+    CHECK_EQ(std::get<1>(result_u), std::get<1>(result));
+    CHECK_EQ(gamma_u, gamma);
+}
+
+TEST_CASE("StoppingRule, with CuttingPlaneSolver") {
+    auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle = MyObservedOracle{};
+    auto rule = StoppingRule<>();
+    rule.rel_gap = 1e-3;
+    using Solver = CuttingPlaneSolver<MyObservedOracle, Ell<Vec>, double, StoppingRule<>>;
+    auto solver = Solver(oracle, ell, -1.0e100, Options{2000, 1e-10}, rule);
+    while (!solver.resume(5U)) {
+    }
+    CHECK(solver.observer().reason() == StoppingRule<>::Reason::Gap);
+    CHECK(solver.observer().gap() <= 1e-3 * std::abs(solver.gamma()));
+    CHECK(solver.resume(5U));  // stays done
+}
+
+TEST_CASE("StoppingRule, stalled with cutting_plane_optim_q and CuttingPlaneSolverQ") {
+    const auto a = Vec{0.1, 0.4};
+    const auto v = Vec{10.0, 35.0};
+    Ell<Vec> ellip{100.0, Vec{0.0, 0.0}};
+    ProfitOracleQ omega{20.0, 40.0, 30.5, a, v};
+    auto gamma = 0.0;
+    auto rule = StoppingRule<>();
+    rule.window = 3U;
+    rule.rel_improvement = 1.0;
+    const auto result = cutting_plane_optim_q(omega, ellip, gamma, Options(), rule);
+    CHECK(rule.reason() == StoppingRule<>::Reason::Stalled);
+    CHECK(std::get<1>(result) < 29U);  // all 29 without the rule
+    CHECK(std::get<1>(result) >= 3U);
+
+    Ell<Vec> ellip_s{100.0, Vec{0.0, 0.0}};
+    ProfitOracleQ omega_s{20.0, 40.0, 30.5, a, v};
+    using Solver = CuttingPlaneSolverQ<ProfitOracleQ, Ell<Vec>, double, StoppingRule<>>;
+    auto stalled = StoppingRule<>();
+    stalled.window = 3U;
+    stalled.rel_improvement = 1.0;
+    auto solver = Solver(omega_s, ellip_s, 0.0, Options(), stalled);
+    while (!solver.resume(2U)) {
+    }
+    CHECK(solver.observer().reason() == StoppingRule<>::Reason::Stalled);
+    CHECK_EQ(std::get<1>(solver.result()), std::get<1>(result));
+}
+
+TEST_CASE("StoppingRule, reset for another solve") {
+    const auto options = Options{2000, 1e-10};
+    auto rule = StoppingRule<>();
+    rule.window = 10U;
+    rule.rel_improvement = 1e-4;
+    auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle = MyObservedOracle{};
+    auto gamma = -1.0e100;
+    const auto result = cutting_plane_optim(oracle, ell, gamma, options, rule);
+    REQUIRE(rule.reason() == StoppingRule<>::Reason::Stalled);
+
+    rule.reset();
+    CHECK(rule.reason() == StoppingRule<>::Reason::None);
+    CHECK_EQ(rule.gap(), std::numeric_limits<double>::infinity());
+    auto ell_2 = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle_2 = MyObservedOracle{};
+    auto gamma_2 = -1.0e100;
+    const auto result_2 = cutting_plane_optim(oracle_2, ell_2, gamma_2, options, rule);
+    CHECK(rule.reason() == StoppingRule<>::Reason::Stalled);
+    CHECK_EQ(std::get<1>(result_2), std::get<1>(result));  // as the first solve
+    CHECK_EQ(gamma_2, gamma);
+}
+
+TEST_CASE("StoppingRule, by the volume") {
+    const auto options = Options{2000, 1e-10};
+    auto ell = Ell<Vec>(Vec{10.0, 10.0}, Vec{0.0, 0.0});
+    auto oracle = MyObservedOracle{};
+    auto gamma = -1.0e100;
+    auto rule = StoppingRule<SolverStats>(SolverStats(4));
+    rule.min_log_volume = 0.5 * std::log(100.0) - 10.0;  // shrunk by e^10
+    const auto result = cutting_plane_optim(oracle, ell, gamma, options, rule);
+    CHECK(rule.reason() == StoppingRule<SolverStats>::Reason::Volume);
+    CHECK(ell.log_volume() < rule.min_log_volume);
+    const auto trace = rule.observer().trace();
+    REQUIRE_EQ(trace.size(), 4U);
+    CHECK_EQ(trace.back().niter, std::get<1>(result));
+    CHECK_EQ(trace.back().log_volume, ell.log_volume());
+    CHECK(trace[0].log_volume > trace[1].log_volume);
+    CHECK(trace[0].log_volume >= rule.min_log_volume);
+}
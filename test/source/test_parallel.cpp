@@ -0,0 +1,337 @@
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, CHECK, TestCase
+
+#include <atomic>                              // for atomic
+#include <cmath>                               // for exp
+#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim, cutting_plane_feas
+#include <ellalgo/cutting_plane_observer.hpp>  // for SolverStats
+#include <ellalgo/ell.hpp>                     // for Ell
+#include <ellalgo/ell_matrix.hpp>              // for Matrix
+#include <ellalgo/ell_stable.hpp>              // for EllStable
+#include <ellalgo/oracles/lmi_oracle.hpp>      // for LmiOracle
+#include <ellalgo/oracles/lowpass_oracle.hpp>  // for LowpassOracle, create_lowpass_case
+#include <ellalgo/oracles/profit_oracle.hpp>   // for ProfitOracleQ
+#include <ellalgo/parallel_driver.hpp>         // for parallel_cutting_plane_optim, ...
+#include <memory>                              // for unique_ptr
+#include <stdexcept>                           // for runtime_error
+#include <string>                              // for string
+#include <tuple>                               // for get, tuple
+#include <valarray>                            // for valarray
+#include <vector>                              // for vector
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief The quasiconvex problem of test_quasicvx.cpp
+ */
+class QuasiCvxOracle {
+    using Cut = std::pair<Vec, double>;
+
+    int idx = -1;
+
+  public:
+    auto assess_optim(const Vec &xc, double &gamma) -> std::tuple<Cut, bool> {
+        const auto sqrtx = xc[0];
+        const auto logy = xc[1];
+        const auto y = std::exp(logy);
+        for (int i = 0; i != 2; i++) {
+            this->idx = (this->idx + 1) % 2;  // round robin
+            if (this->idx == 0) {
+                const auto fj = sqrtx * sqrtx - logy;
+                if (fj > 0.0) {
+                    return {{Vec{2 * sqrtx, -1.0}, fj}, false};
+                }
+            } else {
+                const auto tmp3 = gamma * y;
+                const auto fj = -sqrtx + tmp3;
+                if (fj > 0.0) {
+                    return {{Vec{-1.0, tmp3}, fj}, false};
+                }
+            }
+        }
+        gamma = sqrtx / y;
+        return {{Vec{-1.0, sqrtx}, 0}, true};
+    }
+};
+
+TEST_CASE("parallel_run: every job exactly once") {
+    const auto num_jobs = 1000U;
+    auto counts = std::vector<std::atomic<int>>(num_jobs);
+    for (auto &count : counts) {
+        count = 0;
+    }
+    parallel_run(num_jobs, [&](size_t idx) { counts[idx].fetch_add(1); }, 4U);
+    auto all_once = true;
+    for (const auto &count : counts) {
+        all_once = all_once && count.load() == 1;
+    }
+    CHECK(all_once);
+    parallel_run(0U, [&](size_t idx) { counts[idx].fetch_add(1); });  // no job
+}
+
+TEST_CASE("parallel_run: an exception of a job is rethrown on the caller") {
+    const auto num_jobs = 1000U;
+    std::atomic<size_t> num_run{0U};
+    auto caught = false;
+    try {
+        parallel_run(
+            num_jobs,
+            [&](size_t idx) {
+                num_run.fetch_add(1U);
+                if (idx == 10U) {
+                    throw std::runtime_error("job 10");
+                }
+            },
+            4U);
+    } catch (const std::runtime_error &e) {
+        caught = std::string(e.what()) == "job 10";
+    }
+    CHECK(caught);
+    CHECK_LT(num_run.load(), size_t(num_jobs));  // the jobs left were not handed out
+}
+
+TEST_CASE("parallel_cutting_plane_optim: same results as the serial runs, in order") {
+    using Job = CuttingPlaneJob<QuasiCvxOracle, Ell<Vec>>;
+    const auto num_jobs = 24U;
+    auto oracles = std::vector<QuasiCvxOracle>(num_jobs);
+    auto spaces = std::vector<Ell<Vec>>{};
+    for (auto k = 0U; k != num_jobs; ++k) {
+        spaces.emplace_back(10.0 * (1 + k * k), Vec{0.0, 0.0});  // different iteration counts
+    }
+    auto jobs = std::vector<Job>{};
+    for (auto k = 0U; k != num_jobs; ++k) {
+        jobs.push_back(Job{oracles[k], spaces[k], 0.0});
+    }
+    const auto results = parallel_cutting_plane_optim(jobs.begin(), jobs.end(), Options(), 4U);
+    REQUIRE_EQ(results.size(), num_jobs);
+    for (auto k = 0U; k != num_jobs; ++k) {
+        QuasiCvxOracle omega;
+        Ell<Vec> ellip{10.0 * (1 + k * k), Vec{0.0, 0.0}};
+        auto gamma = 0.0;
+        const auto expected = cutting_plane_optim(omega, ellip, gamma);
+        CHECK_EQ(std::get<1>(results[k]), std::get<1>(expected));
+        CHECK_EQ(jobs[k].gamma, gamma);
+        REQUIRE_EQ(std::get<0>(results[k]).size(), 2U);
+        CHECK_EQ(std::get<0>(results[k])[0], std::get<0>(expected)[0]);
+    }
+}
+
+TEST_CASE("parallel_cutting_plane_feas: LMI problems") {
+    auto m0 = Matrix(2);
+    m0.row(0) = Vec{-7.0, -11.0};
+    m0.row(1) = Vec{-11.0, 3.0};
+    auto m1 = Matrix(2);
+    m1.row(0) = Vec{7.0, -18.0};
+    m1.row(1) = Vec{-18.0, 8.0};
+    auto m2 = Matrix(2);
+    m2.row(0) = Vec{-2.0, -8.0};
+    m2.row(1) = Vec{-8.0, 1.0};
+    const auto F = std::vector<Matrix>{m0, m1, m2};
+    auto B = Matrix(2);
+    B.row(0) = Vec{-3.0, -9.0};
+    B.row(1) = Vec{-9.0, 6.0};
+
+    using Oracle = LmiOracle<Vec, Matrix>;
+    using Job = CuttingPlaneJob<Oracle, Ell<Vec>>;
+    const auto num_jobs = 8U;
+    auto oracles = std::vector<std::unique_ptr<Oracle>>{};
+    auto spaces = std::vector<Ell<Vec>>{};
+    auto jobs = std::vector<Job>{};
+    for (auto k = 0U; k != num_jobs; ++k) {
+        oracles.emplace_back(new Oracle(2, F, B));
+        spaces.emplace_back(10.0 + k, Vec{0.0, 0.0, 0.0});
+    }
+    for (auto k = 0U; k != num_jobs; ++k) {
+        jobs.push_back(Job{*oracles[k], spaces[k], 0.0});
+    }
+    const auto results = parallel_cutting_plane_feas(jobs.begin(), jobs.end());
+    REQUIRE_EQ(results.size(), num_jobs);
+    for (auto k = 0U; k != num_jobs; ++k) {
+        auto omega = Oracle(2, F, B);
+        auto ellip = Ell<Vec>(10.0 + k, Vec{0.0, 0.0, 0.0});
+        const auto expected = cutting_plane_feas(omega, ellip);
+        CHECK_EQ(std::get<1>(results[k]), std::get<1>(expected));
+    }
+}
+
+TEST_CASE("parallel_cutting_plane_optim_q: profit problems") {
+    using Job = CuttingPlaneJob<ProfitOracleQ, Ell<Vec>>;
+    const auto num_jobs = 32U;
+    auto oracles = std::vector<std::unique_ptr<ProfitOracleQ>>{};
+    auto spaces = std::vector<Ell<Vec>>{};
+    auto jobs = std::vector<Job>{};
+    for (auto k = 0U; k != num_jobs; ++k) {
+        oracles.emplace_back(new ProfitOracleQ(20.0, 40.0, 30.5, Vec{0.1, 0.4}, Vec{10.0, 35.0}));
+        spaces.emplace_back(100.0, Vec{0.0, 0.0});
+    }
+    for (auto k = 0U; k != num_jobs; ++k) {
+        jobs.push_back(Job{*oracles[k], spaces[k], 0.0});
+    }
+    const auto results = parallel_cutting_plane_optim_q(jobs.begin(), jobs.end(), Options(), 4U);
+    REQUIRE_EQ(results.size(), num_jobs);
+    for (auto k = 0U; k != num_jobs; ++k) {
+        CHECK_EQ(std::get<1>(results[k]), 29U);  // as in test_profit.cpp
+        CHECK_EQ(jobs[k].gamma, jobs[0].gamma);
+    }
+}
+
+TEST_CASE("parallel_cutting_plane_optim: lowpass problems") {
+    using Job = CuttingPlaneJob<LowpassOracle, Ell<Vec>>;
+    const auto num_jobs = 6U;
+    const auto lowpass = create_lowpass_case(32);
+    auto options = Options();
+    options.max_iters = 50000;
+    options.tolerance = 1e-14;
+    auto oracles = std::vector<LowpassOracle>(num_jobs, lowpass.first);
+    auto spaces = std::vector<Ell<Vec>>{};
+    auto jobs = std::vector<Job>{};
+    for (auto k = 0U; k != num_jobs; ++k) {
+        spaces.emplace_back(40.0 + k, Vec(0.0, 32));
+        spaces.back().set_use_parallel_cut(true);
+    }
+    for (auto k = 0U; k != num_jobs; ++k) {
+        jobs.push_back(Job{oracles[k], spaces[k], lowpass.second});
+    }
+    const auto results = parallel_cutting_plane_optim(jobs.begin(), jobs.end(), options, 4U);
+    REQUIRE_EQ(results.size(), num_jobs);
+    for (auto k = 0U; k != num_jobs; ++k) {
+        auto omega = lowpass.first;
+        auto ellip = Ell<Vec>(40.0 + k, Vec(0.0, 32));
+        ellip.set_use_parallel_cut(true);
+        auto spsq = lowpass.second;
+        const auto expected = cutting_plane_optim(omega, ellip, spsq, options);
+        CHECK_EQ(std::get<1>(results[k]), std::get<1>(expected));
+        CHECK_EQ(jobs[k].gamma, spsq);
+    }
+}
+
+/**
+ * @brief The oracle of test_example3.cpp, with y >= -2
+ *
+ * find x, y s.t. x >= -1, y >= -2, x + y <= 1, 2 x - 3 y <= gamma
+ */
+class Example3Oracle {
+    using Cut = std::pair<Vec, double>;
+
+    int idx = -1;
+    double target = -1e100;
+    Cut cuts[4] = {{Vec{-1.0, 0.0}, 0.0},
+                   {Vec{0.0, -1.0}, 0.0},
+                   {Vec{1.0, 1.0}, 0.0},
+                   {Vec{2.0, -3.0}, 0.0}};
+
+  public:
+    void update(double gamma) { this->target = gamma; }
+
+    auto assess_feas(const Vec &xc) -> Cut * {
+        const auto x = xc[0];
+        const auto y = xc[1];
+        for (int i = 0; i != 4; ++i) {
+            this->idx = (this->idx + 1) % 4;  // round robin
+            const double fj[4] = {-x - 1.0, -y - 2.0, x + y - 1.0, 2.0 * x - 3.0 * y - this->target};
+            if (fj[this->idx] > 0.0) {
+                this->cuts[this->idx].second = fj[this->idx];
+                return &this->cuts[this->idx];
+            }
+        }
+        return nullptr;
+    }
+};
+
+TEST_CASE("bsearch_parallel: one probe per round is bsearch") {
+    const auto options = Options{2000, 1e-8};
+    const auto intvl = std::pair<double, double>{-100.0, 100.0};
+    auto ellip1 = Ell<Vec>(Vec{100.0, 100.0}, Vec{0.0, 0.0});
+    auto omega1 = Example3Oracle{};
+    auto adaptor1 = BSearchAdaptor<Example3Oracle, Ell<Vec>>(omega1, ellip1, options);
+    const auto result1 = bsearch(adaptor1, intvl, options);
+
+    auto ellip2 = Ell<Vec>(Vec{100.0, 100.0}, Vec{0.0, 0.0});
+    auto omega2 = Example3Oracle{};
+    auto adaptor2 = ParallelBSearchAdaptor<Example3Oracle, Ell<Vec>>({&omega2}, ellip2, options);
+    const auto result2 = bsearch_parallel(adaptor2, intvl, options);
+    CHECK_EQ(std::get<1>(result2), std::get<1>(result1));
+    CHECK_EQ(std::get<0>(result2), std::get<0>(result1));
+}
+
+TEST_CASE("bsearch_parallel: three probes per round") {
+    const auto options = Options{2000, 1e-8};
+    auto ellip = Ell<Vec>(Vec{100.0, 100.0}, Vec{0.0, 0.0});
+    auto oracles = std::vector<Example3Oracle>(3);
+    auto adaptor = ParallelBSearchAdaptor<Example3Oracle, Ell<Vec>>(
+        {&oracles[0], &oracles[1], &oracles[2]}, ellip, options);
+    const auto result = bsearch_parallel(adaptor, std::pair<double, double>{-100.0, 100.0}, options);
+    CHECK_EQ(std::get<1>(result), 17U);  // half of the 34 rounds of bsearch
+    CHECK_EQ(std::get<0>(result), doctest::Approx(-8.0).epsilon(1e-4));  // at x = -1, y = 2
+    CHECK_EQ(adaptor.x_best().size(), 2U);
+}
+
+TEST_CASE("BackgroundWorker: the tasks one after another") {
+    BackgroundWorker worker{};
+    auto sum = 0U;
+    for (auto k = 1U; k <= 100U; ++k) {
+        worker.post([&sum, k]() { sum += k; });
+        worker.wait();
+        CHECK_EQ(sum, k * (k + 1U) / 2U);
+    }
+    worker.wait();  // nothing posted
+}
+
+TEST_CASE("cutting_plane_optim_pipelined: the iterates of cutting_plane_optim") {
+    const auto lowpass = create_lowpass_case(32);
+    auto options = Options();
+    options.max_iters = 50000;
+    options.tolerance = 1e-14;
+
+    auto omega = lowpass.first;
+    auto ellip = Ell<Vec>(40.0, Vec(0.0, 32));
+    ellip.set_use_parallel_cut(true);
+    auto spsq = lowpass.second;
+    const auto expected = cutting_plane_optim(omega, ellip, spsq, options);
+    REQUIRE_NE(std::get<0>(expected).size(), 0U);
+
+    auto omega_p = lowpass.first;
+    auto ellip_p = Ell<Vec>(40.0, Vec(0.0, 32));
+    ellip_p.set_use_parallel_cut(true);
+    auto spsq_p = lowpass.second;
+    auto stats = SolverStats();
+    const auto result = cutting_plane_optim_pipelined(omega_p, ellip_p, spsq_p, options, stats);
+    CHECK_EQ(std::get<1>(result), std::get<1>(expected));
+    CHECK_EQ(spsq_p, spsq);
+    CHECK_EQ(ellip_p.tsq(), ellip.tsq());
+    const auto &x = std::get<0>(result);
+    REQUIRE_EQ(x.size(), 32U);
+    for (auto i = 0U; i != 32U; ++i) {
+        CHECK_EQ(x[i], std::get<0>(expected)[i]);
+    }
+    CHECK_EQ(stats.num_updates(), std::get<1>(expected) + 1);
+
+    // the deferred update of the factorization
+    auto omega_s = lowpass.first;
+    auto ellip_s = EllStable<Vec>(40.0, Vec(0.0, 32));
+    auto spsq_s = lowpass.second;
+    const auto expected_s = cutting_plane_optim(omega_s, ellip_s, spsq_s, options);
+    auto omega_sp = lowpass.first;
+    auto ellip_sp = EllStable<Vec>(40.0, Vec(0.0, 32));
+    auto spsq_sp = lowpass.second;
+    const auto result_s = cutting_plane_optim_pipelined(omega_sp, ellip_sp, spsq_sp, options);
+    CHECK_EQ(std::get<1>(result_s), std::get<1>(expected_s));
+    CHECK_EQ(spsq_sp, spsq_s);
+    CHECK_EQ(ellip_sp.tsq(), ellip_s.tsq());
+}
+
+TEST_CASE("cutting_plane_feas_pipelined: the iterates of cutting_plane_feas") {
+    auto omega = Example3Oracle();
+    omega.update(0.0);
+    auto ellip = Ell<Vec>(100.0, Vec{0.0, 0.0});
+    const auto expected = cutting_plane_feas(omega, ellip);
+    REQUIRE_NE(std::get<0>(expected).size(), 0U);
+
+    auto omega_p = Example3Oracle();
+    omega_p.update(0.0);
+    auto ellip_p = Ell<Vec>(100.0, Vec{0.0, 0.0});
+    const auto result = cutting_plane_feas_pipelined(omega_p, ellip_p);
+    CHECK_EQ(std::get<1>(result), std::get<1>(expected));
+    CHECK_EQ(std::get<0>(result)[0], std::get<0>(expected)[0]);
+    CHECK_EQ(std::get<0>(result)[1], std::get<0>(expected)[1]);
+}
@@ -7,7 +7,7 @@
 #include <cmath>                              // for log
 #include <ellalgo/cutting_plane.hpp>          // for cutting_plane_optim, cutti...
 #include <ellalgo/ell.hpp>                    // for Ell
-#include <ellalgo/ell_config.hpp>             // for CInfo
+#include <ellalgo/ell_config.hpp>             // for Options, RestartOptions
 #include <ellalgo/ell_stable.hpp>             // for EllStable
 #include <ellalgo/oracles/profit_oracle.hpp>  // for ProfitOracle, profit_r...
 #include <tuple>                              // for get
@@ -106,3 +106,93 @@ TEST_CASE("Profit Test (Stable)") {
         CHECK_EQ(num_iters, 29);
     }();
 }
+
+TEST_CASE("Profit Test, restarted from a too small ellipsoid") {
+    using Vec = std::valarray<double>;
+
+    const auto a = Vec{0.1, 0.4};
+    const auto v = Vec{10.0, 35.0};
+
+    // the optimum lies outside of the initial ellipsoid
+    Ell<Vec> ellip_plain{Vec{0.01, 0.01}, Vec{0.0, 0.0}};
+    ProfitOracle omega_plain{20.0, 40.0, 30.5, a, v};
+    double gamma_plain = 0.0;
+    cutting_plane_optim(omega_plain, ellip_plain, gamma_plain);
+
+    Ell<Vec> ellip{Vec{0.01, 0.01}, Vec{0.0, 0.0}};
+    ProfitOracle omega{20.0, 40.0, 30.5, a, v};
+    double gamma = 0.0;
+    const auto result
+        = cutting_plane_optim_restart(omega, ellip, gamma, Options(), RestartOptions(10, 2.0));
+    const auto &y = std::get<0>(result);
+    REQUIRE_EQ(y.size(), 2U);
+    CHECK(y[0] <= std::log(30.5));
+    CHECK_LT(gamma_plain, 1000.0);
+    CHECK_EQ(gamma, doctest::Approx(3404.76).epsilon(1e-5));
+    CHECK_LT(std::get<1>(result), 200U);
+
+    // as cutting_plane_optim when it stops before the first restart
+    Ell<Vec> ellip_wide{Vec{100.0, 100.0}, Vec{0.0, 0.0}};
+    double gamma_wide = 0.0;
+    const auto wide = cutting_plane_optim_restart(omega, ellip_wide, gamma_wide, Options(),
+                                                  RestartOptions());
+    CHECK_EQ(std::get<1>(wide), 83U);
+}
+
+TEST_CASE("Profit Test, ProfitOracleQ with and without the cache") {
+    using Vec = std::valarray<double>;
+
+    const auto a = Vec{0.1, 0.4};
+    const auto v = Vec{10.0, 35.0};
+    Ell<Vec> ellip{100.0, Vec{0.0, 0.0}};
+    ProfitOracleQ omega{20.0, 40.0, 10.0, a, v};  // comes back to a few points
+    omega.use_cache = true;
+    double gamma = 0.0;
+    const auto result = cutting_plane_optim_q(omega, ellip, gamma);
+    CHECK_EQ(std::get<1>(result), 43U);
+    CHECK_GT(omega.num_hits(), 0U);
+    CHECK_LT(omega.num_cached(), 43U);
+    omega.clear_cache();
+    CHECK_EQ(omega.num_cached(), 0U);
+
+    Ell<Vec> ellip_nc{100.0, Vec{0.0, 0.0}};
+    ProfitOracleQ omega_nc{20.0, 40.0, 10.0, a, v};
+    double gamma_nc = 0.0;
+    const auto result_nc = cutting_plane_optim_q(omega_nc, ellip_nc, gamma_nc);
+    CHECK_EQ(std::get<1>(result_nc), 43U);
+    CHECK_EQ(omega_nc.num_cached(), 0U);
+    CHECK_EQ(gamma_nc, gamma);
+    CHECK_EQ(std::get<0>(result_nc)[0], std::get<0>(result)[0]);
+    CHECK_EQ(std::get<0>(result_nc)[1], std::get<0>(result)[1]);
+
+    // a cache of two points at most
+    Ell<Vec> ellip_b{100.0, Vec{0.0, 0.0}};
+    ProfitOracleQ omega_b{20.0, 40.0, 10.0, a, v};
+    omega_b.use_cache = true;
+    omega_b.max_cached = 2U;
+    double gamma_b = 0.0;
+    const auto result_b = cutting_plane_optim_q(omega_b, ellip_b, gamma_b);
+    CHECK_EQ(std::get<1>(result_b), 43U);
+    CHECK_LE(omega_b.num_cached(), 2U);
+    CHECK_EQ(gamma_b, gamma);
+
+    // the cut of the tuple, as that of the buffer
+    ProfitOracleQ omega_t{20.0, 40.0, 30.5, a, v};
+    ProfitOracleQ omega_s{20.0, 40.0, 30.5, a, v};
+    const auto y = Vec{2.0, 3.0};
+    auto gamma_t = 100.0;
+    auto gamma_s = 100.0;
+    const auto cut_t = omega_t.assess_optim_q(y, gamma_t, false);
+    auto grad = Vec(2);
+    auto beta = 0.0;
+    auto more_alt = false;
+    const auto *x_q = omega_s.assess_optim_q(y, gamma_s, false, make_span(grad), beta, more_alt);
+    REQUIRE(x_q != nullptr);
+    CHECK(std::get<1>(cut_t));
+    CHECK_EQ(gamma_s, gamma_t);
+    CHECK_EQ(grad[0], std::get<0>(cut_t).first[0]);
+    CHECK_EQ(grad[1], std::get<0>(cut_t).first[1]);
+    CHECK_EQ(beta, std::get<0>(cut_t).second);
+    CHECK_EQ((*x_q)[0], std::get<2>(cut_t)[0]);
+    CHECK_EQ(more_alt, std::get<3>(cut_t));
+}
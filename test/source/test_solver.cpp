@@ -0,0 +1,117 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK_EQ
+
+#include <cmath>                               // for exp
+#include <ellalgo/cutting_plane.hpp>           // for cutting_plane_optim
+#include <ellalgo/cutting_plane_observer.hpp>  // for SolverStats
+#include <ellalgo/cutting_plane_solver.hpp>    // for CuttingPlaneSolver
+#include <ellalgo/ell.hpp>                     // for Ell
+#include <ellalgo/ell_config.hpp>              // for Options
+#include <ellalgo/oracles/lowpass_oracle.hpp>  // for create_lowpass_case
+#include <tuple>                               // for get, tuple
+#include <utility>                             // for pair
+#include <valarray>                            // for valarray
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief The oracle of test_quasicvx.cpp
+ */
+struct MySlicedOracle {
+    using Cut = std::pair<Vec, double>;
+
+    int idx = -1;  // for round robin
+
+    auto assess_optim(const Vec &xc, double &gamma) -> std::tuple<Cut, bool> {
+        const auto sqrtx = xc[0];
+        const auto logy = xc[1];
+        const auto y = std::exp(logy);
+        for (int i = 0; i != 2; i++) {
+            this->idx = this->idx == 1 ? 0 : this->idx + 1;
+            double fj;
+            if (this->idx == 0 && (fj = sqrtx * sqrtx - logy) > 0.0) {  // exp(x) <= y
+                return {{Vec{2 * sqrtx, -1.0}, fj}, false};
+            }
+            const auto tmp3 = gamma * y;
+            if (this->idx == 1 && (fj = -sqrtx + tmp3) > 0.0) {
+                return {{Vec{-1.0, tmp3}, fj}, false};
+            }
+        }
+        gamma = sqrtx / y;
+        return {{Vec{-1.0, sqrtx}, 0}, true};
+    }
+};
+
+TEST_CASE("CuttingPlaneSolver, by slices of iterations") {
+    const auto options = Options{2000, 1e-8};
+    auto omega = MySlicedOracle{};
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0});
+    auto gamma = 0.0;
+    const auto expected = cutting_plane_optim(omega, ellip, gamma, options);
+    REQUIRE_EQ(std::get<1>(expected), 35U);  // as in test_quasicvx.cpp
+
+    for (auto slice = 1U; slice != 9U; ++slice) {
+        auto omega_s = MySlicedOracle{};
+        auto ellip_s = Ell<Vec>(10.0, Vec{0.0, 0.0});
+        auto solver = make_cutting_plane_solver(omega_s, ellip_s, 0.0, options);
+        auto num_slices = 0U;
+        while (!solver.resume(slice)) {
+            ++num_slices;
+            CHECK_EQ(solver.num_iters(), num_slices * slice);
+            CHECK_EQ(solver.tsq(), ellip_s.tsq());
+        }
+        CHECK(solver.done());
+        CHECK(solver.resume(1U));  // stays done
+        CHECK_EQ(solver.num_iters(), std::get<1>(expected));
+        CHECK_EQ(solver.gamma(), gamma);
+        REQUIRE_EQ(solver.x_best().size(), 2U);
+        CHECK_EQ(solver.x_best()[0], std::get<0>(expected)[0]);
+        CHECK_EQ(solver.x_best()[1], std::get<0>(expected)[1]);
+    }
+}
+
+TEST_CASE("CuttingPlaneSolver, two solves interleaved") {
+    const auto lowpass = create_lowpass_case(32);
+    auto options = Options();
+    options.max_iters = 50000;
+    options.tolerance = 1e-14;
+    auto omega = lowpass.first;
+    auto ellip = Ell<Vec>(40.0, Vec(0.0, 32));
+    auto spsq = lowpass.second;
+    const auto expected = cutting_plane_optim(omega, ellip, spsq, options);
+
+    auto omega1 = lowpass.first;
+    auto ellip1 = Ell<Vec>(40.0, Vec(0.0, 32));
+    auto omega2 = MySlicedOracle{};
+    auto ellip2 = Ell<Vec>(10.0, Vec{0.0, 0.0});
+    using Solver1 = CuttingPlaneSolver<LowpassOracle, Ell<Vec>, double, SolverStats>;
+    auto solver1 = Solver1(omega1, ellip1, lowpass.second, options, SolverStats());
+    auto solver2 = make_cutting_plane_solver(omega2, ellip2, 0.0, Options{2000, 1e-8});
+    auto done1 = false;
+    auto done2 = false;
+    while (!done1 || !done2) {
+        done1 = solver1.resume(100U);
+        done2 = solver2.resume(3U);
+    }
+    const auto result1 = solver1.result();
+    CHECK_EQ(std::get<1>(result1), std::get<1>(expected));
+    CHECK_EQ(solver1.gamma(), spsq);
+    CHECK_EQ(solver1.observer().num_updates(), std::get<1>(expected) + 1);
+    CHECK_EQ(solver2.num_iters(), 35U);
+}
+
+TEST_CASE("CuttingPlaneSolver, to max_iters") {
+    auto omega = MySlicedOracle{};
+    auto ellip = Ell<Vec>(10.0, Vec{0.0, 0.0});
+    auto solver = make_cutting_plane_solver(omega, ellip, 0.0, Options{20, 1e-8});
+    CHECK_FALSE(solver.resume(19U));
+    CHECK(solver.resume(5U));
+    CHECK_EQ(std::get<1>(solver.run()), 20U);
+
+    auto solver0 = make_cutting_plane_solver(omega, ellip, 0.0, Options{0, 1e-8});
+    CHECK(solver0.done());
+    CHECK_EQ(solver0.x_best().size(), 0U);
+}
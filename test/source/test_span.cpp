@@ -0,0 +1,103 @@
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, CHECK, TestCase
+
+#include <ellalgo/cutting_plane.hpp>       // for cutting_plane_feas
+#include <ellalgo/ell.hpp>                 // for Ell
+#include <ellalgo/ell_matrix.hpp>          // for Matrix
+#include <ellalgo/ell_span.hpp>            // for Span
+#include <ellalgo/ell_stable.hpp>          // for EllStable
+#include <ellalgo/oracles/lmi_oracle.hpp>  // for LmiOracle
+#include <tuple>                           // for get
+#include <utility>                         // for pair
+#include <valarray>                        // for valarray
+#include <vector>                          // for vector
+
+using Vec = std::valarray<double>;
+
+/**
+ * @brief Hides the span-based interface of an oracle
+ */
+template <typename Oracle> class PairOnly {
+    Oracle &_omega;
+
+  public:
+    explicit PairOnly(Oracle &omega) : _omega{omega} {}
+
+    auto assess_feas(const Vec &x) -> decltype(_omega.assess_feas(x)) {
+        return this->_omega.assess_feas(x);
+    }
+};
+
+template <typename Space> static auto check_grad_buffer() -> void {
+    const auto cut = std::make_pair(Vec{1.0, -2.0, 0.5}, 0.01);
+    Space ell1{10.0, Vec{0.0, 0.0, 0.0}};
+    Space ell2{10.0, Vec{0.0, 0.0, 0.0}};
+    for (auto k = 0; k != 3; ++k) {
+        CHECK_EQ(ell1.update_bias_cut(cut), CutStatus::Success);
+        const auto grad = ell2.grad_buffer();
+        REQUIRE_EQ(grad.size(), 3U);
+        for (auto i = 0U; i != grad.size(); ++i) {
+            grad[i] = cut.first[i];
+        }
+        CHECK_EQ(ell2.update_bias_cut(Span<const double>(grad), cut.second), CutStatus::Success);
+    }
+    CHECK_EQ(ell1.tsq(), ell2.tsq());
+    const auto x1 = ell1.xc();
+    const auto x2 = ell2.xc();
+    for (auto i = 0U; i != 3U; ++i) {
+        CHECK_EQ(x1[i], x2[i]);
+    }
+}
+
+TEST_CASE("Span: view of a valarray") {
+    auto v = Vec{1.0, 2.0, 3.0};
+    const auto s = make_span(v);
+    CHECK_EQ(s.size(), 3U);
+    CHECK_EQ(s.data(), &v[0]);
+    s[1] = 5.0;
+    CHECK_EQ(v[1], 5.0);
+    const Span<const double> cs = s;
+    auto sum = 0.0;
+    for (const auto &e : cs) {
+        sum += e;
+    }
+    CHECK_EQ(sum, 9.0);
+    CHECK(Span<double>{}.empty());
+}
+
+TEST_CASE("Ell: cut written into grad_buffer()") { check_grad_buffer<Ell<Vec>>(); }
+
+TEST_CASE("EllStable: cut written into grad_buffer()") { check_grad_buffer<EllStable<Vec>>(); }
+
+TEST_CASE("cutting_plane_feas: span-based and pair-based oracles agree") {
+    auto m0 = Matrix(2);
+    m0.row(0) = Vec{-7.0, -11.0};
+    m0.row(1) = Vec{-11.0, 3.0};
+    auto m1 = Matrix(2);
+    m1.row(0) = Vec{7.0, -18.0};
+    m1.row(1) = Vec{-18.0, 8.0};
+    auto m2 = Matrix(2);
+    m2.row(0) = Vec{-2.0, -8.0};
+    m2.row(1) = Vec{-8.0, 1.0};
+    const auto F = std::vector<Matrix>{m0, m1, m2};
+    auto B = Matrix(2);
+    B.row(0) = Vec{-3.0, -9.0};  // x = 0 is infeasible
+    B.row(1) = Vec{-9.0, 6.0};
+
+    using Oracle = LmiOracle<Vec, Matrix>;
+    static_assert(detail::has_span_feas<Oracle, Ell<Vec>>::value, "span-based");
+    static_assert(!detail::has_span_feas<PairOnly<Oracle>, Ell<Vec>>::value, "pair-based");
+
+    auto omega1 = Oracle(2, F, B);
+    auto ell1 = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    const auto result1 = cutting_plane_feas(omega1, ell1);
+
+    auto omega2 = Oracle(2, F, B);
+    auto wrapper = PairOnly<Oracle>(omega2);
+    auto ell2 = Ell<Vec>(10.0, Vec{0.0, 0.0, 0.0});
+    const auto result2 = cutting_plane_feas(wrapper, ell2);
+
+    CHECK_GT(std::get<1>(result1), 0U);
+    CHECK_EQ(std::get<1>(result1), std::get<1>(result2));
+    CHECK_EQ(ell1.tsq(), ell2.tsq());
+}
@@ -0,0 +1,81 @@
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>  // for ResultBuilder, TestCase, CHECK
+
+#include <cstdint>                     // for uintptr_t
+#include <ellalgo/ell_memory.hpp>      // for PoolResource
+#include <ellalgo/ell_sym_matrix.hpp>  // for SymMatrix
+#include <utility>                     // for move
+
+using Vec = std::valarray<double>;
+
+TEST_CASE("SymMatrix test 1") {
+    SymMatrix m1(3U);
+    m1(0, 0) = 25.0;
+    m1(1, 0) = 15.0;
+    m1(2, 0) = -5.0;
+    m1(1, 1) = 18.0;
+    m1(2, 2) = 11.0;
+    CHECK_EQ(m1(0, 1), 15.0);
+    CHECK_EQ(m1(1, 2), 0.0);
+    CHECK_EQ(m1(0, 2), -5.0);
+    CHECK_EQ(m1.trace(), 54.0);
+
+    m1.set_diagonal(Vec{4.0, 5.0, 6.0});
+    CHECK_EQ(m1(0, 0), 4.0);
+    CHECK_EQ(m1(1, 1), 5.0);
+    CHECK_EQ(m1(2, 2), 6.0);
+    CHECK_EQ(m1(2, 0), -5.0);
+}
+
+TEST_CASE("SymMatrix test 2 (packed layout)") {
+    SymMatrix m2(10U, 1.0);
+    CHECK_EQ(SymMatrix::offset(10U, 0U), 0U);
+    CHECK_EQ(SymMatrix::offset(10U, 1U), 16U);  // 10 elements padded to 16
+    CHECK_EQ(SymMatrix::offset(10U, 2U), 32U);  // 9 elements padded to 16
+    CHECK_EQ(m2.storage_size(), SymMatrix::offset(10U, 10U));
+    for (auto j = 0U; j != 10U; ++j) {
+        const auto addr = reinterpret_cast<std::uintptr_t>(m2.column(j));
+        CHECK_EQ(addr % SymMatrix::cache_line, 0U);
+        CHECK_EQ(m2.column(j)[0], 1.0);
+        CHECK_EQ(&m2.column(j)[9 - j], &m2(9, j));
+    }
+
+    m2 *= 2.0;
+    CHECK_EQ(m2.trace(), 20.0);
+    m2.identity();
+    CHECK_EQ(m2(3, 4), 0.0);
+    CHECK_EQ(m2(4, 4), 1.0);
+}
+
+TEST_CASE("SymMatrix test 3 (copy)") {
+    SymMatrix m3(4U);
+    m3.identity();
+    m3(3, 1) = 2.0;
+    auto m4 = m3;
+    CHECK_EQ(m4(1, 3), 2.0);
+    m4(1, 3) = 5.0;
+    CHECK_EQ(m3(3, 1), 2.0);
+    const auto *buffer = m4.data();
+    m4 = m3;  // same size: reuse the buffer
+    CHECK_EQ(m4.data(), buffer);
+    CHECK_EQ(m4(3, 1), 2.0);
+}
+
+TEST_CASE("SymMatrix test 4 (memory resource)") {
+    PoolResource pool;
+    SymMatrix m5(5U, 1.0, &pool);
+    CHECK_EQ(m5.resource(), &pool);
+    CHECK_EQ(SymMatrix(5U).resource(), default_resource());
+    CHECK_EQ(reinterpret_cast<std::uintptr_t>(m5.data()) % SymMatrix::cache_line, 0U);
+    const auto *buffer = [&]() {
+        auto m6 = m5;  // from the pool too
+        CHECK_EQ(m6.resource(), &pool);
+        CHECK_EQ(m6(4, 2), 1.0);
+        return m6.data();
+    }();
+    auto m7 = m5;  // the block given back by m6
+    CHECK_EQ(m7.data(), buffer);
+    const auto m8 = std::move(m7);
+    CHECK_EQ(m8.resource(), &pool);
+    CHECK_EQ(pool.num_blocks(), 2U);
+}
@@ -5,6 +5,16 @@ add_requires("doctest", {alias = "doctest"})
 add_requires("fmt", {alias = "fmt"})
 add_requires("benchmark", {alias = "benchmark"})
 
+option("lto")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Enable link-time optimization")
+option_end()
+
+if has_config("lto") then
+    set_policy("build.optimization.lto", true)
+end
+
 if is_mode("coverage") then
     add_cxflags("-ftest-coverage", "-fprofile-arcs", {force = true})
 end
@@ -21,6 +31,9 @@ target("EllAlgo")
     add_includedirs("include", {public = true})
     add_files("source/*.cpp")
     add_packages("fmt")
+    if is_plat("linux") then
+        add_syslinks("pthread", {public = true})
+    end
 
 target("test_ellalgo")
     set_kind("binary")